@@ -0,0 +1,416 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlBitStream.h"
+#include "tnlPlatform.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+static U32 nextRandom(U32 &seed)
+{
+   seed = seed * 1664525 + 1013904223;
+   return seed >> 8;
+}
+
+
+// The byte-at-a-time writeBits and readBits BitStream used before it went a word at a time, working on a bare buffer.
+// Everything written by the new code has to come out the same as this.
+static void legacyWriteBits(U8 *buffer, U32 &bitNum, U32 bitCount, const void *bitPtr)
+{
+   if(!bitCount)
+      return;
+
+   const U8 *sourcePtr = (const U8 *) bitPtr;
+   U32 upShift  = bitNum & 0x7;
+   U32 downShift= 8 - upShift;
+   U8 *destPtr = buffer + (bitNum >> 3);
+   U32 startBit = bitNum;
+
+   bitNum += bitCount;
+
+   if(downShift >= bitCount)
+   {
+      U8 mask = ((1 << bitCount) - 1) << upShift;
+      *destPtr = (*destPtr & ~mask) | ((*sourcePtr << upShift) & mask);
+      return;
+   }
+
+   if(!upShift)
+   {
+      for(; bitCount >= 8; bitCount -= 8)
+         *destPtr++ = *sourcePtr++;
+      if(bitCount)
+      {
+         U8 mask = (1 << bitCount) - 1;
+         *destPtr = (*sourcePtr & mask) | (*destPtr & ~mask);
+      }
+      return;
+   }
+
+   U8 sourceByte;
+   U8 destByte = *destPtr & (0xFF >> downShift);
+   U8 lastMask  = 0xFF >> (7 - ((startBit + bitCount - 1) & 0x7));
+
+   for(; bitCount >= 8; bitCount -= 8)
+   {
+      sourceByte = *sourcePtr++;
+      *destPtr++ = destByte | (sourceByte << upShift);
+      destByte = sourceByte >> downShift;
+   }
+   if(bitCount == 0)
+   {
+      *destPtr = (*destPtr & ~lastMask) | (destByte & lastMask);
+      return;
+   }
+   if(bitCount <= downShift)
+   {
+      *destPtr = (*destPtr & ~lastMask) | ((destByte | (*sourcePtr << upShift)) & lastMask);
+      return;
+   }
+   sourceByte = *sourcePtr;
+
+   *destPtr++ = destByte | (sourceByte << upShift);
+   *destPtr = (*destPtr & ~lastMask) | ((sourceByte >> downShift) & lastMask);
+}
+
+
+// Mostly lower case and spaces, like chat, with the odd character from anywhere else
+static string randomString(U32 &seed)
+{
+   U32 len = nextRandom(seed) % 100;
+   string str;
+
+   for(U32 i = 0; i < len; i++)
+   {
+      U32 pick = nextRandom(seed) % 10;
+      if(pick < 6)
+         str += char('a' + nextRandom(seed) % 26);
+      else if(pick < 8)
+         str += ' ';
+      else
+         str += char(1 + nextRandom(seed) % 255);
+   }
+
+   return str;
+}
+
+
+// Strings with some flags and odd-sized ints in between, so they start all over the place within a byte
+static void writeStrings(BitStream &stream, U32 seed, S32 count)
+{
+   for(S32 i = 0; i < count; i++)
+   {
+      U32 value = nextRandom(seed);
+      U8 bitCount = U8(nextRandom(seed) % 8);
+
+      stream.writeInt(value, bitCount);
+      stream.writeString(randomString(seed).c_str());
+      stream.writeFlag(nextRandom(seed) & 1);
+   }
+}
+
+
+static void readStrings(BitStream &stream, U32 seed, S32 count)
+{
+   char buffer[256];
+
+   for(S32 i = 0; i < count; i++)
+   {
+      U32 value = nextRandom(seed);
+      U8 bitCount = U8(nextRandom(seed) % 8);
+
+      ASSERT_EQ(value & ((1 << bitCount) - 1), stream.readInt(bitCount)) << "string " << i;
+      stream.readString(buffer);
+      ASSERT_EQ(randomString(seed), string(buffer)) << "string " << i;
+      ASSERT_EQ(bool(nextRandom(seed) & 1), stream.readFlag()) << "string " << i;
+   }
+}
+
+
+static U64 hashBytes(const U8 *bytes, U32 count)
+{
+   U64 hash = 14695981039346656037ULL;    // FNV-1a
+   for(U32 i = 0; i < count; i++)
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+
+   return hash;
+}
+
+
+enum FuzzOp {
+   FuzzFlag,
+   FuzzInt,
+   FuzzInt64,
+   FuzzBytes,
+   FuzzBits,
+   FuzzOpCount
+};
+
+struct FuzzEntry
+{
+   FuzzOp op;
+   U32 bitCount;
+   U8 data[48];
+};
+
+
+// Fills a small buffer with a random mix of fields, right up to the end, so both the word-at-a-time paths and the
+// byte-at-a-time ones near the end get a go
+static void fuzzOnce(U32 &seed)
+{
+   const U32 BufferSize = 8 + nextRandom(seed) % 120;
+   U8 buffer[128], legacyBuffer[128];
+
+   // Start with junk, to check that writes leave the bits around them alone
+   for(U32 i = 0; i < BufferSize; i++)
+      buffer[i] = legacyBuffer[i] = U8(nextRandom(seed));
+
+   BitStream stream(buffer, BufferSize);
+   U32 legacyBitNum = 0;
+
+   // Start somewhere other than the beginning now and then
+   U32 startBit = nextRandom(seed) % 2 ? 0 : nextRandom(seed) % 13;
+   stream.setBitPosition(startBit);
+   legacyBitNum = startBit;
+
+   Vector<FuzzEntry> entries;
+
+   while(true)
+   {
+      FuzzEntry entry;
+      entry.op = FuzzOp(nextRandom(seed) % FuzzOpCount);
+
+      switch(entry.op)
+      {
+         case FuzzFlag:  entry.bitCount = 1;                                break;
+         case FuzzInt:   entry.bitCount = nextRandom(seed) % 33;            break;
+         case FuzzInt64: entry.bitCount = 1 + nextRandom(seed) % 64;        break;
+         case FuzzBytes: entry.bitCount = (1 + nextRandom(seed) % 40) * 8;  break;
+         default:        entry.bitCount = 1 + nextRandom(seed) % 384;       break;
+      }
+
+      if(entry.bitCount > stream.getBitSpaceAvailable())
+         break;
+
+      for(U32 i = 0; i < sizeof(entry.data); i++)
+         entry.data[i] = U8(nextRandom(seed));
+
+      U32 value32;
+      U64 value64;
+      memcpy(&value32, entry.data, sizeof(value32));
+      memcpy(&value64, entry.data, sizeof(value64));
+      value32 = convertLEndianToHost(value32);
+      value64 = convertLEndianToHost(value64);
+
+      switch(entry.op)
+      {
+         case FuzzFlag:  stream.writeFlag(entry.data[0] & 1);                      break;
+         case FuzzInt:   stream.writeInt(value32, U8(entry.bitCount));            break;
+         case FuzzInt64: stream.writeInt64(value64, U8(entry.bitCount));          break;
+         case FuzzBytes: stream.write(entry.bitCount >> 3, entry.data);           break;
+         default:        stream.writeBits(entry.bitCount, entry.data);            break;
+      }
+
+      // Ints go on the wire little-endian, so data holds the same bits in wire order
+      legacyWriteBits(legacyBuffer, legacyBitNum, entry.bitCount, entry.data);
+      entries.push_back(entry);
+
+      ASSERT_EQ(legacyBitNum, stream.getBitPosition());
+   }
+
+   ASSERT_TRUE(stream.isValid());
+   for(U32 i = 0; i < BufferSize; i++)
+      ASSERT_EQ(legacyBuffer[i], buffer[i]) << "byte " << i << " of " << BufferSize;
+
+   // And it all reads back again
+   BitStream reader(buffer, BufferSize);
+   reader.setBitPosition(startBit);
+
+   for(S32 i = 0; i < entries.size(); i++)
+   {
+      const FuzzEntry &entry = entries[i];
+      U8 data[sizeof(entry.data)];
+
+      U32 value32;
+      U64 value64;
+      memcpy(&value32, entry.data, sizeof(value32));
+      memcpy(&value64, entry.data, sizeof(value64));
+      value32 = convertLEndianToHost(value32);
+      value64 = convertLEndianToHost(value64);
+
+      switch(entry.op)
+      {
+         case FuzzFlag:
+            ASSERT_EQ(bool(entry.data[0] & 1), reader.readFlag());
+            break;
+
+         case FuzzInt:
+            ASSERT_EQ(entry.bitCount == 32 ? value32 : value32 & ((1 << entry.bitCount) - 1), reader.readInt(U8(entry.bitCount)));
+            break;
+
+         case FuzzInt64:
+            ASSERT_EQ(entry.bitCount == 64 ? value64 : value64 & ((U64(1) << entry.bitCount) - 1), reader.readInt64(U8(entry.bitCount)));
+            break;
+
+         default:
+            reader.readBits(entry.bitCount, data);
+            for(U32 bit = 0; bit < entry.bitCount; bit++)
+               ASSERT_EQ((entry.data[bit >> 3] >> (bit & 7)) & 1, (data[bit >> 3] >> (bit & 7)) & 1) << "bit " << bit;
+            break;
+      }
+   }
+
+   ASSERT_EQ(legacyBitNum, reader.getBitPosition());
+   ASSERT_TRUE(reader.isValid());
+}
+
+
+TEST(BitStreamTest, SameBitsAsByteAtATime)
+{
+   U32 seed = 4321;
+   for(S32 i = 0; i < 5000; i++)
+   {
+      fuzzOnce(seed);
+      if(HasFatalFailure())
+      {
+         ADD_FAILURE() << "iteration " << i;
+         return;
+      }
+   }
+}
+
+
+// Reading past the end still fails, from either path
+TEST(BitStreamTest, ReadPastEnd)
+{
+   U8 buffer[16] = { 0 };
+
+   BitStream stream(buffer, sizeof(buffer));
+   stream.setBitPosition(sizeof(buffer) * 8 - 10);
+   stream.readInt(8);
+   EXPECT_TRUE(stream.isValid());
+   stream.readInt(8);
+   EXPECT_FALSE(stream.isValid());
+
+   BitStream bigRead(buffer, sizeof(buffer));
+   U8 dest[32];
+   EXPECT_FALSE(bigRead.readBits(sizeof(buffer) * 8 + 1, dest));
+   EXPECT_FALSE(bigRead.isValid());
+}
+
+
+// Huffman strings come out exactly as they did before table-driven decoding and batched code writes, and read back,
+// including the last few, which have to be decoded a bit at a time
+TEST(BitStreamTest, HuffmanStringsUnchanged)
+{
+   static U8 buffer[1 << 16];
+
+   BitStream stream(buffer, sizeof(buffer));
+   writeStrings(stream, 1234, 500);
+
+   // Written by the byte-at-a-time, bit-at-a-time implementation
+   EXPECT_EQ(180436U, stream.getBitPosition());
+   EXPECT_EQ(0xae76a68b47979855ULL, hashBytes(buffer, stream.getBytePosition()));
+
+   BitStream reader(buffer, stream.getBytePosition());
+   readStrings(reader, 1234, 500);
+   EXPECT_EQ(stream.getBitPosition(), reader.getBitPosition());
+   EXPECT_TRUE(reader.isValid());
+}
+
+
+TEST(BitStreamTest, Benchmark)
+{
+   const U32 BufferSize = 1 << 20;
+   const S32 Passes = 20;
+   U8 *buffer = new U8[BufferSize];
+   U8 *legacyBuffer = new U8[BufferSize];
+   memset(buffer, 0, BufferSize);
+   memset(legacyBuffer, 0, BufferSize);
+
+   // Mostly flags and small ints, like the ghost updates they are
+   U32 fieldBits[16];
+   U32 seed = 99;
+   for(S32 i = 0; i < 16; i++)
+      fieldBits[i] = i % 3 == 0 ? 1 : 1 + nextRandom(seed) % 16;
+
+   U32 fieldCount = 0, sum = 0;
+
+   U32 start = Platform::getRealMilliseconds();
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      BitStream stream(buffer, BufferSize);
+      for(fieldCount = 0; stream.getBitSpaceAvailable() >= 32; fieldCount++)
+      {
+         U32 bits = fieldBits[fieldCount & 15];
+         if(bits == 1)
+            stream.writeFlag(fieldCount & 1);
+         else
+            stream.writeInt(fieldCount, U8(bits));
+      }
+   }
+   U32 writeTime = Platform::getRealMilliseconds() - start;
+
+   start = Platform::getRealMilliseconds();
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      U32 bitNum = 0;
+      for(U32 i = 0; i < fieldCount; i++)
+      {
+         U32 value = i;
+         legacyWriteBits(legacyBuffer, bitNum, fieldBits[i & 15], &value);
+      }
+   }
+   U32 legacyWriteTime = Platform::getRealMilliseconds() - start;
+
+   EXPECT_EQ(0, memcmp(buffer, legacyBuffer, BufferSize));
+
+   start = Platform::getRealMilliseconds();
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      BitStream stream(buffer, BufferSize);
+      for(U32 i = 0; i < fieldCount; i++)
+      {
+         U32 bits = fieldBits[i & 15];
+         sum += bits == 1 ? stream.readFlag() : stream.readInt(U8(bits));
+      }
+   }
+   U32 readTime = Platform::getRealMilliseconds() - start;
+   EXPECT_NE(0U, sum);
+
+   start = Platform::getRealMilliseconds();
+   U32 stringBytes = 0;
+   for(S32 pass = 0; pass < Passes; pass++)
+   {
+      BitStream stream(buffer, BufferSize);
+      writeStrings(stream, 1234, 5000);
+      stringBytes = stream.getBytePosition();
+
+      BitStream reader(buffer, stringBytes);
+      readStrings(reader, 1234, 5000);
+   }
+   U32 stringTime = Platform::getRealMilliseconds() - start;
+
+   delete [] buffer;
+   delete [] legacyBuffer;
+
+   F32 megabytes = F32(BufferSize) * Passes / (1024 * 1024);
+   F32 stringMegabytes = F32(stringBytes) * Passes / (1024 * 1024);
+
+   printf("flags and small ints: write %.0f MB/s (byte-at-a-time %.0f MB/s), read %.0f MB/s; "
+          "strings: write and read %.0f MB/s\n",
+          megabytes * 1000 / max(writeTime, 1U), megabytes * 1000 / max(legacyWriteTime, 1U),
+          megabytes * 1000 / max(readTime, 1U), stringMegabytes * 1000 / max(stringTime, 1U));
+}
+
+};
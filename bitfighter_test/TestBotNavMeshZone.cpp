@@ -0,0 +1,281 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotNavMeshZone.h"
+#include "stringUtils.h"
+
+#include "tnlPlatform.h"
+#include "tnlThread.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+
+namespace Zap
+{
+
+static const string CacheFile = "botzone_cache_test.botzones";
+
+// A single wall in the middle of the map
+static BotZoneGeometry getTestGeometry()
+{
+   BotZoneGeometry geometry;
+   geometry.bounds.set(Point(-500, -500), Point(500, 500));
+
+   Vector<Point> wall;
+   wall.push_back(Point(-50, -200));
+   wall.push_back(Point( 50, -200));
+   wall.push_back(Point( 50,  200));
+   wall.push_back(Point(-50,  200));
+   geometry.inputPolygons.push_back(wall);
+
+   return geometry;
+}
+
+
+// A grid of pillars, for a big nav mesh with lots of ways through it
+static BotZoneGeometry getPillarGeometry(S32 pillarsPerSide)
+{
+   const F32 Spacing = 200;
+   const F32 Half = pillarsPerSide * Spacing / 2;
+
+   BotZoneGeometry geometry;
+   geometry.bounds.set(Point(-Half, -Half), Point(Half, Half));
+
+   for(S32 i = 0; i < pillarsPerSide; i++)
+      for(S32 j = 0; j < pillarsPerSide; j++)
+      {
+         Point center(-Half + (i + 0.5f) * Spacing, -Half + (j + 0.5f) * Spacing);
+
+         Vector<Point> pillar;
+         pillar.push_back(center + Point(-30, -30));
+         pillar.push_back(center + Point( 30, -30));
+         pillar.push_back(center + Point( 30,  30));
+         pillar.push_back(center + Point(-30,  30));
+         geometry.inputPolygons.push_back(pillar);
+      }
+
+   return geometry;
+}
+
+
+static void buildZones(const BotZoneGeometry &geometry, GridDatabase *database, Vector<BotNavMeshZone *> *zones)
+{
+   Vector<pair<Point, const Vector<Point> *> > noTeleporters;
+   BotNavMeshZone::createBotMeshZones(geometry, database, zones, noTeleporters, false);
+}
+
+
+TEST(BotNavMeshZoneTest, CacheRoundTrip)
+{
+   BotZoneGeometry built = getTestGeometry();
+   ASSERT_TRUE(BotNavMeshZone::computeBotMeshZones(built));
+   ASSERT_TRUE(built.recastPassed);
+   ASSERT_GT(built.zones.size(), 1);
+   ASSERT_TRUE(built.saveToCache(CacheFile));
+
+   BotZoneGeometry loaded = getTestGeometry();
+   ASSERT_TRUE(loaded.loadFromCache(CacheFile));
+
+   EXPECT_TRUE(loaded.recastPassed);
+   ASSERT_EQ(built.zones.size(), loaded.zones.size());
+   ASSERT_EQ(built.neighbors.size(), loaded.neighbors.size());
+
+   for(S32 i = 0; i < built.zones.size(); i++)
+   {
+      EXPECT_EQ(built.zones[i].getStlVector(), loaded.zones[i].getStlVector());
+      ASSERT_EQ(built.neighbors[i].size(), loaded.neighbors[i].size());
+
+      for(S32 j = 0; j < built.neighbors[i].size(); j++)
+      {
+         EXPECT_EQ(built.neighbors[i][j].zoneID, loaded.neighbors[i][j].zoneID);
+         EXPECT_EQ(built.neighbors[i][j].borderCenter, loaded.neighbors[i][j].borderCenter);
+         EXPECT_EQ(built.neighbors[i][j].distTo, loaded.neighbors[i][j].distTo);
+      }
+   }
+
+   remove(CacheFile.c_str());
+}
+
+
+// Cache must not be used if the geometry it was built from changed, or if the file is damaged
+TEST(BotNavMeshZoneTest, CacheInvalidation)
+{
+   BotZoneGeometry built = getTestGeometry();
+   ASSERT_TRUE(BotNavMeshZone::computeBotMeshZones(built));
+   ASSERT_TRUE(built.saveToCache(CacheFile));
+
+   BotZoneGeometry moved = getTestGeometry();
+   moved.inputPolygons[0][0].x += 1;
+   EXPECT_FALSE(moved.loadFromCache(CacheFile));
+   EXPECT_EQ(0, moved.zones.size());
+
+   BotZoneGeometry missing = getTestGeometry();
+   EXPECT_FALSE(missing.loadFromCache(CacheFile + ".missing"));
+
+   // Chop the end off
+   string contents = readFile(CacheFile);
+   ASSERT_TRUE(writeFile(CacheFile, contents.substr(0, contents.size() - 3)));
+
+   BotZoneGeometry truncated = getTestGeometry();
+   EXPECT_FALSE(truncated.loadFromCache(CacheFile));
+
+   // Different builder version
+   contents[4]++;
+   ASSERT_TRUE(writeFile(CacheFile, contents));
+
+   BotZoneGeometry oldVersion = getTestGeometry();
+   EXPECT_FALSE(oldVersion.loadFromCache(CacheFile));
+
+   remove(CacheFile.c_str());
+}
+
+
+// Sum of the link costs along a flight plan laid out as AStar::findPath does: from each zone's center to the gateway
+// into the next zone (no teleporters here)
+static F32 getRouteCost(const Vector<Point> &route)
+{
+   F32 cost = 0;
+   for(S32 i = 2; i + 1 < route.size() - 1; i += 2)
+      cost += route[i + 1].distanceTo(route[i]);
+
+   return cost;
+}
+
+
+// Routes come back laid out as findPath does, and bots heading for the same zone share one search
+TEST(BotNavMeshZoneTest, RouteCache)
+{
+   BotZoneGeometry geometry = getPillarGeometry(8);
+   ASSERT_TRUE(BotNavMeshZone::computeBotMeshZones(geometry));
+
+   GridDatabase database;
+   Vector<BotNavMeshZone *> zones;
+   buildZones(geometry, &database, &zones);
+   ASSERT_GT(zones.size(), 50);
+
+   ZoneRouteCache cache;
+   S32 targetZone = zones.size() - 1;
+   Point target = zones[targetZone]->getCenter() + Point(1, 1);
+   Vector<Point> route;
+
+   for(S32 i = 0; i < targetZone; i++)
+   {
+      Point otherTarget = target + Point(F32(i % 3), 0);     // Somewhere in the same zone
+      ASSERT_TRUE(cache.getRoute(&zones, i, targetZone, otherTarget, route));
+
+      ASSERT_GE(route.size(), 3);
+      EXPECT_EQ(otherTarget, route[0]);
+      EXPECT_EQ(zones[targetZone]->getCenter(), route[1]);
+      EXPECT_EQ(zones[i]->getCenter(), route[route.size() - 2]);
+      EXPECT_EQ(zones[i]->getCenter(), route.last());
+
+      // Cache searches the whole map, so it can only do as well or better than A*
+      Vector<Point> path = AStar::findPath(&zones, i, targetZone, otherTarget);
+      EXPECT_LE(getRouteCost(route), getRouteCost(path) + 0.01f);
+   }
+
+   EXPECT_EQ(1, cache.getSearchCount());
+   EXPECT_EQ(U32(targetZone - 1), cache.getHitCount());
+
+   // Cleared cache has to search again
+   cache.clear();
+   ASSERT_TRUE(cache.getRoute(&zones, 0, targetZone, target, route));
+   EXPECT_EQ(2, cache.getSearchCount());
+}
+
+
+// Finds the same paths, in order, that a single thread does
+class PathFinderThread : public Thread
+{
+   const Vector<BotNavMeshZone *> *mZones;
+   Semaphore *mDone;
+
+public:
+   Vector<Vector<Point> > paths;
+
+   PathFinderThread(const Vector<BotNavMeshZone *> *zones, Semaphore *done) { mZones = zones; mDone = done; }
+
+   U32 run()
+   {
+      for(S32 i = 0; i < mZones->size(); i++)
+         paths.push_back(AStar::findPath(mZones, i, mZones->size() - 1 - i, Point()));
+
+      mDone->increment();
+      return 0;
+   }
+};
+
+
+TEST(BotNavMeshZoneTest, ParallelFindPath)
+{
+   BotZoneGeometry geometry = getPillarGeometry(8);
+   ASSERT_TRUE(BotNavMeshZone::computeBotMeshZones(geometry));
+
+   GridDatabase database;
+   Vector<BotNavMeshZone *> zones;
+   buildZones(geometry, &database, &zones);
+
+   Semaphore done(0);
+   const S32 ThreadCount = 4;
+   PathFinderThread *threads[ThreadCount];
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      threads[i] = new PathFinderThread(&zones, &done);
+      threads[i]->start();
+   }
+
+   PathFinderThread serial(&zones, &done);
+   serial.run();
+
+   for(S32 i = 0; i < ThreadCount + 1; i++)
+      done.wait();
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      ASSERT_EQ(serial.paths.size(), threads[i]->paths.size());
+      for(S32 j = 0; j < serial.paths.size(); j++)
+         EXPECT_EQ(serial.paths[j].getStlVector(), threads[i]->paths[j].getStlVector());
+
+      delete threads[i];
+   }
+}
+
+
+// Lots of bots, each somewhere different, all chasing the same few targets around a big map
+TEST(BotNavMeshZoneTest, RouteCacheBenchmark)
+{
+   BotZoneGeometry geometry = getPillarGeometry(24);
+   ASSERT_TRUE(BotNavMeshZone::computeBotMeshZones(geometry));
+
+   GridDatabase database;
+   Vector<BotNavMeshZone *> zones;
+   buildZones(geometry, &database, &zones);
+
+   const S32 Bots = 200;
+   const S32 Targets = 5;
+   Vector<Point> route;
+
+   U32 start = Platform::getRealMilliseconds();
+   for(S32 t = 0; t < Targets; t++)
+      for(S32 i = 0; i < Bots; i++)
+         route = AStar::findPath(&zones, (i * 7919) % zones.size(), (t * 104729) % zones.size(), Point());
+   U32 searchTime = Platform::getRealMilliseconds() - start;
+
+   ZoneRouteCache cache;
+   start = Platform::getRealMilliseconds();
+   for(S32 t = 0; t < Targets; t++)
+      for(S32 i = 0; i < Bots; i++)
+         cache.getRoute(&zones, (i * 7919) % zones.size(), (t * 104729) % zones.size(), Point(), route);
+   U32 cacheTime = Platform::getRealMilliseconds() - start;
+
+   printf("%d zones, %d bots x %d targets: %d ms searching every time, %d ms with the route cache (%d searches)\n",
+          zones.size(), Bots, Targets, searchTime, cacheTime, cache.getSearchCount());
+
+   EXPECT_LT(cache.getSearchCount(), U32(Bots * Targets));
+}
+
+};
@@ -4,11 +4,86 @@
 //------------------------------------------------------------------------------
 
 #include "gameType.h"
+#include "gameConnection.h"
+#include "ServerGame.h"
+#include "ClientGame.h"
+#include "teamInfo.h"
+
+#include "TestUtils.h"
+
 #include "gtest/gtest.h"
 
+#include <cstring>
+
 namespace Zap
 {
 
-// Need some tests here!
+// A broadcast event's arguments are packed once, outside of any packet, and copied into each
+// connection's stream.  Check that strings inside them still decode correctly, and that they don't
+// upset the compression of strings written after them.
+TEST(GameTypeTest, BroadcastEventPacking)
+{
+   GameConnection conn;    // Only used to construct the events
+   string message = "Server restarting in 5 minutes";
+
+   RefPtr<NetEvent> broadcast = TNL_RPC_CONSTRUCT_BROADCAST(&conn, s2cDisplayAnnouncement, (message));
+   RefPtr<NetEvent> single    = TNL_RPC_CONSTRUCT_NETEVENT(&conn, s2cDisplayAnnouncement, (message));
+
+   // Each pass stands in for a different connection getting the same event
+   for(S32 i = 0; i < 3; i++)
+   {
+      U8 buffer[512];
+      memset(buffer, 0, sizeof(buffer));
+
+      // The string after the event shares more with the one before it than with the event's argument,
+      // so it will only decode properly if the writer knows the receiver last saw the argument
+      BitStream stream(buffer, sizeof(buffer));
+      stream.writeString("Server shutting down");
+      broadcast->pack(&conn, &stream);
+      stream.writeString("Server shutting down now");
+      ASSERT_TRUE(stream.isValid());
+
+      BitStream reader(buffer, stream.getBytePosition());
+      char buf[256];
+
+      reader.readString(buf);
+      EXPECT_STREQ("Server shutting down", buf);
+
+      RefPtr<NetEvent> received = TNL_RPC_CONSTRUCT_NETEVENT(&conn, s2cDisplayAnnouncement, (string()));
+      received->unpack(&conn, &reader);
+
+      reader.readString(buf);
+      EXPECT_STREQ("Server shutting down now", buf);
+
+      // The received event should pack exactly like the original
+      U8 receivedBuffer[512], singleBuffer[512];
+      memset(receivedBuffer, 0, sizeof(receivedBuffer));
+      memset(singleBuffer, 0, sizeof(singleBuffer));
+
+      BitStream receivedStream(receivedBuffer, sizeof(receivedBuffer));
+      BitStream singleStream(singleBuffer, sizeof(singleBuffer));
+      received->pack(&conn, &receivedStream);
+      single->pack(&conn, &singleStream);
+
+      ASSERT_EQ(singleStream.getBitPosition(), receivedStream.getBitPosition());
+      EXPECT_EQ(0, memcmp(singleBuffer, receivedBuffer, singleStream.getBytePosition()));
+   }
+}
+
+
+// GameType RPCs go out to every client ghosting the GameType as a single broadcast event
+TEST(GameTypeTest, BroadcastRPCReachesAllClients)
+{
+   const S32 Clients = 3;
+
+   GamePair gamePair("", Clients);
+   GamePair::idle(10, 20);    // Make sure every client has the GameType ghost
+
+   gamePair.server->getGameType()->s2cSetTeamScore(0, 42);
+   GamePair::idle(10, 10);
+
+   for(S32 i = 0; i < Clients; i++)
+      EXPECT_EQ(42, ((Team *)gamePair.getClient(i)->getTeam(0))->getScore()) << "client " << i;
+}
 
 };
@@ -0,0 +1,596 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/gridDB.h"
+#include "../zap/BfObject.h"
+#include "../zap/ServerGame.h"
+#include "../zap/stringUtils.h"
+
+#include "TestUtils.h"
+
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+// Bare-bones object we can put in a database without dragging a Game along
+class GridTestObject : public DatabaseObject
+{
+public:
+   GridTestObject(U8 typeNumber, const Rect &extent)
+   {
+      mObjectTypeNumber = typeNumber;
+      setExtent(extent);
+   }
+};
+
+
+// Tiny deterministic random generator, so our tests and benchmarks are repeatable
+class GridTestRandom
+{
+   U32 mState;
+
+public:
+   GridTestRandom(U32 seed) { mState = seed; }
+
+   F32 readF()
+   {
+      mState = mState * 1664525 + 1013904223;
+      return F32(mState >> 8) / F32(1 << 24);
+   }
+
+   F32 readF(F32 min, F32 max) { return min + (max - min) * readF(); }
+};
+
+
+static bool findPointer(const Vector<DatabaseObject *> &objects, DatabaseObject *object)
+{
+   for(S32 i = 0; i < objects.size(); i++)
+      if(objects[i] == object)
+         return true;
+
+   return false;
+}
+
+
+// Check that a query of extents returns exactly those objects whose extents overlap it
+static void checkQuery(GridDatabase &db, Rect extents)
+{
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isAnyObjectType, found, extents);
+
+   const Vector<DatabaseObject *> *all = db.findObjects_fast();
+
+   S32 expected = 0;
+   for(S32 i = 0; i < all->size(); i++)
+   {
+      Rect objExtent = all->get(i)->getExtent();
+
+      if(objExtent.intersects(extents))
+      {
+         expected++;
+         EXPECT_TRUE(findPointer(found, all->get(i))) << "Missing object with extents " << objExtent.toString();
+      }
+   }
+
+   EXPECT_EQ(expected, found.size());
+}
+
+
+TEST(GridDatabaseTest, QueriesMatchBruteForce)
+{
+   GridDatabase db(false);
+   GridTestRandom random(0xB17F);
+
+   const F32 WorldSize = 30000;
+
+   for(S32 i = 0; i < 2000; i++)
+   {
+      Point pos(random.readF(-WorldSize, WorldSize), random.readF(-WorldSize, WorldSize));
+      F32 size = (i % 50 == 0) ? random.readF(2000, 20000) : random.readF(5, 100);   // Mostly small things, a few giants
+
+      db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(pos, size)));
+   }
+
+   GridTestRandom queries(42);
+
+   // Check once with the default grid, and again after fitting it to the level
+   for(S32 pass = 0; pass < 2; pass++)
+   {
+      if(pass == 1)
+      {
+         db.fitGridToExtents(db.getExtents());
+         EXPECT_GT(db.getBucketCount(), GridDatabase::DefaultBucketRowCount * GridDatabase::DefaultBucketRowCount);
+      }
+
+      for(S32 i = 0; i < 200; i++)
+      {
+         Point pos(queries.readF(-WorldSize * 1.2f, WorldSize * 1.2f), queries.readF(-WorldSize * 1.2f, WorldSize * 1.2f));
+         checkQuery(db, Rect(pos, queries.readF(1, 1500)));
+      }
+   }
+
+   // Move objects around, including well outside the area the grid was fitted to
+   const Vector<DatabaseObject *> *all = db.findObjects_fast();
+   for(S32 i = 0; i < all->size(); i++)
+   {
+      Point pos(random.readF(-WorldSize * 3, WorldSize * 3), random.readF(-WorldSize * 3, WorldSize * 3));
+      all->get(i)->setExtent(Rect(pos, random.readF(5, 100)));
+   }
+
+   for(S32 i = 0; i < 200; i++)
+   {
+      Point pos(queries.readF(-WorldSize * 3, WorldSize * 3), queries.readF(-WorldSize * 3, WorldSize * 3));
+      checkQuery(db, Rect(pos, queries.readF(1, 5000)));
+   }
+}
+
+
+// The old 16x16 grid wrapped every 4096 pixels, so these two objects would have shared a bucket
+TEST(GridDatabaseTest, DistantObjectsDoNotShareBuckets)
+{
+   GridDatabase db(false);
+
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(100, 100),        10)));
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(100 + 4096, 100), 10)));
+
+   db.fitGridToExtents(db.getExtents());
+
+   EXPECT_EQ(1, db.countBucketEntries(Rect(Point(100, 100), 10)));
+   EXPECT_EQ(1, db.countBucketEntries(Rect(Point(100 + 4096, 100), 10)));
+
+   // Huge objects go in the oversize bucket rather than being registered everywhere
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(2000, 100), 5000)));
+   EXPECT_EQ(2, db.countBucketEntries(Rect(Point(100, 100), 10)));
+}
+
+
+TEST(GridDatabaseTest, BucketSizeSelection)
+{
+   Rect smallLevel(Point(0, 0), Point(2000, 2000));
+   Rect hugeLevel (Point(-20000, -20000), Point(20000, 20000));
+
+   // Lots of objects in a small space --> small buckets, but never smaller than the objects themselves
+   EXPECT_EQ(GridDatabase::MinBucketWidthBitShift, GridDatabase::computeBucketWidthBitShift(smallLevel, 100000, 1));
+   EXPECT_EQ(7, GridDatabase::computeBucketWidthBitShift(smallLevel, 10000, 100));
+
+   // Bigger levels get bigger buckets, within limits
+   EXPECT_GT(GridDatabase::computeBucketWidthBitShift(hugeLevel, 1000, 50), GridDatabase::computeBucketWidthBitShift(smallLevel, 1000, 50));
+   EXPECT_EQ(GridDatabase::MaxBucketWidthBitShift, GridDatabase::computeBucketWidthBitShift(hugeLevel, 1, 50));
+}
+
+
+TEST(GridDatabaseTest, FrozenStaticObjects)
+{
+   GridDatabase db(false);
+   GridTestRandom random(0x5747);
+
+   const F32 WorldSize = 10000;
+
+   // Half walls, half things that move
+   for(S32 i = 0; i < 1000; i++)
+   {
+      Point pos(random.readF(-WorldSize, WorldSize), random.readF(-WorldSize, WorldSize));
+      U8 type = (i % 2 == 0) ? WallItemTypeNumber : TestItemTypeNumber;
+      db.addToDatabase(new GridTestObject(type, Rect(pos, random.readF(5, 300))));
+   }
+
+   db.fitGridToExtents(db.getExtents());
+   db.freezeStaticObjects((TestFunc)isWallType);
+
+   EXPECT_EQ(500, db.getStaticObjectCount());
+
+   const Vector<DatabaseObject *> *all = db.findObjects_fast();
+   for(S32 i = 0; i < all->size(); i++)
+      EXPECT_EQ(isWallType(all->get(i)->getObjectTypeNumber()), db.isStatic(all->get(i)));
+
+   GridTestRandom queries(7);
+   for(S32 i = 0; i < 200; i++)
+   {
+      Point pos(queries.readF(-WorldSize, WorldSize), queries.readF(-WorldSize, WorldSize));
+      checkQuery(db, Rect(pos, queries.readF(1, 2000)));
+   }
+
+   // Type-filtered queries only see the layer they ask for
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isWallType, found, db.getExtents());
+   EXPECT_EQ(500, found.size());
+
+   // Objects that were frozen but move anyway drop back into the dynamic buckets
+   DatabaseObject *wall = all->get(0);
+   ASSERT_TRUE(db.isStatic(wall));
+   wall->setExtent(Rect(Point(WorldSize * 2, WorldSize * 2), 10));
+   EXPECT_FALSE(db.isStatic(wall));
+   EXPECT_EQ(499, db.getStaticObjectCount());
+   checkQuery(db, Rect(Point(WorldSize * 2, WorldSize * 2), 50));
+
+   // Removing a frozen object takes it out of the static layer as well
+   DatabaseObject *wall2 = all->get(2);
+   ASSERT_TRUE(db.isStatic(wall2));
+   Rect wall2Extent = wall2->getExtent();
+   db.removeFromDatabase(wall2, true);
+   EXPECT_EQ(498, db.getStaticObjectCount());
+   checkQuery(db, wall2Extent);
+
+   // Re-fitting the grid keeps the static layer consistent
+   db.fitGridToExtents(db.getExtents());
+   EXPECT_EQ(498, db.getStaticObjectCount());
+   for(S32 i = 0; i < 100; i++)
+   {
+      Point pos(queries.readF(-WorldSize, WorldSize), queries.readF(-WorldSize, WorldSize));
+      checkQuery(db, Rect(pos, queries.readF(1, 2000)));
+   }
+}
+
+
+// Check that the extents the database maintains match what we get by looking at every object
+static void checkExtents(GridDatabase &db)
+{
+   const Vector<DatabaseObject *> *all = db.findObjects_fast();
+
+   Rect expected;
+   if(all->size() > 0)
+      expected = all->get(0)->getExtent();
+
+   for(S32 i = 1; i < all->size(); i++)
+      expected.unionRect(all->get(i)->getExtent());
+
+   EXPECT_EQ(expected.toString(), db.getExtents().toString());
+}
+
+
+TEST(GridDatabaseTest, IncrementalExtents)
+{
+   GridDatabase db(false);
+   GridTestRandom random(0xE27E);
+
+   const F32 WorldSize = 5000;
+
+   checkExtents(db);
+
+   for(S32 i = 0; i < 300; i++)
+   {
+      Point pos(random.readF(-WorldSize, WorldSize), random.readF(-WorldSize, WorldSize));
+      U8 type = (i % 3 == 0) ? WallItemTypeNumber : TestItemTypeNumber;
+      db.addToDatabase(new GridTestObject(type, Rect(pos, random.readF(5, 300))));
+      checkExtents(db);
+   }
+
+   db.fitGridToExtents(db.getExtents());
+   db.freezeStaticObjects((TestFunc)isWallType);
+   checkExtents(db);
+
+   // Move things around -- sometimes far out, sometimes back in -- and pull a few out of the database
+   for(S32 i = 0; i < 2000; i++)
+   {
+      const Vector<DatabaseObject *> *all = db.findObjects_fast();
+      DatabaseObject *object = all->get(S32(random.readF() * all->size()) % all->size());
+
+      if(i % 50 == 49)
+         db.removeFromDatabase(object, true);
+      else
+      {
+         F32 range = (i % 10 == 0) ? WorldSize * 3 : WorldSize;
+         Point pos(random.readF(-range, range), random.readF(-range, range));
+         object->setExtent(Rect(pos, random.readF(5, 300)));
+      }
+
+      checkExtents(db);
+   }
+
+   // Emptying the database empties the extents
+   while(db.getObjectCount() > 0)
+   {
+      db.removeFromDatabase(db.getObjectByIndex(0), true);
+      checkExtents(db);
+   }
+
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(100, 100), 10)));
+   checkExtents(db);
+
+   db.removeEverythingFromDatabase();
+   checkExtents(db);
+}
+
+
+// Objects spanning several buckets must only be reported once, whichever layer they're in
+TEST(GridDatabaseTest, ObjectsReportedOnce)
+{
+   GridDatabase db(false);
+
+   db.addToDatabase(new GridTestObject(WallItemTypeNumber, Rect(Point(0, 0), Point(2000, 2000))));
+   db.addToDatabase(new GridTestObject(TestItemTypeNumber, Rect(Point(0, 0), Point(2000, 2000))));
+   db.setGridLayout(GridDatabase::MinBucketWidthBitShift, db.getExtents());
+
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isAnyObjectType, found, Rect(Point(100, 100), Point(1900, 1900)));
+   EXPECT_EQ(2, found.size());
+
+   db.freezeStaticObjects((TestFunc)isWallType);
+
+   found.clear();
+   db.findObjects((TestFunc)isAnyObjectType, found, Rect(Point(100, 100), Point(1900, 1900)));
+   EXPECT_EQ(2, found.size());
+
+   // Results are appended to what the caller passes in, so running a second search into the same vector adds to it
+   db.findObjects((TestFunc)isAnyObjectType, found, Rect(Point(500, 500), Point(600, 600)));
+   EXPECT_EQ(4, found.size());
+}
+
+
+struct GridQueryThreadData
+{
+   const GridDatabase *db;
+   const Vector<Rect> *queries;
+   Vector<S32> counts;
+   Vector<DatabaseObject *> found;
+   U32 checksum;
+};
+
+
+static void runGridQueries(GridQueryThreadData *data)
+{
+   data->counts.clear();
+   data->checksum = 0;
+
+   Vector<DatabaseObject *> found;
+
+   for(S32 i = 0; i < data->queries->size(); i++)
+   {
+      found.clear();
+
+      TestFunc testFunc = (i % 3 == 0) ? (TestFunc)isWallType : (TestFunc)isAnyObjectType;
+      data->db->findObjects(testFunc, found, data->queries->get(i));
+
+      data->counts.push_back(found.size());
+
+      for(S32 j = 0; j < found.size(); j++)
+         data->checksum = data->checksum * 31 + U32(size_t(found[j]) >> 4);
+   }
+}
+
+
+// Searches don't write to the database or its objects, so many threads can search one database at once
+TEST(GridDatabaseTest, ConcurrentQueries)
+{
+   GridDatabase db(false);
+   GridTestRandom random(0xC0FFEE);
+
+   const F32 WorldSize = 10000;
+
+   for(S32 i = 0; i < 3000; i++)
+   {
+      Point pos(random.readF(-WorldSize, WorldSize), random.readF(-WorldSize, WorldSize));
+      F32 size = (i % 100 == 0) ? random.readF(2000, 12000) : random.readF(5, 300);
+      U8 type = (i % 3 == 0) ? WallItemTypeNumber : TestItemTypeNumber;
+
+      db.addToDatabase(new GridTestObject(type, Rect(pos, size)));
+   }
+
+   db.fitGridToExtents(db.getExtents());
+   db.freezeStaticObjects((TestFunc)isWallType);
+
+   Vector<Rect> queries;
+   for(S32 i = 0; i < 2000; i++)
+   {
+      Point pos(random.readF(-WorldSize, WorldSize), random.readF(-WorldSize, WorldSize));
+      queries.push_back(Rect(pos, random.readF(10, 3000)));
+   }
+
+   // Get our reference answers with a single thread
+   GridQueryThreadData expected;
+   expected.db = &db;
+   expected.queries = &queries;
+   runGridQueries(&expected);
+
+   const S32 ThreadCount = 8;
+   GridQueryThreadData data[ThreadCount];
+   std::vector<std::thread> threads;
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      data[i].db = &db;
+      data[i].queries = &queries;
+      threads.push_back(std::thread(runGridQueries, &data[i]));
+   }
+
+   for(S32 i = 0; i < ThreadCount; i++)
+      threads[i].join();
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      ASSERT_EQ(expected.counts.size(), data[i].counts.size());
+
+      for(S32 j = 0; j < expected.counts.size(); j++)
+         ASSERT_EQ(expected.counts[j], data[i].counts[j]) << "Thread " << i << ", query " << j;
+
+      EXPECT_EQ(expected.checksum, data[i].checksum);
+   }
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// The spatial index we used to have: a fixed 16x16 grid of 256 pixel buckets that wraps around, so objects far
+// apart can share a bucket.  Kept here so we can see how the current index compares.
+class LegacyGrid
+{
+   enum {
+      BucketRowCount = 16,
+      BucketMask = BucketRowCount - 1,
+      BucketWidthBitShift = 8,
+   };
+
+   Vector<S32> mBuckets[BucketRowCount][BucketRowCount];
+   const Vector<DatabaseObject *> &mObjects;
+   mutable Vector<U32> mLastQueryId;
+   mutable U32 mQueryId;
+
+   static void fillBins(const Rect &extents, IntRect &bins)
+   {
+      bins.minx = S32(extents.min.x) >> BucketWidthBitShift;
+      bins.miny = S32(extents.min.y) >> BucketWidthBitShift;
+      bins.maxx = S32(extents.max.x) >> BucketWidthBitShift;
+      bins.maxy = S32(extents.max.y) >> BucketWidthBitShift;
+
+      if(U32(bins.maxx - bins.minx) >= BucketRowCount)
+         bins.maxx = bins.minx + BucketRowCount - 1;
+
+      if(U32(bins.maxy - bins.miny) >= BucketRowCount)
+         bins.maxy = bins.miny + BucketRowCount - 1;
+   }
+
+public:
+   LegacyGrid(const Vector<DatabaseObject *> &objects) : mObjects(objects)
+   {
+      mQueryId = 0;
+      mLastQueryId.resize(objects.size());
+
+      for(S32 i = 0; i < objects.size(); i++)
+      {
+         mLastQueryId[i] = 0;
+
+         IntRect bins;
+         fillBins(objects[i]->getExtent(), bins);
+
+         for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+            for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+               mBuckets[x & BucketMask][y & BucketMask].push_back(i);
+      }
+   }
+
+   // Returns number of bucket entries examined
+   S32 findObjects(const Rect &extents, Vector<DatabaseObject *> &fillVector) const
+   {
+      IntRect bins;
+      fillBins(extents, bins);
+
+      mQueryId++;
+      S32 candidates = 0;
+
+      for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+         for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+         {
+            const Vector<S32> &bucket = mBuckets[x & BucketMask][y & BucketMask];
+            candidates += bucket.size();
+
+            for(S32 i = 0; i < bucket.size(); i++)
+            {
+               S32 index = bucket[i];
+               Rect objExtent = mObjects[index]->getExtent();
+
+               if(mLastQueryId[index] != mQueryId && objExtent.intersects(extents))
+               {
+                  mLastQueryId[index] = mQueryId;
+                  fillVector.push_back(mObjects[index]);
+               }
+            }
+         }
+
+      return candidates;
+   }
+};
+
+
+// Compares candidate counts and query times of the legacy index and the current one over the levels we ship.
+// Queries are a mix of collision-sized boxes and scope-sized boxes, centered on objects in the level.
+TEST(GridDatabaseTest, LevelQueryBenchmark)
+{
+   Vector<string> levels;
+   const string extensions[] = { "level" };
+   getFilesFromFolder("levels", levels, extensions, ARRAYSIZE(extensions));
+   ASSERT_GT(levels.size(), 0);
+
+   std::sort(levels.getStlVector().begin(), levels.getStlVector().end());
+
+   const S32 QueryCount = 2000;
+   const S32 Reps = 20;
+
+   printf("%-20s %7s %5s %14s %14s %10s %10s\n", "level", "objects", "shift", "legacy cands", "new cands", "legacy ms", "new ms");
+
+   for(S32 i = 0; i < levels.size(); i++)
+   {
+      ServerGame *game = newServerGame();
+      GridDatabase *db = game->getGameObjDatabase();
+      game->loadLevelFromFile(joindir("levels", levels[i]), db);
+
+      const Vector<DatabaseObject *> *objects = db->findObjects_fast();
+      if(objects->size() == 0)
+      {
+         delete game;
+         continue;
+      }
+
+      LegacyGrid legacy(*objects);
+      db->fitGridToExtents(db->getExtents());
+      db->freezeStaticObjects((TestFunc)isStaticGeometryType);
+
+      // Build our query list
+      GridTestRandom random(i + 1);
+      Vector<Rect> queries(QueryCount);
+      for(S32 j = 0; j < QueryCount; j++)
+      {
+         Point center = objects->get(S32(random.readF() * (objects->size() - 1)))->getExtent().getCenter();
+
+         if(j % 2 == 0)
+            queries.push_back(Rect(center, 64));
+         else
+            queries.push_back(Rect(center - Point(800, 600), center + Point(800, 600)));
+      }
+
+      S64 legacyCandidates = 0, newCandidates = 0;
+      Vector<DatabaseObject *> legacyFound, newFound;
+
+      // First pass -- count candidates and make sure both indices agree on the answers
+      for(S32 j = 0; j < queries.size(); j++)
+      {
+         legacyFound.clear();
+         newFound.clear();
+
+         legacyCandidates += legacy.findObjects(queries[j], legacyFound);
+         newCandidates    += db->countBucketEntries(queries[j]);
+
+         db->findObjects((TestFunc)isAnyObjectType, newFound, queries[j]);
+
+         ASSERT_EQ(legacyFound.size(), newFound.size());
+      }
+
+      S64 start = Platform::getHighPrecisionTimerValue();
+      for(S32 rep = 0; rep < Reps; rep++)
+         for(S32 j = 0; j < queries.size(); j++)
+         {
+            legacyFound.clear();
+            legacy.findObjects(queries[j], legacyFound);
+         }
+      F64 legacyMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+      start = Platform::getHighPrecisionTimerValue();
+      for(S32 rep = 0; rep < Reps; rep++)
+         for(S32 j = 0; j < queries.size(); j++)
+         {
+            newFound.clear();
+            db->findObjects((TestFunc)isAnyObjectType, newFound, queries[j]);
+         }
+      F64 newMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+      printf("%-20s %7d %5d %14lld %14lld %10.2f %10.2f\n", levels[i].c_str(), objects->size(), db->getBucketWidthBitShift(),
+             (long long)legacyCandidates, (long long)newCandidates, legacyMs, newMs);
+
+      delete game;
+   }
+}
+
+
+};
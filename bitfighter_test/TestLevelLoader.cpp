@@ -7,9 +7,18 @@
 #include "gameLoader.h"
 #include "gameType.h"
 #include "ServerGame.h"
+#include "stringUtils.h"
+
+#include "LevelFilesForTesting.h"
+#include "TestUtils.h"
+
+#include "tnlPlatform.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <sstream>
+
 namespace Zap
 {
 
@@ -18,6 +27,213 @@ class LevelLoaderTest: public testing::Test
 
 };
 
+// The way lines were split up before LevelLineTokenizer came along
+static Vector<string> legacyTokenize(const string &line, S32 &id)
+{
+   Vector<string> args = parseString(line);
+   id = 0;
+
+   if(args.size() >= 1)
+   {
+      std::size_t pos = args[0].find("!");
+      if(pos != string::npos)
+      {
+         id = atoi(args[0].substr(pos + 1, args[0].size() - pos - 1).c_str());
+         args[0] = args[0].substr(0, pos);
+      }
+   }
+
+   return args;
+}
+
+
+static void checkTokenizer(LevelLineTokenizer &tokenizer, const string &line)
+{
+   S32 legacyId;
+   Vector<string> expected = legacyTokenize(line, legacyId);
+
+   S32 argc = tokenizer.tokenize(line.c_str(), (S32)line.size());
+   const char **argv = tokenizer.getArgv();
+
+   ASSERT_EQ(expected.size(), argc) << "Line: " << line;
+   EXPECT_EQ(legacyId, tokenizer.getId()) << "Line: " << line;
+   for(S32 i = 0; i < argc; i++)
+      EXPECT_EQ(expected[i], argv[i]) << "Line: " << line;
+}
+
+
+static Vector<string> getBenchmarkLevels()
+{
+   Vector<string> levels;
+   const string extensions[] = { "level" };
+   getFilesFromFolder("levels", levels, extensions, ARRAYSIZE(extensions));
+   std::sort(levels.getStlVector().begin(), levels.getStlVector().end());
+
+   for(S32 i = 0; i < levels.size(); i++)
+      levels[i] = joindir("levels", levels[i]);
+
+   return levels;
+}
+
+
+static Vector<string> getBenchmarkLevelCode()
+{
+   Vector<string> code;
+   code.push_back(getLevelCode1());
+   code.push_back(getLevelCodeForTestingEngineer1());
+   code.push_back(getLevelCodeForEmptyLevelWithBots("S_Bot"));
+   return code;
+}
+
+
+// Tokenizer has to split lines up exactly the way parseString() always has
+TEST_F(LevelLoaderTest, tokenizer)
+{
+   LevelLineTokenizer tokenizer;
+
+   const char *lines[] = {
+      "",
+      "   ",
+      "\r",
+      "LevelName My Level\r",
+      "TestItem!12 10 20",
+      "TestItem! 10 20",
+      "Spawn!7!8 0 0",
+      "LevelDescription \"A quoted  description\" after",
+      "LevelDescription \"unterminated quote",
+      "Script \"a b\"c d",
+      "Script \"abc\" \"\" \" x\" y\"",
+      "\"",
+      "\"\"\"\"",
+      "Tabs\tand\vother\fwhitespace",
+      "Team Blue 0 0 1",
+   };
+
+   for(U32 i = 0; i < ARRAYSIZE(lines); i++)
+      checkTokenizer(tokenizer, lines[i]);
+
+   // Anything past an embedded NUL was never seen by the old parser
+   string withNul("Barrier 1 2\0 3 4", 15);
+   EXPECT_EQ(3, tokenizer.tokenize(withNul.c_str(), (S32)withNul.size()));
+
+   // Every line of every level we ship, or use for testing
+   Vector<string> contents = getBenchmarkLevelCode();
+   Vector<string> levels = getBenchmarkLevels();
+   for(S32 i = 0; i < levels.size(); i++)
+      contents.push_back(readFile(levels[i]));
+
+   for(S32 i = 0; i < contents.size(); i++)
+   {
+      istringstream iss(contents[i]);
+      string line;
+      while(std::getline(iss, line))
+         checkTokenizer(tokenizer, line);
+   }
+}
+
+
+// Level file is hashed as it's read, and should come out the same as hashing it from disk separately
+TEST_F(LevelLoaderTest, loadLevelFromFileHash)
+{
+   Vector<string> levels = getBenchmarkLevels();
+   ASSERT_GT(levels.size(), 0);
+
+   ServerGame *game = newServerGame();
+   string hash;
+   EXPECT_TRUE(game->loadLevelFromFile(levels[0], game->getGameObjDatabase(), &hash));
+   EXPECT_EQ(Game::md5.getHashFromFile(levels[0]), hash);
+   EXPECT_GT(game->getGameObjDatabase()->findObjects_fast()->size(), 0);
+
+   EXPECT_FALSE(game->loadLevelFromFile("no_such_level_file.level", game->getGameObjDatabase()));
+
+   delete game;
+}
+
+
+// Not really a test -- prints how long it takes to read, hash, and tokenize each level, the old way and the new way,
+// and how long a complete load takes
+TEST_F(LevelLoaderTest, loadBenchmark)
+{
+   const S32 Reps = 100;
+
+   Vector<string> levels = getBenchmarkLevels();
+   Vector<string> code = getBenchmarkLevelCode();
+
+   printf("%-24s %8s %10s %10s %10s\n", "level", "bytes", "legacy ms", "new ms", "load ms");
+
+   LevelLineTokenizer tokenizer;
+
+   for(S32 i = 0; i < levels.size() + code.size(); i++)
+   {
+      bool isFile = i < levels.size();
+      string name = isFile ? levels[i] : "LevelFilesForTesting " + itos(i - levels.size());
+      S32 words = 0;
+      U32 bytes = 0;
+
+      S64 start = Platform::getHighPrecisionTimerValue();
+      for(S32 rep = 0; rep < Reps; rep++)
+      {
+         string contents = isFile ? readFile(levels[i]) : code[i - levels.size()];
+         if(isFile)
+            Game::md5.getHashFromFile(levels[i]);
+
+         istringstream iss(contents);
+         string line;
+         while(std::getline(iss, line))
+         {
+            S32 id;
+            words += legacyTokenize(line, id).size();
+         }
+      }
+      F64 legacyMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start) / Reps;
+
+      start = Platform::getHighPrecisionTimerValue();
+      for(S32 rep = 0; rep < Reps; rep++)
+      {
+         string contents;
+         if(isFile)
+            Game::md5.getHashFromFile(levels[i], contents);
+         else
+            contents = code[i - levels.size()];
+
+         bytes = (U32)contents.size();
+
+         const char *pos = contents.c_str();
+         const char *end = pos + contents.size();
+         while(pos < end)
+         {
+            const char *eol = (const char *)memchr(pos, '\n', end - pos);
+            if(!eol)
+               eol = end;
+
+            words -= tokenizer.tokenize(pos, S32(eol - pos));
+            pos = eol + 1;
+         }
+      }
+      F64 newMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start) / Reps;
+
+      EXPECT_EQ(0, words) << name;     // Both ways found the same number of words
+
+      F64 loadMs = 0;
+      for(S32 rep = 0; rep < Reps; rep++)
+      {
+         ServerGame *game = newServerGame();
+
+         start = Platform::getHighPrecisionTimerValue();
+         if(isFile)
+            game->loadLevelFromFile(levels[i], game->getGameObjDatabase());
+         else
+            game->loadLevelFromString(code[i - levels.size()], game->getGameObjDatabase());
+         loadMs += Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+         delete game;
+      }
+
+      printf("%-24s %8d %10.3f %10.3f %10.3f\n", name.c_str(), bytes, legacyMs, newMs, loadMs / Reps);
+   }
+}
+
+
 TEST_F(LevelLoaderTest, longLine)
 {
    U32 TEST_POINTS = 0xFFF;            //0xFFFF takes a wicked long time to run
@@ -50,5 +266,66 @@ TEST_F(LevelLoaderTest, longLine)
    EXPECT_EQ(TEST_POINTS - 1, objects->size());
 }
 
+
+// Headers of many levels get read on several threads, but come back lined up with the filenames we asked for
+TEST_F(LevelLoaderTest, readLevelHeaders)
+{
+   const string dir = "levelheaders_test";
+   const string indexFile = joindir(dir, "levels.index");
+   makeSureFolderExists(dir);
+   remove(indexFile.c_str());
+
+   Vector<string> filenames;
+   for(S32 i = 0; i < 40; i++)
+   {
+      filenames.push_back(joindir(dir, "level" + itos(i) + ".level"));
+      writeFile(filenames.last(), "CTFGameType 10 8\nLevelName Level Number " + itos(i) + "\nMinPlayers 2\nMaxPlayers " + itos(i) + "\n");
+   }
+   filenames.push_back(joindir(dir, "missing.level"));
+   filenames.push_back("");
+
+   Vector<LevelHeader> headers;
+   LevelSource::readLevelHeaders(filenames, headers, indexFile);
+
+   ASSERT_EQ(filenames.size(), headers.size());
+   for(S32 i = 0; i < 40; i++)
+   {
+      EXPECT_TRUE(headers[i].found);
+      EXPECT_EQ("CTFGameType", headers[i].gameType);
+      EXPECT_EQ("Level Number " + itos(i), headers[i].levelName);
+      EXPECT_EQ("2", headers[i].minPlayers);
+      EXPECT_EQ(itos(i), headers[i].maxPlayers);
+      EXPECT_EQ("", headers[i].script);
+   }
+   EXPECT_FALSE(headers[40].found);
+   EXPECT_FALSE(headers[41].found);
+
+   LevelInfo levelInfo("level3.level", dir);
+   LevelSource::applyLevelHeader(headers[3], levelInfo);
+   EXPECT_EQ(CTFGame, levelInfo.mLevelType);
+   EXPECT_STREQ("Level Number 3", levelInfo.mLevelName.getString());
+   EXPECT_EQ(3, levelInfo.maxRecPlayers);
+
+   // Unchanged files come from the index.  Doctor the index to prove it.
+   string index = readFile(indexFile);
+   size_t pos = index.find("Level Number 5\t");
+   ASSERT_NE(string::npos, pos);
+   index.replace(pos, 14, "From The Index");
+   writeFile(indexFile, index);
+
+   // Changed files don't
+   writeFile(filenames[6], "GameType\nLevelName Changed\n");
+
+   LevelSource::readLevelHeaders(filenames, headers, indexFile);
+   EXPECT_EQ("From The Index", headers[5].levelName);
+   EXPECT_EQ("Changed", headers[6].levelName);
+   EXPECT_EQ("", headers[6].maxPlayers);
+   EXPECT_EQ("Level Number 7", headers[7].levelName);
+
+   for(S32 i = 0; i < 40; i++)
+      remove(filenames[i].c_str());
+   remove(indexFile.c_str());
+}
+
 };
 
@@ -145,4 +145,81 @@ TEST_F(LuaEnvironmentTest, findAllObjects)
 }
 
 
+TEST_F(LuaEnvironmentTest, scriptBudgets)
+{
+   LuaScriptRunner::setBudgets(10000, 0, 0);
+
+   EXPECT_TRUE(levelgen->runString("function light() local x = 0; for i = 1, 100 do x = x + i end end"));
+   EXPECT_TRUE(levelgen->runString("function heavy() local x = 0; for i = 1, 30000 do x = x + i end end"));
+   EXPECT_TRUE(levelgen->runString("function api() for i = 1, 10 do bf:getPlayerCount() end end"));
+   EXPECT_TRUE(levelgen->runString("function alloc() t = { }; for i = 1, 1000 do t[i] = { i } end end"));
+
+   // Staying under budget is free
+   LuaScriptRunner::startTick();
+   EXPECT_FALSE(levelgen->runCmd("light", 0));
+   EXPECT_FALSE(levelgen->skipTick());
+
+   // Going over costs some ticks, depending on how far over
+   LuaScriptRunner::startTick();
+   EXPECT_FALSE(levelgen->runCmd("heavy", 0));
+   EXPECT_EQ(1, levelgen->getProfile().overBudgetTicks);
+
+   S32 skipped = 0;
+   while(levelgen->skipTick())
+      skipped++;
+
+   EXPECT_GE(skipped, 5);
+   EXPECT_EQ(skipped, levelgen->getProfile().throttledTicks);
+
+   // Budget starts over each tick
+   LuaScriptRunner::startTick();
+   EXPECT_FALSE(levelgen->runCmd("light", 0));
+   EXPECT_FALSE(levelgen->skipTick());
+
+   // Calls into our methods and allocations get charged to the script
+   EXPECT_FALSE(levelgen->runCmd("api", 0));
+   EXPECT_FALSE(levelgen->runCmd("alloc", 0));
+
+   const LuaScriptProfile &profile = levelgen->getProfile();
+   EXPECT_EQ(5, profile.calls);
+   EXPECT_GE(profile.methodCalls, 10u);
+   EXPECT_GE(profile.instructions, 60000u);
+   EXPECT_GT(profile.allocBytes, 1000u * 16);
+   EXPECT_EQ(0, profile.tickCalls);
+
+   levelgen->resetProfile();
+   EXPECT_EQ(0, levelgen->getProfile().calls);
+
+   IniSettings *iniSettings = settings->getIniSettings();
+   LuaScriptRunner::setBudgets(iniSettings->luaTickInstructionBudget, iniSettings->luaTickTimeBudget, iniSettings->luaWatchdogTimeout);
+}
+
+
+TEST_F(LuaEnvironmentTest, scriptWatchdog)
+{
+   EXPECT_TRUE(levelgen->runString("function spin() while true do end end"));
+   EXPECT_TRUE(levelgen->runString("function sneaky() while true do pcall(spin) end end"));
+   EXPECT_TRUE(levelgen->runString("function ok() return 1 end"));
+
+   // Runaway scripts get stopped, whether by instruction count...
+   LuaScriptRunner::setBudgets(10000, 0, 0);
+   EXPECT_TRUE(levelgen->runCmd("spin", 0));
+
+   // ...even if they try to catch the error...
+   EXPECT_TRUE(levelgen->runCmd("sneaky", 0));
+
+   // ...or by time
+   LuaScriptRunner::setBudgets(0, 0, 50);
+   EXPECT_TRUE(levelgen->runCmd("spin", 0));
+
+   // Other calls are unaffected
+   EXPECT_FALSE(levelgen->runCmd("ok", 1));
+   EXPECT_EQ(1, lua_tointeger(L, -1));
+   lua_pop(L, 1);
+
+   IniSettings *iniSettings = settings->getIniSettings();
+   LuaScriptRunner::setBudgets(iniSettings->luaTickInstructionBudget, iniSettings->luaTickTimeBudget, iniSettings->luaWatchdogTimeout);
+}
+
+
 };
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "moveObject.h"
+#include "projectile.h"
+#include "ship.h"
+#include "ServerGame.h"
+#include "AllocationCounter.h"
+#include "TestUtils.h"
+
+#include "tnlPlatform.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+// A walled box split down the middle: ships on the left, in a zone, and projectiles on the right
+static const string LevelCode =
+   "LevelFormat 2\n"
+   "GameType 10 8\n"
+   "LevelName Crowded Physics\n"
+   "Team Blue 0 0 1\n"
+   "BarrierMaker 40 -1000 -500 1000 -500 1000 500 -1000 500 -1000 -500\n"
+   "BarrierMaker 40 0 -500 0 500\n"
+   "Zone -980 -480 -20 -480 -20 480 -980 480\n";
+
+
+static void moveAll(const Vector<MoveObject *> &objects, S32 ships, MoveScratch &scratch)
+{
+   for(S32 i = 0; i < objects.size(); i++)
+      objects[i]->move(0.01f, ActualState, false, scratch);
+
+   for(S32 i = 0; i < ships; i++)
+      objects[i]->checkForZones(scratch);
+}
+
+
+// One ship flying into another pushes it out of the way, and leaves the scratch lists as it found them
+TEST(MoveObjectTest, DisplacedShipIsPushedAside)
+{
+   GamePair gamePair(LevelCode, 0);
+   ServerGame *server = gamePair.server;
+   MoveScratch *scratch = server->getMoveScratch();
+
+   Ship *pusher = new Ship(NULL, 0, Point(-600, 0));
+   Ship *pushed = new Ship(NULL, 0, Point(-600 + Ship::CollisionRadius * 2 + 1, 0));
+   pusher->addToGame(server, server->getGameObjDatabase());
+   pushed->addToGame(server, server->getGameObjDatabase());
+
+   pusher->setActualVel(Point(500, 0));
+   pusher->move(0.1f, ActualState, false, *scratch);
+
+   EXPECT_GT(pushed->getActualPos().x, -600 + Ship::CollisionRadius * 2 + 1);
+   EXPECT_EQ(0, scratch->displacers.size());
+   EXPECT_EQ(0, scratch->disabled.size());
+   EXPECT_EQ(0, scratch->fillVector.size());
+}
+
+
+// 64 ships bumping into each other and the walls, and 500 projectiles bouncing around next door
+TEST(MoveObjectTest, CrowdedPhysicsBenchmark)
+{
+   GamePair gamePair(LevelCode, 0);
+   ServerGame *server = gamePair.server;
+   MoveScratch *scratch = server->getMoveScratch();
+
+   const S32 Ships = 64;
+   const S32 Projectiles = 500;
+
+   Vector<MoveObject *> objects;
+
+   for(S32 i = 0; i < Ships; i++)
+   {
+      F32 angle = i * 0.7f;
+      Ship *ship = new Ship(NULL, 0, Point(-900 + (i % 8) * 110, -400 + (i / 8) * 110));
+      ship->addToGame(server, server->getGameObjDatabase());
+      ship->setActualVel(Point(cos(angle), sin(angle)) * 400);
+      objects.push_back(ship);
+   }
+
+   for(S32 i = 0; i < Projectiles; i++)
+   {
+      F32 angle = i * 0.3f;
+      Burst *burst = new Burst(Point(40 + (i % 25) * 37, -450 + (i / 25) * 45), Point(cos(angle), sin(angle)) * 300, NULL);
+      burst->addToGame(server, server->getGameObjDatabase());
+      objects.push_back(burst);
+   }
+
+   // Let the scratch lists grow to fit, and let everyone find their zones
+   for(S32 tick = 0; tick < 20; tick++)
+      moveAll(objects, Ships, *scratch);
+
+   const S32 Ticks = 200;
+
+   U32 allocations = getAllocationCount();
+   U32 start = Platform::getRealMilliseconds();
+
+   for(S32 tick = 0; tick < Ticks; tick++)
+      moveAll(objects, Ships, *scratch);
+
+   U32 elapsed = Platform::getRealMilliseconds() - start;
+   allocations = getAllocationCount() - allocations;
+
+   if(isAllocationCountEnabled())
+      EXPECT_EQ(0, allocations);
+
+   EXPECT_EQ(0, scratch->displacers.size());
+   EXPECT_EQ(0, scratch->disabled.size());
+   EXPECT_EQ(0, scratch->fillVector.size());
+
+   // Everyone stayed on their own side of the wall
+   for(S32 i = 0; i < objects.size(); i++)
+      EXPECT_EQ(i < Ships, objects[i]->getActualPos().x < 0) << "object " << i;
+
+   printf("%d ships, %d projectiles, %d ticks: %d ms (%.3f ms/tick), %d allocations%s\n", Ships, Projectiles, Ticks,
+          elapsed, F32(elapsed) / Ticks, allocations, isAllocationCountEnabled() ? "" : " (not counted in this build)");
+}
+
+};
@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlNetInterface.h"
+#include "tnlNetConnection.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Lets the tests get at the connection tables directly, without going through the handshake
+class TableInterface : public NetInterface
+{
+public:
+   TableInterface() : NetInterface(Address("IP:127.0.0.1:0")) { /* Do nothing */ }
+
+   using NetInterface::addPendingConnection;
+   using NetInterface::removePendingConnection;
+   using NetInterface::findPendingConnection;
+   using NetInterface::findAndRemovePendingConnection;
+   using NetInterface::addConnection;
+   using NetInterface::removeConnection;
+
+   S32 getPendingCount() { return mPendingConnections.size(); }
+};
+
+
+// Lots of clients from the same few networks, as the master sees
+static Address makeAddress(U32 client)
+{
+   Address address;
+   address.transport = IPProtocol;
+   address.netNum[0] = 0x0A000000 + (client / 3);
+   address.port = U16(28000 + client % 3);
+
+   return address;
+}
+
+
+static NetConnection *makeConnection(U32 client)
+{
+   NetConnection *conn = new NetConnection();
+   conn->setNetAddress(makeAddress(client));
+
+   return conn;
+}
+
+
+TEST(NetInterfaceTest, ConnectionTables)
+{
+   TableInterface netInterface;
+
+   const S32 Count = 1000;
+   Vector<RefPtr<NetConnection> > connections;
+
+   for(S32 i = 0; i < Count; i++)
+   {
+      connections.push_back(makeConnection(i));
+      netInterface.addPendingConnection(connections[i]);
+   }
+   ASSERT_EQ(Count, netInterface.getPendingCount());
+
+   for(S32 i = 0; i < Count; i++)
+      ASSERT_EQ(connections[i].getPointer(), netInterface.findPendingConnection(makeAddress(i)));
+   EXPECT_EQ(NULL, netInterface.findPendingConnection(makeAddress(Count)));
+
+   // Adding another for the same address replaces the first
+   RefPtr<NetConnection> replacement = makeConnection(7);
+   netInterface.addPendingConnection(replacement);
+   EXPECT_EQ(Count, netInterface.getPendingCount());
+   EXPECT_EQ(replacement.getPointer(), netInterface.findPendingConnection(makeAddress(7)));
+   netInterface.removePendingConnection(replacement);
+   netInterface.addPendingConnection(connections[7]);
+
+   // Every other one gets connected, and the rest give up
+   for(S32 i = 0; i < Count; i++)
+   {
+      if(i % 2 == 0)
+         netInterface.addConnection(connections[i]);
+      netInterface.removePendingConnection(connections[i]);
+   }
+
+   EXPECT_EQ(0, netInterface.getPendingCount());
+   EXPECT_EQ(Count / 2, netInterface.getConnectionList().size());
+
+   for(S32 i = 0; i < Count; i++)
+   {
+      EXPECT_EQ(NULL, netInterface.findPendingConnection(makeAddress(i)));
+      EXPECT_EQ(i % 2 == 0 ? connections[i].getPointer() : NULL, netInterface.findConnection(makeAddress(i)));
+   }
+
+   // Take them out from all over the place; the rest can still be found
+   for(S32 i = 0; i < Count; i += 4)
+      netInterface.removeConnection(connections[i]);
+
+   for(S32 i = 0; i < Count; i += 2)
+      EXPECT_EQ(i % 4 == 0 ? NULL : connections[i].getPointer(), netInterface.findConnection(makeAddress(i)));
+
+   // Several connections can share an address; all of them can be removed
+   RefPtr<NetConnection> local1 = new NetConnection();
+   RefPtr<NetConnection> local2 = new NetConnection();
+   netInterface.addConnection(local1);
+   netInterface.addConnection(local2);
+   EXPECT_TRUE(netInterface.findConnection(Address()) != NULL);
+   netInterface.removeConnection(local1);
+   EXPECT_EQ(local2.getPointer(), netInterface.findConnection(Address()));
+   netInterface.removeConnection(local2);
+   EXPECT_EQ(NULL, netInterface.findConnection(Address()));
+
+   // Tidy up without sending disconnect packets to our made-up addresses
+   while(netInterface.getConnectionList().size())
+      netInterface.removeConnection(netInterface.getConnectionList()[0]);
+}
+
+
+// Thousands of clients connecting at once, each handshake packet looking up the pending connection, then a few
+// game packets each, then half of them leaving
+TEST(NetInterfaceTest, ConnectStormBenchmark)
+{
+   TableInterface netInterface;
+
+   const S32 Clients = 5000;
+   const S32 HandshakeLookups = 3;     // Challenge response, connect request, connect accept
+   const S32 PacketLookups = 10;
+
+   Vector<RefPtr<NetConnection> > connections;
+   for(S32 i = 0; i < Clients; i++)
+      connections.push_back(makeConnection(i));
+
+   U32 start = Platform::getRealMilliseconds();
+
+   for(S32 i = 0; i < Clients; i++)
+      netInterface.addPendingConnection(connections[i]);
+
+   for(S32 i = 0; i < Clients; i++)
+   {
+      for(S32 j = 0; j < HandshakeLookups; j++)
+         ASSERT_EQ(connections[i].getPointer(), netInterface.findPendingConnection(makeAddress(i)));
+
+      netInterface.addConnection(connections[i]);
+      netInterface.removePendingConnection(connections[i]);
+   }
+
+   U32 handshakeTime = Platform::getRealMilliseconds() - start;
+   start = Platform::getRealMilliseconds();
+
+   for(S32 j = 0; j < PacketLookups; j++)
+      for(S32 i = 0; i < Clients; i++)
+         ASSERT_EQ(connections[i].getPointer(), netInterface.findConnection(makeAddress(i)));
+
+   U32 packetTime = Platform::getRealMilliseconds() - start;
+   start = Platform::getRealMilliseconds();
+
+   for(S32 i = 0; i < Clients; i += 2)
+      netInterface.removeConnection(connections[i]);
+
+   U32 leaveTime = Platform::getRealMilliseconds() - start;
+
+   EXPECT_EQ(0, netInterface.getPendingCount());
+   EXPECT_EQ(Clients / 2, netInterface.getConnectionList().size());
+
+   while(netInterface.getConnectionList().size())
+      netInterface.removeConnection(netInterface.getConnectionList()[0]);
+
+   printf("%d clients: handshakes %d ms, %d packets each %d ms, half leaving %d ms\n",
+          Clients, handshakeTime, PacketLookups, packetTime, leaveTime);
+}
+
+};
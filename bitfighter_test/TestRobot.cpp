@@ -8,6 +8,9 @@
 #include "../zap/ServerGame.h"
 #include "../zap/gameType.h"
 #include "../zap/luaLevelGenerator.h"
+#include "../zap/GameManager.h"
+#include "../zap/robot.h"
+#include "../zap/stringUtils.h"
 #include "gtest/gtest.h"
 
 namespace Zap
@@ -62,6 +65,138 @@ TEST(RobotTest, luaRobotNew)
 }
 
 
+static string getLevelCodeForBotThreads()
+{
+   string levelCode =
+      "GameType 10 8\n"
+      "LevelName Bot Threads\n"
+      "Team Blue 0 0 1\n"
+      "Spawn 0 0 0\n";
+
+   for(S32 x = -6; x <= 6; x++)
+      for(S32 y = -4; y <= 4; y++)
+         levelCode += "TestItem " + itos(x) + " " + itos(y) + "\n";
+
+   return levelCode;
+}
+
+
+// Puts a bot in the robots folder so we can add it by name; returns its filename so it can be removed when we're done
+static string writeBot(const GameSettingsPtr &settings, const string &name, const string &code)
+{
+   string filename = joindir(settings->getFolderManager()->robotDir, name + ".bot");
+   writeFile(filename, code);
+   return filename;
+}
+
+
+static void addBots(ServerGame *server, const char *name, S32 count)
+{
+   Vector<const char *> args;
+   args.push_back("0");
+   args.push_back(name);
+
+   for(S32 i = 0; i < count; i++)
+      server->addBot(args, ClientInfo::ClassRobotAddedByAddbots);
+}
+
+
+// Bots running on the bot threads get states of their own; the changes they make to the game are held until
+// they're all done thinking
+TEST(RobotTest, BotThreadsDeferChanges)
+{
+   const S32 Bots = 4;
+
+   GameSettingsPtr settings = GameSettingsPtr(new GameSettings());
+   settings->getIniSettings()->botThreads = 2;
+
+   string filename = writeBot(settings, "test_adder",
+      "function getName() return 'Adder' end\n"
+      "function main() end\n"
+      "added = false\n"
+      "function onTick(deltaT)\n"
+      "   if not added then\n"
+      "      bf:addItem(TestItem.new())\n"
+      "      added = true\n"
+      "   end\n"
+      "end\n");
+
+   GamePair gamePair(settings, getLevelCodeForBotThreads());
+   gamePair.addClient("TestPlayer");      // Otherwise the game suspends itself, and bots don't get ticked
+   ServerGame *server = gamePair.server;
+   ASSERT_TRUE(server->getBotThreadPool() != NULL);
+
+   Vector<DatabaseObject *> items;
+   server->getGameObjDatabase()->findObjects(TestItemTypeNumber, items);
+   S32 levelItems = items.size();
+
+   addBots(server, "test_adder", Bots);
+   GamePair::idle(10, 5);
+
+   ASSERT_EQ(Bots, server->getBotCount());
+   for(S32 i = 0; i < Bots; i++)
+      EXPECT_TRUE(server->getBot(i)->ownsLuaState());
+
+   items.clear();
+   server->getGameObjDatabase()->findObjects(TestItemTypeNumber, items);
+   EXPECT_EQ(levelItems + Bots, items.size());
+
+   remove(filename.c_str());
+}
+
+
+// Times bots' onTick() run serially and on the bot threads, for several bot counts
+TEST(RobotTest, BotThreadsBenchmark)
+{
+   const S32 botCounts[] = { 1, 8, 32 };
+   const U32 threadCounts[] = { 0, 4 };
+   const S32 Ticks = 100;
+
+   // Mostly looking at the world, as most bots do
+   string filename = writeBot(GameSettingsPtr(new GameSettings()), "test_thinker",
+      "function getName() return 'Thinker' end\n"
+      "function main() end\n"
+      "function onTick(deltaT)\n"
+      "   local total = 0\n"
+      "   for i = 1, 5 do\n"
+      "      local items = bf:findAllObjects(ObjType.TestItem)\n"
+      "      for _, item in ipairs(items) do\n"
+      "         total = total + item:getPos().x\n"
+      "      end\n"
+      "   end\n"
+      "   bot:setAngle(total)\n"
+      "end\n");
+
+   printf("%8s %8s %14s\n", "bots", "threads", "bot ticks/sec");
+
+   for(U32 i = 0; i < ARRAYSIZE(botCounts); i++)
+      for(U32 j = 0; j < ARRAYSIZE(threadCounts); j++)
+      {
+         GameSettingsPtr settings = GameSettingsPtr(new GameSettings());
+         settings->getIniSettings()->botThreads = threadCounts[j];
+
+         GamePair gamePair(settings, getLevelCodeForBotThreads());
+         gamePair.addClient("TestPlayer");
+         ServerGame *server = gamePair.server;
+
+         addBots(server, "test_thinker", botCounts[i]);
+         GamePair::idle(10, 5);     // Get the bots started
+         ASSERT_EQ(botCounts[i], server->getBotCount());
+
+         U32 start = Platform::getRealMilliseconds();
+         for(S32 k = 0; k < Ticks; k++)
+            GameManager::idleServerGame(10);
+         U32 elapsed = max(Platform::getRealMilliseconds() - start, 1U);
+
+         printf("%8d %8d %14.0f\n", botCounts[i], threadCounts[j], F32(botCounts[i] * Ticks) * 1000 / elapsed);
+
+         EXPECT_EQ(botCounts[i], server->getBotCount());    // None got killed along the way
+      }
+
+   remove(filename.c_str());
+}
+
+
 /** onShipSpawned doesn't fire?
 
 TEST(RobotTest, RemoveFromGameDuringInitialOnShipSpawn)
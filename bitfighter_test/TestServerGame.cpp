@@ -5,7 +5,12 @@
 
 #include "gameType.h"
 #include "ServerGame.h"
+#include "ClientGame.h"
+#include "GameManager.h"
+#include "gameNetInterface.h"
 #include "EngineeredItem.h"
+#include "loadoutZone.h"
+#include "stringUtils.h"
 
 #include "TestUtils.h"
 
@@ -165,4 +170,305 @@ TEST(ServerGameTest, LoadoutManagementTests)
 }
 
 
+
+// Builds a level with a field of items around the spawn, so every client has plenty to ghost
+static string getLevelCodeForGhostingBenchmark()
+{
+   string levelCode =
+      "GameType 10 8\n"
+      "LevelName Ghosting Benchmark\n"
+      "GridSize 255\n"
+      "Team Blue 0 0 1\n"
+      "Specials\n"
+      "MinPlayers\n"
+      "MaxPlayers\n"
+      "Spawn 0 0 0\n";
+
+   for(S32 x = -6; x <= 6; x++)
+      for(S32 y = -4; y <= 4; y++)
+         levelCode += "TestItem " + itos(x) + " " + itos(y) + "\n";
+
+   return levelCode;
+}
+
+
+static U32 getGhostedObjectCount(ClientGame *client)
+{
+   return client->getGameObjDatabase()->findObjects_fast()->size();
+}
+
+
+// Ghosting only starts after an RPC round trip, and packets go out on a real-time schedule, so a quick burst
+// of ticks isn't always enough to get it going.  Idle until every client has received the GameType.
+static void idleUntilGhosting(GamePair &gamePair, S32 clientCount)
+{
+   for(S32 i = 0; i < 1000; i++)
+   {
+      bool ghosting = true;
+      for(S32 j = 0; j < clientCount && ghosting; j++)
+         ghosting = gamePair.getClient(j)->getGameType() != NULL;
+
+      if(ghosting)
+         return;
+
+      GamePair::idle(10, 1);
+      Platform::sleep(1);
+   }
+}
+
+
+// Times server ticks with packet preparation done on the main thread and on a worker pool, for
+// several player counts.  Both modes must leave every client with the same set of ghosts.
+TEST(ServerGameTest, PacketPrepareThreadsBenchmark)
+{
+   const S32 playerCounts[] = { 4, 16, 32 };
+   const U32 threadCounts[] = { 0, 4 };
+   const S32 Ticks = 200;
+
+   printf("%8s %8s %12s\n", "players", "threads", "ms/tick");
+
+   for(U32 i = 0; i < ARRAYSIZE(playerCounts); i++)
+   {
+      Vector<U32> ghostCounts[ARRAYSIZE(threadCounts)];
+
+      for(U32 j = 0; j < ARRAYSIZE(threadCounts); j++)
+      {
+         GamePair gamePair(getLevelCodeForGhostingBenchmark(), playerCounts[i]);
+         ServerGame *server = gamePair.server;
+
+         server->getNetInterface()->setPacketPrepareThreadCount(threadCounts[j]);
+         EXPECT_EQ(threadCounts[j], server->getNetInterface()->getPacketPrepareThreadCount());
+
+         idleUntilGhosting(gamePair, playerCounts[i]);
+         GamePair::idle(10, 20);    // Let the clients finish joining and receive their initial ghosts
+
+         U32 serverTime = 0;
+         for(S32 k = 0; k < Ticks; k++)
+         {
+            U32 start = Platform::getRealMilliseconds();
+            GameManager::idleServerGame(10);
+            serverTime += Platform::getRealMilliseconds() - start;
+
+            GameManager::idleClientGames(10);
+         }
+
+         printf("%8d %8d %12.3f\n", playerCounts[i], threadCounts[j], F32(serverTime) / Ticks);
+
+         for(S32 k = 0; k < playerCounts[i]; k++)
+            ghostCounts[j].push_back(getGhostedObjectCount(gamePair.getClient(k)));
+
+         server->getNetInterface()->setPacketPrepareThreadCount(0);
+      }
+
+      SCOPED_TRACE("players = " + itos(playerCounts[i]));
+      for(U32 j = 1; j < ARRAYSIZE(threadCounts); j++)
+         EXPECT_EQ(ghostCounts[0].getStlVector(), ghostCounts[j].getStlVector());
+   }
+}
+
+// Every client sees the same zones, so after the first connection packs one, the rest should copy
+// its bits rather than call packUpdate again -- and still end up with the right geometry
+TEST(ServerGameTest, SharedPackUpdates)
+{
+   const S32 Players = 4;
+   const S32 Zones = 7;
+
+   GamePair gamePair(getLevelCodeForGhostingBenchmark(), Players);
+   ServerGame *server = gamePair.server;
+   idleUntilGhosting(gamePair, Players);
+   GamePair::idle(10, 20);    // Get everyone joined, so the zones go out to all clients on the same tick
+
+   NetClassRep *classRep = &LoadoutZone::dynClassRep;
+   U32 initialHits = classRep->getInitialUpdateCacheHits();
+   U32 initialCount = classRep->getInitialUpdateCount();
+
+   for(S32 i = 0; i < Zones; i++)
+   {
+      F32 x = F32(i - Zones / 2) * 100;
+
+      Vector<Point> geom;
+      geom.push_back(Point(x, 0));
+      geom.push_back(Point(x + 50, 0));
+      geom.push_back(Point(x + 50, 50));
+      geom.push_back(Point(x, 50));
+
+      LoadoutZone *zone = new LoadoutZone();
+      zone->GeomObject::setGeom(geom);
+      zone->onGeomChanged();
+      zone->addToGame(server, server->getGameObjDatabase());
+   }
+
+   GamePair::idle(10, 20);
+
+   Vector<DatabaseObject *> serverZones;
+   server->getGameObjDatabase()->findObjects(LoadoutZoneTypeNumber, serverZones);
+   ASSERT_EQ(Zones, serverZones.size());
+
+   for(S32 i = 0; i < Players; i++)
+   {
+      Vector<DatabaseObject *> clientZones;
+      gamePair.getClient(i)->getGameObjDatabase()->findObjects(LoadoutZoneTypeNumber, clientZones);
+      ASSERT_EQ(Zones, clientZones.size()) << "client " << i;
+
+      for(S32 j = 0; j < clientZones.size(); j++)
+      {
+         bool found = false;
+         for(S32 k = 0; k < serverZones.size() && !found; k++)
+            found = clientZones[j]->getExtent() == serverZones[k]->getExtent();
+
+         EXPECT_TRUE(found) << "client " << i << " has a zone the server doesn't";
+      }
+   }
+
+   // Only the first connection to ghost each zone had to pack it
+   EXPECT_EQ(U32(Players * Zones), classRep->getInitialUpdateCount() - initialCount);
+   EXPECT_EQ(U32((Players - 1) * Zones), classRep->getInitialUpdateCacheHits() - initialHits);
+}
+
+
+// Over a thousand repair items packed in around the spawn, all in scope of a ship sitting on it
+static string getLevelCodeForCrowdedScope()
+{
+   string levelCode =
+      "LevelFormat 2\n"
+      "GameType 10 8\n"
+      "LevelName Crowded Scope\n"
+      "Team Blue 0 0 1\n"
+      "Specials\n"
+      "MinPlayers\n"
+      "MaxPlayers\n"
+      "Spawn 0 0 0\n";
+
+   for(S32 x = -20; x <= 20; x++)
+      for(S32 y = -16; y <= 16; y++)
+         levelCode += "RepairItem " + itos(x * 35) + " " + itos(y * 35) + " 20\n";
+
+   return levelCode;
+}
+
+
+// With 1000+ ghosts waiting on their initial update, each packet only has room for a few of them;
+// times how long the server takes to get them all out, and checks none were lost along the way
+TEST(ServerGameTest, CrowdedScopeGhostingBenchmark)
+{
+   const S32 Players = 4;
+
+   GamePair gamePair(getLevelCodeForCrowdedScope(), Players);
+   ServerGame *server = gamePair.server;
+
+   Vector<DatabaseObject *> serverItems;
+   server->getGameObjDatabase()->findObjects(RepairItemTypeNumber, serverItems);
+   ASSERT_LE(1000, serverItems.size());
+
+   U32 serverTime = 0;
+   S32 ticks = 0;
+   bool done = false;
+
+   for(; ticks < 5000 && !done; ticks++)
+   {
+      U32 start = Platform::getRealMilliseconds();
+      GameManager::idleServerGame(10);
+      serverTime += Platform::getRealMilliseconds() - start;
+
+      GameManager::idleClientGames(10);
+
+      done = true;
+      for(S32 i = 0; i < Players && done; i++)
+      {
+         Vector<DatabaseObject *> clientItems;
+         gamePair.getClient(i)->getGameObjDatabase()->findObjects(RepairItemTypeNumber, clientItems);
+         done = clientItems.size() == serverItems.size();
+      }
+   }
+
+   printf("%d ghosts to %d players in %d ticks, %.3f ms/tick\n", serverItems.size(), Players, ticks, F32(serverTime) / ticks);
+
+   for(S32 i = 0; i < Players; i++)
+   {
+      Vector<DatabaseObject *> clientItems;
+      gamePair.getClient(i)->getGameObjDatabase()->findObjects(RepairItemTypeNumber, clientItems);
+      EXPECT_EQ(serverItems.size(), clientItems.size()) << "client " << i;
+   }
+}
+
+
+// Arenas hosted side by side each get ticked and keep their own tick counts; between ticks, the first
+// one is the current game again
+TEST(ServerGameTest, MultipleArenas)
+{
+   GamePair gamePair(getLevelCodeForGhostingBenchmark(), 1);
+   ServerGame *first = gamePair.server;
+
+   ServerGame *second = newServerGame();
+   GameManager::addServerGame(second);
+   ASSERT_EQ(2, GameManager::getServerGameCount());
+
+   first->resetTickStats();
+
+   for(S32 i = 0; i < 10; i++)
+      GameManager::idleServerGame(10);
+
+   EXPECT_EQ(10U, first->getTickCount());
+   EXPECT_EQ(10U, second->getTickCount());
+   EXPECT_EQ(first, GameManager::getServerGame());
+   EXPECT_EQ(first, Game::getAddTarget());
+
+   GameManager::deleteServerGame(second);
+
+   EXPECT_EQ(1, GameManager::getServerGameCount());
+   EXPECT_EQ(first, GameManager::getServerGame());
+
+   GamePair::idle(10, 5);     // The remaining arena carries on as usual
+   EXPECT_EQ(1, gamePair.getClient(0)->getPlayerCount());
+}
+
+
+// Packet notifies, ghost refs and RPC events should come from their pools, and be recycled as
+// packets are acknowledged
+TEST(ServerGameTest, PacketPoolsRecycle)
+{
+   ChunkerStats packetStats = NetConnection::getPacketPoolStats();
+   ChunkerStats rpcStats = RPCEvent::getPoolStats();
+
+   GamePair gamePair(getLevelCodeForGhostingBenchmark(), 2);
+   GamePair::idle(10, 50);
+
+   ChunkerStats newPacketStats = NetConnection::getPacketPoolStats();
+   ChunkerStats newRPCStats = RPCEvent::getPoolStats();
+
+   EXPECT_GT(newPacketStats.allocCount, packetStats.allocCount);
+   EXPECT_GT(newPacketStats.reuseCount, packetStats.reuseCount);
+   EXPECT_GT(newRPCStats.allocCount, rpcStats.allocCount);
+   EXPECT_GT(newRPCStats.reuseCount, rpcStats.reuseCount);
+}
+
+
+// With players waiting, zones for a new level get built on the secondary thread; zones for a level
+// that was switched away from before they were done are thrown out
+TEST(ServerGameTest, BotZonesBuiltInBackground)
+{
+   GamePair gamePair(getLevelCodeForGhostingBenchmark(), 1);
+   ServerGame *server = gamePair.server;
+
+   S32 zoneCount = server->getBotZoneDatabase()->getObjectCount();
+   ASSERT_GT(zoneCount, 0);      // Initial load has no players, so zones are built right away
+
+   server->cycleLevel(FIRST_LEVEL);
+   server->cycleLevel(FIRST_LEVEL);
+   EXPECT_EQ(0, server->getBotZoneDatabase()->getObjectCount());
+
+   for(S32 i = 0; i < 100 && server->getBotZoneDatabase()->getObjectCount() == 0; i++)
+   {
+      Platform::sleep(20);
+      GamePair::idle(10, 1);
+   }
+
+   Platform::sleep(100);         // Give the stale build a chance to show up, if it was going to
+   GamePair::idle(10, 1);
+
+   EXPECT_EQ(zoneCount, server->getBotZoneDatabase()->getObjectCount());
+   EXPECT_FALSE(server->getGameType()->mBotZoneCreationFailed);
+}
+
+
 };
@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlUDP.h"
+#include "tnlNetInterface.h"
+#include "tnlBitStream.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+static const U32 BigSocketBuffer = 1 << 20;     // Room for a few batches, so nothing gets dropped on the way
+
+
+// Receives until count packets have arrived, or nothing has for a while
+static S32 receiveAll(Socket &socket, Datagram *datagrams, S32 count)
+{
+   Socket *socketPtr = &socket;
+   S32 received = 0;
+   while(received < count && Socket::waitForRead(&socketPtr, 1, 1000))
+      received += socket.recvBatch(datagrams + received, count - received, MaxPacketDataSize);
+
+   return received;
+}
+
+
+TEST(SocketTest, BatchRoundTrip)
+{
+   Socket sender(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   Socket receiver(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   ASSERT_TRUE(sender.isValid());
+   ASSERT_TRUE(receiver.isValid());
+
+   // More than one batch's worth, all different sizes
+   const S32 Count = Socket::MaxBatchSize * 2 + 10;
+
+   Vector<U8> sendData;
+   Vector<Datagram> datagrams;
+   sendData.resize(Count * MaxPacketDataSize);
+   datagrams.resize(Count);
+   for(S32 i = 0; i < Count; i++)
+   {
+      datagrams[i].address = receiver.getBoundAddress();
+      datagrams[i].buffer = sendData.address() + i * MaxPacketDataSize;
+      datagrams[i].size = 1 + (i * 37) % MaxPacketDataSize;
+
+      for(S32 j = 0; j < datagrams[i].size; j++)
+         datagrams[i].buffer[j] = U8(i + j);
+   }
+
+   EXPECT_EQ(Count, sender.sendBatch(datagrams.address(), Count));
+
+   Vector<U8> recvData;
+   Vector<Datagram> received;
+   recvData.resize(Count * MaxPacketDataSize);
+   received.resize(Count);
+   for(S32 i = 0; i < Count; i++)
+      received[i].buffer = recvData.address() + i * MaxPacketDataSize;
+
+   ASSERT_EQ(Count, receiveAll(receiver, received.address(), Count));
+
+   // Loopback keeps them in order
+   for(S32 i = 0; i < Count; i++)
+   {
+      EXPECT_TRUE(received[i].address == sender.getBoundAddress());
+      ASSERT_EQ(datagrams[i].size, received[i].size) << "packet " << i;
+      EXPECT_EQ(0, memcmp(datagrams[i].buffer, received[i].buffer, received[i].size)) << "packet " << i;
+   }
+
+   // Nothing left
+   EXPECT_EQ(0, receiver.recvBatch(received.address(), Count, MaxPacketDataSize));
+}
+
+
+// Takes its own info packets, and remembers the number in each
+class CountingInterface : public NetInterface
+{
+public:
+   Vector<U32> received;
+
+   CountingInterface() : NetInterface(Address("IP:127.0.0.1:0")) { /* Do nothing */ }
+
+   void handleInfoPacket(const Address &address, U8 packetType, BitStream *stream)
+   {
+      received.push_back(stream->readInt(32));
+   }
+};
+
+
+static void writeCountPacket(PacketStream &stream, U32 number)
+{
+   stream.write(U8(NetInterface::FirstValidInfoPacketId));
+   stream.writeInt(number, 32);
+}
+
+
+// Packets queued up in processConnections all get sent, in order
+TEST(SocketTest, NetInterfaceSendsQueuedPackets)
+{
+   CountingInterface sender;
+   Socket receiver(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   Address receiverAddress = receiver.getBoundAddress();
+
+   const S32 Count = Socket::MaxBatchSize * 3 + 5;
+
+   // Delayed packets are sent from processConnections
+   for(S32 i = 0; i < Count; i++)
+   {
+      PacketStream stream;
+      writeCountPacket(stream, i);
+      sender.sendtoDelayed(&receiverAddress, NULL, &stream, 0);
+   }
+
+   Platform::sleep(2);
+   sender.processConnections();
+
+   Vector<U8> recvData;
+   Vector<Datagram> received;
+   recvData.resize(Count * MaxPacketDataSize);
+   received.resize(Count);
+   for(S32 i = 0; i < Count; i++)
+      received[i].buffer = recvData.address() + i * MaxPacketDataSize;
+
+   ASSERT_EQ(Count, receiveAll(receiver, received.address(), Count));
+
+   for(S32 i = 0; i < Count; i++)
+   {
+      BitStream stream(received[i].buffer, received[i].size);
+      EXPECT_EQ(NetInterface::FirstValidInfoPacketId, stream.readInt(8));
+      EXPECT_EQ(U32(i), stream.readInt(32));
+   }
+}
+
+
+// checkIncomingPackets reads everything waiting, a batch at a time
+TEST(SocketTest, NetInterfaceReadsBatches)
+{
+   CountingInterface receiver;
+   Socket sender(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   Address receiverAddress = receiver.getSocket().getBoundAddress();
+   Socket *socket = &receiver.getSocket();
+
+   // The interface's socket has the default buffer size, so don't send too many at once
+   const S32 Rounds = 10;
+   const S32 PerRound = Socket::MaxBatchSize / 2;
+
+   for(S32 round = 0; round < Rounds; round++)
+   {
+      for(S32 i = 0; i < PerRound; i++)
+      {
+         PacketStream stream;
+         writeCountPacket(stream, round * PerRound + i);
+         EXPECT_EQ(NoError, stream.sendto(sender, receiverAddress));
+      }
+
+      for(S32 tries = 0; receiver.received.size() < (round + 1) * PerRound && tries < 100; tries++)
+      {
+         Socket::waitForRead(&socket, 1, 10);
+         receiver.checkIncomingPackets();
+      }
+   }
+
+   ASSERT_EQ(Rounds * PerRound, receiver.received.size());
+   for(S32 i = 0; i < receiver.received.size(); i++)
+      EXPECT_EQ(U32(i), receiver.received[i]);
+}
+
+
+// Packets per second over loopback, sending and receiving a batch at a time, or a packet at a time
+TEST(SocketTest, LoopbackBenchmark)
+{
+   Socket sender(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   Socket receiver(Address("IP:127.0.0.1:0"), BigSocketBuffer, BigSocketBuffer);
+   Socket *receiverPtr = &receiver;
+   Address receiverAddress = receiver.getBoundAddress();
+
+   const S32 Rounds = 500;
+   const S32 PacketSize = 200;     // Typical of a game update
+
+   U8 data[Socket::MaxBatchSize][MaxPacketDataSize];
+   Datagram datagrams[Socket::MaxBatchSize];
+   for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+   {
+      memset(data[i], i, PacketSize);
+      datagrams[i].address = receiverAddress;
+      datagrams[i].buffer = data[i];
+      datagrams[i].size = PacketSize;
+   }
+
+   Address address;
+   S32 size;
+   S32 singleCount = 0;
+
+   U32 start = Platform::getRealMilliseconds();
+   for(S32 round = 0; round < Rounds; round++)
+   {
+      for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+         sender.sendto(receiverAddress, datagrams[i].buffer, PacketSize);
+
+      for(S32 i = 0; i < Socket::MaxBatchSize && Socket::waitForRead(&receiverPtr, 1, 1000); )
+         while(i < Socket::MaxBatchSize && receiver.recvfrom(&address, data[i], MaxPacketDataSize, &size) == NoError)
+         {
+            singleCount++;
+            i++;
+         }
+   }
+   U32 singleTime = Platform::getRealMilliseconds() - start;
+
+   S32 batchCount = 0;
+
+   start = Platform::getRealMilliseconds();
+   for(S32 round = 0; round < Rounds; round++)
+   {
+      sender.sendBatch(datagrams, Socket::MaxBatchSize);
+
+      for(S32 i = 0; i < Socket::MaxBatchSize && Socket::waitForRead(&receiverPtr, 1, 1000); )
+      {
+         S32 count = receiver.recvBatch(datagrams + i, Socket::MaxBatchSize - i, MaxPacketDataSize);
+         batchCount += count;
+         i += count;
+      }
+
+      // recvBatch filled in the sender's address; point them back at the receiver for the next round
+      for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+         datagrams[i].address = receiverAddress;
+   }
+   U32 batchTime = Platform::getRealMilliseconds() - start;
+
+   EXPECT_EQ(Rounds * Socket::MaxBatchSize, singleCount);
+   EXPECT_EQ(Rounds * Socket::MaxBatchSize, batchCount);
+
+   printf("%d packets of %d bytes over loopback: one at a time %.0f packets/s, batched %.0f packets/s\n",
+          Rounds * Socket::MaxBatchSize, PacketSize,
+          singleCount * 1000.0 / getMax(singleTime, 1U), batchCount * 1000.0 / getMax(batchTime, 1U));
+}
+
+};
@@ -42,7 +42,7 @@ static void doScenario1(GamePair &gamePair)
    // Note that spawn delay does not get set until the delayed ship tries to spawn, even if player is marked as inactive
 
    // Kill the ship again -- should be delayed when it tries to respawn because client has been inactive
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    serverGame->getGameObjDatabase()->findObjects(PlayerShipTypeNumber, fillVector);
    EXPECT_EQ(1, fillVector.size());    // Should only be one ship
 
@@ -102,7 +102,7 @@ static void doScenario2(GamePair &gamePair)
 
    // Should now be 2 ships in the game -- one belonging to client1 and another belonging to client2
    gamePair.idle(10, 5);               // Idle 5x; give things time to propagate
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    serverGame->getGameObjDatabase()->findObjects(PlayerShipTypeNumber, fillVector);
    ASSERT_EQ(2, fillVector.size());                  
    fillVector.clear();
@@ -183,7 +183,7 @@ static void doScenario34(GamePair &gamePair, bool letGameSlipIntoFullSuspendMode
    ASSERT_FALSE(clientGame->isSpawnDelayed());         
 
    gamePair.idle(Ship::KillDeleteDelay / 15, 20);     // Idle; give things time to propagate
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    serverGame->getGameObjDatabase()->findObjects(PlayerShipTypeNumber, fillVector);
    ASSERT_EQ(1, fillVector.size());                   // Now that player 2 has left, should only be one ship
    fillVector.clear();
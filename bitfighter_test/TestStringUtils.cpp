@@ -69,4 +69,14 @@ TEST(StringUtilsTest, chopComment)
 }
 
 
+TEST(StringUtilsTest, itos)
+{
+   EXPECT_EQ("-2147483648",          itos(S32_MIN));
+   EXPECT_EQ("4294967295",           itos(U32_MAX));
+   EXPECT_EQ("18446744073709551615", itos(U64_MAX));
+   EXPECT_EQ("-9223372036854775807", itos(S64(-9223372036854775807LL)));
+   EXPECT_EQ("1413456789012",        itos(S64(1413456789012LL)));
+}
+
+
 };
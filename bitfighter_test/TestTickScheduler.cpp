@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickScheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+TEST(TickSchedulerTest, FixedSchedule)
+{
+   TickScheduler scheduler(10);
+
+   // First tick is due right away, and starts the schedule
+   EXPECT_EQ(0, scheduler.getTimeToNextTick(1000));
+   EXPECT_EQ(10, scheduler.tick(1000));
+   EXPECT_EQ(10, scheduler.getTimeToNextTick(1000));
+   EXPECT_EQ(4, scheduler.getTimeToNextTick(1006));
+
+   // A late tick doesn't push back the ones after it
+   EXPECT_EQ(13, scheduler.tick(1013));
+   EXPECT_EQ(7, scheduler.getTimeToNextTick(1013));
+   EXPECT_EQ(7, scheduler.tick(1020));
+
+   EXPECT_EQ(2, scheduler.getTickCount());
+   EXPECT_EQ(3, scheduler.getMaxJitter());
+   EXPECT_FLOAT_EQ(1.5f, scheduler.getAverageJitter());
+
+   scheduler.resetStats();
+   EXPECT_EQ(0, scheduler.getTickCount());
+   EXPECT_EQ(0, scheduler.getMaxJitter());
+}
+
+
+TEST(TickSchedulerTest, CatchUp)
+{
+   TickScheduler scheduler(10);
+   scheduler.tick(0);
+
+   // A little behind: the missed ticks run back-to-back
+   scheduler.tick(25);
+   EXPECT_EQ(0, scheduler.getTimeToNextTick(25));
+   scheduler.tick(25);
+   EXPECT_EQ(5, scheduler.getTimeToNextTick(25));
+
+   // Way behind: start the schedule over
+   scheduler.tick(500);
+   EXPECT_EQ(10, scheduler.getTimeToNextTick(500));
+}
+
+
+TEST(TickSchedulerTest, PeriodChangeAndWrap)
+{
+   TickScheduler scheduler(10);
+
+   // Schedule keeps working across the ms counter wrapping around
+   U32 start = U32_MAX - 4;
+   scheduler.tick(start);
+   EXPECT_EQ(10, scheduler.getTimeToNextTick(start));
+   EXPECT_EQ(0, scheduler.getTimeToNextTick(start + 12));
+   EXPECT_EQ(12, scheduler.tick(start + 12));
+
+   // New period counts from the last tick
+   scheduler.setPeriod(40);
+   EXPECT_EQ(40, scheduler.getPeriod());
+   EXPECT_EQ(30, scheduler.getTimeToNextTick(start + 22));
+}
+
+};
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "VisibilityCache.h"
+#include "ServerGame.h"
+#include "TestUtils.h"
+
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+// One wall, running from (0, -255) to (0, 255), 40 wide
+static const string LevelCode =
+   "GameType 10 8\n"
+   "LevelName Visibility\n"
+   "Team Blue 0 0 1\n"
+   "BarrierMaker 40 0 -1 0 1\n";
+
+
+TEST(VisibilityCacheTest, SameAnswersAsDatabase)
+{
+   GamePair gamePair(LevelCode);
+   ServerGame *server = gamePair.server;
+   VisibilityCache *cache = server->getVisibilityCache();
+   GridDatabase *database = server->getGameObjDatabase();
+
+   cache->clear();
+
+   Point left(-200, 0), right(200, 0);
+   Point aboveLeft(-200, 350), aboveRight(200, 350);
+
+   EXPECT_FALSE(database->pointCanSeePoint(left, right));
+   EXPECT_FALSE(cache->canSee(left, right));
+   EXPECT_TRUE(database->pointCanSeePoint(aboveLeft, aboveRight));
+   EXPECT_TRUE(cache->canSee(aboveLeft, aboveRight));
+
+   // A line clears the end of the wall, but anything as wide as a ship flying along it won't
+   EXPECT_TRUE(cache->canSee(aboveLeft, aboveRight, 10));
+   EXPECT_FALSE(cache->canSee(aboveLeft, aboveRight, 120));
+
+   EXPECT_EQ(4, cache->getQueryCount());
+   EXPECT_EQ(0, cache->getHitCount());
+
+   // Asking again, either way around, doesn't do the work again
+   EXPECT_FALSE(cache->canSee(right, left));
+   EXPECT_TRUE(cache->canSee(aboveRight, aboveLeft));
+   EXPECT_FALSE(cache->canSee(aboveRight, aboveLeft, 120));
+   EXPECT_EQ(3, cache->getHitCount());
+
+   cache->clear();
+   EXPECT_FALSE(cache->canSee(left, right));
+   EXPECT_EQ(1, cache->getQueryCount());
+   EXPECT_EQ(0, cache->getHitCount());
+}
+
+
+// Cache starts over each tick, in case walls have been added or removed
+TEST(VisibilityCacheTest, ClearedEachTick)
+{
+   GamePair gamePair(LevelCode);
+   VisibilityCache *cache = gamePair.server->getVisibilityCache();
+
+   cache->canSee(Point(-200, 0), Point(200, 0));
+   EXPECT_EQ(1, cache->getQueryCount());
+
+   gamePair.idle(10);
+   EXPECT_EQ(0, cache->getQueryCount());
+}
+
+
+// Many bots all looking at the same few places, as when chasing the same flag
+TEST(VisibilityCacheTest, Benchmark)
+{
+   GamePair gamePair(LevelCode);
+   ServerGame *server = gamePair.server;
+   VisibilityCache *cache = server->getVisibilityCache();
+   GridDatabase *database = server->getGameObjDatabase();
+
+   const S32 Bots = 64;
+   const S32 Targets = 4;
+   const S32 Repeats = 5;     // Each bot asks about each target this many times a tick
+
+   U32 start = Platform::getRealMilliseconds();
+   S32 visible = 0;
+   for(S32 tick = 0; tick < 100; tick++)
+      for(S32 i = 0; i < Bots; i++)
+         for(S32 j = 0; j < Targets * Repeats; j++)
+            visible += database->pointCanSeePoint(Point(-300, F32(i * 10 - 320)), Point(300, F32((j % Targets) * 100 - 150)));
+   U32 uncachedTime = Platform::getRealMilliseconds() - start;
+
+   start = Platform::getRealMilliseconds();
+   S32 cachedVisible = 0;
+   for(S32 tick = 0; tick < 100; tick++)
+   {
+      cache->clear();
+      for(S32 i = 0; i < Bots; i++)
+         for(S32 j = 0; j < Targets * Repeats; j++)
+            cachedVisible += cache->canSee(Point(-300, F32(i * 10 - 320)), Point(300, F32((j % Targets) * 100 - 150)));
+   }
+   U32 cachedTime = Platform::getRealMilliseconds() - start;
+
+   EXPECT_EQ(visible, cachedVisible);
+   EXPECT_EQ(U32(Bots * Targets * (Repeats - 1)), cache->getHitCount());
+
+   printf("%d bots x %d targets x %d repeats, 100 ticks: %d ms uncached, %d ms cached\n",
+          Bots, Targets, Repeats, uncachedTime, cachedTime);
+}
+
+};
@@ -49,6 +49,7 @@ module = nil
 package = nil
 io = nil
 debug = nil
+jit = nil           -- Scripts could turn the compiler back on and get out from under the watchdog
 
 -- Unsafe functions mixed with safe functions of some packages
 string.dump = nil
@@ -53,6 +53,8 @@ void BitStream::reset()
    error = false;
    mCompressRelative = false;
    mStringBuffer[0] = 0;
+   mStringWriteCount = 0;
+   mStringTableEntryWriteCount = 0;
    mStringTable = NULL;
 }
 
@@ -90,20 +92,14 @@ bool BitStream::resizeBits(U32 newBits)
    return true;
 }
 
-bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
+// Byte-at-a-time versions of writeBits and readBits, for the last few bytes of the buffer, where there's no room to
+// load and store whole words.  They start at bit bitNum of buffer, and leave the caller to advance its position.
+static void writeBitsByByte(U8 *buffer, U32 bitNum, U32 bitCount, const U8 *sourcePtr)
 {
-   if(!bitCount)
-      return true;
-
-   if(bitCount + bitNum > maxWriteBitNum)
-      if(!resizeBits(bitCount + bitNum - maxWriteBitNum))
-         return false;
-
    U32 upShift  = bitNum & 0x7;
    U32 downShift= 8 - upShift;
 
-   const U8 *sourcePtr = (U8 *) bitPtr;
-   U8 *destPtr = getBuffer() + (bitNum >> 3);
+   U8 *destPtr = buffer + (bitNum >> 3);
 
    // if this write is for <= 1 byte, and it will all fit in the
    // first dest byte, then do some special masking.
@@ -111,15 +107,13 @@ bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
    {
       U8 mask = ((1 << bitCount) - 1) << upShift;
       *destPtr = (*destPtr & ~mask) | ((*sourcePtr << upShift) & mask);
-      bitNum += bitCount;
-      return true;
+      return;
    }
 
    // check for byte aligned writes -- this will be
    // much faster than the shifting writes.
    if(!upShift)
    {
-      bitNum += bitCount;
       for(; bitCount >= 8; bitCount -= 8)
          *destPtr++ = *sourcePtr++;
       if(bitCount)
@@ -127,7 +121,7 @@ bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
          U8 mask = (1 << bitCount) - 1;
          *destPtr = (*sourcePtr & mask) | (*destPtr & ~mask);
       }
-      return true;
+      return;
    }
 
    // the write destination is not byte aligned.
@@ -135,8 +129,6 @@ bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
    U8 destByte = *destPtr & (0xFF >> downShift);
    U8 lastMask  = 0xFF >> (7 - ((bitNum + bitCount - 1) & 0x7));
 
-   bitNum += bitCount;
-
    for(/* empty */;bitCount >= 8; bitCount -= 8)
    {
       sourceByte = *sourcePtr++;
@@ -146,35 +138,24 @@ bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
    if(bitCount == 0)
    {
       *destPtr = (*destPtr & ~lastMask) | (destByte & lastMask);
-      return true;
+      return;
    }
    if(bitCount <= downShift)
    {
       *destPtr = (*destPtr & ~lastMask) | ((destByte | (*sourcePtr << upShift)) & lastMask);
-      return true;
+      return;
    }
    sourceByte = *sourcePtr;
 
    *destPtr++ = destByte | (sourceByte << upShift);
    *destPtr = (*destPtr & ~lastMask) | ((sourceByte >> downShift) & lastMask);
-   return true;
 }
 
-bool BitStream::readBits(U32 bitCount, void *bitPtr)
+static void readBitsByByte(const U8 *buffer, U32 bitNum, U32 bitCount, U8 *destPtr)
 {
-   if(!bitCount)
-      return true;
-   if(bitCount + bitNum > maxReadBitNum)
-   {
-      error = true;
-      return false;
-   }
-
-   U8 *sourcePtr = getBuffer() + (bitNum >> 3);
+   const U8 *sourcePtr = buffer + (bitNum >> 3);
    U32 byteCount = (bitCount + 7) >> 3;
 
-   U8 *destPtr = (U8 *) bitPtr;
-
    U32 downShift = bitNum & 0x7;
    U32 upShift = 8 - downShift;
 
@@ -182,12 +163,10 @@ bool BitStream::readBits(U32 bitCount, void *bitPtr)
    {
       while(byteCount--)
          *destPtr++ = *sourcePtr++;
-      bitNum += bitCount;
-      return true;
+      return;
    }
 
    U8 sourceByte = *sourcePtr >> downShift;
-   bitNum += bitCount;
 
    for(; bitCount >= 8; bitCount -= 8)
    {
@@ -200,10 +179,88 @@ bool BitStream::readBits(U32 bitCount, void *bitPtr)
       if(bitCount <= upShift)
       {
          *destPtr = sourceByte;
-         return true;
+         return;
       }
       *destPtr = sourceByte | ( (*++sourcePtr) << upShift);
    }
+}
+
+
+// Gathers byteCount (up to 8) little-endian bytes into a value
+static U64 loadBytes(const U8 *ptr, U32 byteCount)
+{
+   U64 value = 0;
+   memcpy(&value, ptr, byteCount);
+   return convertLEndianToHost(value);
+}
+
+// ...and scatters the low byteCount bytes of value back out
+static void storeBytes(U8 *ptr, U64 value, U32 byteCount)
+{
+   value = convertHostToLEndian(value);
+   memcpy(ptr, &value, byteCount);
+}
+
+
+// Big reads and writes go through in chunks of this many bits, which is a whole number of bytes
+static const U32 ChunkBits = 56;
+
+bool BitStream::writeBits(U32 bitCount, const void *bitPtr)
+{
+   if(!bitCount)
+      return true;
+
+   if(bitCount + bitNum > maxWriteBitNum)
+      if(!resizeBits(bitCount + bitNum - maxWriteBitNum))
+         return false;
+
+   const U8 *sourcePtr = (const U8 *) bitPtr;
+
+   while(bitCount > MaxWordBits && canWriteWord())
+   {
+      writeWord(loadBytes(sourcePtr, ChunkBits >> 3), ChunkBits);
+      sourcePtr += ChunkBits >> 3;
+      bitCount -= ChunkBits;
+   }
+
+   if(canWriteWord())
+      writeWord(loadBytes(sourcePtr, (bitCount + 7) >> 3), bitCount);
+   else
+   {
+      writeBitsByByte(getBuffer(), bitNum, bitCount, sourcePtr);
+      bitNum += bitCount;
+   }
+
+   return true;
+}
+
+bool BitStream::readBits(U32 bitCount, void *bitPtr)
+{
+   if(!bitCount)
+      return true;
+   if(bitCount + bitNum > maxReadBitNum)
+   {
+      error = true;
+      return false;
+   }
+
+   U8 *destPtr = (U8 *) bitPtr;
+
+   while(bitCount > MaxWordBits && canReadWord())
+   {
+      storeBytes(destPtr, readWord(ChunkBits), ChunkBits >> 3);
+      destPtr += ChunkBits >> 3;
+      bitCount -= ChunkBits;
+   }
+
+   if(canReadWord())
+      storeBytes(destPtr, readWord(bitCount), (bitCount + 7) >> 3);
+   else
+   {
+      readBitsByByte(getBuffer(), bitNum, bitCount, destPtr);
+      bitNum += bitCount;
+   }
+
    return true;
 }
 
@@ -224,19 +281,6 @@ bool BitStream::testBit(U32 bitCount)
    return (*(getBuffer() + (bitCount >> 3)) & (1 << (bitCount & 0x7))) != 0;
 }
 
-bool BitStream::writeFlag(bool val)
-{
-   if(bitNum + 1 > maxWriteBitNum)
-      if(!resizeBits(1))
-         return false;
-   if(val)
-      *(getBuffer() + (bitNum >> 3)) |= (1 << (bitNum & 0x7));
-   else
-      *(getBuffer() + (bitNum >> 3)) &= ~(1 << (bitNum & 0x7));
-   bitNum++;
-   return (val);
-}
-
 bool BitStream::write(const ByteBuffer *theBuffer)
 {
    U32 size = theBuffer->getBufferSize();
@@ -255,24 +299,11 @@ bool BitStream::read(ByteBuffer *theBuffer)
    return read(size, theBuffer->getBuffer());
 }
 
-U32 BitStream::readInt(U8 bitCount)
-{
-   TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use readInt64");
-   U32 ret = 0;
-   readBits(bitCount, &ret);
-   ret = convertLEndianToHost(ret);
-
-   // Clear bits that we didn't read.
-   if(bitCount == 32)
-      return ret;
-   else
-      ret &= (1 << bitCount) - 1;
-
-   return ret;
-}
-
 U64 BitStream::readInt64(U8 bitCount)
 {
+   if(bitCount <= MaxWordBits && canReadWord())
+      return readWord(bitCount);
+
    U64 ret = 0;
    readBits(bitCount, &ret);
    ret = convertLEndianToHost(ret);
@@ -287,15 +318,14 @@ U64 BitStream::readInt64(U8 bitCount)
 }
 
 
-void BitStream::writeInt(U32 val, U8 bitCount)
-{
-   TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use writeInt64");
-   val = convertHostToLEndian(val);
-   writeBits(bitCount, &val);
-}
-
 void BitStream::writeInt64(U64 val, U8 bitCount)
 {
+   if(bitCount <= MaxWordBits && canWriteWord())
+   {
+      writeWord(val, bitCount);
+      return;
+   }
+
    val = convertHostToLEndian(val);
    writeBits(bitCount, &val);
 }
@@ -508,6 +538,7 @@ void BitStream::writeString(const char *string, U8 maxLen)     // maxlen default
 {
    if(!string)
       string = "";
+   mStringWriteCount++;
    U8 j;
    for(j = 0; j < maxLen && mStringBuffer[j] == string[j] && string[j];j++)
       ;  // do nothing
@@ -543,6 +574,8 @@ void BitStream::readStringTableEntry(StringTableEntry *ste)
 
 void BitStream::writeStringTableEntry(const StringTableEntry &ste)
 {
+   mStringWriteCount++;
+   mStringTableEntryWriteCount++;
    if(mStringTable)
       mStringTable->writeStringTableEntry(this, ste);
    else
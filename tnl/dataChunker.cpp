@@ -82,4 +82,46 @@ void DataChunker::freeBlocks()
    }
 }
 
+//----------------------------------------------------------------------------
+
+SizedFreeListChunker::SizedFreeListChunker(ChunkerStats *stats)
+{
+   for(U32 i = 0; i < MaxBlockSize / Granularity; i++)
+      mChunkers[i] = NULL;
+
+   mStats = stats;
+}
+
+SizedFreeListChunker::~SizedFreeListChunker()
+{
+   for(U32 i = 0; i < MaxBlockSize / Granularity; i++)
+      delete mChunkers[i];
+}
+
+void *SizedFreeListChunker::alloc(size_t size)
+{
+   if(size == 0 || size > MaxBlockSize)
+      return malloc(size);
+
+   U32 index = U32(size - 1) / Granularity;
+   if(!mChunkers[index])
+      mChunkers[index] = new FreeListChunker((index + 1) * Granularity, DataChunker::ChunkSize, mStats);
+
+   return mChunkers[index]->alloc();
+}
+
+void SizedFreeListChunker::free(void *block, size_t size)
+{
+   if(!block)
+      return;
+
+   if(size == 0 || size > MaxBlockSize)
+   {
+      ::free(block);
+      return;
+   }
+
+   mChunkers[U32(size - 1) / Granularity]->free(block);
+}
+
 };
@@ -32,7 +32,7 @@
 
 namespace TNL {
 
-ClassChunker<EventConnection::EventNote> EventConnection::mEventNoteChunker;
+ClassChunker<EventConnection::EventNote> EventConnection::mEventNoteChunker(DataChunker::ChunkSize, &mPacketPoolStats);
 
 EventConnection::EventConnection()
 {
@@ -30,9 +30,34 @@
 #include "tnlNetBase.h"
 #include "tnlNetObject.h"
 #include "tnlNetInterface.h"
+#include "tnlThread.h"
 
 namespace TNL {
 
+// Ghosts for the same object on different connections are chained through NetObject::mFirstObjectRef.
+// Connections may be scoped in parallel (see NetInterface::setPacketPrepareThreadCount), so edits to
+// that shared chain are serialized; everything else touched while scoping belongs to one connection.
+static Mutex gObjectRefLock;
+
+// Created on first use, and never freed, so refs can't outlive it during static destruction
+static FreeListChunker *gGhostRefPool = NULL;
+
+void *GhostConnection::GhostRef::operator new(size_t size)
+{
+   TNLAssert(size == sizeof(GhostRef), "GhostRef can't be subclassed");
+
+   if(!gGhostRefPool)
+      gGhostRefPool = new FreeListChunker(sizeof(GhostRef), DataChunker::ChunkSize, &mPacketPoolStats);
+
+   return gGhostRefPool->alloc();
+}
+
+void GhostConnection::GhostRef::operator delete(void *ptr)
+{
+   if(ptr)
+      gGhostRefPool->free(ptr);
+}
+
 GhostConnection::GhostConnection()
 {
    // ghost management data:
@@ -42,6 +67,11 @@ GhostConnection::GhostConnection()
    mScoping = false;
    mGhostLookupTable = NULL;
    mGhostZeroUpdateIndex = 0;
+   mGhostUpdatesPrioritized = false;
+   mGhostMaxIndex = 0;
+   mGhostSortedIndex = 0;
+   mGhostSelectCount = MinGhostSelectCount;
+   mPackUpdateConnectionSpecific = false;
 
    mGhostFrom = false;
    mGhostTo = false;
@@ -182,14 +212,10 @@ void GhostConnection::packetReceived(PacketNotify *pnotify)
    }
 }
 
-static S32 QSORT_CALLBACK UQECompare(const void *a,const void *b)
+static bool UQELess(const GhostInfo *a, const GhostInfo *b)
 {
-   GhostInfo *ga = *((GhostInfo **) a);
-   GhostInfo *gb = *((GhostInfo **) b);
-
-   F32 ret = ga->priority - gb->priority;
-   return (ret < 0) ? -1 : ((ret > 0) ? 1 : 0);
-} 
+   return a->priority < b->priority;
+}
 
 void GhostConnection::prepareWritePacket()
 {
@@ -244,28 +270,18 @@ bool GhostConnection::isDataToTransmit()
    return Parent::isDataToTransmit() || mGhostZeroUpdateIndex != 0;
 }
 
-void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
+void GhostConnection::prepareDataPacket()
 {
-   Parent::writePacket(bstream, pnotify);
-   GhostPacketNotify *notify = static_cast<GhostPacketNotify *>(pnotify);
-
-   if(mConnectionParameters.mDebugObjectSizes)
-      bstream->writeInt(DebugChecksum, 32);
+   Parent::prepareDataPacket();
 
-   notify->ghostList = NULL;
-   
-   if(!doesGhostFrom())
-      return;
-   
-   if(!bstream->writeFlag(mGhosting && mScopeObject.isValid()))
-      return;
-      
-   // fill a packet (or two) with ghosting data
+   if(doesGhostFrom() && mGhosting && mScopeObject.isValid())
+      prioritizeGhostUpdates();
+}
 
+void GhostConnection::prioritizeGhostUpdates()
+{
    // 2. call scoped objects' priority functions if the flag set is nonzero
    //    A removed ghost is assumed to have a high priority
-   // 3. call updates based on sorted priority until the packet is
-   //    full.  set flags to zero for all updated objects
 
    GhostInfo *walk;
 
@@ -300,13 +316,63 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       else
          walk->priority = 0;
    }
-   GhostRef *updateList = NULL;
-   if(mGhostZeroUpdateIndex != 0)
-      qsort(&mGhostArray[0], mGhostZeroUpdateIndex, sizeof(GhostInfo *), UQECompare);
+
+   // A packet only holds a handful of updates, so rather than sorting everything, just pull the
+   // ones likely to fit to the top.  writePacket selects more if it runs through them.
+   selectGhostUpdates(mGhostZeroUpdateIndex, mGhostSelectCount);
+
+   mGhostMaxIndex = maxIndex;
+   mGhostUpdatesPrioritized = true;
+}
+
+void GhostConnection::selectGhostUpdates(S32 end, S32 count)
+{
+   GhostInfo **first = mGhostArray.address();
+   S32 start = getMax(end - count, 0);
+
+   if(start > 0)
+      std::nth_element(first, first + start, first + end, UQELess);
+   std::sort(first + start, first + end, UQELess);
+
    // reset the array indices...
-   for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
+   for(S32 i = end - 1; i >= 0; i--)
       mGhostArray[i]->arrayIndex = i;
 
+   mGhostSortedIndex = start;
+}
+
+void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
+{
+   // Callers that write packets directly (the game recorder, for one) skip prepareDataPacket
+   bool prioritized = mGhostUpdatesPrioritized;
+   mGhostUpdatesPrioritized = false;
+
+   Parent::writePacket(bstream, pnotify);
+   GhostPacketNotify *notify = static_cast<GhostPacketNotify *>(pnotify);
+
+   if(mConnectionParameters.mDebugObjectSizes)
+      bstream->writeInt(DebugChecksum, 32);
+
+   notify->ghostList = NULL;
+   
+   if(!doesGhostFrom())
+      return;
+   
+   if(!bstream->writeFlag(mGhosting && mScopeObject.isValid()))
+      return;
+      
+   // fill a packet (or two) with ghosting data
+
+   if(!prioritized)
+      prioritizeGhostUpdates();
+   mGhostUpdatesPrioritized = false;
+
+   // 3. call updates based on sorted priority until the packet is
+   //    full.  set flags to zero for all updated objects
+
+   GhostRef *updateList = NULL;
+   U32 maxIndex = mGhostMaxIndex;
+
    U8 sendSize = 0;
    while(maxIndex != 0)
    {
@@ -321,8 +387,15 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
    U32 count = 0;
    bool have_something_to_send = bstream->getBitPosition() >= 256;
+   S32 walked = 0;
    for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
    {
+      // Ran out of ordered updates with room left in the packet -- order some more.  Updates
+      // already written only ever get swapped with each other, so the rest are untouched.
+      if(i < mGhostSortedIndex)
+         selectGhostUpdates(i + 1, mGhostSelectCount);
+
+      walked++;
       GhostInfo *walk = mGhostArray[i];
       if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
          continue;
@@ -356,15 +429,16 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
             NetObject::mIsInitialUpdate = true;
          }
          // update the object
-         retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         bool fromCache;
+         retMask = packObjectUpdate(walk->obj, updateMask, bstream, fromCache);
 
          if(NetObject::mIsInitialUpdate)
          {
             NetObject::mIsInitialUpdate = false;
-            walk->obj->getClassRep()->addInitialUpdate(bstream->getBitPosition() - startPos);
+            walk->obj->getClassRep()->addInitialUpdate(bstream->getBitPosition() - startPos, fromCache);
          }
          else
-            walk->obj->getClassRep()->addPartialUpdate(bstream->getBitPosition() - startPos);
+            walk->obj->getClassRep()->addPartialUpdate(bstream->getBitPosition() - startPos, fromCache);
 
          if(mConnectionParameters.mDebugObjectSizes)
             bstream->writeIntAt(bstream->getBitPosition(), BitStreamPosBitSize, startPos - BitStreamPosBitSize);
@@ -433,6 +507,9 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
    // mGhostZeroUpdateIndex # of ghosts remain to be updated.
    // no more objects...
    bstream->writeFlag(false);
+
+   // Order a bit more than this packet got through next time, so we rarely have to select twice
+   mGhostSelectCount = getMax(walked + walked / 2, (S32)MinGhostSelectCount);
    notify->ghostList = updateList;
 }
 
@@ -565,12 +642,14 @@ void GhostConnection::detachObject(GhostInfo *info)
    }
    if(info->obj)
    {
+      gObjectRefLock.lock();
       if(info->prevObjectRef)
          info->prevObjectRef->nextObjectRef = info->nextObjectRef;
       else
          info->obj->mFirstObjectRef = info->nextObjectRef;
       if(info->nextObjectRef)
          info->nextObjectRef->prevObjectRef = info->prevObjectRef;
+      gObjectRefLock.unlock();
       // remove it from the lookup table
       
       U32 id = info->obj->getHashId();
@@ -708,11 +787,13 @@ void GhostConnection::objectInScope(NetObject *obj)
 
    giptr->connection = this;
 
+   gObjectRefLock.lock();
    giptr->nextObjectRef = obj->mFirstObjectRef;
    if(obj->mFirstObjectRef)
       obj->mFirstObjectRef->prevObjectRef = giptr;
    giptr->prevObjectRef = NULL;
    obj->mFirstObjectRef = giptr;
+   gObjectRefLock.unlock();
    
    giptr->nextLookupInfo = mGhostLookupTable[index];
    mGhostLookupTable[index] = giptr;
@@ -861,8 +942,90 @@ NetObject *GhostConnection::resolveGhostParent(S32 id)
    return mGhostRefs[id]->obj;
 }
 
+U32 GhostConnection::packObjectUpdate(NetObject *obj, U32 updateMask, BitStream *bstream, bool &fromCache)
+{
+   fromCache = false;
+
+   if(NetObject::mPackCacheEpoch == 0)
+      return obj->packUpdate(this, updateMask, bstream);
+
+   U32 epoch = NetObject::mPackCacheEpoch;
+   U32 classGroup = getNetClassGroup();
+   bool initialUpdate = NetObject::mIsInitialUpdate;
+
+   // Look for an encoding another connection already wrote this epoch, remembering
+   // a stale entry we can reuse if there isn't one
+   S32 freeIndex = -1;
+   for(S32 i = 0; i < obj->mPackCache.size(); i++)
+   {
+      NetObject::PackCacheEntry &entry = obj->mPackCache[i];
+      if(entry.epoch != epoch)
+      {
+         if(freeIndex == -1)
+            freeIndex = i;
+         continue;
+      }
+
+      if(entry.updateMask != updateMask || entry.classGroup != classGroup || entry.initialUpdate != initialUpdate)
+         continue;
+
+      // The first connection to pack this found it depended on the connection; so does everyone else
+      if(entry.connectionSpecific)
+         return obj->packUpdate(this, updateMask, bstream);
+
+      bstream->writeBits(entry.bitCount, entry.bits.address());
+      fromCache = true;
+      return entry.retMask;
+   }
+
+   // Nobody has packed this yet -- do it ourselves, and keep the bits for the next connection
+   U32 startPos = bstream->getBitPosition();
+   U32 startStringCount = bstream->getStringWriteCount();
+   mPackUpdateConnectionSpecific = false;
+
+   U32 retMask = obj->packUpdate(this, updateMask, bstream);
+
+   // Strings are compressed against what was previously written to this stream, and string table
+   // entries against this connection's table, so anything that writes them can't be shared.  An
+   // overrun update will be rewound, so it's not worth keeping either.
+   bool connectionSpecific = mPackUpdateConnectionSpecific ||
+                             bstream->getStringWriteCount() != startStringCount ||
+                             !bstream->isValid();
+   mPackUpdateConnectionSpecific = false;
+
+   if(freeIndex == -1)
+   {
+      freeIndex = obj->mPackCache.size();
+      obj->mPackCache.resize(freeIndex + 1);
+   }
+
+   NetObject::PackCacheEntry &entry = obj->mPackCache[freeIndex];
+   entry.epoch = epoch;
+   entry.updateMask = updateMask;
+   entry.classGroup = classGroup;
+   entry.initialUpdate = initialUpdate;
+   entry.connectionSpecific = connectionSpecific;
+   entry.retMask = retMask;
+   entry.bitCount = 0;
+
+   if(!connectionSpecific)
+   {
+      entry.bitCount = bstream->getBitPosition() - startPos;
+      entry.bits.resize((entry.bitCount + 7) >> 3);
+
+      BitStream reader(bstream->getBuffer(), bstream->getBytePosition());
+      reader.setBitPosition(startPos);
+      reader.readBits(entry.bitCount, entry.bits.address());
+   }
+
+   return retMask;
+}
+
 S32 GhostConnection::getGhostIndex(NetObject *obj)
 {
+   // Ghost indices differ from connection to connection
+   markPackUpdateConnectionSpecific();
+
    if(!obj)
       return -1;
    if(!doesGhostFrom())
@@ -52,7 +52,24 @@ namespace HuffmanStringProcessor {
    Vector<HuffNode> mHuffNodes;
    Vector<HuffLeaf> mHuffLeaves;
 
+   // Decoding table, indexed by the next DecodeBits bits of the stream.  Each entry holds every whole symbol
+   // those bits spell out (up to MaxDecodeSymbols), and how far into the bits each one ends.  Codes longer than
+   // DecodeBits have no symbols; decoding carries on down the tree from node.
+   static const U32 DecodeBits = 10;
+   static const U32 MaxDecodeSymbols = 3;
+   static const U32 MaxCodeBits = 32;
+
+   struct HuffDecode {
+      U8  symbolCount;
+      U8  symbols[MaxDecodeSymbols];
+      U8  endBits[MaxDecodeSymbols];
+      S16 node;
+   };
+
+   HuffDecode mHuffDecodes[1 << DecodeBits];
+
    void buildTables();
+   void buildDecodeTable();
 
    // We have to be a bit careful with these, since they are pointers...
    struct HuffWrap {
@@ -153,6 +170,34 @@ void HuffmanStringProcessor::buildTables()
    BitStream bs((U8 *) &code, 4);
 
    generateCodes(bs, 0, 0);
+
+   buildDecodeTable();
+}
+
+void HuffmanStringProcessor::buildDecodeTable()
+{
+   for (U32 bits = 0; bits < (1 << DecodeBits); bits++) {
+      HuffDecode& rDecode = mHuffDecodes[bits];
+      rDecode.symbolCount = 0;
+
+      // Walk down the tree, starting over at the top after each symbol, until we run out of bits
+      S32 index = 0;
+      for (U32 i = 0; i < DecodeBits && rDecode.symbolCount < MaxDecodeSymbols; i++) {
+         index = (bits & (1 << i)) ? mHuffNodes[index].index1 : mHuffNodes[index].index0;
+
+         if (index < 0) {
+            rDecode.symbols[rDecode.symbolCount] = mHuffLeaves[-(index + 1)].symbol;
+            rDecode.endBits[rDecode.symbolCount] = U8(i + 1);
+            rDecode.symbolCount++;
+            index = 0;
+         }
+      }
+
+      rDecode.node = S16(index);    // Only used when symbolCount is 0
+   }
+
+   for (S32 i = 0; i < mHuffLeaves.size(); i++)
+      TNLAssert(mHuffLeaves[i].numBits <= MaxCodeBits, "Code too long for decoder");
 }
 
 void HuffmanStringProcessor::generateCodes(BitStream& rBS, S32 index, S32 depth)
@@ -199,7 +244,39 @@ bool HuffmanStringProcessor::readHuffBuffer(BitStream* pStream, char* out_pBuffe
 
    if (pStream->readFlag()) {
       U32 len = pStream->readInt(8);
-      for (U32 i = 0; i < len; i++) {
+      U32 i = 0;
+
+      // While there's a word's worth of bits left in the stream, decode out of it with the table, stopping while
+      // there's still room for the longest code
+      U64 bits;
+      while (i < len && pStream->peekWord(bits)) {
+         U32 used = 0;
+         while (i < len && used + MaxCodeBits <= BitStream::MaxWordBits) {
+            const HuffDecode& rDecode = mHuffDecodes[(bits >> used) & ((1 << DecodeBits) - 1)];
+
+            if (rDecode.symbolCount == 0) {
+               S32 index = rDecode.node;
+               used += DecodeBits;
+               while (index >= 0) {
+                  index = ((bits >> used) & 1) ? mHuffNodes[index].index1 : mHuffNodes[index].index0;
+                  used++;
+               }
+               out_pBuffer[i++] = mHuffLeaves[-(index+1)].symbol;
+            } else {
+               U32 count = rDecode.symbolCount;
+               if (count > len - i)
+                  count = len - i;
+
+               for (U32 j = 0; j < count; j++)
+                  out_pBuffer[i++] = rDecode.symbols[j];
+               used += rDecode.endBits[count - 1];
+            }
+         }
+         pStream->advanceBitPosition(used);
+      }
+
+      // Close to the end of the stream, go a bit at a time
+      for (; i < len; i++) {
          S32 index = 0;
          while (true) {
             if (index >= 0) {
@@ -253,10 +330,25 @@ bool HuffmanStringProcessor::writeHuffBuffer(BitStream* pStream, const char* out
    } else {
       pStream->writeFlag(true);
       pStream->writeInt(len, 8);
+
+      // Gather codes up into words, and write a word at a time
+      U64 pending = 0;
+      U32 pendingBits = 0;
       for (i = 0; i < len; i++) {
          HuffLeaf& rLeaf = mHuffLeaves[((unsigned char)out_pBuffer[i])];
-         pStream->writeBits(rLeaf.numBits, &rLeaf.code);
+
+         if (pendingBits + rLeaf.numBits > BitStream::MaxWordBits) {
+            pStream->writeInt64(pending, pendingBits);
+            pending = 0;
+            pendingBits = 0;
+         }
+
+         // The code was built up in a BitStream, so it's in stream order, with leftovers from longer codes past numBits
+         U64 code = convertLEndianToHost(rLeaf.code) & ((U64(1) << rLeaf.numBits) - 1);
+         pending |= code << pendingBits;
+         pendingBits += rLeaf.numBits;
       }
+      pStream->writeInt64(pending, pendingBits);
    }
 
    return true;
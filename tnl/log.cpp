@@ -26,6 +26,7 @@
 
 #include "tnlLog.h"
 #include "tnlDataChunker.h"
+#include "tnlThread.h"
 #include "../zap/oglconsole.h"   // For logging to the console
 #include <time.h>
 #include <string.h>
@@ -104,9 +105,18 @@ void LogConsumer::logString(LogConsumer::MsgType msgType, std::string message)
 // in a script, some messages can get very long
 static char msg[1024 * 8];
 
+// Bots may log from worker threads, so only one thread at a time gets to use msg
+static Mutex &getLogLock()
+{
+   static Mutex logLock;
+   return logLock;
+}
+
 
 void LogConsumer::logprintf(const char *format, ...)
 {
+   getLogLock().lock();
+
    va_list args; 
    va_start(args, format); 
 
@@ -117,6 +127,8 @@ void LogConsumer::logprintf(const char *format, ...)
    std::string message(msg);
 
    prepareAndLogString(message);
+
+   getLogLock().unlock();
 }
 
 
@@ -230,6 +242,8 @@ LogType *LogType::find(const char *name)
 // Logs to logfiles that have subscribed to specified message type
 void logprintf(LogConsumer::MsgType msgType, const char *format, ...)
 {
+   getLogLock().lock();
+
    va_list args; 
    va_start(args, format); 
 
@@ -240,12 +254,16 @@ void logprintf(LogConsumer::MsgType msgType, const char *format, ...)
    std::string message(msg);
 
    LogConsumer::logString(msgType, message);
+
+   getLogLock().unlock();
 }
 
 
 // Logs to general log
 void logprintf(const char *format, ...)
 {
+   getLogLock().lock();
+
    va_list args; 
    va_start(args, format); 
 
@@ -256,6 +274,8 @@ void logprintf(const char *format, ...)
    std::string message(msg);
 
    LogConsumer::logString(LogConsumer::All, message);
+
+   getLogLock().unlock();
 }
 
 
@@ -47,6 +47,8 @@ NetClassRep::NetClassRep()
    mInitialUpdateBitsUsed = 0;
    mPartialUpdateCount = 0;
    mPartialUpdateBitsUsed = 0;
+   mInitialUpdateCacheHits = 0;
+   mPartialUpdateCacheHits = 0;
 }
 
 Object* NetClassRep::create(const char* className)
@@ -149,17 +151,19 @@ void NetClassRep::logBitUsage()
    {
       if(walk->mInitialUpdateCount)
       {
-         logprintf(LogConsumer::LogNetBase, "%s (Initialized) - Count: %d   Total: %d   Avg Size: %g", 
+         logprintf(LogConsumer::LogNetBase, "%s (Initialized) - Count: %d   Total: %d   Avg Size: %g   Cache Hits: %.0f%%", 
                walk->mClassName, walk->mInitialUpdateCount, walk->mInitialUpdateBitsUsed, 
-               walk->mInitialUpdateBitsUsed / F32(walk->mInitialUpdateCount));
+               walk->mInitialUpdateBitsUsed / F32(walk->mInitialUpdateCount),
+               walk->mInitialUpdateCacheHits * 100.0f / walk->mInitialUpdateCount);
          atLeastOne = true;
       }
 
       if(walk->mPartialUpdateCount)
       {
-         logprintf(LogConsumer::LogNetBase, "%s (Updated) - Count: %d   Total: %d   Avg Size: %g", 
+         logprintf(LogConsumer::LogNetBase, "%s (Updated) - Count: %d   Total: %d   Avg Size: %g   Cache Hits: %.0f%%", 
                walk->mClassName, walk->mPartialUpdateCount, walk->mPartialUpdateBitsUsed, 
-               walk->mPartialUpdateBitsUsed / F32(walk->mPartialUpdateCount));
+               walk->mPartialUpdateBitsUsed / F32(walk->mPartialUpdateCount),
+               walk->mPartialUpdateCacheHits * 100.0f / walk->mPartialUpdateCount);
          atLeastOne = true;
       }
    }
@@ -99,6 +99,9 @@ NetConnection::NetConnection()
    mPingSendCount = 0;
    mLastPingSendTime = 0;
 
+   mConnectionListIndex = -1;
+   mPendingListIndex = -1;
+
    mLastSeqRecvd = 0;
 
    mHighestAckedSeq = mInitialSendSeq;
@@ -111,6 +114,7 @@ NetConnection::NetConnection()
    ssthresh = 30;
    mLastSeqRecvdAck = 0;
    mLastAckTime = 0;
+   mPendingSendAction = SendNothing;
 
    mPingTimeout = DefaultPingTimeout;
    mPingRetryCount = DefaultPingRetryCount;
@@ -164,6 +168,25 @@ NetConnection::PacketNotify::PacketNotify()
    sendTime = 0;
 }
 
+ChunkerStats NetConnection::mPacketPoolStats;
+
+// Created on first use, and never freed, so notifies can't outlive it during static destruction
+static SizedFreeListChunker *gPacketNotifyPool = NULL;
+
+void *NetConnection::PacketNotify::operator new(size_t size)
+{
+   if(!gPacketNotifyPool)
+      gPacketNotifyPool = new SizedFreeListChunker(&mPacketPoolStats);
+
+   return gPacketNotifyPool->alloc(size);
+}
+
+void NetConnection::PacketNotify::operator delete(void *ptr, size_t size)
+{
+   if(ptr)
+      gPacketNotifyPool->free(ptr, size);
+}
+
 bool NetConnection::checkTimeout(U32 time)
 {
    if(!mLastPingSendTime)
@@ -676,18 +699,44 @@ void NetConnection::handleNotify(U32 sequence, bool recvd)
 //--------------------------------------------------------------------
 
 void NetConnection::checkPacketSend(bool force, U32 curTime)
+{
+   preparePacketSend(force, curTime);
+   finishPacketSend(curTime);
+}
+
+U32 NetConnection::getPacketSendDelay()
 {
    U32 delay = mCurrentPacketSendPeriod;
 
+   //  This might fix extremely high ping for users with very limited speeds
+   //printf("%i", mLastSendSeq - mHighestAckedSeq);
+   if(mLastSendSeq - mHighestAckedSeq > 5)
+      delay *= (mLastSendSeq - mHighestAckedSeq - 5) * 2;
+
+   return delay;
+}
+
+bool NetConnection::getNextPacketSendTime(U32 &sendTime)
+{
+   // Adaptive connections send as soon as they have data, which is only produced by game ticks
+   // and incoming packets, so they have no deadline of their own
+   if(isAdaptive())
+      return false;
+
+   sendTime = mLastUpdateTime + getPacketSendDelay() - mSendDelayCredit;
+   return true;
+}
+
+void NetConnection::preparePacketSend(bool force, U32 curTime)
+{
+   mPendingSendAction = SendNothing;
+
+   U32 delay = getPacketSendDelay();
+
    if(!force)
    {
       if(!isAdaptive())
       {
-         //  This might fix extremely high ping for users with very limited speeds
-         //printf("%i", mLastSendSeq - mHighestAckedSeq);
-         if(mLastSendSeq - mHighestAckedSeq > 5)
-            delay *= (mLastSendSeq - mHighestAckedSeq - 5) * 2;
-
          if(curTime - mLastUpdateTime + mSendDelayCredit < delay)
             return;
       
@@ -717,11 +766,26 @@ void NetConnection::checkPacketSend(bool force, U32 curTime)
          {         
             mLastSeqRecvdAck = mLastSeqRecvd;
             mLastAckTime = curTime;
-            sendAckPacket();
+            mPendingSendAction = SendAck;
          }
       }
       return;
    }
+   prepareDataPacket();
+   mPendingSendAction = SendData;
+}
+
+void NetConnection::finishPacketSend(U32 curTime)
+{
+   PacketSendAction action = mPendingSendAction;
+   mPendingSendAction = SendNothing;
+
+   if(action == SendAck)
+      sendAckPacket();
+
+   if(action != SendData)
+      return;
+
    PacketStream stream(mCurrentPacketSendSize);
    mLastUpdateTime = curTime;
 
@@ -795,6 +859,10 @@ void NetConnection::prepareWritePacket()
 {
 }
 
+void NetConnection::prepareDataPacket()
+{
+}
+
 void NetConnection::writePacket(BitStream *bstream, PacketNotify *note)
 {
 }
@@ -33,6 +33,7 @@
 #include "tnlNetObject.h"
 #include "tnlClientPuzzle.h"
 #include "tnlCertificate.h"
+#include "tnlThread.h"
 #include <tomcrypt.h>
 
 namespace TNL {
@@ -46,20 +47,30 @@ NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
    NetClassRep::initialize(); // initialize the net class reps, if they haven't been initialized already.
 
    mLastTimeoutCheckTime = 0;
+   mLastProcessTime = 0;
    mAllowConnections = true;
    mRequiresKeyExchange = false;
 
    Random::read(mRandomHashData, sizeof(mRandomHashData));
 
-   mConnectionHashTable.resize(129);
-   for(S32 i = 0; i < mConnectionHashTable.size(); i++)
-      mConnectionHashTable[i] = NULL;
    mSendPacketList = NULL;
+   mPrepareQueue = NULL;
    mCurrentTime = Platform::getRealMilliseconds();
+
+   mQueueingSends = false;
+   mSendQueue.reserve(Socket::MaxBatchSize);
+   mSendQueueData.reserve(Socket::MaxBatchSize * MaxPacketDataSize);
+
+   mRecvBatch.resize(Socket::MaxBatchSize);
+   mRecvBatchData.resize(Socket::MaxBatchSize * MaxPacketDataSize);
+   for(S32 i = 0; i < mRecvBatch.size(); i++)
+      mRecvBatch[i].buffer = mRecvBatchData.address() + i * MaxPacketDataSize;
 }
 
 NetInterface::~NetInterface()
 {
+   setPacketPrepareThreadCount(0);     // Stops the worker threads, if any
+
    // gracefully close all the connections on this NetInterface:
    while(mConnectionList.size())
    {
@@ -104,9 +115,50 @@ void NetInterface::setPrivateKey(AsymmetricKey *theKey)
 
 NetError NetInterface::sendto(const Address &address, BitStream *stream)
 {
+   if(mQueueingSends)
+   {
+      queueSend(address, stream->getBuffer(), stream->getBytePosition());
+      return NoError;
+   }
+
    return mSocket.sendto(address, stream->getBuffer(), stream->getBytePosition());
 }
 
+void NetInterface::queueSend(const Address &address, const U8 *data, U32 size)
+{
+   if(mSendQueue.size() == Socket::MaxBatchSize)
+      flushSends();
+
+   QueuedSend queued;
+   queued.address = address;
+   queued.offset = mSendQueueData.size();
+   queued.size = size;
+   mSendQueue.push_back(queued);
+
+   mSendQueueData.resize(queued.offset + size);
+   memcpy(mSendQueueData.address() + queued.offset, data, size);
+}
+
+void NetInterface::flushSends()
+{
+   if(mSendQueue.size() == 0)
+      return;
+
+   // Data may have moved while the queue was filling, so the pointers are only worked out now
+   Datagram datagrams[Socket::MaxBatchSize];
+   for(S32 i = 0; i < mSendQueue.size(); i++)
+   {
+      datagrams[i].address = mSendQueue[i].address;
+      datagrams[i].buffer = mSendQueueData.address() + mSendQueue[i].offset;
+      datagrams[i].size = mSendQueue[i].size;
+   }
+
+   mSocket.sendBatch(datagrams, mSendQueue.size());
+
+   mSendQueue.clear();
+   mSendQueueData.clear();
+}
+
 void NetInterface::sendtoDelayed(const Address *address, NetConnection *receiveTo, BitStream *stream, U32 millisecondDelay)
 {
    U32 dataSize = stream->getBytePosition();
@@ -152,6 +204,101 @@ U32 NetInterface::computeClientIdentityToken(const Address &address, const Nonce
    return hash[0];
 }
 
+//-----------------------------------------------------------------------------
+// NetInterface connection hash table
+//-----------------------------------------------------------------------------
+
+NetInterface::ConnectionHashTable::ConnectionHashTable()
+{
+   mSlots.resize(128);
+   for(S32 i = 0; i < mSlots.size(); i++)
+      mSlots[i] = NULL;
+   mCount = 0;
+}
+
+U32 NetInterface::ConnectionHashTable::getHomeSlot(const Address &address) const
+{
+   // Address::hash() leaves nearby addresses with nearby hashes, so mix it up before masking off the low bits
+   U32 hash = address.hash();
+   hash ^= hash >> 16;
+   hash *= 0x85ebca6b;
+   hash ^= hash >> 13;
+
+   return hash & (mSlots.size() - 1);
+}
+
+NetConnection *NetInterface::ConnectionHashTable::find(const Address &address) const
+{
+   // Search through the table for an address that matches.  If the connection pointer is NULL, we've found an
+   // empty space and a connection with that address is not in the table
+   for(U32 index = getHomeSlot(address); mSlots[index] != NULL; index = (index + 1) & (mSlots.size() - 1))
+      if(address == mSlots[index]->getNetAddress())
+         return mSlots[index];
+
+   return NULL;
+}
+
+void NetInterface::ConnectionHashTable::insert(NetConnection *conn)
+{
+   if((mCount + 1) * 2 > mSlots.size())
+      grow();
+
+   U32 index = getHomeSlot(conn->getNetAddress());
+   while(mSlots[index] != NULL)
+      index = (index + 1) & (mSlots.size() - 1);
+
+   mSlots[index] = conn;
+   mCount++;
+}
+
+void NetInterface::ConnectionHashTable::remove(NetConnection *conn)
+{
+   U32 mask = mSlots.size() - 1;
+   U32 index = getHomeSlot(conn->getNetAddress());
+
+   while(mSlots[index] != conn)
+   {
+      TNLAssert(mSlots[index] != NULL, "Attempting to remove a connection that is not in the table.");
+      if(mSlots[index] == NULL)
+         return;
+      index = (index + 1) & mask;
+   }
+   mSlots[index] = NULL;
+   mCount--;
+
+   // rehash all subsequent entries until we find a NULL entry:
+   for(index = (index + 1) & mask; mSlots[index] != NULL; index = (index + 1) & mask)
+   {
+      NetConnection *rehashConn = mSlots[index];
+      mSlots[index] = NULL;
+
+      U32 realIndex = getHomeSlot(rehashConn->getNetAddress());
+      while(mSlots[realIndex] != NULL)
+         realIndex = (realIndex + 1) & mask;
+      mSlots[realIndex] = rehashConn;
+   }
+}
+
+void NetInterface::ConnectionHashTable::grow()
+{
+   Vector<NetConnection *> oldSlots = mSlots;
+
+   mSlots.resize(oldSlots.size() * 2);
+   for(S32 i = 0; i < mSlots.size(); i++)
+      mSlots[i] = NULL;
+
+   for(S32 i = 0; i < oldSlots.size(); i++)
+   {
+      if(!oldSlots[i])
+         continue;
+
+      U32 index = getHomeSlot(oldSlots[i]->getNetAddress());
+      while(mSlots[index] != NULL)
+         index = (index + 1) & (mSlots.size() - 1);
+      mSlots[index] = oldSlots[i];
+   }
+}
+
 //-----------------------------------------------------------------------------
 // NetInterface pending connection list management
 //-----------------------------------------------------------------------------
@@ -168,43 +315,47 @@ void NetInterface::addPendingConnection(NetConnection *connection)
 
    // Hang on to the connection and add it to the pending connection list
    connection->incRef();
+   connection->mPendingListIndex = mPendingConnections.size();
    mPendingConnections.push_back(connection);   // (only place where something is added to the mPendingConnections list)
+   mPendingConnectionHashTable.insert(connection);
 }
 
 
-// Search the pending connection list for the specified connection and remove it
+// Remove the specified connection from the pending connection list, if it's there
 void NetInterface::removePendingConnection(NetConnection *connection)
 {
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(mPendingConnections[i] == connection)
-      {
-         connection->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   S32 index = connection->mPendingListIndex;
+   if(index < 0 || index >= mPendingConnections.size() || mPendingConnections[index] != connection)
+      return;
+
+   // Fill the hole with the last one
+   mPendingConnections.erase_fast(index);
+   if(index < mPendingConnections.size())
+      mPendingConnections[index]->mPendingListIndex = index;
+
+   connection->mPendingListIndex = -1;
+   mPendingConnectionHashTable.remove(connection);
+   connection->decRef();
 }
 
 
 NetConnection *NetInterface::findPendingConnection(const Address &address)
 {
-   // Loop through all the pending connections and compare the NetAddresses
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-         return mPendingConnections[i];
-   return NULL;
+   return mPendingConnectionHashTable.find(address);
 }
 
 void NetInterface::findAndRemovePendingConnection(const Address &address)
 {
-   // Search through the list by Address and remove any connection
-   // that matches.
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-      {
-         mPendingConnections[i]->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   NetConnection *connection = mPendingConnectionHashTable.find(address);
+   if(connection)
+      removePendingConnection(connection);
+}
+
+void NetInterface::setPendingConnectionAddress(NetConnection *conn, const Address &address)
+{
+   mPendingConnectionHashTable.remove(conn);
+   conn->setNetAddress(address);
+   mPendingConnectionHashTable.insert(conn);
 }
 
 //-----------------------------------------------------------------------------
@@ -213,108 +364,167 @@ void NetInterface::findAndRemovePendingConnection(const Address &address)
 
 NetConnection *NetInterface::findConnection(const Address &addr)
 {
-   // The connection hash table is a single vector, with hash collisions
-   // resolved to the next open space in the table.
+   return mConnectionHashTable.find(addr);
+}
 
-   // Compute the hash index based on the network address
-   U32 hashIndex = addr.hash() % mConnectionHashTable.size();
+void NetInterface::removeConnection(NetConnection *conn)
+{
+   S32 index = conn->mConnectionListIndex;
+   TNLAssert(index >= 0 && index < mConnectionList.size() && mConnectionList[index] == conn,
+             "Attempting to remove a connection that is not in the list.");
+   if(index < 0 || index >= mConnectionList.size() || mConnectionList[index] != conn)
+      return;
 
-   // Search through the table for an address that matches the source
-   // address.  If the connection pointer is NULL, we've found an
-   // empty space and a connection with that address is not in the table
-   while(mConnectionHashTable[hashIndex] != NULL)
+   // Fill the hole with the last one
+   mConnectionList.erase_fast(index);
+   if(index < mConnectionList.size())
+      mConnectionList[index]->mConnectionListIndex = index;
+
+   conn->mConnectionListIndex = -1;
+   mConnectionHashTable.remove(conn);
+   conn->decRef();
+}
+
+void NetInterface::addConnection(NetConnection *conn)
+{
+   conn->incRef();
+   conn->mConnectionListIndex = mConnectionList.size();
+   mConnectionList.push_back(conn);
+   mConnectionHashTable.insert(conn);
+}
+
+//-----------------------------------------------------------------------------
+// Parallel packet preparation
+//-----------------------------------------------------------------------------
+
+/// Pool of worker threads that run NetConnection::preparePacketSend over a list of connections.
+/// The thread calling prepare() works through the list alongside the pool, and returns once
+/// every connection has been prepared.
+class PacketPrepareQueue
+{
+   class WorkerThread : public Thread
+   {
+      PacketPrepareQueue *mQueue;
+   public:
+      WorkerThread(PacketPrepareQueue *queue) { mQueue = queue; }
+      U32 run();
+   };
+
+   Vector<WorkerThread *> mThreads;
+   Semaphore mStartSemaphore;    ///< Released once per worker at the start of each pass
+   Semaphore mDoneSemaphore;     ///< Incremented by each worker when it runs out of connections
+   Mutex mLock;                  ///< Guards mNextIndex
+   bool mQuit;
+
+   Vector<NetConnection *> *mConnections;
+   U32 mCurrentTime;
+   S32 mNextIndex;
+
+   void prepareConnections();
+
+public:
+   PacketPrepareQueue(U32 threadCount);
+   ~PacketPrepareQueue();
+
+   U32 getThreadCount() { return mThreads.size(); }
+
+   void prepare(Vector<NetConnection *> &connections, U32 currentTime);
+};
+
+U32 PacketPrepareQueue::WorkerThread::run()
+{
+   for(;;)
    {
-      if(addr == mConnectionHashTable[hashIndex]->getNetAddress())
-         return mConnectionHashTable[hashIndex];
-      hashIndex++;
-      if(hashIndex >= (U32) mConnectionHashTable.size())
-         hashIndex = 0;
+      mQueue->mStartSemaphore.wait();
+      if(mQueue->mQuit)
+         break;
+
+      mQueue->prepareConnections();
+      mQueue->mDoneSemaphore.increment();
    }
-   return NULL;
+
+   mQueue->mDoneSemaphore.increment();
+   return 0;
 }
 
-void NetInterface::removeConnection(NetConnection *conn)
+PacketPrepareQueue::PacketPrepareQueue(U32 threadCount)
 {
-   for(S32 i = 0; i < mConnectionList.size(); i++)
+   mQuit = false;
+   mConnections = NULL;
+   mCurrentTime = 0;
+   mNextIndex = 0;
+
+   for(U32 i = 0; i < threadCount; i++)
    {
-      if(mConnectionList[i] == conn)
+      WorkerThread *thread = new WorkerThread(this);
+      if(!thread->start())
       {
-         mConnectionList.erase_fast(i);
+         delete thread;
          break;
       }
+      mThreads.push_back(thread);
    }
-   U32 index = conn->getNetAddress().hash() % mConnectionHashTable.size();
-   U32 startIndex = index;
+}
 
-   while(mConnectionHashTable[index] != conn)
-   {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      TNLAssert(index != startIndex, "Attempting to remove a connection that is not in the table."); // not in the table
-      if(index == startIndex)
-         return;
-   }
-   mConnectionHashTable[index] = NULL;
+PacketPrepareQueue::~PacketPrepareQueue()
+{
+   mQuit = true;
+   mStartSemaphore.increment(mThreads.size());
 
-   // rehash all subsequent entries until we find a NULL entry:
+   // Each worker checks in on its way out, after which it no longer touches this queue
+   for(S32 i = 0; i < mThreads.size(); i++)
+      mDoneSemaphore.wait();
+
+   for(S32 i = 0; i < mThreads.size(); i++)
+      delete mThreads[i];
+}
+
+void PacketPrepareQueue::prepareConnections()
+{
    for(;;)
    {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      if(!mConnectionHashTable[index])
-         break;
-      NetConnection *rehashConn = mConnectionHashTable[index];
-      mConnectionHashTable[index] = NULL;
-      U32 realIndex = rehashConn->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[realIndex] != NULL)
-      {
-         realIndex++;
-         if(realIndex >= (U32) mConnectionHashTable.size())
-            realIndex = 0;
-      }
-      mConnectionHashTable[realIndex] = rehashConn;
+      mLock.lock();
+      S32 index = mNextIndex++;
+      mLock.unlock();
+
+      if(index >= mConnections->size())
+         return;
+
+      (*mConnections)[index]->preparePacketSend(false, mCurrentTime);
    }
-   conn->decRef();
 }
 
-void NetInterface::addConnection(NetConnection *conn)
+void PacketPrepareQueue::prepare(Vector<NetConnection *> &connections, U32 currentTime)
 {
-   conn->incRef();
-   mConnectionList.push_back(conn);
+   mConnections = &connections;
+   mCurrentTime = currentTime;
+   mNextIndex = 0;
 
-   S32 numConnections = mConnectionList.size();
+   mStartSemaphore.increment(mThreads.size());
+   prepareConnections();
 
-   if(numConnections > mConnectionHashTable.size() / 2)
-   {
-      mConnectionHashTable.resize(numConnections * 4 - 1);
-      for(S32 i = 0; i < mConnectionHashTable.size(); i++)
-         mConnectionHashTable[i] = NULL;
+   for(S32 i = 0; i < mThreads.size(); i++)
+      mDoneSemaphore.wait();
 
-      for(S32 i = 0; i < numConnections; i++)
-      {
-         U32 index = mConnectionList[i]->getNetAddress().hash() % mConnectionHashTable.size();
-         while(mConnectionHashTable[index] != NULL)
-         {
-            index++;
-            if(index >= (U32) mConnectionHashTable.size())
-               index = 0;
-         }
-         mConnectionHashTable[index] = mConnectionList[i];
-      }
-   }
-   else
-   {
-      U32 index = mConnectionList[numConnections - 1]->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[index] != NULL)
-      {
-         index++;
-         if(index >= (U32) mConnectionHashTable.size())
-            index = 0;
-      }
-      mConnectionHashTable[index] = mConnectionList[numConnections - 1];
-   }
+   mConnections = NULL;
+}
+
+void NetInterface::setPacketPrepareThreadCount(U32 threadCount)
+{
+#ifdef TNL_NO_THREADS
+   threadCount = 0;     // Thread::start() would run the worker loop inline and never return
+#endif
+
+   if(threadCount == getPacketPrepareThreadCount())
+      return;
+
+   delete mPrepareQueue;
+   mPrepareQueue = threadCount ? new PacketPrepareQueue(threadCount) : NULL;
+}
+
+U32 NetInterface::getPacketPrepareThreadCount()
+{
+   return mPrepareQueue ? mPrepareQueue->getThreadCount() : 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -324,8 +534,12 @@ void NetInterface::addConnection(NetConnection *conn)
 void NetInterface::processConnections()
 {
    mCurrentTime = Platform::getRealMilliseconds();
+   mLastProcessTime = mCurrentTime;
    mPuzzleManager.tick(mCurrentTime);
 
+   // Everything sent from here until the connections are done goes out in batches
+   mQueueingSends = true;
+
    // first see if there are any delayed packets that need to be sent...
    while(mSendPacketList && S32(mSendPacketList->sendTime - getCurrentTime()) < 0)
    {
@@ -343,7 +557,7 @@ void NetInterface::processConnections()
       }
       else
       {
-         mSocket.sendto(mSendPacketList->remoteAddress,
+         queueSend(mSendPacketList->remoteAddress,
             mSendPacketList->packetData, mSendPacketList->packetSize);
       }
       mSendPacketList->~DelaySendPacket(); // properly free stuff like SafePtr
@@ -352,8 +566,30 @@ void NetInterface::processConnections()
    }
 
    NetObject::collapseDirtyList(); // collapse all the mask bits...
-   for(S32 i = 0; i < mConnectionList.size(); i++)
-      mConnectionList[i]->checkPacketSend(false, getCurrentTime());
+
+   // Nothing changes object state while packets are being written, so connections sending
+   // the same update for an object can share a single packUpdate call
+   NetObject::beginPackUpdateSharing();
+
+   if(mPrepareQueue && mConnectionList.size() > 1)
+   {
+      // Scope queries and ghost priorities are computed on the worker pool; writing and
+      // sending the packets stays on this thread, in connection order
+      mPrepareQueue->prepare(mConnectionList, getCurrentTime());
+      for(S32 i = 0; i < mConnectionList.size(); i++)
+         mConnectionList[i]->finishPacketSend(getCurrentTime());
+   }
+   else
+   {
+      for(S32 i = 0; i < mConnectionList.size(); i++)
+         mConnectionList[i]->checkPacketSend(false, getCurrentTime());
+   }
+
+   NetObject::endPackUpdateSharing();
+
+   // Send them before anything below gets disconnected, so the packets still go out ahead of the disconnect notices
+   flushSends();
+   mQueueingSends = false;
 
    if(U32(getCurrentTime() - mLastTimeoutCheckTime) > TimeoutCheckInterval)
    {
@@ -411,6 +647,7 @@ void NetInterface::processConnections()
             pending->setConnectionState(NetConnection::ConnectTimedOut);
             pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
             removePendingConnection(pending);
+            continue;
          }
          i++;
       }
@@ -440,21 +677,60 @@ void NetInterface::processConnections()
    }
 }
 
+// Milliseconds from now until time, or 0 if it has already passed
+static U32 getTimeUntil(U32 time, U32 now)
+{
+   return S32(time - now) > 0 ? time - now : 0;
+}
+
+U32 NetInterface::getTimeToNextProcess(U32 maxWait)
+{
+   U32 now = Platform::getRealMilliseconds();
+   U32 wait = maxWait;
+
+   if(mSendPacketList)     // Sorted by send time
+      wait = getMin(wait, getTimeUntil(mSendPacketList->sendTime, now));
+
+   for(S32 i = 0; i < mConnectionList.size(); i++)
+   {
+      U32 sendTime;
+      if(mConnectionList[i]->getNextPacketSendTime(sendTime) && S32(sendTime - mLastProcessTime) > 0)
+         wait = getMin(wait, getTimeUntil(sendTime, now));
+   }
+
+   wait = getMin(wait, getTimeUntil(mLastTimeoutCheckTime + TimeoutCheckInterval + 1, now));
+
+   // Puzzle solutions are computed a slice at a time, so keep coming back while one is underway
+   for(S32 i = 0; i < mPendingConnections.size(); i++)
+      if(mPendingConnections[i]->getConnectionState() == NetConnection::ComputingPuzzleSolution)
+         return 0;
+
+   return wait;
+}
+
 //-----------------------------------------------------------------------------
 // NetInterface incoming packet dispatch
 //-----------------------------------------------------------------------------
 
 void NetInterface::checkIncomingPackets()
 {
-   PacketStream stream;
-   NetError error;
-   Address sourceAddress;
-
    mCurrentTime = Platform::getRealMilliseconds();
 
-   // read out all the available packets:
-   while((error = stream.recvfrom(mSocket, &sourceAddress)) == NoError)
-      processPacket(sourceAddress, &stream);
+   // read out all the available packets, a batch at a time:
+   S32 count;
+   do
+   {
+      count = mSocket.recvBatch(mRecvBatch.address(), mRecvBatch.size(), MaxPacketDataSize);
+
+      for(S32 i = 0; i < count; i++)
+      {
+         BitStream stream(mRecvBatch[i].buffer, mRecvBatch[i].size);
+         stream.setMaxSizes(mRecvBatch[i].size, 0);
+         stream.reset();
+
+         processPacket(mRecvBatch[i].address, &stream);
+      }
+   } while(count == mRecvBatch.size());
 }
 
 void NetInterface::processPacket(const Address &sourceAddress, BitStream *pStream)
@@ -1142,7 +1418,7 @@ void NetInterface::handlePunch(const Address &theAddress, BitStream *stream)
    if(i == mPendingConnections.size())
       return;
 
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    logprintf(LogConsumer::LogNetInterface, "Punch from %s matched nonces - connecting...", theAddress.toString());
 
    conn->setConnectionState(NetConnection::AwaitingConnectResponse);
@@ -1277,7 +1553,7 @@ void NetInterface::handleArrangedConnectRequest(const Address &theAddress, BitSt
    if(oldConnection)
       disconnect(oldConnection, NetConnection::ReasonSelfDisconnect, "");
 
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    conn->setInitialRecvSequence(connectSequence);
    if(theParams.mUsingCrypto)
       conn->setSymmetricCipher(new SymmetricCipher(theParams.mSymmetricKey, theParams.mInitVector));
@@ -34,6 +34,8 @@ namespace TNL {
 GhostConnection *NetObject::mRPCSourceConnection = NULL;
 GhostConnection *NetObject::mRPCDestConnection = NULL;
 bool NetObject::mIsInitialUpdate = false;
+U32 NetObject::mPackCacheEpoch = 0;
+U32 NetObject::mLastPackCacheEpoch = 0;
 
 NetObject::NetObject()
 {
@@ -158,6 +160,20 @@ void NetObject::collapseDirtyList()
    }
 }
 
+void NetObject::beginPackUpdateSharing()
+{
+   mLastPackCacheEpoch++;
+   if(mLastPackCacheEpoch == 0)     // 0 means sharing is off
+      mLastPackCacheEpoch++;
+
+   mPackCacheEpoch = mLastPackCacheEpoch;
+}
+
+void NetObject::endPackUpdateSharing()
+{
+   mPackCacheEpoch = 0;
+}
+
 bool NetObject::onGhostAdd(GhostConnection *theConnection)
 {
    return true;
@@ -219,6 +235,15 @@ void NetObject::postRPCEvent(NetObjectRPCEvent *theEvent)
    }
    else
    {
+      // Going to more than one connection?  Then pack the arguments just once.
+      S32 targets = 0;
+      for(GhostInfo *walk = mFirstObjectRef; walk && targets < 2; walk = walk->nextObjectRef)
+         if(!(walk->flags & GhostInfo::NotAvailable))
+            targets++;
+
+      if(targets > 1)
+         theEvent->setBroadcast();
+
       for(GhostInfo *walk = mFirstObjectRef; walk; walk = walk->nextObjectRef)
       {
          if(!(walk->flags & GhostInfo::NotAvailable))
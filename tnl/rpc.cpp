@@ -30,17 +30,112 @@
 #include "tnlNetEvent.h"
 #include "tnlRPC.h"
 #include "tnlEventConnection.h"
+#include "tnlDataChunker.h"
+#include "tnlThread.h"
 
 namespace TNL {
 
 RPCEvent::RPCEvent(RPCGuaranteeType gType, RPCDirection dir) :
       NetEvent((NetEvent::GuaranteeType) gType, (NetEvent::EventDirection) dir)
 {
+   mBroadcastState = NotBroadcast;
+   mPackedArgsBitCount = 0;
+   mPackedArgsHaveStrings = false;
+}
+
+// RPCs can be called from any thread, so the pool is locked.  Both are created on first use, and
+// never freed, so events can't outlive them during static destruction.
+static SizedFreeListChunker *gRPCEventPool = NULL;
+static Mutex *gRPCEventPoolLock = NULL;
+static ChunkerStats gRPCEventPoolStats;
+
+void *RPCEvent::operator new(size_t size)
+{
+   if(!gRPCEventPool)
+   {
+      gRPCEventPoolLock = new Mutex;
+      gRPCEventPool = new SizedFreeListChunker(&gRPCEventPoolStats);
+   }
+
+   gRPCEventPoolLock->lock();
+   void *ret = gRPCEventPool->alloc(size);
+   gRPCEventPoolLock->unlock();
+
+   return ret;
+}
+
+void RPCEvent::operator delete(void *ptr, size_t size)
+{
+   if(!ptr)
+      return;
+
+   gRPCEventPoolLock->lock();
+   gRPCEventPool->free(ptr, size);
+   gRPCEventPoolLock->unlock();
+}
+
+ChunkerStats RPCEvent::getPoolStats()
+{
+   if(!gRPCEventPoolLock)
+      return gRPCEventPoolStats;
+
+   gRPCEventPoolLock->lock();
+   ChunkerStats stats = gRPCEventPoolStats;
+   gRPCEventPoolLock->unlock();
+
+   return stats;
+}
+
+void RPCEvent::setBroadcast()
+{
+   TNLAssert(mBroadcastState == NotBroadcast, "Event is already a broadcast");
+   mBroadcastState = BroadcastUnpacked;
+}
+
+NetEvent *RPCEvent::makeBroadcast(NetEvent *theEvent)
+{
+   static_cast<RPCEvent *>(theEvent)->setBroadcast();
+   return theEvent;
+}
+
+// Pack the arguments into a stream of their own.  Strings are written against an empty string buffer,
+// so the first is never compressed against whatever precedes it in a real packet, and the receiver
+// decodes them the same way no matter what it last read.
+void RPCEvent::packBroadcastArgs()
+{
+   BitStream stream;
+   mFunctor->write(stream);
+
+   if(stream.getStringTableEntryWriteCount() != 0 || !stream.isValid())
+   {
+      mBroadcastState = BroadcastPerConnection;
+      return;
+   }
+
+   mPackedArgsBitCount = stream.getBitPosition();
+   mPackedArgsHaveStrings = stream.getStringWriteCount() != 0;
+   mPackedArgs = new ByteBuffer(stream.getBuffer(), stream.getBytePosition());
+   mPackedArgs->takeOwnership();
+   mBroadcastState = BroadcastPacked;
 }
 
 void RPCEvent::pack(EventConnection *ps, BitStream *bstream)
 {
-   mFunctor->write(*bstream);
+   if(mBroadcastState == BroadcastUnpacked)
+      packBroadcastArgs();
+
+   if(mBroadcastState != BroadcastPacked)
+   {
+      mFunctor->write(*bstream);
+      return;
+   }
+
+   bstream->writeBits(mPackedArgsBitCount, mPackedArgs->getBuffer());
+
+   // The receiver's string buffer now holds the last string in our arguments, which this stream
+   // never saw; an empty buffer makes the next string written go out uncompressed
+   if(mPackedArgsHaveStrings)
+      bstream->clearStringBuffer();
 }
 
 void RPCEvent::unpack(EventConnection *ps, BitStream *bstream)
@@ -79,9 +79,32 @@ protected:
    ConnectionStringTable *mStringTable; ///< String table used to compress StringTableEntries over the network.
    /// String buffer holds the last string written into the stream for substring compression.
    char mStringBuffer[256];
+   U32  mStringWriteCount;    ///< Number of strings and string table entries written since the last reset.
+   U32  mStringTableEntryWriteCount;   ///< Number of string table entries written since the last reset.
 
    bool resizeBits(U32 numBitsNeeded);
+
+   /// @name Word-at-a-time access
+   ///
+   /// When the eight bytes starting at the current byte are all inside the readable (or writable) part of the
+   /// buffer, a field can be pulled out of (or merged into) one little-endian 64-bit load and store instead of
+   /// being shifted in a byte at a time.  Up to 7 of those bits are taken up by the offset into the first byte,
+   /// leaving room for fields of up to MaxWordBits.  Bits around the field are left as they were, just as
+   /// with writeBits().
+   ///
+   /// @{
+   static U64 loadWord(const U8 *ptr);
+   static void storeWord(U8 *ptr, U64 word);
+
+   bool canWriteWord() const;
+   void writeWord(U64 value, U32 bitCount);  ///< Only when canWriteWord() and bitCount <= MaxWordBits
+   U64  readWord(U32 bitCount);              ///< Only when canReadWord() and bitCount <= MaxWordBits
+   /// @}
+
 public:
+   enum {
+      MaxWordBits = 57,       ///< Bits guaranteed to be returned by peekWord()
+   };
 
    /// @name Constructors
    ///
@@ -113,6 +136,14 @@ public:
    /// clears the string compression buffer.
    void clearStringBuffer() { mStringBuffer[0] = 0; }
 
+   /// Returns the number of strings and string table entries written since the last reset.  Their
+   /// encoding depends on what was written before them, in this stream or on this connection.
+   U32 getStringWriteCount() const { return mStringWriteCount; }
+
+   /// Returns the number of string table entries written since the last reset.  Unlike plain strings,
+   /// these can't be moved between streams, as the receiver reads them through its string table.
+   U32 getStringTableEntryWriteCount() const { return mStringTableEntryWriteCount; }
+
    /// sets the ConnectionStringTable for compressing string table entries across the network
    void setStringTable(ConnectionStringTable *table) { mStringTable = table; }
 
@@ -139,6 +170,13 @@ public:
    /// Returns the number of bits that can be written into the BitStream without resizing
    U32 getBitSpaceAvailable() const { return maxWriteBitNum - bitNum; }
 
+   /// Returns true if the next MaxWordBits bits can be read in one go.
+   bool canReadWord() const;
+
+   /// Puts the next MaxWordBits (or more) bits in bits, first bit lowest, without moving the read position.
+   /// Returns false, leaving bits alone, when that many aren't available; see canReadWord().
+   bool peekWord(U64 &bits) const;
+
    /// Pads the bits up to the next byte boundary with 0's.
    void zeroToByteBoundary();
 
@@ -341,6 +379,106 @@ inline bool BitStream::read(const U32 in_numBytes,  void* out_pBuffer)
    return readBits(in_numBytes << 3, out_pBuffer);
 }
 
+inline U64 BitStream::loadWord(const U8 *ptr)
+{
+   U64 word;
+   memcpy(&word, ptr, sizeof(word));
+   return convertLEndianToHost(word);
+}
+
+inline void BitStream::storeWord(U8 *ptr, U64 word)
+{
+   word = convertHostToLEndian(word);
+   memcpy(ptr, &word, sizeof(word));
+}
+
+inline bool BitStream::canWriteWord() const
+{
+   return (bitNum >> 3) + sizeof(U64) <= (maxWriteBitNum >> 3);
+}
+
+inline bool BitStream::canReadWord() const
+{
+   return (bitNum >> 3) + sizeof(U64) <= (maxReadBitNum >> 3);
+}
+
+inline void BitStream::writeWord(U64 value, U32 bitCount)
+{
+   TNLAssert(canWriteWord() && bitCount <= MaxWordBits, "Word write out of range");
+
+   U8 *ptr = getBuffer() + (bitNum >> 3);
+   U32 shift = bitNum & 0x7;
+   U64 mask = ((U64(1) << bitCount) - 1) << shift;
+
+   storeWord(ptr, (loadWord(ptr) & ~mask) | ((value << shift) & mask));
+   bitNum += bitCount;
+}
+
+inline U64 BitStream::readWord(U32 bitCount)
+{
+   TNLAssert(canReadWord() && bitCount <= MaxWordBits, "Word read out of range");
+
+   U64 value = loadWord(getBuffer() + (bitNum >> 3)) >> (bitNum & 0x7);
+   bitNum += bitCount;
+
+   return value & ((U64(1) << bitCount) - 1);
+}
+
+inline bool BitStream::peekWord(U64 &bits) const
+{
+   if(!canReadWord())
+      return false;
+
+   bits = loadWord(getBuffer() + (bitNum >> 3)) >> (bitNum & 0x7);
+   return true;
+}
+
+inline void BitStream::writeInt(U32 val, U8 bitCount)
+{
+   TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use writeInt64");
+
+   if(canWriteWord())
+      writeWord(val, bitCount);
+   else
+   {
+      val = convertHostToLEndian(val);
+      writeBits(bitCount, &val);
+   }
+}
+
+inline U32 BitStream::readInt(U8 bitCount)
+{
+   TNLAssert(bitCount <= 32, "bitCount must be less then 32, for 64 bit, use readInt64");
+
+   if(canReadWord())
+      return U32(readWord(bitCount));
+
+   U32 ret = 0;
+   readBits(bitCount, &ret);
+   ret = convertLEndianToHost(ret);
+
+   // Clear bits that we didn't read.
+   if(bitCount == 32)
+      return ret;
+   else
+      ret &= (1 << bitCount) - 1;
+
+   return ret;
+}
+
+inline bool BitStream::writeFlag(bool val)
+{
+   if(bitNum + 1 > maxWriteBitNum)
+      if(!resizeBits(1))
+         return false;
+   if(val)
+      *(getBuffer() + (bitNum >> 3)) |= (1 << (bitNum & 0x7));
+   else
+      *(getBuffer() + (bitNum >> 3)) &= ~(1 << (bitNum & 0x7));
+   bitNum++;
+   return (val);
+}
+
 inline bool BitStream::readFlag()
 {
    if(bitNum > maxReadBitNum)
@@ -88,6 +88,18 @@ class DataChunker
 
 //----------------------------------------------------------------------------
 
+/// Allocation counts kept by a ClassChunker or FreeListChunker, for profiling.  Several chunkers
+/// can report into the same ChunkerStats.
+struct ChunkerStats
+{
+   U32 allocCount;   ///< Elements handed out by the chunker -- each one a heap allocation avoided
+   U32 reuseCount;   ///< Elements handed out from the free list, rather than from fresh chunker memory
+
+   ChunkerStats() { allocCount = 0; reuseCount = 0; }
+};
+
+//----------------------------------------------------------------------------
+
 /// Templatized data chunker class with proper construction and destruction of its elements.
 ///
 /// DataChunker just allocates space. This subclass actually constructs/destructs the
@@ -98,17 +110,25 @@ class ClassChunker: private DataChunker
    S32 numAllocated; ///< number of elements currently allocated through this ClassChunker
    S32 elementSize;  ///< the size of each element, or the size of a pointer, whichever is greater
    T *freeListHead;  ///< a pointer to a linked list of freed elements for reuse
+   ChunkerStats *mStats; ///< where to count allocations, or NULL
 public:
-   ClassChunker(S32 size = DataChunker::ChunkSize) : DataChunker(size)
+   ClassChunker(S32 size = DataChunker::ChunkSize, ChunkerStats *stats = NULL) : DataChunker(size)
    {
       numAllocated = 0;
       elementSize = getMax(U32(sizeof(T)), U32(sizeof(T *)));
       freeListHead = NULL;
+      mStats = stats;
    }
    /// Allocates and properly constructs in place a new element.
    T *alloc()
    {
       numAllocated++;
+      if(mStats)
+      {
+         mStats->allocCount++;
+         if(freeListHead)
+            mStats->reuseCount++;
+      }
       if(freeListHead == NULL)
          return constructInPlace(reinterpret_cast<T*>(DataChunker::alloc(elementSize)));
       T* ret = freeListHead;
@@ -131,6 +151,77 @@ public:
    }
 };
 
+//----------------------------------------------------------------------------
+
+/// Hands out fixed size blocks of raw memory, recycling freed ones.
+///
+/// Unlike ClassChunker, this does no construction or destruction, which makes it suitable for
+/// implementing a class's operator new and delete.  Memory is handed out 8-byte aligned as long as
+/// blockSize is a multiple of 8.
+class FreeListChunker: private DataChunker
+{
+   S32 mBlockSize;         ///< the size of each block, or the size of a pointer, whichever is greater
+   void *mFreeListHead;    ///< linked list of freed blocks for reuse
+   ChunkerStats *mStats;   ///< where to count allocations, or NULL
+public:
+   FreeListChunker(S32 blockSize, S32 size = DataChunker::ChunkSize, ChunkerStats *stats = NULL) : DataChunker(size)
+   {
+      mBlockSize = getMax(U32(blockSize), U32(sizeof(void *)));
+      mFreeListHead = NULL;
+      mStats = stats;
+   }
+
+   /// Returns a block of at least the blockSize passed to the constructor.
+   void *alloc()
+   {
+      if(mStats)
+      {
+         mStats->allocCount++;
+         if(mFreeListHead)
+            mStats->reuseCount++;
+      }
+      if(mFreeListHead == NULL)
+         return DataChunker::alloc(mBlockSize);
+      void *ret = mFreeListHead;
+      mFreeListHead = *(reinterpret_cast<void **>(mFreeListHead));
+      return ret;
+   }
+
+   /// Returns a block from alloc() to the free list.
+   void free(void *block)
+   {
+      *(reinterpret_cast<void **>(block)) = mFreeListHead;
+      mFreeListHead = block;
+   }
+};
+
+//----------------------------------------------------------------------------
+
+/// A FreeListChunker for each block size up to MaxBlockSize, in steps of Granularity bytes.
+///
+/// This is meant for a family of small, frequently created classes of differing sizes, such as
+/// the subclasses of a base class that has a virtual destructor: the base class's operator new and
+/// operator delete(void *, size_t) can both pass their size along.  Larger requests go to the heap.
+class SizedFreeListChunker
+{
+public:
+   enum {
+      Granularity = 16,
+      MaxBlockSize = 1024,
+   };
+
+private:
+   FreeListChunker *mChunkers[MaxBlockSize / Granularity];   ///< Created as each size is first needed
+   ChunkerStats *mStats;
+
+public:
+   SizedFreeListChunker(ChunkerStats *stats = NULL);
+   ~SizedFreeListChunker();
+
+   void *alloc(size_t size);              ///< Allocates a block of at least size bytes
+   void free(void *block, size_t size);   ///< Frees a block from alloc(); size must be the size it was allocated with
+};
+
 };
 
 #endif
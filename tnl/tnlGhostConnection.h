@@ -93,6 +93,10 @@ public:
       GhostRef *nextRef;     ///< The next ghost updated in this packet
       GhostRef *updateChain; ///< A pointer to the GhostRef on the least previous packet that
                              ///  updated this ghost, or NULL, if no prior packet updated this ghost
+
+      /// Every object update in every packet gets one of these, so they come from a pool.
+      static void *operator new(size_t size);
+      static void operator delete(void *ptr);
    };
 
    /// Notify structure attached to each packet with information about the ghost updates in the packet
@@ -116,6 +120,9 @@ protected:
    /// Performs the scoping query in order to determine if there is data to send from this GhostConnection.
    void prepareWritePacket();
 
+   /// Detaches out-of-scope ghosts and sorts the remaining ones by update priority.
+   void prepareDataPacket();
+
    /// Override to write ghost updates into each packet.
    void writePacket(BitStream *bstream, PacketNotify *notify);
 
@@ -139,6 +146,26 @@ protected:
    S32 mGhostZeroUpdateIndex; ///< Index in mGhostArray of first ghost with 0 update mask (ie, with no updates).
    S32 mGhostFreeIndex;       ///< index in mGhostArray of first free ghost.
 
+   bool mGhostUpdatesPrioritized;  ///< Set by prioritizeGhostUpdates, cleared when writePacket consumes the ordering.
+   U32  mGhostMaxIndex;            ///< Highest ghost index among the pending updates, used to size ghost ids in the packet.
+
+   S32  mGhostSortedIndex;         ///< Pending updates at or above this index are in send order; those below have lower priority, in no order.
+   S32  mGhostSelectCount;         ///< How many updates to put in order at a time, sized from what recent packets had room for.
+
+   /// Runs the priority functions of all ghosts with pending updates and orders the most important
+   /// ones so they are written first.  Only as many as a packet is likely to hold are ordered.
+   void prioritizeGhostUpdates();
+
+   /// Moves the count highest priority updates among the first end entries of mGhostArray to the
+   /// top of that range, in ascending priority order.
+   void selectGhostUpdates(S32 end, S32 count);
+
+   bool mPackUpdateConnectionSpecific;   ///< Set by markPackUpdateConnectionSpecific during a packUpdate call
+
+   /// Writes an update for obj, copying it from another connection's identical update when pack
+   /// update sharing is on.  fromCache is set if the bits were copied.
+   U32 packObjectUpdate(NetObject *obj, U32 updateMask, BitStream *bstream, bool &fromCache);
+
    bool mGhosting;         ///< Am I currently ghosting objects over?
    bool mScoping;          ///< Am I currently allowing objects to be scoped?
    U32  mGhostingSequence; ///< Sequence number describing this ghosting session.
@@ -194,6 +221,7 @@ public:
       GhostLookupTableSize = (1 << GhostLookupTableSizeShift), ///< Size of the hash table used to lookup source NetObjects by remote ghost ID.
       GhostLookupTableMask = (GhostLookupTableSize - 1),       ///< Hashing mask for table lookups.
 
+      MinGhostSelectCount = 32,                ///< Fewest pending updates put in send order at a time.
    };
 
    void setScopeObject(NetObject *object);                           ///< Sets the object that is queried at each packet to determine
@@ -218,6 +246,11 @@ public:
    /// Returns true if the object is available on the client.
    bool isGhostAvailable(NetObject *object) { return getGhostIndex(object) != -1; }
 
+   /// Called from within NetObject::packUpdate() whenever the encoding consults state
+   /// belonging to this connection, so the result is not shared with other connections
+   /// packing the same object during this tick.
+   void markPackUpdateConnectionSpecific() { mPackUpdateConnectionSpecific = true; }
+
    void resetGhosting();                   ///< Stops ghosting objects from this GhostConnection to the remote host, which causes all ghosts to be destroyed on the client.
    void activateGhosting();                ///< Begins ghosting objects from this GhostConnection to the remote host, starting with the GhostAlways objects.
    bool isGhosting() { return mGhosting; } ///< Returns true if this connection is currently ghosting objects to the remote host.
@@ -209,6 +209,8 @@ protected:
    U32 mPartialUpdateBitsUsed; ///< Number of bits used on partial updates of objects of this class.
    U32 mInitialUpdateCount;    ///< Number of objects of this class constructed over a connection.
    U32 mPartialUpdateCount;    ///< Number of objects of this class updated over a connection.
+   U32 mInitialUpdateCacheHits; ///< Number of initial updates copied from another connection's packUpdate.
+   U32 mPartialUpdateCacheHits; ///< Number of partial updates copied from another connection's packUpdate.
 
    /// Next declared NetClassRep.
    ///
@@ -241,20 +243,31 @@ public:
    S32 getClassVersion() const;                    ///< Returns the version of this class.
    const char *getClassName() const;               ///< Returns the string class name.
 
-   /// Records bits used in the initial update of objects of this class.
-   void addInitialUpdate(U32 bitCount)
+   /// Records bits used in the initial update of objects of this class.  fromCache is set when the
+   /// update was copied from the shared pack cache rather than written by packUpdate.
+   void addInitialUpdate(U32 bitCount, bool fromCache = false)
    {
       mInitialUpdateCount++;
       mInitialUpdateBitsUsed += bitCount;
+      if(fromCache)
+         mInitialUpdateCacheHits++;
    }
 
-   /// Records bits used in a partial update of an object of this class.
-   void addPartialUpdate(U32 bitCount)
+   /// Records bits used in a partial update of an object of this class.  fromCache is set when the
+   /// update was copied from the shared pack cache rather than written by packUpdate.
+   void addPartialUpdate(U32 bitCount, bool fromCache = false)
    {
       mPartialUpdateCount++;
       mPartialUpdateBitsUsed += bitCount;
+      if(fromCache)
+         mPartialUpdateCacheHits++;
    }
 
+   U32 getInitialUpdateCount() const { return mInitialUpdateCount; }
+   U32 getPartialUpdateCount() const { return mPartialUpdateCount; }
+   U32 getInitialUpdateCacheHits() const { return mInitialUpdateCacheHits; }
+   U32 getPartialUpdateCacheHits() const { return mPartialUpdateCacheHits; }
+
    virtual Object *create() const = 0;             ///< Creates an instance of the class this represents.
 
    /// Returns the number of classes registered under classGroup and classType.
@@ -47,6 +47,10 @@
 #include "tnlConnectionStringTable.h"
 #endif
 
+#ifndef _TNL_DATACHUNKER_H_
+#include "tnlDataChunker.h"
+#endif
+
 namespace TNL {
 
 class NetConnection;
@@ -291,6 +295,12 @@ protected:
                                        ///  Any setup work to determine if there isDataToTransmit() should happen in
                                        ///  this function.  prepareWritePacket should _always_ call the Parent:: function.
 
+   virtual void prepareDataPacket();   ///< Called after prepareWritePacket once it is known that a data packet will be written.
+                                       ///
+                                       ///  Work that only depends on this connection's state (ghost prioritization, for instance)
+                                       ///  can be done here rather than in writePacket, so that it can run in parallel across
+                                       ///  connections.  prepareDataPacket should _always_ call the Parent:: function.
+
    virtual void writePacket(BitStream *bstream, PacketNotify *note); ///< Called to write a subclass's packet data into the packet.
                                                                      ///
                                                                      ///  Information about what the instance wrote into the packet can be attached
@@ -309,7 +319,13 @@ protected:
    /// override this so you allocate a subclass of PacketNotify with extra fields.
    virtual PacketNotify *allocNotify() { return new PacketNotify; }
 
+   static ChunkerStats mPacketPoolStats;   ///< Counts for the pools packet notifies, ghost refs and event notes come from
+
 public:
+   /// Returns allocation counts for the pools that the per-packet bookkeeping structures
+   /// (PacketNotifies, GhostRefs and EventNotes) are drawn from.
+   static const ChunkerStats &getPacketPoolStats() { return mPacketPoolStats; }
+
    /// Returns the next send sequence that will be sent by this side.
    U32 getNextSendSequence() { return mLastSendSeq + 1; }
 
@@ -384,6 +400,12 @@ public:
 
       PacketNotify *nextPacket; ///< Pointer to the next packet sent on this connection
       PacketNotify();
+      virtual ~PacketNotify() {}
+
+      /// One of these comes and goes with every packet, so they (and the subclasses connections
+      /// allocate in allocNotify) are drawn from a pool rather than the heap.
+      static void *operator new(size_t size);
+      static void operator delete(void *ptr, size_t size);
    };
 
 //----------------------------------------------------------------
@@ -434,9 +456,13 @@ private:
    bool mLocalRateChanged;       ///< Set to true when the local connection's rate has changed.
    U32 mCurrentPacketSendSize;   ///< Current size of each packet sent to the remote host.
    U32 mCurrentPacketSendPeriod; ///< Millisecond delay between sent packets.
+   U32 getPacketSendDelay();     ///< Current send period, stretched while too many packets are unacked.
 
    Address mNetAddress;       ///< The network address of the host this instance is connected to.
 
+   S32 mConnectionListIndex;  ///< Where this is in its NetInterface's connection list, or -1, so it can be removed without a search
+   S32 mPendingListIndex;     ///< Where this is in its NetInterface's pending connection list, or -1
+
    // timeout management stuff:
    U32 mPingSendCount;    ///< Number of unacknowledged ping packets sent to the remote host
    U32 mLastPingSendTime; ///< Last time a ping packet was sent from this connection
@@ -559,6 +585,27 @@ public:
    /// If force is true and there is space in the window, it will always send a packet.
    void checkPacketSend(bool force, U32 currentTime);
 
+   /// Returns the time at which checkPacketSend will next consider sending a packet.  Returns
+   /// false for adaptive connections, which decide that on every call.
+   bool getNextPacketSendTime(U32 &sendTime);
+
+   /// What preparePacketSend decided this connection should send; consumed by finishPacketSend.
+   enum PacketSendAction {
+      SendNothing,   ///< Not time to send yet, or nothing to send
+      SendAck,       ///< Only an ack packet is due
+      SendData,      ///< A data packet has been prepared and should be written and sent
+   };
+
+   /// First half of checkPacketSend: decides whether a packet is due and prepares its contents.
+   ///
+   /// This only touches the state of this connection (and, through the scope query, reads the
+   /// game state), so NetInterface may run it for several connections at the same time.
+   void preparePacketSend(bool force, U32 currentTime);
+
+   /// Second half of checkPacketSend: writes and sends whatever preparePacketSend decided on.
+   /// Always called from the thread that owns the NetInterface's socket.
+   void finishPacketSend(U32 currentTime);
+
    /// Connection state flags for a NetConnection instance.  If this list is modifed, please check if netInterface.cpp needs updates as well
    enum NetConnectionState {
       NotConnected=0,            ///< Initial state of a NetConnection instance - not connected
@@ -642,6 +689,8 @@ private:
    U32 mLastSeqRecvdAck;
    U32 mLastAckTime;
 
+   PacketSendAction mPendingSendAction;   ///< Set by preparePacketSend, consumed by finishPacketSend
+
    /// @}
 protected:
    ConnectionStringTable *mStringTable; ///< Helper for managing translation between global NetStringTable ids to local ids for this connection.
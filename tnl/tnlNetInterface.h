@@ -48,6 +48,7 @@
 namespace TNL {
 
 class AsymmetricKey;
+class PacketPrepareQueue;
 class Certificate;
 struct ConnectionParameters;
 
@@ -169,11 +170,33 @@ public:
    };
 
 protected:
+   /// Connections keyed by remote address.  This is a flat hash table (no buckets), with collisions going in
+   /// the next open slot.  It doubles in size whenever it gets half full, so lookups stay quick however many
+   /// connections there are.  Several connections can share an address (local connections all have the same,
+   /// empty one); find returns any of them.
+   class ConnectionHashTable
+   {
+      Vector<NetConnection *> mSlots;  ///< Always a power of two in size
+      S32 mCount;                      ///< Number of slots in use
+
+      U32 getHomeSlot(const Address &address) const;
+      void grow();
+
+   public:
+      ConnectionHashTable();     // Constructor
+
+      NetConnection *find(const Address &address) const;
+      void insert(NetConnection *conn);
+      void remove(NetConnection *conn);
+      S32 size() const { return mCount; }
+   };
+
    Vector<NetConnection *> mConnectionList;        /// List of all the connections that are in a connected state on this NetInterface.
-   Vector<NetConnection *> mConnectionHashTable;   /// A resizable hash table for all connected connections.  This is a flat hash table (no buckets).
+   ConnectionHashTable mConnectionHashTable;       /// The same connections, by address.
 
    Vector<NetConnection *> mPendingConnections;    /// List of connections that are in the startup state, where the remote host has not fully
                                                    /// validated the connection.
+   ConnectionHashTable mPendingConnectionHashTable;   /// The same connections, by address.
 
    RefPtr<AsymmetricKey> mPrivateKey;  /// The private key used by this NetInterface for secure key exchange.
    RefPtr<Certificate> mCertificate;   /// A certificate, signed by some Certificate Authority, to authenticate this host.
@@ -193,6 +216,7 @@ protected:
    U32 mCurrentTime;            /// Current time tracked by this NetInterface.
    bool mRequiresKeyExchange;   /// True if all connections outgoing and incoming require key exchange.
    U32  mLastTimeoutCheckTime;  /// Last time all the active connections were checked for timeouts.
+   U32  mLastProcessTime;       /// Time of the last processConnections call.
    U8  mRandomHashData[12];     /// Data that gets hashed with connect challenge requests to prevent connection spoofing.
    bool mAllowConnections;      /// Set if this NetInterface allows connections from remote instances.
 
@@ -211,6 +235,35 @@ protected:
    };
    DelaySendPacket *mSendPacketList; /// List of delayed packets pending to send.
 
+   PacketPrepareQueue *mPrepareQueue; /// Worker pool for preparing connection packets in parallel, or NULL to prepare them serially.
+
+   /// @name Batched packet I/O
+   ///
+   /// While processConnections is sending the tick's packets, sendto copies them into the send queue instead of
+   /// handing them to the socket one by one; they go out together, Socket::MaxBatchSize per system call, when the
+   /// queue fills or the connections are done.  Incoming packets are read a batch at a time in the same way.
+   ///
+   /// @{
+   struct QueuedSend
+   {
+      Address address;   /// Where the packet is going.
+      U32 offset;        /// Where its data starts in mSendQueueData.
+      U32 size;          /// Size, in bytes, of the packet data.
+   };
+   Vector<QueuedSend> mSendQueue;     /// Packets waiting for flushSends.
+   Vector<U8> mSendQueueData;         /// Their data, one after another.
+   bool mQueueingSends;               /// True while sendto is queueing rather than sending.
+
+   Vector<Datagram> mRecvBatch;       /// Where checkIncomingPackets reads each batch into...
+   Vector<U8> mRecvBatchData;         /// ...and the buffers the packets land in.
+
+   /// Adds a packet to the send queue, flushing first if it's full.
+   void queueSend(const Address &address, const U8 *data, U32 size);
+
+   /// Sends everything in the send queue.
+   void flushSends();
+   /// @}
+
    enum NetInterfaceConstants {
       ChallengeRetryCount = 4,     /// Number of times to send connect challenge requests before giving up.
       ChallengeRetryTime = 2500,   /// Timeout interval in milliseconds before retrying connect challenge.
@@ -241,6 +294,9 @@ protected:
    /// Finds a connection by address from the pending list and removes it.
    void findAndRemovePendingConnection(const Address &address);
 
+   /// Changes the address of a pending connection, keeping the pending connection table up to date.
+   void setPendingConnectionAddress(NetConnection *conn, const Address &address);
+
    /// Adds a connection to the internal connection list.
    void addConnection(NetConnection *connection);
 
@@ -351,7 +407,8 @@ public:
    /// Returns the Socket associated with this NetInterface
    Socket &getSocket() { return mSocket; }
 
-   /// Sends a packet to the remote address over this interface's socket.
+   /// Sends a packet to the remote address over this interface's socket.  During processConnections, the
+   /// packet is queued and sent along with the rest of the tick's packets, and this always returns NoError.
    NetError sendto(const Address &address, BitStream *stream);
 
    /// Sends a packet to the remote address after millisecondDelay time has elapsed.
@@ -373,6 +430,26 @@ public:
    /// and pending connections.
    void processConnections();
 
+   /// Returns how many milliseconds can pass before processConnections has something to do,
+   /// capped at maxWait.
+   ///
+   /// This covers delayed packets, fixed rate connections whose next packet is due, and the
+   /// periodic timeout check.  A connection that was already due at the last processConnections
+   /// call but had nothing to send is waiting on new data or acks, so it adds no deadline; those
+   /// arrive with incoming packets or the next game tick.
+   U32 getTimeToNextProcess(U32 maxWait);
+
+   /// Sets the number of worker threads processConnections uses to prepare outgoing packets.
+   ///
+   /// Preparing a packet runs the connection's scope query and ghost prioritization, which
+   /// only read the game state, so it can be spread over several threads.  Packets are still
+   /// written and sent from the calling thread, in connection order.  Zero (the default)
+   /// prepares every connection on the calling thread.  Ignored when TNL_NO_THREADS is set.
+   void setPacketPrepareThreadCount(U32 threadCount);
+
+   /// Returns the number of packet preparation worker threads.
+   U32 getPacketPrepareThreadCount();
+
    /// Returns the list of connections on this NetInterface.
    Vector<NetConnection *> &getConnectionList() { return mConnectionList; }
 
@@ -217,6 +217,24 @@ class NetObject : public Object
    static bool mIsInitialUpdate; ///< Managed by GhostConnection - set to true when this is an initial update
    SafePtr<NetObject> mServerObject; ///< Direct pointer to the parent object on the server if it is a local connection
    GhostConnection *mOwningConnection; ///< The connection that owns this ghost, if it's a ghost
+
+   /// An encoding written by packUpdate that other connections can copy instead of calling
+   /// packUpdate again, while pack update sharing is on (see beginPackUpdateSharing).
+   struct PackCacheEntry
+   {
+      U32 epoch;                 ///< Sharing epoch this entry was written in; entries from older epochs are reused
+      U32 updateMask;
+      U32 classGroup;
+      bool initialUpdate;
+      bool connectionSpecific;   ///< packUpdate depended on the connection, so each connection packs its own
+      U32 retMask;               ///< What packUpdate returned
+      U32 bitCount;
+      Vector<U8> bits;
+   };
+   Vector<PackCacheEntry> mPackCache;
+
+   static U32 mPackCacheEpoch;      ///< Current sharing epoch, or 0 when sharing is off
+   static U32 mLastPackCacheEpoch;  ///< Most recently started sharing epoch
 protected:
    enum NetFlag
    {
@@ -247,6 +265,15 @@ public:
    /// list.
    static void collapseDirtyList();
 
+   /// Turns on sharing of packUpdate output between connections.  Until endPackUpdateSharing()
+   /// is called, a GhostConnection packing an object with the same update mask (and initial-update
+   /// state and class group) as another connection already did will copy those bits rather than
+   /// call packUpdate again.  Object state must not change while sharing is on.
+   static void beginPackUpdateSharing();
+
+   /// Turns off sharing of packUpdate output; anything cached so far is discarded.
+   static void endPackUpdateSharing();
+
    /// Returns the connection from which the current RPC method originated,
    /// or NULL if not currently within the processing of an RPC method call.
    static GhostConnection *getRPCSourceConnection() { return mRPCSourceConnection; }
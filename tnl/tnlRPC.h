@@ -35,6 +35,10 @@
 #include "tnlMethodDispatch.h"
 #endif
 
+#ifndef _TNL_DATACHUNKER_H_
+#include "tnlDataChunker.h"
+#endif
+
 namespace TNL {
 
 /*! @page rpcdesc RPC in the Torque Network Library
@@ -172,6 +176,20 @@ public: \
 /// All declared RPC methods create subclasses of RPCEvent to send data across the wire
 class RPCEvent : public NetEvent
 {
+   /// State of the arguments packed for a broadcast event
+   enum BroadcastState {
+      NotBroadcast,        ///< Arguments are packed separately for each connection
+      BroadcastUnpacked,   ///< Arguments will be packed the first time the event is written
+      BroadcastPacked,     ///< mPackedArgs holds the arguments, ready to copy into any connection's packet
+      BroadcastPerConnection, ///< Arguments include StringTableEntries, so each connection packs its own
+   };
+
+   BroadcastState mBroadcastState;
+   ByteBufferPtr mPackedArgs;       ///< Arguments packed once for every connection this event is posted to
+   U32 mPackedArgsBitCount;         ///< Number of valid bits in mPackedArgs
+   bool mPackedArgsHaveStrings;     ///< True if the packed arguments include strings
+
+   void packBroadcastArgs();
 public:
    Functor *mFunctor;
    /// Constructor call from within the rpc<i>Something</i> method generated by the TNL_IMPLEMENT_RPC macro.
@@ -181,6 +199,22 @@ public:
    virtual bool checkClassType(Object *theObject) = 0;
 
    void process(EventConnection *ps);
+
+   /// Marks this event as one that will be posted to many connections.  Its arguments are then
+   /// packed only once, and the bits copied into each connection's packet.  Must be called before
+   /// the event is first written.
+   void setBroadcast();
+
+   /// Calls setBroadcast() on theEvent, which must be an RPCEvent, and returns it.
+   static NetEvent *makeBroadcast(NetEvent *theEvent);
+
+   /// An event is created for every RPC call and freed once delivered, so the event classes
+   /// generated by the RPC macros are allocated from a pool shared by all of them.
+   static void *operator new(size_t size);
+   static void operator delete(void *ptr, size_t size);
+
+   /// Returns allocation counts for the RPC event pool.
+   static ChunkerStats getPoolStats();
 };
 
 /// Declares an RPC method within a class declaration, which can be used for declaring methods in a superclass that will be implemented in a subclass using TNL_DECLARE_RPC and friends.
@@ -201,6 +235,10 @@ public:
 /// connections, instead of allocating an RPCEvent for each connection.
 #define TNL_RPC_CONSTRUCT_NETEVENT(object, rpcMethod, args) (object)->rpcMethod##_construct args
 
+/// Like TNL_RPC_CONSTRUCT_NETEVENT, but for an event that will be posted to many connections --
+/// its arguments are packed once and shared by all of them.  See RPCEvent::setBroadcast().
+#define TNL_RPC_CONSTRUCT_BROADCAST(object, rpcMethod, args) TNL::RPCEvent::makeBroadcast((object)->rpcMethod##_construct args)
+
 };
 
 #endif
@@ -144,6 +144,14 @@ enum NetError {
    UnknownError,          ///< There was some other, unknown error.
 };
 
+/// One packet in a batch handed to Socket::sendBatch or filled in by Socket::recvBatch.
+struct Datagram
+{
+   Address address;  ///< Where the packet is going to, or where it came from.
+   U8 *buffer;       ///< The packet data.
+   S32 size;         ///< Bytes of packet data in buffer.
+};
+
 /// The Socket class encapsulates a platform's network socket.
 class Socket
 {
@@ -152,6 +160,7 @@ class Socket
 public:
    enum {
       DefaultBufferSize = 32768, ///< The default send and receive buffer sizes
+      MaxBatchSize = 64,         ///< Most packets sendBatch and recvBatch will hand to the OS in one call
    };
 
    /// Opens a socket on the specified address/port
@@ -177,6 +186,15 @@ public:
    /// @param   bytesRead       Specifies the number of bytes which were actually in the packet.
    NetError recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *bytesRead);
 
+   /// Sends a batch of packets, MaxBatchSize at a time, in a single system call where the platform has one
+   /// (sendmmsg on Linux), and one sendto each otherwise.  As with sendto, a packet that can't be sent is
+   /// dropped; the rest still go.  Returns the number of packets sent.
+   S32 sendBatch(const Datagram *datagrams, S32 count);
+
+   /// Reads up to count waiting packets in one go (recvmmsg on Linux), filling in the address and size of
+   /// each.  Each buffer must hold bufferSize bytes.  Returns the number of packets read, 0 if none were waiting.
+   S32 recvBatch(Datagram *datagrams, S32 count, S32 bufferSize);
+
    /// Returns the Address corresponding to this socket, as bound on the local machine.
    Address getBoundAddress();
 
@@ -189,6 +207,11 @@ public:
    virtual NetError send(const U8 *buffer, S32 bufferSize);
 
    bool isWritable(U32 timeout = 0);
+
+   /// Blocks until at least one of the sockets has an incoming packet waiting, or until
+   /// timeoutMillis has passed.  A timeout of 0 just polls.  Returns true if there is
+   /// something to read.
+   static bool waitForRead(Socket *const *sockets, S32 count, U32 timeoutMillis);
 };
 
 //inline void read(BitStream &s, IPAddress *val)
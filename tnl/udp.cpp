@@ -94,6 +94,11 @@ typedef in_addr IN_ADDR;
 
 #define closesocket close
 
+// recvmmsg and sendmmsg move a whole batch of datagrams per system call
+#if defined(TNL_OS_LINUX) && defined(__GLIBC__)
+#define TNL_HAVE_MMSG
+#endif
+
 #else
 
 #endif
@@ -411,6 +416,126 @@ NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *out
    return NoError;
 }
 
+// Journaled packets have to go through sendto and recvfrom one at a time, so each one is recorded or played back
+static bool isJournaling()
+{
+#ifdef TNL_ENABLE_JOURNALING
+   return Journal::getCurrentMode() != Journal::Inactive;
+#else
+   return false;
+#endif
+}
+
+S32 Socket::sendBatch(const Datagram *datagrams, S32 count)
+{
+   S32 sent = 0;
+
+#ifdef TNL_HAVE_MMSG
+   if(!isJournaling())
+   {
+      mmsghdr messages[MaxBatchSize];
+      iovec iovecs[MaxBatchSize];
+      SOCKADDR addresses[MaxBatchSize];
+
+      S32 next = 0;
+      while(next < count)
+      {
+         // Gather up the next batch, skipping any that are for the wrong kind of socket, as sendto would
+         U32 batchCount = 0;
+         for(; next < count && batchCount < MaxBatchSize; next++)
+         {
+            const Datagram &datagram = datagrams[next];
+            if(datagram.address.transport != mTransportProtocol)
+               continue;
+
+            memset(&messages[batchCount], 0, sizeof(messages[batchCount]));
+
+            iovecs[batchCount].iov_base = datagram.buffer;
+            iovecs[batchCount].iov_len = datagram.size;
+
+            socklen_t addressSize;
+            TNLToSocketAddress(datagram.address, &addresses[batchCount], &addressSize);
+
+            messages[batchCount].msg_hdr.msg_name = &addresses[batchCount];
+            messages[batchCount].msg_hdr.msg_namelen = addressSize;
+            messages[batchCount].msg_hdr.msg_iov = &iovecs[batchCount];
+            messages[batchCount].msg_hdr.msg_iovlen = 1;
+
+            batchCount++;
+         }
+
+         // sendmmsg stops at the first packet it can't send; drop that one and carry on with the rest
+         U32 done = 0;
+         while(done < batchCount)
+         {
+            S32 result = ::sendmmsg(mPlatformSocket, messages + done, batchCount - done, 0);
+            if(result <= 0)
+               done++;
+            else
+            {
+               done += result;
+               sent += result;
+            }
+         }
+      }
+
+      return sent;
+   }
+#endif
+
+   for(S32 i = 0; i < count; i++)
+      if(sendto(datagrams[i].address, datagrams[i].buffer, datagrams[i].size) == NoError)
+         sent++;
+
+   return sent;
+}
+
+S32 Socket::recvBatch(Datagram *datagrams, S32 count, S32 bufferSize)
+{
+#ifdef TNL_HAVE_MMSG
+   if(!isJournaling())
+   {
+      mmsghdr messages[MaxBatchSize];
+      iovec iovecs[MaxBatchSize];
+      SOCKADDR addresses[MaxBatchSize];
+
+      U32 batchCount = getMin(count, S32(MaxBatchSize));
+
+      memset(messages, 0, sizeof(mmsghdr) * batchCount);
+      for(U32 i = 0; i < batchCount; i++)
+      {
+         iovecs[i].iov_base = datagrams[i].buffer;
+         iovecs[i].iov_len = bufferSize;
+
+         messages[i].msg_hdr.msg_name = &addresses[i];
+         messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+         messages[i].msg_hdr.msg_iov = &iovecs[i];
+         messages[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      // On a blocking socket, wait for the first packet only, like recvfrom
+      S32 received = ::recvmmsg(mPlatformSocket, messages, batchCount, MSG_WAITFORONE, NULL);
+      if(received <= 0)
+         return 0;
+
+      for(S32 i = 0; i < received; i++)
+      {
+         SocketToTNLAddress(&addresses[i], &datagrams[i].address);
+         datagrams[i].size = messages[i].msg_len;
+      }
+
+      return received;
+   }
+#endif
+
+   S32 received = 0;
+   while(received < count &&
+         recvfrom(&datagrams[received].address, datagrams[received].buffer, bufferSize, &datagrams[received].size) == NoError)
+      received++;
+
+   return received;
+}
+
 NetError Socket::connect(const Address &theAddress)
 {
    SOCKADDR destAddress;
@@ -482,6 +607,37 @@ bool Socket::isWritable(U32 timeoutMillis)
    return FD_ISSET(mPlatformSocket, &fds);
 }
 
+bool Socket::waitForRead(Socket *const *sockets, S32 count, U32 timeoutMillis)
+{
+   fd_set fds;
+   FD_ZERO(&fds);
+
+   S32 maxSocket = -1;
+   for(S32 i = 0; i < count; i++)
+   {
+      if(!sockets[i]->isValid())
+         continue;
+
+      FD_SET(sockets[i]->mPlatformSocket, &fds);
+      maxSocket = getMax(maxSocket, sockets[i]->mPlatformSocket);
+   }
+
+   // select() with an empty set is an error on Windows, so just wait out the timeout
+   if(maxSocket == -1)
+   {
+      Platform::sleep(timeoutMillis);
+      return false;
+   }
+
+   timeval timeoutval;
+   timeoutval.tv_sec = timeoutMillis / 1000;
+   timeoutval.tv_usec = (timeoutMillis % 1000) * 1000;
+
+   // Unlike isWritable, a zero timeout polls rather than blocking indefinitely,
+   // and SOCKET_ERROR is negative, so this is false on failure as well
+   return ::select(maxSocket + 1, &fds, 0, 0, &timeoutval) > 0;
+}
+
 #if defined ( TNL_OS_WIN32 )
 void Socket::getInterfaceAddresses(Vector<Address> *addressVector)
 {
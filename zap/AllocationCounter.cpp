@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "AllocationCounter.h"
+
+#ifdef TNL_DEBUG
+#  include <atomic>
+#  include <cstdlib>
+#  include <new>
+
+static std::atomic<U32> allocationCount(0);
+
+
+// Replacements for the global operators; the standard library's nothrow versions call through to these
+void *operator new(size_t size)
+{
+   allocationCount++;
+
+   void *mem = malloc(size > 0 ? size : 1);
+   if(!mem)
+      throw std::bad_alloc();
+
+   return mem;
+}
+
+
+void *operator new[](size_t size)
+{
+   return operator new(size);
+}
+
+
+void operator delete(void *mem) noexcept
+{
+   free(mem);
+}
+
+
+void operator delete[](void *mem) noexcept
+{
+   free(mem);
+}
+#endif
+
+
+namespace Zap
+{
+
+bool isAllocationCountEnabled()
+{
+#ifdef TNL_DEBUG
+   return true;
+#else
+   return false;
+#endif
+}
+
+
+U32 getAllocationCount()
+{
+#ifdef TNL_DEBUG
+   return allocationCount;
+#else
+   return 0;
+#endif
+}
+
+
+} /* namespace Zap */
@@ -0,0 +1,24 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _ALLOCATION_COUNTER_H_
+#define _ALLOCATION_COUNTER_H_
+
+#include "tnlTypes.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Counts trips through the global operator new, so we can check that code that's supposed to leave the heap alone
+// really does.  Only debug builds count anything; release builds keep the standard operator new, and
+// getAllocationCount() stays at 0.
+bool isAllocationCountEnabled();
+U32 getAllocationCount();        // Allocations made by all threads since startup
+
+
+} /* namespace Zap */
+#endif /* _ALLOCATION_COUNTER_H_ */
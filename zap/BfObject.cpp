@@ -222,6 +222,18 @@ bool isZoneType(U8 x)      // Zones a ship could be in
 }
 
 
+// Things that don't move once a level has been loaded
+bool isStaticGeometryType(U8 x)
+{
+   return
+         isWallType(x)                 || isZoneType(x)            ||
+         x == TeleporterTypeNumber     || x == SpeedZoneTypeNumber || x == TurretTypeNumber              ||
+         x == ShipSpawnTypeNumber      || x == FlagSpawnTypeNumber || x == ForceFieldProjectorTypeNumber ||
+         x == AsteroidSpawnTypeNumber  || x == LineTypeNumber      || x == TextItemTypeNumber            ||
+         x == BotNavMeshZoneTypeNumber;
+}
+
+
 bool isSeekerTarget(U8 x)
 {
    return isShipType(x);
@@ -967,7 +979,7 @@ S32 BfObject::radiusDamage(Point pos, S32 innerRad, S32 outerRad, TestFunc objec
    Rect queryRect(pos, pos);
    queryRect.expand(Point(outerRad, outerRad));
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    findObjects(objectTypeTest, fillVector, queryRect);
 
    // No damage calculated on the client
@@ -111,6 +111,7 @@ bool isFlagOrShipCollideableType(U8 x);
 bool isVisibleOnCmdrsMapType(U8 x);
 bool isVisibleOnCmdrsMapWithSensorType(U8 x);
 bool isZoneType(U8 x);
+bool isStaticGeometryType(U8 x);
 bool isSeekerTarget(U8 x);
 bool isMountableItemType(U8 x);
 
@@ -12,6 +12,8 @@
 #include "EngineeredItem.h"         // For Turret and ForceFieldProjector methods in generating zones
 #include "GeomUtils.h"
 #include "MathUtils.h"
+#include "md5wrapper.h"
+#include "stringUtils.h"
 
 #include "tnlLog.h"
 
@@ -19,6 +21,7 @@
 #include <clipper.hpp>
 
 #include <vector>
+#include <queue>
 #include <math.h>
 
 
@@ -130,10 +133,10 @@ struct rcEdge
 
 
 // Build connections between zones using the adjacency data created in recast
-bool BotNavMeshZone::buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotNavMeshZone *> *allZones, 
+bool BotNavMeshZone::buildBotNavMeshZoneConnectionsRecastStyle(Vector<Vector<NeighboringZone> > &zoneNeighbors, 
                                                                rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap)
 {
-   if(allZones->size() == 0)      // Nothing to do!
+   if(zoneNeighbors.size() == 0)      // Nothing to do!
       return true;
 
    // We'll reuse these objects throughout the following block, saving the cost of creating and destructing them
@@ -246,10 +249,10 @@ bool BotNavMeshZone::buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotN
          neighbor.borderCenter.set((neighbor.borderStart + neighbor.borderEnd) * 0.5);
 
          neighbor.zoneID = polyToZoneMap[e.poly[1]];  
-         allZones->get(polyToZoneMap[e.poly[0]])->mNeighbors.push_back(neighbor);  // (copies neighbor implicitly)
+         zoneNeighbors[polyToZoneMap[e.poly[0]]].push_back(neighbor);  // (copies neighbor implicitly)
 
          neighbor.zoneID = polyToZoneMap[e.poly[0]];   
-         allZones->get(polyToZoneMap[e.poly[1]])->mNeighbors.push_back(neighbor);
+         zoneNeighbors[polyToZoneMap[e.poly[1]]].push_back(neighbor);
       }
    }
    
@@ -260,13 +263,11 @@ bool BotNavMeshZone::buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotN
 }
 
 
-static Vector<DatabaseObject *> zones;
-
 // Returns index of zone containing specified point
 static BotNavMeshZone *findZoneTouchingCircle(const GridDatabase *botZoneDatabase, const Point &centerPoint, F32 radius)
 {
    Rect rect(centerPoint, radius);
-   zones.clear();
+   Vector<DatabaseObject *> zones;
    botZoneDatabase->findObjects(BotNavMeshZoneTypeNumber, zones, rect);
 
    const Vector<Point> *poly;
@@ -290,14 +291,11 @@ static BotNavMeshZone *findZoneTouchingCircle(const GridDatabase *botZoneDatabas
 #  define LOG_TIMER
 #endif
 
-static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
-                                const Vector<DatabaseObject *> &turrets,
-                                const Vector<DatabaseObject *> &forceFieldProjectors, 
-                                F32 bufferRadius,   PolyTree &solution)
+static void collectBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
+                                  const Vector<DatabaseObject *> &turrets,
+                                  const Vector<DatabaseObject *> &forceFieldProjectors, 
+                                  F32 bufferRadius, Vector<Vector<Point> > &inputPolygons)
 {
-
-   Vector<Vector<Point> > inputPolygons;
-
    // Add barriers (PolyWalls are Barriers on the server)
    for(S32 i = 0; i < barriers.size(); i++)
    {
@@ -352,8 +350,6 @@ static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
          inputPolygons[i][j].x = (F32)floor(inputPolygons[i][j].x);
          inputPolygons[i][j].y = (F32)floor(inputPolygons[i][j].y);
       }
-
-   return mergePolysToPolyTree(inputPolygons, solution);
 }
 
 
@@ -411,60 +407,310 @@ static void linkTeleportersBotNavMeshZoneConnections(const GridDatabase *botZone
 }
 
 
-// Server only
-// Use the Triangle library to create zones.  Aggregate triangles with Recast
-bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
-                                       const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
-                                       const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
-                                       const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones)
+const U32 BotZoneGeometry::CacheVersion = 2;
+
+static const char BotZoneCacheMagic[] = { 'B', 'F', 'Z', 'C' };
+
+
+BotZoneGeometry::BotZoneGeometry()
 {
-#ifdef LOG_TIMER
-   U32 starttime = Platform::getRealMilliseconds();
-#endif
+   recastPassed = false;
+}
+
+
+// Cache files are only read on the machine that wrote them, so we can write things out in native byte order
+template <class T>
+static void appendRaw(string &buffer, const T &value)
+{
+   buffer.append((const char *)&value, sizeof(T));
+}
+
+
+static void appendPoint(string &buffer, const Point &point)
+{
+   appendRaw(buffer, point.x);
+   appendRaw(buffer, point.y);
+}
 
-   Rect bounds(worldExtents);      // Modifiable copy
-   allZones->deleteAndClear();
 
-   bounds.expandToInt(Point(LevelZoneBuffer, LevelZoneBuffer));      // Provide a little breathing room
+// Reads from a cache file's contents, refusing to read past the end
+class CacheReader
+{
+private:
+   const string &mBuffer;
+   U32 mPos;
+   bool mOk;
+
+public:
+   explicit CacheReader(const string &buffer) : mBuffer(buffer), mPos(0), mOk(true) { }
+
+   template <class T>
+   T read()
+   {
+      T value = T();
+
+      if(mPos + sizeof(T) > mBuffer.size())
+         mOk = false;
+      else
+      {
+         memcpy(&value, mBuffer.data() + mPos, sizeof(T));
+         mPos += sizeof(T);
+      }
+
+      return value;
+   }
+
+   Point readPoint()
+   {
+      F32 x = read<F32>();
+      F32 y = read<F32>();
+      return Point(x, y);
+   }
+
+   string readString(U32 size)
+   {
+      if(mPos + size > mBuffer.size())
+      {
+         mOk = false;
+         return "";
+      }
+
+      mPos += size;
+      return mBuffer.substr(mPos - size, size);
+   }
+
+   // A count of things, each at least minSize bytes -- a bogus count makes the reader fail instead of allocating like mad
+   U32 readCount(U32 minSize)
+   {
+      U32 count = read<U32>();
+
+      if(U64(count) * minSize > mBuffer.size() - mPos)
+      {
+         mOk = false;
+         return 0;
+      }
+
+      return count;
+   }
+
+   bool isOk() const   { return mOk; }
+   bool isAtEnd() const { return mPos == mBuffer.size(); }
+};
+
+
+// Hash of everything computeBotMeshZones works from; levelgens can add walls, so the level file alone doesn't tell the whole story
+string BotZoneGeometry::getInputHash() const
+{
+   string buffer;
+
+   appendPoint(buffer, bounds.min);
+   appendPoint(buffer, bounds.max);
+
+   appendRaw(buffer, (U32)inputPolygons.size());
+   for(S32 i = 0; i < inputPolygons.size(); i++)
+   {
+      appendRaw(buffer, (U32)inputPolygons[i].size());
+      for(S32 j = 0; j < inputPolygons[i].size(); j++)
+         appendPoint(buffer, inputPolygons[i][j]);
+   }
+
+   md5wrapper md5;
+   return md5.getHashFromString(buffer);
+}
+
+
+// Write computed zones to filename, creating its folder if needed.  Returns true if successful.
+bool BotZoneGeometry::saveToCache(const string &filename) const
+{
+   string buffer;
+   string inputHash = getInputHash();
+
+   buffer.append(BotZoneCacheMagic, sizeof(BotZoneCacheMagic));
+   appendRaw(buffer, CacheVersion);
+   appendRaw(buffer, (U32)inputHash.size());
+   buffer.append(inputHash);
+   appendRaw(buffer, (U8)recastPassed);
+
+   appendRaw(buffer, (U32)zones.size());
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      appendRaw(buffer, (U32)zones[i].size());
+      for(S32 j = 0; j < zones[i].size(); j++)
+         appendPoint(buffer, zones[i][j]);
+   }
+
+   appendRaw(buffer, (U32)neighbors.size());
+   for(S32 i = 0; i < neighbors.size(); i++)
+   {
+      appendRaw(buffer, (U32)neighbors[i].size());
+      for(S32 j = 0; j < neighbors[i].size(); j++)
+      {
+         const NeighboringZone &neighbor = neighbors[i][j];
+
+         appendRaw(buffer, neighbor.zoneID);
+         appendPoint(buffer, neighbor.borderStart);
+         appendPoint(buffer, neighbor.borderEnd);
+         appendPoint(buffer, neighbor.borderCenter);
+         appendPoint(buffer, neighbor.center);
+         appendRaw(buffer, neighbor.distTo);
+      }
+   }
+
+   makeSureFolderExists(extractDirectory(filename));
+
+   // Write to a temp file and move it into place, so nobody ever sees half a cache file
+   string tempFilename = filename + ".tmp";
+
+   FILE *file = fopen(tempFilename.c_str(), "wb");
+   if(!file)
+      return false;
+
+   bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+   ok = (fclose(file) == 0) && ok;
+
+   if(ok)
+   {
+      remove(filename.c_str());     // Rename won't replace an existing file on Windows
+      ok = rename(tempFilename.c_str(), filename.c_str()) == 0;
+   }
+
+   if(!ok)
+      remove(tempFilename.c_str());
+
+   return ok;
+}
+
+
+// Replace zones and neighbors with those from filename.  Returns false, leaving them untouched, if the file is
+// missing, damaged, from a different version of the builder, or was built from different inputs.
+bool BotZoneGeometry::loadFromCache(const string &filename)
+{
+   FILE *file = fopen(filename.c_str(), "rb");
+   if(!file)
+      return false;
+
+   string buffer;
+   char chunk[4096];
+   size_t size;
+
+   while((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+      buffer.append(chunk, size);
+
+   fclose(file);
+
+   CacheReader reader(buffer);
+
+   if(reader.readString(sizeof(BotZoneCacheMagic)) != string(BotZoneCacheMagic, sizeof(BotZoneCacheMagic)) ||
+      reader.read<U32>() != CacheVersion)
+      return false;
+
+   string storedHash = reader.readString(reader.read<U32>());
+   if(!reader.isOk() || storedHash != getInputHash())
+      return false;
+
+   bool cachedRecastPassed = reader.read<U8>() != 0;
+
+   Vector<Vector<Point> > cachedZones;
+   cachedZones.resize(reader.readCount(sizeof(U32)));
+
+   for(S32 i = 0; i < cachedZones.size(); i++)
+   {
+      U32 count = reader.readCount(2 * sizeof(F32));
+      cachedZones[i].reserve(count);
+
+      for(U32 j = 0; j < count; j++)
+         cachedZones[i].push_back(reader.readPoint());
+   }
+
+   Vector<Vector<NeighboringZone> > cachedNeighbors;
+   cachedNeighbors.resize(reader.readCount(sizeof(U32)));
+
+   for(S32 i = 0; i < cachedNeighbors.size(); i++)
+   {
+      U32 count = reader.readCount(sizeof(U16) + 9 * sizeof(F32));
+      cachedNeighbors[i].reserve(count);
+
+      for(U32 j = 0; j < count; j++)
+      {
+         NeighboringZone neighbor;
+
+         neighbor.zoneID       = reader.read<U16>();
+         neighbor.borderStart  = reader.readPoint();
+         neighbor.borderEnd    = reader.readPoint();
+         neighbor.borderCenter = reader.readPoint();
+         neighbor.center       = reader.readPoint();
+         neighbor.distTo       = reader.read<F32>();
+
+         cachedNeighbors[i].push_back(neighbor);
+      }
+   }
+
+   // Neighbors must line up with zones, and point at zones that exist
+   if(!reader.isOk() || !reader.isAtEnd() || (cachedRecastPassed && cachedNeighbors.size() != cachedZones.size()))
+      return false;
+
+   for(S32 i = 0; i < cachedNeighbors.size(); i++)
+      for(S32 j = 0; j < cachedNeighbors[i].size(); j++)
+         if(cachedNeighbors[i][j].zoneID >= cachedZones.size())
+            return false;
+
+   recastPassed = cachedRecastPassed;
+   zones = cachedZones;
+   neighbors = cachedNeighbors;
+
+   return true;
+}
+
+
+// Server only
+// Gathers everything computeBotMeshZones needs from the level's objects.  Returns false if the level can't have zones.
+bool BotNavMeshZone::prepareBotMeshZones(BotZoneGeometry &geometry, const Rect *worldExtents,
+                                         const Vector<DatabaseObject *> &barrierList, const Vector<DatabaseObject *> &turretList,
+                                         const Vector<DatabaseObject *> &forceFieldProjectorList)
+{
+   geometry.bounds.set(worldExtents);
+
+   geometry.bounds.expandToInt(Point(LevelZoneBuffer, LevelZoneBuffer));      // Provide a little breathing room
 
    // Make sure level isn't too big for zone generation, which uses 16 bit ints
-   if(bounds.getHeight() >= (F32)U16_MAX || bounds.getWidth() >= (F32)U16_MAX)
+   if(geometry.bounds.getHeight() >= (F32)U16_MAX || geometry.bounds.getWidth() >= (F32)U16_MAX)
    {
       logprintf(LogConsumer::LogLevelError, "Level too big for zone generation! (max allowed dimension is %d)", U16_MAX);
       return false;
    }
 
-   Vector<F32> holes;
-   PolyTree solution;
-
    // Check if this is some sort of degenerate empty level and manually inject a zone.  Using a square because it looks nice;
    // A triangle would work too, and would be a tiny bit more efficient.
    if(barrierList.size() == 0 && turretList.size() == 0 && forceFieldProjectorList.size() == 0)
    {
-      Vector<Vector<Point> > inputPolygons(1);
       Vector<Point> points(4);
       points.push_back(Point(0, 0));
       points.push_back(Point(3, 0));
       points.push_back(Point(3, 3));
       points.push_back(Point(0, 3));
-      inputPolygons.push_back(points);
-
-      if(!mergePolysToPolyTree(inputPolygons, solution))
-         return false;
+      geometry.inputPolygons.push_back(points);
    }
+
+   // Gather bot zone buffers from barriers, turrets, and forcefield projectors
    else
-   {
-      // Merge bot zone buffers from barriers, turrets, and forcefield projectors
-      // The Clipper library is the work horse here.  Its output is essential for the
-      // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
-      if(!mergeBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, solution))
-         return false;
-   }
+      collectBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, geometry.inputPolygons);
 
+   return true;
+}
 
-#ifdef LOG_TIMER
-   U32 done1 = Platform::getRealMilliseconds();
-#endif
+
+// Server only
+// Use the Triangle library to create zones.  Aggregate triangles with Recast.  This only works on the data in geometry,
+// so it is safe to run on a worker thread.
+bool BotNavMeshZone::computeBotMeshZones(BotZoneGeometry &geometry)
+{
+   Rect bounds(geometry.bounds);      // Modifiable copy
+
+   // The Clipper library is the work horse here.  Its output is essential for the
+   // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
+   PolyTree solution;
+   if(!mergePolysToPolyTree(geometry.inputPolygons, solution))
+      return false;
 
    // Tessellate!
    // This will downscale the Clipper output and use poly2tri to triangulate
@@ -472,11 +718,6 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
    if(!Triangulate::processComplex(outputTriangles, bounds, solution))
       return false;
 
-#ifdef LOG_TIMER
-   U32 done2 = Platform::getRealMilliseconds();
-#endif
-
-   bool recastPassed = false;
    rcPolyMesh mesh;
 
    if(bounds.getWidth() < U16_MAX && bounds.getHeight() < U16_MAX)
@@ -488,29 +729,26 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       bounds.offset(Point(mesh.offsetX, mesh.offsetY));
 
       // Merge!  into convex polygons
-      recastPassed = Triangulate::mergeTriangles(outputTriangles, mesh);
+      geometry.recastPassed = Triangulate::mergeTriangles(outputTriangles, mesh);
    }
 
-   populateZoneList(botZoneDatabase, allZones);     // Populate allZones from botZoneDatabase
-
    // So here we are.  If recastPassed, our triangles were successfully aggregated into zones, but will need further polishing below.  If it failed 
    // (which will happen rarely, if ever), the aggregation failed and our zones are just the unaggregated raw triangles that we created before 
    // attempting mergeTriangles.  
 
-   if(recastPassed)
+   if(geometry.recastPassed)
    {
-      BotNavMeshZone *botzone = NULL;
-      bool addedZones = false;
-   
       const S32 bytesPerVertex = sizeof(U16);      // Recast coords are U16s
       Vector<S32> polyToZoneMap;
       polyToZoneMap.resize(mesh.npolys);
 
+      S32 zoneCount = 0;      // Zones that are complete -- the one we're filling in isn't counted yet
+
       // Visualize rcPolyMesh
       for(S32 i = 0; i < mesh.npolys; i++)
       {
          S32 j = 0;
-         botzone = NULL;
+         bool addingZone = false;
 
          while(j < mesh.nvp)
          {
@@ -522,74 +760,136 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
             if(vert[0] == U16_MAX)
                break;
 
-            if(botZoneDatabase->getObjectCount() >= MAX_ZONES)      // Don't add too many zones...
+            if(zoneCount >= MAX_ZONES)      // Don't add too many zones...
                break;
 
             if(j == 0)     // Add new zone because... why?
             {
-               botzone = new BotNavMeshZone(botZoneDatabase->getObjectCount());
-
-               // Triangulation only needed for display on local client... it is expensive to compute for so many zones,
-               // and there is really no point if they will never be viewed.  Once disabled, triangluation cannot be re-enabled
-               // for this object.
-               if(!triangulateZones)
-                  botzone->disableTriangulation();
-
-               polyToZoneMap[i] = botzone->getZoneId();
+               polyToZoneMap[i] = geometry.zones.size();
+               geometry.zones.push_back(Vector<Point>());
+               addingZone = true;
             }
 
-            botzone->addVert(Point(vert[0] - mesh.offsetX, vert[1] - mesh.offsetY));
+            geometry.zones.last().push_back(Point(vert[0] - mesh.offsetX, vert[1] - mesh.offsetY));
             j++;
          }
    
-         if(botzone != NULL)
-         {
-            botzone->addToZoneDatabase(botZoneDatabase);
-            addedZones = true;
-         }
+         if(addingZone)
+            zoneCount++;
       }
 
-#ifdef LOG_TIMER
-      logprintf("Recast built %d zones!", botZoneDatabase->getObjectCount());
-#endif              
+      geometry.neighbors.resize(geometry.zones.size());
+      buildBotNavMeshZoneConnectionsRecastStyle(geometry.neighbors, mesh, polyToZoneMap);
 
-      if(addedZones)
-         populateZoneList(botZoneDatabase, allZones);     // Repopulate allZones with the zones we modified above
+      // Cost of each link, figured as buildBotNavMeshZoneConnections does: from the center of the zone to the border.
+      // Without this, every link is free, and pathfinding is only steered by the heuristic.
+      for(S32 i = 0; i < geometry.neighbors.size(); i++)
+      {
+         Point center = Rect(geometry.zones[i]).getCenter();     // Same as BotNavMeshZone::getCenter()
 
-      buildBotNavMeshZoneConnectionsRecastStyle(allZones, mesh, polyToZoneMap);
-      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+         for(S32 j = 0; j < geometry.neighbors[i].size(); j++)
+            geometry.neighbors[i][j].distTo = center.distanceTo(geometry.neighbors[i][j].borderCenter);
+      }
    }
 
    // If recast failed, build zones from the underlying triangle geometry.  This bit could be made more efficient by using the adjacnecy
-   // data from Triangle, but it should only run rarely, if ever.
+   // data from Triangle, but it should only run rarely, if ever.  Connections are worked out by createBotMeshZones.
    else  // recastPassed == false
    {
-      TNLAssert(false, "Recast failed -- please report this level to the devs, and pick continue to build zones from triangle output");
-      logprintf(LogConsumer::LogLevelError, "There were problems with bot nav zone creation -- please report this level to the devs!");
-
       for(S32 i = 0; i < outputTriangles.size(); i+=3)
       {
-         if(botZoneDatabase->getObjectCount() >= MAX_ZONES)      // Don't add too many zones...
+         if(geometry.zones.size() >= MAX_ZONES)      // Don't add too many zones...
             break;
 
-         BotNavMeshZone *botzone = new BotNavMeshZone(i/3);
-         // Triangulation only needed for display on local client... it is expensive to compute for so many zones,
-         // and there is really no point if they will never be viewed.  Once disabled, triangluation cannot be re-enabled
-         // for this object.
-         if(!triangulateZones)
-            botzone->disableTriangulation();
+         geometry.zones.push_back(Vector<Point>());
+         geometry.zones.last().push_back(outputTriangles[i]);
+         geometry.zones.last().push_back(outputTriangles[i+1]);
+         geometry.zones.last().push_back(outputTriangles[i+2]);
+      }
+   }
 
-         botzone->addVert(outputTriangles[i]);
-         botzone->addVert(outputTriangles[i+1]);
-         botzone->addVert(outputTriangles[i+2]);
+   return true;
+}
 
-         botzone->addToZoneDatabase(botZoneDatabase);
-      }
 
-      buildBotNavMeshZoneConnections(allZones);
-      linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+// Server only
+// Turns the output of computeBotMeshZones into BotNavMeshZones
+void BotNavMeshZone::createBotMeshZones(const BotZoneGeometry &geometry, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                        const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones)
+{
+   allZones->deleteAndClear();
+
+   if(!geometry.recastPassed)
+   {
+      TNLAssert(false, "Recast failed -- please report this level to the devs, and pick continue to build zones from triangle output");
+      logprintf(LogConsumer::LogLevelError, "There were problems with bot nav zone creation -- please report this level to the devs!");
+   }
+
+   for(S32 i = 0; i < geometry.zones.size(); i++)
+   {
+      BotNavMeshZone *botzone = new BotNavMeshZone(i);
+
+      // Triangulation only needed for display on local client... it is expensive to compute for so many zones,
+      // and there is really no point if they will never be viewed.  Once disabled, triangluation cannot be re-enabled
+      // for this object.
+      if(!triangulateZones)
+         botzone->disableTriangulation();
+
+      for(S32 j = 0; j < geometry.zones[i].size(); j++)
+         botzone->addVert(geometry.zones[i][j]);
+
+      botzone->addToZoneDatabase(botZoneDatabase);
    }
 
+#ifdef LOG_TIMER
+   logprintf("Recast built %d zones!", botZoneDatabase->getObjectCount());
+#endif              
+
+   populateZoneList(botZoneDatabase, allZones);     // Populate allZones from botZoneDatabase
+
+   if(geometry.recastPassed)
+   {
+      for(S32 i = 0; i < geometry.neighbors.size(); i++)
+         allZones->get(i)->mNeighbors = geometry.neighbors[i];
+   }
+   else
+      buildBotNavMeshZoneConnections(allZones);
+
+   linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+}
+
+
+// Server only
+// Build zones in one go, on the calling thread
+bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                       const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
+                                       const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
+                                       const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones)
+{
+#ifdef LOG_TIMER
+   U32 starttime = Platform::getRealMilliseconds();
+#endif
+
+   allZones->deleteAndClear();
+
+   BotZoneGeometry geometry;
+
+   if(!prepareBotMeshZones(geometry, worldExtents, barrierList, turretList, forceFieldProjectorList))
+      return false;
+
+#ifdef LOG_TIMER
+   U32 done1 = Platform::getRealMilliseconds();
+#endif
+
+   if(!computeBotMeshZones(geometry))
+      return false;
+
+#ifdef LOG_TIMER
+   U32 done2 = Platform::getRealMilliseconds();
+#endif
+
+   createBotMeshZones(geometry, botZoneDatabase, allZones, teleporterData, triangulateZones);
+
 #ifdef LOG_TIMER
    U32 done3 = Platform::getRealMilliseconds();
 
@@ -613,12 +913,12 @@ void BotNavMeshZone::buildBotNavMeshZoneConnections(const Vector<BotNavMeshZone
    NeighboringZone neighbor;
 
    // Figure out which zones are adjacent to which, and find the "gateway" between them
-   for(S32 i = 0; i < zones.size() - 1; i++)
+   for(S32 i = 0; i < allZones->size() - 1; i++)
    {
-      for(S32 j = i + 1; j < zones.size(); j++)
+      for(S32 j = i + 1; j < allZones->size(); j++)
       {
          // Do zones i and j touch?  First a quick and dirty bounds check:
-         if(!zones[i]->getExtent().intersectsOrBorders(zones[j]->getExtent()))
+         if(!allZones->get(i)->getExtent().intersectsOrBorders(allZones->get(j)->getExtent()))
             continue;
 
          if(zonesTouch(allZones->get(i)->getOutline(), allZones->get(j)->getOutline(), 1.0, bordStart, bordEnd))
@@ -673,22 +973,36 @@ F32 AStar::heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 to
 }
 
 
-// Returns a path, including the startZone and targetZone 
+AStar::SearchState::SearchState(S32 zoneCount)
+{
+   whichList.resize(zoneCount);     // All NotListed
+   openList.resize(zoneCount + 1);
+   openZone.resize(zoneCount);
+   parentZones.resize(zoneCount);
+
+   Fcost.resize(zoneCount);
+   Gcost.resize(zoneCount);
+   Hcost.resize(zoneCount);
+}
+
+
+// Returns a path, including the startZone and targetZone.  Keeps all of its working state in a SearchState of its own,
+// so it's safe to call from several threads at once.
 Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target)
 {
-   // Because of these variables...
-   static U16 onClosedList = 0;
-   static U16 onOpenList;
+   SearchState state(zones->size());
 
-   // ...these arrays can be reused without further initialization
-   static U16 whichList[MAX_ZONES];       // Record whether a zone is on the open or closed list
-   static S16 openList[MAX_ZONES + 1]; 
-   static S16 openZone[MAX_ZONES]; 
-   static S16 parentZones[MAX_ZONES]; 
+   Vector<U8>  &whichList   = state.whichList;
+   Vector<S16> &openList    = state.openList;
+   Vector<S16> &openZone    = state.openZone;
+   Vector<S16> &parentZones = state.parentZones;
 
-   static F32 Fcost[MAX_ZONES];   
-   static F32 Gcost[MAX_ZONES];    
-   static F32 Hcost[MAX_ZONES];   
+   Vector<F32> &Fcost = state.Fcost;
+   Vector<F32> &Gcost = state.Gcost;
+   Vector<F32> &Hcost = state.Hcost;
+
+   const U8 onOpenList   = SearchState::OnOpenList;
+   const U8 onClosedList = SearchState::OnClosedList;
 
    S16 numberOfOpenListItems = 0;
    bool foundPath;
@@ -697,18 +1011,6 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
 
    Vector<Point> path;
 
-   // This block here lets us repeatedly reuse the whichList array without resetting it or recreating it
-   // which, for larger numbers of zones should be a real time saver.  It's not clear if it is particularly
-   // more efficient for the zone counts we typically see in Bitfighter levels.
-   if(onClosedList > U16_MAX - 3 ) // Reset whichList when we've run out of headroom
-   {
-      for(S32 i = 0; i < MAX_ZONES; i++) 
-         whichList[i] = 0;
-      onClosedList = 0;   
-   }
-   onClosedList = onClosedList + 2; // Changing the values of onOpenList and onClosed list is faster than redimming whichList() array
-   onOpenList = onClosedList - 1;
-
    Gcost[startZone] = 0;         // That's the cost of going from the startZone to the startZone!
    Fcost[0] = Hcost[0] = heuristic(zones, startZone, targetZone);
 
@@ -784,11 +1086,11 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
          // Add these adjacent child squares to the open list
          //   for later consideration if appropriate.
 
-         Vector<NeighboringZone> neighboringZones = zones->get(parentZone)->mNeighbors;
+         const Vector<NeighboringZone> &neighboringZones = zones->get(parentZone)->mNeighbors;
 
          for(S32 a = 0; a < neighboringZones.size(); a++)
          {
-            NeighboringZone zone = neighboringZones[a];
+            const NeighboringZone &zone = neighboringZones[a];
             S32 zoneID = zone.zoneID;
 
             //   Check if zone is already on the closed list (items on the closed list have
@@ -797,8 +1099,8 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
                continue;
 
             //   Add zone to the open list if it's not already on it
-            TNLAssert(newOpenListItemID < MAX_ZONES, "Too many nav zones... try increasing MAX_ZONES!");
-            if(whichList[zoneID] != onOpenList && newOpenListItemID < MAX_ZONES) 
+            TNLAssert(newOpenListItemID < zones->size(), "More open list items than zones!");
+            if(whichList[zoneID] != onOpenList && newOpenListItemID < zones->size()) 
             {   
                // Create a new open list item in the binary heap
                newOpenListItemID = newOpenListItemID + 1;   // Give each new item a unique id
@@ -926,6 +1228,155 @@ Point AStar::findGateway(const Vector<BotNavMeshZone *> *zones, S32 zone1, S32 z
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+ZoneRouteCache::ZoneRouteCache()
+{
+   mSearches = 0;
+   mHits = 0;
+}
+
+
+bool ZoneRouteCache::getRoute(const Vector<BotNavMeshZone *> *zones, U16 startZone, U16 targetZone, const Point &target,
+                              Vector<Point> &flightPlan)
+{
+   flightPlan.clear();
+
+   // Hold the lock while searching, so bots wanting the same target at the same moment wait for one search
+   // rather than all doing their own
+   mLock.lock();
+
+   map<U16, Vector<S16> >::iterator it = mNextZones.find(targetZone);
+
+   if(it != mNextZones.end())
+      mHits++;
+   else
+   {
+      if(S32(mNextZones.size()) >= MaxTargets)
+         mNextZones.clear();
+
+      it = mNextZones.insert(pair<U16, Vector<S16> >(targetZone, Vector<S16>())).first;
+      findRoutesTo(zones, targetZone, it->second);
+      mSearches++;
+   }
+
+   const Vector<S16> &nextZones = it->second;
+
+   // Walk from start to target, then lay the points out backwards, closest last, as AStar::findPath does
+   if(nextZones[startZone] >= 0)
+   {
+      Vector<S32> route;
+      for(S32 zone = startZone; zone != targetZone; zone = nextZones[zone])
+         route.push_back(zone);
+
+      flightPlan.push_back(target);
+      flightPlan.push_back(zones->get(targetZone)->getCenter());
+
+      S32 zone = targetZone;
+      for(S32 i = route.size() - 1; i >= 0; i--)
+      {
+         flightPlan.push_back(AStar::findGateway(zones, route[i], zone));
+         zone = route[i];
+         flightPlan.push_back(zones->get(zone)->getCenter());
+      }
+
+      flightPlan.push_back(zones->get(startZone)->getCenter());
+   }
+
+   mLock.unlock();
+
+   return flightPlan.size() > 0;
+}
+
+
+// Dijkstra's algorithm, run backwards from targetZone over the links into each zone.  Fills nextZones with the
+// first step along the shortest path to targetZone from every zone.  Caller must hold mLock.
+void ZoneRouteCache::findRoutesTo(const Vector<BotNavMeshZone *> *zones, U16 targetZone, Vector<S16> &nextZones)
+{
+   S32 zoneCount = zones->size();
+
+   if(mIncoming.size() != zoneCount)
+   {
+      mIncoming.clear();
+      mIncoming.resize(zoneCount);
+
+      for(S32 i = 0; i < zoneCount; i++)
+      {
+         const Vector<NeighboringZone> &neighbors = zones->get(i)->mNeighbors;
+
+         for(S32 j = 0; j < neighbors.size(); j++)
+         {
+            IncomingLink link;
+            link.fromZone = i;
+            link.distTo = neighbors[j].distTo;
+            mIncoming[neighbors[j].zoneID].push_back(link);
+         }
+      }
+   }
+
+   nextZones.resize(zoneCount);
+   for(S32 i = 0; i < zoneCount; i++)
+      nextZones[i] = -1;
+
+   Vector<F32> cost;
+   cost.resize(zoneCount);
+   Vector<U8> done;
+   done.resize(zoneCount);
+
+   // Ordered by cost, cheapest first
+   priority_queue<pair<F32, S32>, vector<pair<F32, S32> >, greater<pair<F32, S32> > > open;
+
+   nextZones[targetZone] = targetZone;
+   open.push(pair<F32, S32>(0, targetZone));
+
+   while(!open.empty())
+   {
+      S32 zone = open.top().second;
+      open.pop();
+
+      if(done[zone])       // Already reached more cheaply
+         continue;
+      done[zone] = true;
+
+      for(S32 i = 0; i < mIncoming[zone].size(); i++)
+      {
+         const IncomingLink &link = mIncoming[zone][i];
+         F32 newCost = cost[zone] + link.distTo;
+
+         if(done[link.fromZone] || (nextZones[link.fromZone] >= 0 && newCost >= cost[link.fromZone]))
+            continue;
+
+         cost[link.fromZone] = newCost;
+         nextZones[link.fromZone] = zone;
+         open.push(pair<F32, S32>(newCost, link.fromZone));
+      }
+   }
+}
+
+
+void ZoneRouteCache::clear()
+{
+   mLock.lock();
+   mIncoming.clear();
+   mNextZones.clear();
+   mLock.unlock();
+}
+
+
+U32 ZoneRouteCache::getSearchCount() const
+{
+   return mSearches;
+}
+
+
+U32 ZoneRouteCache::getHitCount() const
+{
+   return mHits;
+}
+
+
 };
 
 
@@ -9,6 +9,10 @@
 #include "gridDB.h"            // Parent
 #include "../recast/Recast.h"  // for rcPolyMesh;
 
+#include "tnlThread.h"
+
+#include <map>
+
 namespace Zap
 {
 
@@ -44,6 +48,29 @@ class ServerGame;
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+// Plain geometry for building bot zones, so the expensive part of the build can run away from the game objects
+struct BotZoneGeometry
+{
+   static const U32 CacheVersion;      // Bump whenever a change to the zone builder would give different zones
+
+   BotZoneGeometry();      // Constructor
+
+   Rect bounds;
+   Vector<Vector<Point> > inputPolygons;        // Buffered barriers, turrets, and forcefield projectors
+
+   Vector<Vector<Point> > zones;                // Zone outlines
+   Vector<Vector<NeighboringZone> > neighbors;  // Neighbors of each zone; only filled when recastPassed
+   bool recastPassed;
+
+   // Cache of computed zones -- only used if it was built from the same inputs by the same version of the builder
+   string getInputHash() const;
+   bool saveToCache(const string &filename) const;
+   bool loadFromCache(const string &filename);
+};
+
+////////////////////////////////////////
+////////////////////////////////////////
+
 class BotNavMeshZone : public DatabaseObject 
 {
    typedef GeomObject Parent;
@@ -84,7 +111,15 @@ public:
                                  const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
                                  const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones);
 
-   static bool buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotNavMeshZone *> *allZones, 
+   // buildBotMeshZones is these three steps in a row; only computeBotMeshZones is safe to run off the game thread
+   static bool prepareBotMeshZones(BotZoneGeometry &geometry, const Rect *worldExtents,
+                                   const Vector<DatabaseObject *> &barrierList, const Vector<DatabaseObject *> &turretList,
+                                   const Vector<DatabaseObject *> &forceFieldProjectorList);
+   static bool computeBotMeshZones(BotZoneGeometry &geometry);
+   static void createBotMeshZones(const BotZoneGeometry &geometry, GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
+                                  const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones);
+
+   static bool buildBotNavMeshZoneConnectionsRecastStyle(Vector<Vector<NeighboringZone> > &zoneNeighbors, 
                                                          rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap);
    static void buildBotNavMeshZoneConnections(const Vector<BotNavMeshZone *> *allZones);
 };
@@ -99,12 +134,75 @@ private:
    static F32 heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 toZone);
    static Point findGateway(const Vector<BotNavMeshZone *> *zones, S32 zone1, S32 zone2);
 
+   friend class ZoneRouteCache;
+
 public:
+   // Scratch space for a search.  Each search gets its own, so findPath can be run from several threads at once.
+   struct SearchState
+   {
+      explicit SearchState(S32 zoneCount);     // Constructor
+
+      enum ListStatus {
+         NotListed,
+         OnOpenList,
+         OnClosedList
+      };
+
+      Vector<U8> whichList;         // Record whether a zone is on the open or closed list
+      Vector<S16> openList;         // Binary heap of open list item IDs, starting at index 1
+      Vector<S16> openZone;         // Zone for each open list item
+      Vector<S16> parentZones;
+
+      Vector<F32> Fcost;            // Indexed by open list item
+      Vector<F32> Gcost;            // Indexed by zone
+      Vector<F32> Hcost;            // Indexed by open list item
+   };
+
    static Vector<Point> findPath (const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
    
 };
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Flight plans to any zone, shared by all bots on the server.  For each target zone we search once, backwards from the
+// target, and keep the next hop from every zone, so every bot heading for that zone shares the one search, wherever it
+// starts from.  Safe to use from the bot threads.
+class ZoneRouteCache
+{
+private:
+   static const S32 MaxTargets = 256;     // Forget everything when we've cached this many targets
+
+   struct IncomingLink
+   {
+      S16 fromZone;
+      F32 distTo;
+   };
+
+   Mutex mLock;
+   Vector<Vector<IncomingLink> > mIncoming;     // Links into each zone; built on first use, as links can be one way
+   map<U16, Vector<S16> > mNextZones;           // Keyed by target zone; next zone toward it from each zone, -1 if none
+
+   U32 mSearches;
+   U32 mHits;
+
+   void findRoutesTo(const Vector<BotNavMeshZone *> *zones, U16 targetZone, Vector<S16> &nextZones);
+
+public:
+   ZoneRouteCache();     // Constructor
+
+   // Fills flightPlan with a path from startZone to target, laid out as AStar::findPath does; returns false if there isn't one
+   bool getRoute(const Vector<BotNavMeshZone *> *zones, U16 startZone, U16 targetZone, const Point &target, 
+                 Vector<Point> &flightPlan);
+
+   void clear();        // Call whenever the zones change
+
+   U32 getSearchCount() const;
+   U32 getHitCount() const;
+};
+
+
 };
 
 
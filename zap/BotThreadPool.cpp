@@ -0,0 +1,469 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotThreadPool.h"
+
+#include "LuaScriptRunner.h"
+#include "LuaModule.h"
+#include "robot.h"
+
+#include "tnlLog.h"
+
+#include <string.h>
+
+
+namespace Zap
+{
+
+// Calls a bot makes that have to wait until the tick's done, kept in the bot's own registry
+static const char *DEFERRED_CALLS_KEY = "bf_deferred_calls";
+
+// Methods that don't follow the naming rules in getCallMode()
+struct CallModeOverride
+{
+   const char *className;
+   const char *methodName;
+   BotThreadPool::CallMode mode;
+};
+
+static const CallModeOverride callModeOverrides[] = {
+   // Steering and shooting only change the bot's own ship
+   { "Robot", "setAngle",             BotThreadPool::SelfCall     },
+   { "Robot", "setThrust",            BotThreadPool::SelfCall     },
+   { "Robot", "setThrustToPt",        BotThreadPool::SelfCall     },
+   { "Robot", "fireWeapon",           BotThreadPool::SelfCall     },
+   { "Robot", "fireModule",           BotThreadPool::SelfCall     },
+   { "Robot", "getWaypoint",          BotThreadPool::SelfCall     },    // Updates the bot's own flight plan
+
+   // Bots tell the world what they want, and the world does it after the tick
+   { "Robot", "setLoadoutWeapon",     BotThreadPool::DeferredCall },
+   { "Robot", "setLoadoutModule",     BotThreadPool::DeferredCall },
+   { "Robot", "globalMsg",            BotThreadPool::DeferredCall },
+   { "Robot", "teamMsg",              BotThreadPool::DeferredCall },
+   { "Robot", "privateMsg",           BotThreadPool::DeferredCall },
+   { "Robot", "dropItem",             BotThreadPool::DeferredCall },
+   { "Robot", "copyMoveFromObject",   BotThreadPool::DeferredCall },
+   { "Robot", "removeFromGame",       BotThreadPool::DeferredCall },
+
+   { "LuaScriptRunner", "addItem",          BotThreadPool::DeferredCall },
+   { "LuaScriptRunner", "subscribe",        BotThreadPool::DeferredCall },
+   { "LuaScriptRunner", "unsubscribe",      BotThreadPool::DeferredCall },
+   { "LuaScriptRunner", "pointCanSeePoint", BotThreadPool::FreeCall     },
+   { "LuaScriptRunner", "getGameInfo",      BotThreadPool::SerialCall   },    // Created on first use
+};
+
+
+Mutex BotThreadPool::mSerialLock;
+
+
+U32 BotThreadPool::WorkerThread::run()
+{
+   for(;;)
+   {
+      mPool->mStartSemaphore.wait();
+      if(mPool->mQuit)
+         break;
+
+      mPool->runScripts(mWorker);
+      mPool->mDoneSemaphore.increment();
+   }
+
+   mPool->mDoneSemaphore.increment();
+   return 0;
+}
+
+
+// Constructor
+BotThreadPool::BotThreadPool(U32 threadCount)
+{
+   mQuit = false;
+   mScripts = NULL;
+   mContexts = NULL;
+   mFunction = NULL;
+   mDeltaT = 0;
+   mNextIndex = 0;
+
+   mWorkerLocks = new Mutex[threadCount + 1];      // Plus one for the main thread
+
+   for(U32 i = 0; i < threadCount; i++)
+   {
+      WorkerThread *thread = new WorkerThread(this, i + 1);
+      if(!thread->start())
+      {
+         delete thread;
+         break;
+      }
+      mThreads.push_back(thread);
+   }
+}
+
+
+// Destructor
+BotThreadPool::~BotThreadPool()
+{
+   mQuit = true;
+   mStartSemaphore.increment(mThreads.size());
+
+   // Each worker checks in on its way out, after which it no longer touches this pool
+   for(S32 i = 0; i < mThreads.size(); i++)
+      mDoneSemaphore.wait();
+
+   for(S32 i = 0; i < mThreads.size(); i++)
+      delete mThreads[i];
+
+   delete [] mWorkerLocks;
+}
+
+
+BotThreadPool *BotThreadPool::create(U32 threadCount)
+{
+#ifdef TNL_NO_THREADS
+   threadCount = 0;     // Thread::start() would run the worker loop inline and never return
+#endif
+
+   return threadCount ? new BotThreadPool(threadCount) : NULL;
+}
+
+
+U32 BotThreadPool::getThreadCount() const
+{
+   return mThreads.size();
+}
+
+
+void BotThreadPool::run(const Vector<LuaScriptRunner *> &scripts, const Vector<ScriptContext> &contexts, const char *function, U32 deltaT)
+{
+   TNLAssert(scripts.size() == contexts.size(), "Need a context for each script!");
+
+   mScripts = &scripts;
+   mContexts = &contexts;
+   mFunction = function;
+   mDeltaT = deltaT;
+   mNextIndex = 0;
+
+   mStartSemaphore.increment(mThreads.size());
+   runScripts(0);
+
+   for(S32 i = 0; i < mThreads.size(); i++)
+      mDoneSemaphore.wait();
+
+   mScripts = NULL;
+   mContexts = NULL;
+
+   // Everyone's done thinking; now do what they asked for, in the same order they'd have run in serially
+   for(S32 i = 0; i < scripts.size(); i++)
+      replayDeferredCalls(scripts[i]);
+
+   for(S32 i = 0; i < scripts.size(); i++)
+      if(scripts[i]->mKillPending)
+      {
+         scripts[i]->mKillPending = false;
+         scripts[i]->killScript();
+      }
+}
+
+
+void BotThreadPool::runScripts(U32 worker)
+{
+   for(;;)
+   {
+      mLock.lock();
+      S32 index = mNextIndex++;
+      mLock.unlock();
+
+      if(index >= mScripts->size())
+         return;
+
+      mWorkerLocks[worker].lock();
+      runScript((*mScripts)[index], (*mContexts)[index], worker);
+      mWorkerLocks[worker].unlock();
+   }
+}
+
+
+void BotThreadPool::runScript(LuaScriptRunner *script, ScriptContext context, U32 worker)
+{
+   lua_State *L = script->getLuaState();
+   LuaStateInfo *info = getLuaStateInfo(L);
+
+   TNLAssert(script->ownsLuaState() && info && info->threaded, "Script can't run on a worker thread!");
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+   info->pool = this;
+   info->worker = worker;
+
+   try
+   {
+      setScriptContext(L, context);
+      lua_pushinteger(L, mDeltaT);     // -- deltaT
+      script->runCmd(mFunction, 0);
+   }
+   catch(LuaException &e)
+   {
+      logprintf(LogConsumer::LogError, "%s %s", script->getErrorMessagePrefix(), e.what());
+      script->mKillPending = true;
+      clearStack(L);
+   }
+
+   info->pool = NULL;
+}
+
+
+void BotThreadPool::replayDeferredCalls(LuaScriptRunner *script)
+{
+   lua_State *L = script->getLuaState();
+
+   lua_getfield(L, LUA_REGISTRYINDEX, DEFERRED_CALLS_KEY);     // -- calls
+   if(lua_isnil(L, -1))
+   {
+      lua_pop(L, 1);
+      return;
+   }
+
+   lua_pushnil(L);                                             // -- calls, nil
+   lua_setfield(L, LUA_REGISTRYINDEX, DEFERRED_CALLS_KEY);     // -- calls
+
+   S32 count = (S32)lua_objlen(L, 1);
+
+   for(S32 i = 1; i <= count; i++)
+   {
+      lua_rawgeti(L, 1, i);                  // -- calls, call
+      lua_getfield(L, 2, "n");               // -- calls, call, n
+      S32 args = (S32)lua_tointeger(L, -1);
+      lua_pop(L, 1);                         // -- calls, call
+
+      for(S32 j = 1; j <= args + 1; j++)
+         lua_rawgeti(L, 2, j);               // -- calls, call, function, <<args>>
+
+      if(lua_pcall(L, args, 0, 0))           // -- calls, call
+      {
+         // Would have been raised in the bot's onTick(), had we run it then; the outcome is the same
+         script->logError("In deferred call:\n%s", lua_tostring(L, -1));
+         script->mKillPending = true;
+         break;
+      }
+
+      lua_pop(L, 1);                         // -- calls
+   }
+
+   clearStack(L);
+}
+
+
+// A bot wants the game to itself.  Let go of our own lock first, so another bot waiting for the world isn't stuck
+// waiting on us.
+void BotThreadPool::lockWorld(U32 worker)
+{
+   mWorkerLocks[worker].unlock();
+   mWorldLock.lock();
+
+   for(S32 i = 0; i <= mThreads.size(); i++)
+      mWorkerLocks[i].lock();
+}
+
+
+void BotThreadPool::unlockWorld(U32 worker)
+{
+   for(S32 i = 0; i <= mThreads.size(); i++)
+      mWorkerLocks[i].unlock();
+
+   mWorldLock.unlock();
+   mWorkerLocks[worker].lock();
+}
+
+
+// Lookers run free, doers get the game to themselves
+BotThreadPool::CallMode BotThreadPool::getCallMode(const char *className, const char *methodName)
+{
+   for(U32 i = 0; i < ARRAYSIZE(callModeOverrides); i++)
+      if(strcmp(callModeOverrides[i].className, className) == 0 && strcmp(callModeOverrides[i].methodName, methodName) == 0)
+         return callModeOverrides[i].mode;
+
+   static const char *readPrefixes[] = { "get", "is", "has", "can", "find" };
+
+   for(U32 i = 0; i < ARRAYSIZE(readPrefixes); i++)
+      if(strncmp(methodName, readPrefixes[i], strlen(readPrefixes[i])) == 0)
+         return FreeCall;
+
+   return ExclusiveCall;
+}
+
+
+// Called while the state is being configured, after our classes and loose functions are registered, but before any
+// helper scripts get a chance to squirrel away references to them
+void BotThreadPool::wrapFunctions(lua_State *L)
+{
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+   // LuaWrapper keeps each class's metatable, with all its methods, in the registry under the class name
+   lua_pushnil(L);                                    // -- nil
+   while(lua_next(L, LUA_REGISTRYINDEX))              // -- key, value
+   {
+      if(lua_type(L, -2) == LUA_TSTRING && lua_istable(L, -1))
+      {
+         lua_getfield(L, -1, LUAW_EXTENDS_KEY);       // -- key, value, value.__extends
+         bool isClass = lua_istable(L, -1);
+         lua_pop(L, 1);                               // -- key, value
+
+         if(isClass)
+            wrapClass(L, lua_tostring(L, -2), lua_gettop(L));
+      }
+
+      lua_pop(L, 1);                                  // -- key
+   }
+
+   // Loose functions, like findFile() or Geom.triangulate()
+   ProfileMap &moduleProfiles = LuaModuleRegistrarBase::getModuleProfiles();
+
+   for(ProfileMap::iterator it = moduleProfiles.begin(); it != moduleProfiles.end(); it++)
+   {
+      if((*it).first == "global")
+         lua_pushvalue(L, LUA_GLOBALSINDEX);          // -- table
+      else
+         lua_getglobal(L, (*it).first.c_str());       // -- table
+
+      if(lua_istable(L, -1))
+      {
+         vector<LuaStaticFunctionProfile> &profiles = (*it).second;
+         for(U32 i = 0; i < profiles.size(); i++)
+            wrapField(L, lua_gettop(L), profiles[i].functionName, SerialCall);
+      }
+
+      lua_pop(L, 1);                                  // --
+   }
+
+   // registerLooseFunctions() pointed this at the unwrapped version
+   luaL_dostring(L, "math.random = getRandomNumber");
+
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack not cleared!");
+}
+
+
+void BotThreadPool::wrapClass(lua_State *L, const char *className, S32 metatableIndex)
+{
+   for(lua_pushnil(L); lua_next(L, metatableIndex); lua_pop(L, 1))     // -- name, function
+   {
+      if(lua_type(L, -2) != LUA_TSTRING || !lua_iscfunction(L, -1) || lua_tocfunction(L, -1) == gatedCall)
+         continue;
+
+      const char *name = lua_tostring(L, -2);
+
+      if(strncmp(name, "__", 2) == 0)                 // Metamethods, like __index and __gc, are LuaWrapper's own
+         continue;
+
+      lua_pushvalue(L, -2);                           // -- name, function, name
+      lua_pushvalue(L, -2);                           // -- name, function, name, function
+      lua_pushinteger(L, getCallMode(className, name));
+      lua_pushcclosure(L, gatedCall, 2);              // -- name, function, name, gatedFunction
+      lua_rawset(L, metatableIndex);                  // -- name, function
+   }
+
+   // Creating objects might touch all sorts of things
+   lua_getglobal(L, className);                       // -- classTable
+   if(lua_istable(L, -1))
+      wrapField(L, lua_gettop(L), "new", ExclusiveCall);
+   lua_pop(L, 1);                                     // --
+}
+
+
+void BotThreadPool::wrapField(lua_State *L, S32 tableIndex, const char *name, CallMode mode)
+{
+   lua_getfield(L, tableIndex, name);                 // -- function
+
+   if(!lua_iscfunction(L, -1) || lua_tocfunction(L, -1) == gatedCall)
+   {
+      lua_pop(L, 1);                                  // --
+      return;
+   }
+
+   lua_pushinteger(L, mode);                          // -- function, mode
+   lua_pushcclosure(L, gatedCall, 2);                 // -- gatedFunction
+   lua_setfield(L, tableIndex, name);                 // --
+}
+
+
+// Save a deferred call, function and args, for replayDeferredCalls()
+static void recordCall(lua_State *L)
+{
+   S32 args = lua_gettop(L);                                      // -- <<args>>
+
+   lua_getfield(L, LUA_REGISTRYINDEX, DEFERRED_CALLS_KEY);        // -- <<args>>, calls
+   if(lua_isnil(L, -1))
+   {
+      lua_pop(L, 1);                                              // -- <<args>>
+      lua_newtable(L);                                            // -- <<args>>, calls
+      lua_pushvalue(L, -1);                                       // -- <<args>>, calls, calls
+      lua_setfield(L, LUA_REGISTRYINDEX, DEFERRED_CALLS_KEY);     // -- <<args>>, calls
+   }
+
+   lua_createtable(L, args + 1, 1);                               // -- <<args>>, calls, call
+
+   lua_pushvalue(L, lua_upvalueindex(1));                         // -- <<args>>, calls, call, function
+   lua_rawseti(L, -2, 1);                                         // -- <<args>>, calls, call
+
+   for(S32 i = 1; i <= args; i++)
+   {
+      lua_pushvalue(L, i);                                        // -- <<args>>, calls, call, arg
+      lua_rawseti(L, -2, i + 1);                                  // -- <<args>>, calls, call
+   }
+
+   lua_pushinteger(L, args);                                      // -- <<args>>, calls, call, n
+   lua_setfield(L, -2, "n");                                      // -- <<args>>, calls, call
+
+   lua_rawseti(L, -2, (S32)lua_objlen(L, -2) + 1);                // -- <<args>>, calls
+}
+
+
+// Stands in for each C function a threaded state's scripts can call.  Upvalues are the real function and its CallMode.
+S32 BotThreadPool::gatedCall(lua_State *L)
+{
+   LuaStateInfo *info = getLuaStateInfo(L);
+   BotThreadPool *pool = info ? info->pool : NULL;
+   CallMode mode = CallMode(lua_tointeger(L, lua_upvalueindex(2)));
+
+   if(mode == SelfCall)
+   {
+      Robot *robot = luaW_to<Robot>(L, 1);
+      mode = (robot && static_cast<LuaScriptRunner *>(robot) == info->runningScript) ? FreeCall : ExclusiveCall;
+   }
+
+   // Off the worker threads, we have the game to ourselves
+   if(!pool || mode == FreeCall)
+   {
+      lua_pushvalue(L, lua_upvalueindex(1));          // -- <<args>>, function
+      lua_insert(L, 1);                               // -- function, <<args>>
+      lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);    // -- <<results>>
+      return lua_gettop(L);
+   }
+
+   if(mode == DeferredCall)
+   {
+      recordCall(L);
+      return 0;
+   }
+
+   if(mode == SerialCall)
+      mSerialLock.lock();
+   else
+      pool->lockWorld(info->worker);
+
+   lua_pushvalue(L, lua_upvalueindex(1));             // -- <<args>>, function
+   lua_insert(L, 1);                                  // -- function, <<args>>
+   S32 error = lua_pcall(L, lua_gettop(L) - 1, LUA_MULTRET, 0);     // -- <<results>> or error
+
+   if(mode == SerialCall)
+      mSerialLock.unlock();
+   else
+      pool->unlockWorld(info->worker);
+
+   // Now that we've let go of the locks, pass any error along
+   if(error)
+      return lua_error(L);
+
+   return lua_gettop(L);
+}
+
+
+} /* namespace Zap */
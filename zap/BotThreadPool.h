@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _BOT_THREAD_POOL_H_
+#define _BOT_THREAD_POOL_H_
+
+#include "LuaBase.h"       // For ScriptContext
+
+#include "tnlThread.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class LuaScriptRunner;
+
+// Runs bots' onTick() handlers in parallel, each bot in a Lua state of its own.  The game doesn't change while
+// the bots are running, so it serves as their snapshot of the world: calls that only look at the game run freely,
+// calls that change it either stop all the other bots while they run, or are saved up and run on the main thread
+// once every bot is done.  Which is which is decided by wrapFunctions() when each bot's state is created.
+class BotThreadPool
+{
+public:
+   enum CallMode {
+      FreeCall,         // Only looks at the game; can run alongside other bots
+      SelfCall,         // Only changes the bot making the call; free on our own bot, exclusive on anyone else's
+      SerialCall,       // Uses some shared scratch space; runs alongside other bots, but one call at a time
+      ExclusiveCall,    // Changes the game; waits for all other bots to get out of the way
+      DeferredCall,     // Changes the game and returns nothing; replayed on the main thread once all bots are done
+   };
+
+private:
+   class WorkerThread : public Thread
+   {
+      BotThreadPool *mPool;
+      U32 mWorker;
+   public:
+      WorkerThread(BotThreadPool *pool, U32 worker) { mPool = pool; mWorker = worker; }
+      U32 run();
+   };
+
+   Vector<WorkerThread *> mThreads;
+   Semaphore mStartSemaphore;    // Released once per worker at the start of each pass
+   Semaphore mDoneSemaphore;     // Incremented by each worker when it runs out of bots
+   Mutex mLock;                  // Guards mNextIndex
+   bool mQuit;
+
+   // Each worker holds its own lock while it runs a bot; a bot wanting the game to itself takes mWorldLock
+   // and then all of them.  Worker 0 is the main thread.
+   Mutex *mWorkerLocks;
+   Mutex mWorldLock;
+
+   static Mutex mSerialLock;     // Taken around SerialCalls
+
+   const Vector<LuaScriptRunner *> *mScripts;
+   const Vector<ScriptContext> *mContexts;
+   const char *mFunction;
+   U32 mDeltaT;
+   S32 mNextIndex;
+
+   explicit BotThreadPool(U32 threadCount);     // Use create()
+
+   void runScripts(U32 worker);
+   void runScript(LuaScriptRunner *script, ScriptContext context, U32 worker);
+   void replayDeferredCalls(LuaScriptRunner *script);
+
+   void lockWorld(U32 worker);
+   void unlockWorld(U32 worker);
+
+   static CallMode getCallMode(const char *className, const char *methodName);
+   static void wrapClass(lua_State *L, const char *className, S32 metatableIndex);
+   static void wrapField(lua_State *L, S32 tableIndex, const char *name, CallMode mode);
+
+   static S32 gatedCall(lua_State *L);
+
+public:
+   static BotThreadPool *create(U32 threadCount);    // Returns NULL for 0 threads, or if threads aren't available
+   ~BotThreadPool();                                 // Destructor
+
+   U32 getThreadCount() const;
+
+   // Run function (with deltaT as its arg) in each script, in parallel, then run anything they deferred in script order
+   void run(const Vector<LuaScriptRunner *> &scripts, const Vector<ScriptContext> &contexts, const char *function, U32 deltaT);
+
+   // Replace the C functions registered in L with versions that are safe to call from a worker thread
+   static void wrapFunctions(lua_State *L);
+};
+
+
+} /* namespace Zap */
+#endif /* _BOT_THREAD_POOL_H_ */
@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BotZoneBuildThread.h"
+
+#include "ServerGame.h"
+
+namespace Zap
+{
+
+// Constructor
+BotZoneBuildThread::BotZoneBuildThread(ServerGame *game, U32 levelLoadCount, const BotZoneGeometry &geometry, 
+                                       const string &cacheFilename)
+{
+   mGame = game;
+   mLevelLoadCount = levelLoadCount;
+   mGeometry = geometry;
+   mCacheFilename = cacheFilename;
+   mSucceeded = false;
+}
+
+
+// Destructor
+BotZoneBuildThread::~BotZoneBuildThread()
+{
+   // Do nothing
+}
+
+
+// Runs on the secondary thread -- only works on mGeometry
+void BotZoneBuildThread::run()
+{
+   mSucceeded = BotNavMeshZone::computeBotMeshZones(mGeometry);
+
+   if(mSucceeded && mCacheFilename != "")
+      mGeometry.saveToCache(mCacheFilename);
+}
+
+
+void BotZoneBuildThread::finish()
+{
+   mGame->onBotZonesBuilt(mLevelLoadCount, mGeometry, mSucceeded);
+}
+
+
+} /* namespace Zap */
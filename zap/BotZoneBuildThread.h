@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _BOT_ZONE_BUILD_THREAD_H_
+#define _BOT_ZONE_BUILD_THREAD_H_
+
+#include "BotNavMeshZone.h"
+#include "../master/DatabaseAccessThread.h"
+
+namespace Zap
+{
+
+class ServerGame;
+
+// Runs the expensive part of bot zone generation on the secondary thread.  The zones themselves are
+// created back on the game thread, and only if the level they were built for is still being played.
+class BotZoneBuildThread : public Master::ThreadEntry
+{
+private:
+   ServerGame *mGame;
+   U32 mLevelLoadCount;       // Which level load these zones belong to
+   BotZoneGeometry mGeometry;
+   string mCacheFilename;     // Where to save the zones once built, or "" if they shouldn't be cached
+   bool mSucceeded;
+
+public:
+   BotZoneBuildThread(ServerGame *game, U32 levelLoadCount, const BotZoneGeometry &geometry, const string &cacheFilename);  // Constructor
+   virtual ~BotZoneBuildThread();                                                                // Destructor
+
+   void run();
+   void finish();
+};
+
+} /* namespace Zap */
+#endif /* _BOT_ZONE_BUILD_THREAD_H_ */
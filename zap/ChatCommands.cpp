@@ -914,6 +914,20 @@ void shuffleTeams(ClientGame *game, const Vector<string> &words)
 }
 
 
+// /luaprofile [reset] ==> Server shows time used by each script, in a message box and in its log
+void luaProfileHandler(ClientGame *game, const Vector<string> &words)
+{
+   if(game->hasAdmin("!!! Need admin permissions to view script profiles"))
+   {
+      Vector<StringPtr> args;
+      if(words.size() > 1)
+         args.push_back(StringPtr(words[1]));
+
+      game->sendCommand("luaprofile", args);
+   }
+}
+
+
 void banPlayerHandler(ClientGame *game, const Vector<string> &words)
 {
    if(game->hasAdmin("!!! Need admin permissions to ban players"))
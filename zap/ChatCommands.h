@@ -125,6 +125,7 @@ void banIpHandler              (ClientGame *game, const Vector<string> &args);
 void renamePlayerHandler       (ClientGame *game, const Vector<string> &args);
 void globalMuteHandler         (ClientGame *game, const Vector<string> &args);
 void shuffleTeams              (ClientGame *game, const Vector<string> &args);
+void luaProfileHandler         (ClientGame *game, const Vector<string> &args);
 void downloadMapHandler        (ClientGame *game, const Vector<string> &args);
 void rateMapHandler            (ClientGame *game, const Vector<string> &args);
 void commentMapHandler         (ClientGame *game, const Vector<string> &args);
@@ -267,7 +267,8 @@ void ClientGame::startLoadingLevel(bool engineerEnabled)
 
 void ClientGame::doneLoadingLevel()
 {
-   computeWorldObjectExtents();              // Make sure our world extents reflect all the objects we've loaded
+   getGameObjDatabase()->fitGridToExtents(*getWorldExtents());    // Size our spatial index to suit this level
+   getGameObjDatabase()->freezeStaticObjects((TestFunc)isStaticGeometryType);
    Barrier::prepareRenderingGeometry(this);  // Get walls ready to render
 
    getUIManager()->doneLoadingLevel();
@@ -794,8 +795,6 @@ void ClientGame::idle(U32 timeDelta)
    {
       mConnectionToServer->updateTimers(timeDelta);
 
-      computeWorldObjectExtents();
-
       Move *theMove = getUIManager()->getCurrentMove();       // Get move from keyboard input
 
       theMove->time = timeDelta;
@@ -844,7 +843,7 @@ void ClientGame::idle(U32 timeDelta)
          {
             static const S32 HelpSearchRadius = 200;
             Rect searchRect = Rect(localPlayerShip->getPos(), HelpSearchRadius);
-            fillVector.clear();
+            Vector<DatabaseObject *> fillVector;
             mGameObjDatabase->findObjects((TestFunc)hasRelatedHelpItem, fillVector, searchRect);
 
             if(getUIManager()->isShowingInGameHelp())
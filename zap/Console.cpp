@@ -39,11 +39,9 @@ Console::~Console()
    if(mConsole)
       quit();
 
-   if(L)
-   {
-      lua_close(L);
-      L = NULL;
-   }
+   // We've been holding on to the shared state until now
+   shutdown();
+   L = NULL;
 }
 
 
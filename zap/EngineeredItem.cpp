@@ -14,6 +14,7 @@
 #include "projectile.h"
 
 #include "ServerGame.h"
+#include "VisibilityCache.h"
 
 #include "Colors.h"
 #include "stringUtils.h"
@@ -205,7 +206,7 @@ bool EngineerModuleDeployer::canCreateObjectAtLocation(const GridDatabase *gameO
 
    Vector<Point> candidateForceFieldGeom = ForceField::computeGeom(forceFieldStart, forceFieldEnd);
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    gameObjectDatabase->findObjects(ForceFieldProjectorTypeNumber, fillVector, queryRect);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -2207,7 +2208,7 @@ void Turret::idle(IdleCallPath path)
    queryRect.unionPoint(aimPos + cross * TurretPerceptionDistance);
    queryRect.unionPoint(aimPos - cross * TurretPerceptionDistance);
    queryRect.unionPoint(aimPos + mAnchorNormal * TurretPerceptionDistance);
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    findObjects((TestFunc)isTurretTargetType, fillVector, queryRect);    // Get all potential targets
 
    WeaponInfo weaponInfo = WeaponInfo::getWeaponInfo(mWeaponFireType);
@@ -2260,14 +2261,14 @@ void Turret::idle(IdleCallPath path)
          continue;
 
       // See if we can see it...
-      Point n;
-      if(findObjectLOS((TestFunc)isWallType, ActualState, aimPos, potential->getPos(), t, n))
+      if(!static_cast<ServerGame *>(getGame())->getVisibilityCache()->canSee(aimPos, potential->getPos()))
          continue;
 
       // See if we're gonna clobber our own stuff...
       disableCollision();
       Point delta2 = delta;
       delta2.normalize(weaponInfo.projLiveTime * (F32)weaponInfo.projVelocity / 1000.f);
+      Point n;
       BfObject *hitObject = findObjectLOS((TestFunc) isWithHealthType, 0, aimPos, aimPos + delta2, t, n);
       enableCollision();
 
@@ -9,6 +9,9 @@
 #include "playerInfo.h"          // For RobotPlayerInfo constructor
 #include "robot.h"
 #include "Zone.h"
+#include "GameManager.h"
+#include "ServerGame.h"
+#include "BotThreadPool.h"
 
 //#include "../lua/luaprofiler-2.0.2/src/luaprofiler.h"      // For... the profiler!
 
@@ -107,7 +110,7 @@ void EventManager::subscribe(LuaScriptRunner *subscriber, EventType eventType, S
    if(isSubscribed(subscriber, eventType) || isPendingSubscribed(subscriber, eventType))
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
+   lua_State *L = subscriber->getLuaState();
 
    // Make sure the script has the proper event listener
    bool ok = LuaScriptRunner::loadFunction(L, subscriber->getScriptId(), eventDefs[eventType].function);     // -- function
@@ -250,12 +253,16 @@ void EventManager::fireEvent(EventType eventType)
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
+   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
+   {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
 
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
-   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
       fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+   }
 }
 
 
@@ -268,15 +275,43 @@ void EventManager::fireEvent(EventType eventType, U32 deltaT)
    if(eventType == TickEvent)
       mStepCount--;   
 
-   lua_State *L = LuaScriptRunner::getL();
+   // Bots with states of their own can be run together on the bot threads, once everyone else is done
+   ServerGame *serverGame = GameManager::getServerGame();
+   BotThreadPool *pool = (eventType == TickEvent && serverGame) ? serverGame->getBotThreadPool() : NULL;
 
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+   Vector<LuaScriptRunner *> threadedScripts;
+   Vector<ScriptContext> threadedContexts;
 
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+      // Scripts that went over their budget sit out a few ticks
+      if(eventType == TickEvent && subscriptions[eventType][i].subscriber->skipTick())
+         continue;
+
+      if(pool && subscriptions[eventType][i].subscriber->ownsLuaState())
+      {
+         threadedScripts.push_back(subscriptions[eventType][i].subscriber);
+         threadedContexts.push_back(subscriptions[eventType][i].context);
+         continue;
+      }
+
       lua_pushinteger(L, deltaT);   // -- deltaT
       fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
    }
+
+   if(threadedScripts.size() > 0)
+   {
+      // The world's extents are worked out lazily, which is fine for one thread but not for several
+      serverGame->getGameObjDatabase()->getExtents();
+
+      pool->run(threadedScripts, threadedContexts, eventDefs[eventType].function, deltaT);
+   }
 }
 
 
@@ -286,12 +321,14 @@ void EventManager::fireEvent(EventType eventType, CoreItem *core)
    if(suppressEvents(eventType))
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       core->push(L);                // -- core
       fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
    }
@@ -304,12 +341,14 @@ void EventManager::fireEvent(EventType eventType, Ship *ship)
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       ship->push(L);                // -- ship
       fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
    }
@@ -322,12 +361,14 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, BfObject *damaging
    if(suppressEvents(eventType))
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       ship->push(L);                // -- ship
 
       if(damagingObject)
@@ -352,12 +393,14 @@ void EventManager::fireEvent(LuaScriptRunner *sender, EventType eventType, const
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       if(sender == subscriptions[eventType][i].subscriber)    // Don't alert sender about own message!
          continue;
 
@@ -381,12 +424,14 @@ void EventManager::fireEvent(LuaScriptRunner *player, EventType eventType, LuaPl
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       if(player == subscriptions[eventType][i].subscriber)    // Don't trouble player with own joinage or leavage!
          continue;
 
@@ -402,12 +447,14 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, Zone *zone)
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       try   
       {
          // Passing ship, zone, zoneType, zoneId
@@ -434,12 +481,14 @@ void EventManager::fireEvent(EventType eventType, MoveObject *object, Zone *zone
    if(suppressEvents(eventType))   
       return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       try   
       {
          // Passing object, zone, zoneType, zoneId
@@ -466,12 +515,14 @@ void EventManager::fireEvent(EventType eventType, S32 score, S32 team, LuaPlayer
    if(suppressEvents(eventType))
          return;
 
-   lua_State *L = LuaScriptRunner::getL();
-
-   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
-
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(!isInCurrentArena(subscriptions[eventType][i]))
+         continue;
+
+      lua_State *L = subscriptions[eventType][i].subscriber->getLuaState();    // Bots may have states of their own
+      TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
       lua_pushinteger(L, score);   // -- score
       lua_pushinteger(L, team);    // -- score, team
 
@@ -485,6 +536,15 @@ void EventManager::fireEvent(EventType eventType, S32 score, S32 team, LuaPlayer
 }
 
 
+// With several arenas hosted in one process, every script still shares our subscription lists; only
+// those running in the arena currently being ticked should hear about its events
+bool EventManager::isInCurrentArena(const Subscription &subscription)
+{
+   return GameManager::getServerGameCount() <= 1 ||
+          subscription.subscriber->getLuaGame() == GameManager::getServerGame();
+}
+
+
 // Actually fire the event, called by one of the fireEvent() methods above
 // Returns true if there was an error, false if everything ran ok
 bool EventManager::fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context)
@@ -82,6 +82,7 @@ private:
 
    void handleEventFiringError(lua_State *L, const Subscription &subscriber, EventType eventType, const char *errorMsg);
    bool fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context);
+   static bool isInCurrentArena(const Subscription &subscription);
       
    bool mIsPaused;
    S32 mStepCount;           // If running for a certain number of steps, this will be > 0, while mIsPaused will be true
@@ -352,7 +352,7 @@ BfFont *FontManager::getFont(FontId currentFontId)
    if(mUsingExternalFonts || currentFontId < FirstExternalFont)
       font = fontList[currentFontId];
    else
-     font = fontList[FontDefault];
+     font = fontList[FontRoman];
 
    TNLAssert(font, "Font is NULL... Did the FontManager get initialized?");
 
@@ -6,6 +6,8 @@
 #include "GameManager.h"
 
 #include "ServerGame.h"
+#include "TickScheduler.h"
+#include "gameNetInterface.h"
 
 #ifndef ZAP_DEDICATED
 #  include "UIErrorMessage.h"
@@ -19,6 +21,9 @@ namespace Zap
 
 // Declare statics
 ServerGame *GameManager::mServerGame = NULL;
+Vector<ServerGame *> GameManager::mServerGames;
+U32 GameManager::mArenaStatsTime = 0;
+TickScheduler GameManager::mTickScheduler;
 #ifndef ZAP_DEDICATED
    Vector<ClientGame *> GameManager::mClientGames;
 #endif
@@ -51,21 +56,174 @@ void GameManager::setServerGame(ServerGame *serverGame)
    TNLAssert(!mServerGame, "Already have a ServerGame!");
 
    mServerGame = serverGame;
+   mServerGames.push_back(serverGame);
+}
+
+
+void GameManager::addServerGame(ServerGame *serverGame)
+{
+   TNLAssert(serverGame, "Expect a valid serverGame here!");
+   TNLAssert(mServerGame, "Use setServerGame() for the first arena!");
+
+   mServerGames.push_back(serverGame);
+}
+
+
+const Vector<ServerGame *> *GameManager::getServerGames()
+{
+   return &mServerGames;
+}
+
+
+S32 GameManager::getServerGameCount()
+{
+   return mServerGames.size();
+}
+
+
+// Objects created without a game in mind (by levelgens, mostly) go to the add target, so it has to follow us
+// from arena to arena
+void GameManager::setCurrentServerGame(ServerGame *serverGame)
+{
+   TNLAssert(mServerGames.contains(serverGame), "Not one of our arenas!");
+
+   mServerGame = serverGame;
+
+   if(mServerGames.size() > 1)
+      mServerGame->setAddTarget();
 }
 
 
 void GameManager::deleteServerGame()
 {
    // mServerGame might be NULL here; for example when quitting after losing a connection to the game server
-   delete mServerGame;     // Kill the serverGame (leaving the clients running)
+   mServerGames.deleteAndClear();   // Kill the serverGames (leaving the clients running)
    mServerGame = NULL;
 }
 
 
+void GameManager::deleteServerGame(ServerGame *serverGame)
+{
+   S32 index = mServerGames.getIndex(serverGame);
+   TNLAssert(index != -1, "Not one of our arenas!");
+
+   mServerGames.deleteAndErase(index);
+
+   if(mServerGame == serverGame)
+      mServerGame = NULL;
+
+   if(mServerGames.size() > 0)
+      setCurrentServerGame(mServerGames[0]);
+}
+
+
 void GameManager::idleServerGame(U32 timeDelta)
 {
-   if(mServerGame)
-      mServerGame->idle(timeDelta);
+   for(S32 i = 0; i < mServerGames.size(); i++)
+   {
+      setCurrentServerGame(mServerGames[i]);
+
+      S64 startTime = Platform::getHighPrecisionTimerValue();
+      mServerGames[i]->idle(timeDelta);
+      mServerGames[i]->recordTick(Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime));
+   }
+
+   if(mServerGames.size() > 0)
+      setCurrentServerGame(mServerGames[0]);
+
+   mArenaStatsTime += timeDelta;
+   if(mArenaStatsTime >= ArenaStatsInterval)
+   {
+      if(mServerGames.size() > 1)
+         logArenaStats();
+
+      if(mTickScheduler.getTickCount() > 0)     // Only in use on dedicated servers
+         logTickStats();
+
+      mArenaStatsTime = 0;
+   }
+}
+
+
+void GameManager::logArenaStats()
+{
+   for(S32 i = 0; i < mServerGames.size(); i++)
+   {
+      ServerGame *arena = mServerGames[i];
+
+      logprintf(LogConsumer::ServerFilter, "Arena %d [%s]: %d players, %d ticks, %.3f ms/tick average, %.3f ms max", i + 1,
+                arena->getNetInterface()->getFirstBoundInterfaceAddress().toString(), arena->getPlayerCount(),
+                arena->getTickCount(), arena->getAverageTickTime(), arena->getMaxTickTime());
+
+      arena->resetTickStats();
+   }
+}
+
+
+void GameManager::logTickStats()
+{
+   logprintf(LogConsumer::ServerFilter, "Server ticks: %d at %d ms intervals, %.2f ms late on average, %d ms max",
+             mTickScheduler.getTickCount(), mTickScheduler.getPeriod(), mTickScheduler.getAverageJitter(),
+             mTickScheduler.getMaxJitter());
+
+   mTickScheduler.resetStats();
+}
+
+
+TickScheduler *GameManager::getTickScheduler()
+{
+   return &mTickScheduler;
+}
+
+
+// Sleeps until a packet arrives on one of the arenas' sockets, or until maxWait has passed... but
+// wakes up earlier if any arena has a packet to send before then.  Returns true if there are
+// packets waiting to be read.
+bool GameManager::waitForIncomingPackets(U32 maxWait)
+{
+   Vector<Socket *> sockets(mServerGames.size());
+   U32 wait = maxWait;
+
+   for(S32 i = 0; i < mServerGames.size(); i++)
+   {
+      GameNetInterface *netInterface = mServerGames[i]->getNetInterface();
+
+      sockets.push_back(&netInterface->getSocket());
+      wait = netInterface->getTimeToNextProcess(wait);
+   }
+
+   return Socket::waitForRead(sockets.address(), sockets.size(), wait);
+}
+
+
+void GameManager::checkIncomingPackets()
+{
+   for(S32 i = 0; i < mServerGames.size(); i++)
+   {
+      setCurrentServerGame(mServerGames[i]);
+      mServerGames[i]->getNetInterface()->checkIncomingPackets();
+   }
+
+   if(mServerGames.size() > 0)
+      setCurrentServerGame(mServerGames[0]);
+}
+
+
+void GameManager::processDueConnections()
+{
+   for(S32 i = 0; i < mServerGames.size(); i++)
+   {
+      GameNetInterface *netInterface = mServerGames[i]->getNetInterface();
+
+      if(netInterface->getTimeToNextProcess(1) == 0)
+      {
+         setCurrentServerGame(mServerGames[i]);
+         netInterface->processConnections();
+      }
+   }
+
+   if(mServerGames.size() > 0)
+      setCurrentServerGame(mServerGames[0]);
 }
 
 
@@ -14,6 +14,7 @@ namespace Zap
 {
 
 class ServerGame;
+class TickScheduler;
 #ifndef ZAP_DEDICATED
 class ClientGame;
 #endif
@@ -31,7 +32,10 @@ public:
    };
 
 private:
-   static ServerGame *mServerGame;
+   static ServerGame *mServerGame;              // Arena currently being worked on -- the only one unless we're hosting several
+   static Vector<ServerGame *> mServerGames;    // All arenas hosted by this process, each with its own port
+   static U32 mArenaStatsTime;                  // Time since arena tick stats were last logged
+   static TickScheduler mTickScheduler;         // Paces server ticks on a dedicated server
 #ifndef ZAP_DEDICATED
    static Vector<ClientGame *> mClientGames;
 #endif
@@ -42,11 +46,26 @@ public:
    GameManager();
    virtual ~GameManager();
 
+   static const U32 ArenaStatsInterval = 5 * 60 * 1000;     // How often to log arena tick stats, in ms
+
    // ServerGame related
    static void setServerGame(ServerGame *serverGame);
+   static void addServerGame(ServerGame *serverGame);          // Host an additional arena in this process
    static ServerGame *getServerGame();
-   static void deleteServerGame();
+   static const Vector<ServerGame *> *getServerGames();
+   static S32 getServerGameCount();
+   static void setCurrentServerGame(ServerGame *serverGame);   // Point getServerGame() at the arena we're about to work on
+   static void deleteServerGame();                             // Delete all arenas
+   static void deleteServerGame(ServerGame *serverGame);       // Delete a single arena
    static void idleServerGame(U32 timeDelta);
+   static void logArenaStats();
+
+   // Dedicated server main loop
+   static TickScheduler *getTickScheduler();
+   static bool waitForIncomingPackets(U32 maxWait);   // Block until a packet arrives or connections need servicing
+   static void checkIncomingPackets();                // Handle packets waiting on any arena
+   static void processDueConnections();               // Send whatever packets are due on any arena
+   static void logTickStats();
 
    // ClientGame related
 #ifndef ZAP_DEDICATED
@@ -85,6 +85,7 @@ ParamInfo paramDefs[] = {
 { "hostdescr",             ONE_REQUIRED,   HOST_DESCRIPTION,      1, "<string>",  "Set a brief description of the server, which will be visible when players browse for game servers. Use double quotes (\") for descriptions containing spaces.", "You must specify a description (use quotes) with the -hostdescr option" },
 { "maxplayers",            ONE_REQUIRED,   MAX_PLAYERS_PARAM,     1, "<int>",     "Max players allowed in a game (default is 128)", "You must specify the max number of players on your server with the -maxplayers option" }, 
 { "hostaddr",              ONE_REQUIRED,   HOST_ADDRESS,          1, "<address>", "Specify host address for the server to listen to when hosting",                        "You must specify a host address for the host to listen on (e.g. IP:Any:28000 or IP:192.169.1.100:5500)" },
+{ "arenas",                ONE_REQUIRED,   ARENA_COUNT,           1, "<int>",     "Host this many independent games from one dedicated server process, on consecutive ports starting with the one given by -hostaddr (default is 1)", "You must specify the number of arenas with the -arenas option" },
 
 // Specifying levels
 { "levels",                ALL_REMAINING,  LEVEL_LIST,            2, "<level 1> [level 2]...", "Specify the levels to play. Note that all remaining items on the command line will be interpreted as levels, so this must be the last parameter.", "You must specify one or more levels to load with the -levels option" },
@@ -410,6 +411,16 @@ U32 GameSettings::getMaxPlayers()
 }
 
 
+// Number of arenas a dedicated server should host; each is a complete game with its own port and players
+S32 GameSettings::getArenaCount()
+{
+   if(!isDedicatedServer() || getSpecified(HOST_ON_DEDICATED))
+      return 1;
+
+   return max(1, min((S32)getU32(ARENA_COUNT), (S32)MAX_ARENAS));
+}
+
+
 // Write all our settings to bitfighter.ini
 void GameSettings::save()
 {
@@ -47,6 +47,7 @@ enum ParamId {
    HOST_DESCRIPTION,
    MAX_PLAYERS_PARAM,
    HOST_ADDRESS,
+   ARENA_COUNT,
 
    LEVEL_LIST,
    USE_FILE,
@@ -162,6 +163,7 @@ public:
    static const S32 LoadoutPresetCount = 3;     // How many presets do we save?
 
    static const U16 DEFAULT_GAME_PORT = 28000;
+   static const S32 MAX_ARENAS = 32;      // Most arenas one dedicated server process will host
 
 
    void readCmdLineParams(const Vector<string> &argv);
@@ -218,6 +220,7 @@ public:
 
    string getHostAddress();
    U32 getMaxPlayers();
+   S32 getArenaCount();
 
    void save();
 
@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelPreloadThread.h"
+
+#include "md5wrapper.h"
+#include "stringUtils.h"
+
+using namespace std;
+
+namespace Zap
+{
+
+// Constructor
+LevelPreloadThread::LevelPreloadThread(const LevelSourcePtr &levelSource, S32 levelIndex, const string &filename)
+{
+   mLevelSource = levelSource;
+   mLevelIndex = levelIndex;
+   mFilename = filename;
+}
+
+
+// Destructor
+LevelPreloadThread::~LevelPreloadThread()
+{
+   // Do nothing
+}
+
+
+// Runs on the secondary thread -- don't touch the game or the LevelSource from here!
+void LevelPreloadThread::run()
+{
+   // Read and hash the file as it is on disk in a single pass, then strip the UTF-8 BOM like readFile() does
+   md5wrapper md5;
+   mHash = md5.getHashFromFile(mFilename, mContents);
+
+   if(mContents.empty())
+   {
+      mHash = "";
+      return;
+   }
+
+   trim_left_in_place(mContents, "\357\273\277");
+}
+
+
+void LevelPreloadThread::finish()
+{
+   if(mHash != "")
+      mLevelSource->setPreloadedLevel(mLevelIndex, mFilename, mContents, mHash);
+}
+
+
+} /* namespace Zap */
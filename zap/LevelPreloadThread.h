@@ -0,0 +1,38 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_PRELOAD_THREAD_H_
+#define _LEVEL_PRELOAD_THREAD_H_
+
+#include "LevelSource.h"
+#include "../master/DatabaseAccessThread.h"
+
+#include <string>
+
+namespace Zap
+{
+
+// Reads and hashes a level file on the secondary thread, so the server doesn't have to hit the disk
+// when it switches to that level.  The results are handed to the LevelSource on the game thread.
+class LevelPreloadThread : public Master::ThreadEntry
+{
+private:
+   LevelSourcePtr mLevelSource;
+   S32 mLevelIndex;
+   string mFilename;
+
+   string mContents;
+   string mHash;
+
+public:
+   LevelPreloadThread(const LevelSourcePtr &levelSource, S32 levelIndex, const string &filename);   // Constructor
+   virtual ~LevelPreloadThread();                                                                      // Destructor
+
+   void run();
+   void finish();
+};
+
+} /* namespace Zap */
+#endif /* _LEVEL_PRELOAD_THREAD_H_ */
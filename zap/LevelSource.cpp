@@ -13,6 +13,10 @@
 #include "stringUtils.h"
 
 #include "tnlAssert.h"
+#include "tnlThread.h"
+
+#include <map>
+#include <sys/stat.h>
 
 
 namespace Zap
@@ -84,11 +88,15 @@ void LevelInfo::ensureLevelInfoHasValidName()
 // Statics
 const string LevelSource::TestFileName = "editor.tmp";
 
+static const string LevelIndexFilename = "levelinfo.index";    // Lives in the cache folder
+static const string LevelIndexVersion = "BitfighterLevelIndex 1";
+static const U32 LevelHeaderThreads = 4;                         // Plus the calling thread
+
 
 // Constructor
 LevelSource::LevelSource()
 {
-   // Do nothing
+   mPreloadedIndex = -1;
 }
 
 
@@ -114,8 +122,17 @@ LevelInfo LevelSource::getLevelInfo(S32 index)
 // Parse through the chunk of data passed in and find parameters to populate levelInfo with
 // This is only used on the server to provide quick level information without having to load the level
 // (like with playlists or menus)
-// Warning: Mungs chunk!
 void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &levelInfo)
+{
+   LevelHeader header;
+   parseLevelHeader(chunk, size, header);
+   applyLevelHeader(header, levelInfo);
+}
+
+
+// Find the parameters we care about in the chunk of level code passed in.  Only touches header, so it's fine
+// to call from any thread.
+void LevelSource::parseLevelHeader(const char *chunk, S32 size, LevelHeader &header)
 {
    S32 cur = 0;
    S32 startingCur = 0;
@@ -132,24 +149,12 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
       {
          if(cur - startingCur > 5)
          {
-            char c = chunk[cur];
-            chunk[cur] = 0;
-            Vector<string> list = parseString(&chunk[startingCur]);
-            chunk[cur] = c;
+            Vector<string> list = parseString(string(&chunk[startingCur], cur - startingCur));
 
             if(list.size() >= 1 && list[0].find("GameType") != string::npos)
             {
-               // validateGameType() will return a valid GameType string -- either what's passed in, or the default if something bogus was specified
-               TNL::Object *theObject = TNL::Object::create(GameType::validateGameType(list[0].c_str()));
-
-               GameType *gt = dynamic_cast<GameType *>(theObject); 
-               if(gt)
-               {
-                  levelInfo.mLevelType = gt->getGameTypeId();
-                  foundGameType = true;
-               }
-
-               delete theObject;
+               header.gameType = list[0];
+               foundGameType = true;
             }
             else if(list.size() >= 2 && list[0] == "LevelName")
             {
@@ -159,23 +164,23 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
                for(S32 i = 2; i < list.size(); i++)   
                   levelName += " " + list[i];
 
-               levelInfo.mLevelName = levelName;
+               header.levelName = levelName;
 
                foundLevelName = true;
             }
             else if(list.size() >= 2 && list[0] == "MinPlayers")
             {
-               levelInfo.minRecPlayers = atoi(list[1].c_str());
+               header.minPlayers = list[1];
                foundMinPlayers = true;
             }
             else if(list.size() >= 2 && list[0] == "MaxPlayers")
             {
-               levelInfo.maxRecPlayers = atoi(list[1].c_str());
+               header.maxPlayers = list[1];
                foundMaxPlayers = true;
             }
             else if(list.size() >= 2 && list[0] == "Script")
             {
-               levelInfo.mScriptFileName = list[1];
+               header.script = list[1];
                foundScriptFileName = true;
             }
          }
@@ -183,11 +188,315 @@ void LevelSource::getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &le
       }
       cur++;
    }
+}
+
+
+// Copy what we found in a level's header to its levelInfo
+void LevelSource::applyLevelHeader(const LevelHeader &header, LevelInfo &levelInfo)
+{
+   if(header.gameType != "")
+   {
+      // validateGameType() will return a valid GameType string -- either what's passed in, or the default if something bogus was specified
+      TNL::Object *theObject = TNL::Object::create(GameType::validateGameType(header.gameType.c_str()));
+
+      GameType *gt = dynamic_cast<GameType *>(theObject); 
+      if(gt)
+         levelInfo.mLevelType = gt->getGameTypeId();
+
+      delete theObject;
+   }
+
+   if(header.levelName != "")
+      levelInfo.mLevelName = header.levelName;
+
+   if(header.minPlayers != "")
+      levelInfo.minRecPlayers = atoi(header.minPlayers.c_str());
+
+   if(header.maxPlayers != "")
+      levelInfo.maxRecPlayers = atoi(header.maxPlayers.c_str());
+
+   if(header.script != "")
+      levelInfo.mScriptFileName = header.script;
 
    levelInfo.ensureLevelInfoHasValidName();
 }
 
 
+// Reads 4kb of file and finds level's parameters there.  Returns false if file couldn't be read.
+bool LevelSource::readLevelHeader(const string &fullFilename, LevelHeader &header)
+{
+   struct stat st;
+   if(stat(fullFilename.c_str(), &st) == 0)
+   {
+      header.fileTime = st.st_mtime;
+      header.fileSize = st.st_size;
+   }
+
+   FILE *f = fopen(fullFilename.c_str(), "rb");
+   if(!f)
+      return false;
+
+   char data[1024 * 4];  // 4 kb should be enough to fit all parameters at the beginning of level; we don't need to read everything
+   S32 size = (S32)fread(data, 1, sizeof(data), f);
+   fclose(f);
+
+   parseLevelHeader(data, size, header);
+   header.found = true;
+
+   return true;
+}
+
+
+// Constructor
+LevelHeader::LevelHeader()
+{
+   found = false;
+   fileTime = 0;
+   fileSize = -1;
+}
+
+
+typedef map<string, LevelHeader> LevelIndex;
+
+
+// Can't use parseString() for the index; it drops blank fields, and limits word length
+static Vector<string> splitIndexLine(const string &line, char separator)
+{
+   Vector<string> fields;
+   size_t start = 0;
+   size_t end;
+
+   while((end = line.find(separator, start)) != string::npos)
+   {
+      fields.push_back(line.substr(start, end - start));
+      start = end + 1;
+   }
+
+   fields.push_back(line.substr(start));
+
+   return fields;
+}
+
+// Index of headers we read last time, so we only need to read files that have changed since.  One level per line,
+// tab separated: filename, time, size, then the values from the header.
+static void readLevelIndex(const string &indexFilename, LevelIndex &index)
+{
+   string contents = readFile(indexFilename);
+
+   Vector<string> lines = splitIndexLine(contents, '\n');
+
+   if(lines[0] != LevelIndexVersion)
+      return;
+
+   for(S32 i = 1; i < lines.size(); i++)
+   {
+      Vector<string> fields = splitIndexLine(lines[i], '\t');
+
+      if(fields.size() != 8)
+         continue;
+
+      LevelHeader header;
+      header.found      = true;
+      header.fileTime   = atoll(fields[1].c_str());
+      header.fileSize   = atoll(fields[2].c_str());
+      header.gameType   = fields[3];
+      header.levelName  = fields[4];
+      header.minPlayers = fields[5];
+      header.maxPlayers = fields[6];
+      header.script     = fields[7];
+
+      index[fields[0]] = header;
+   }
+}
+
+
+static void writeLevelIndex(const string &indexFilename, const LevelIndex &index)
+{
+   string contents = LevelIndexVersion + "\n";
+
+   for(LevelIndex::const_iterator it = index.begin(); it != index.end(); it++)
+   {
+      const LevelHeader &header = it->second;
+
+      string line = it->first                   + "\t" + 
+                    itos(header.fileTime)       + "\t" + 
+                    itos(header.fileSize)       + "\t" + 
+                    header.gameType             + "\t" + 
+                    header.levelName            + "\t" + 
+                    header.minPlayers           + "\t" + 
+                    header.maxPlayers           + "\t" + 
+                    header.script;
+
+      if(line.find_first_of("\r\n") == string::npos && it->first.find('\t') == string::npos)   // Weird filename... just read it every time
+         contents += line + "\n";
+   }
+
+   makeSureFolderExists(extractDirectory(indexFilename));
+
+   // Write to a temp file and move it into place, so a server starting at the same time never sees half an index
+   string tempFilename = indexFilename + ".tmp";
+
+   if(writeFile(tempFilename, contents))
+   {
+      remove(indexFilename.c_str());    // Rename won't replace an existing file on Windows
+      rename(tempFilename.c_str(), indexFilename.c_str());
+   }
+}
+
+
+// Hands out level files to worker threads.  Each header is only written by the thread that claimed it.
+class LevelHeaderReader
+{
+   class WorkerThread : public Thread
+   {
+      LevelHeaderReader *mReader;
+   public:
+      WorkerThread(LevelHeaderReader *reader) { mReader = reader; }
+      U32 run();
+   };
+
+   const Vector<string> &mFilenames;
+   Vector<LevelHeader> &mHeaders;
+   const LevelIndex &mIndex;
+
+   Mutex mLock;                  // Guards mNextIndex
+   S32 mNextIndex;
+   Semaphore mDoneSemaphore;     // Incremented by each worker when it runs out of files
+
+public:
+   LevelHeaderReader(const Vector<string> &filenames, Vector<LevelHeader> &headers, const LevelIndex &index);
+
+   void readHeaders();
+   void run(U32 threadCount);
+};
+
+
+U32 LevelHeaderReader::WorkerThread::run()
+{
+   mReader->readHeaders();
+   mReader->mDoneSemaphore.increment();
+   return 0;
+}
+
+
+LevelHeaderReader::LevelHeaderReader(const Vector<string> &filenames, Vector<LevelHeader> &headers, const LevelIndex &index) :
+   mFilenames(filenames), mHeaders(headers), mIndex(index), mNextIndex(0)
+{
+   // Do nothing
+}
+
+
+void LevelHeaderReader::readHeaders()
+{
+   for(;;)
+   {
+      mLock.lock();
+      S32 i = mNextIndex++;
+      mLock.unlock();
+
+      if(i >= mFilenames.size())
+         return;
+
+      const string &filename = mFilenames[i];
+      if(filename == "")
+         continue;
+
+      // Use the indexed header if the file hasn't changed
+      LevelIndex::const_iterator it = mIndex.find(filename);
+
+      struct stat st;
+      if(it != mIndex.end() && stat(filename.c_str(), &st) == 0 && 
+            it->second.fileTime == (S64)st.st_mtime && it->second.fileSize == (S64)st.st_size)
+         mHeaders[i] = it->second;
+      else
+         LevelSource::readLevelHeader(filename, mHeaders[i]);
+   }
+}
+
+
+// Reads all the headers, using threadCount workers plus the calling thread; returns when they're all done
+void LevelHeaderReader::run(U32 threadCount)
+{
+   Vector<WorkerThread *> threads;
+
+   // Not worth starting threads for a handful of files
+   if(mFilenames.size() < 16)
+      threadCount = 0;
+
+   for(U32 i = 0; i < threadCount; i++)
+   {
+      WorkerThread *thread = new WorkerThread(this);
+      if(!thread->start())
+      {
+         delete thread;
+         break;
+      }
+      threads.push_back(thread);
+   }
+
+   readHeaders();
+
+   for(S32 i = 0; i < threads.size(); i++)
+      mDoneSemaphore.wait();
+
+   for(S32 i = 0; i < threads.size(); i++)
+      delete threads[i];
+}
+
+
+// Read headers of all the files in fullFilenames, in parallel.  headers will line up with fullFilenames; blank filenames
+// and files that couldn't be read get headers with found == false.  If indexFilename is given, files that haven't changed
+// since the index was written aren't read at all, and the index is updated afterwards.
+void LevelSource::readLevelHeaders(const Vector<string> &fullFilenames, Vector<LevelHeader> &headers, const string &indexFilename)
+{
+   LevelIndex index;
+
+   if(indexFilename != "")
+      readLevelIndex(indexFilename, index);
+
+   headers.clear();
+   headers.resize(fullFilenames.size());
+
+   LevelHeaderReader reader(fullFilenames, headers, index);
+
+#ifdef TNL_NO_THREADS
+   reader.run(0);
+#else
+   reader.run(LevelHeaderThreads);
+#endif
+
+   if(indexFilename == "")
+      return;
+
+   bool changed = false;
+
+   for(S32 i = 0; i < fullFilenames.size(); i++)
+   {
+      if(fullFilenames[i] == "")
+         continue;
+
+      LevelIndex::iterator it = index.find(fullFilenames[i]);
+
+      if(!headers[i].found)
+      {
+         if(it != index.end())
+         {
+            index.erase(it);
+            changed = true;
+         }
+      }
+      else if(it == index.end() || it->second.fileTime != headers[i].fileTime || it->second.fileSize != headers[i].fileSize)
+      {
+         index[fullFilenames[i]] = headers[i];
+         changed = true;
+      }
+   }
+
+   if(changed)
+      writeLevelIndex(indexFilename, index);
+}
+
+
 // User has uploaded a file and wants to add it to the current playlist
 pair<S32, bool> LevelSource::addLevel(LevelInfo levelInfo)
 {
@@ -231,6 +540,49 @@ void LevelSource::setLevelFileName(S32 index, const string &filename)
 }
 
 
+string LevelSource::getLevelFilePath(S32 index)
+{
+   return "";
+}
+
+
+// Called with the contents of the level we expect to load next, so loadLevel can skip the disk
+void LevelSource::setPreloadedLevel(S32 index, const string &filename, const string &contents, const string &hash)
+{
+   mPreloadedIndex = index;
+   mPreloadedFilename = filename;
+   mPreloadedContents = contents;
+   mPreloadedHash = hash;
+}
+
+
+void LevelSource::clearPreloadedLevel()
+{
+   mPreloadedIndex = -1;
+   mPreloadedFilename.clear();
+   mPreloadedContents.clear();
+   mPreloadedHash.clear();
+}
+
+
+// If we've preloaded the specified level, hand over its contents and hash and return true.  Either way, the
+// preload is used up.
+bool LevelSource::takePreloadedLevel(S32 index, const string &filename, string &contents, string &hash)
+{
+   bool found = mPreloadedIndex == index && mPreloadedFilename == filename && mPreloadedHash != "";
+
+   if(found)
+   {
+      contents.swap(mPreloadedContents);
+      hash.swap(mPreloadedHash);
+   }
+
+   clearPreloadedLevel();
+
+   return found;
+}
+
+
 GameTypeId LevelSource::getLevelType(S32 index)
 {
    return mLevelInfos[index].mLevelType;
@@ -274,6 +626,17 @@ bool LevelSource::loadLevels(FolderManager *folderManager)
 }
 
 
+// One level at a time; MultiLevelSource knows a faster way
+void LevelSource::populateLevelInfosFromSource(const Vector<string> &fullFilenames)
+{
+   TNLAssert(fullFilenames.size() == mLevelInfos.size(), "Need one filename per level!");
+
+   for(S32 i = mLevelInfos.size() - 1; i >= 0; i--)
+      if(!populateLevelInfoFromSource(fullFilenames[i], mLevelInfos[i]))
+         mLevelInfos.erase(i);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -293,22 +656,14 @@ MultiLevelSource::~MultiLevelSource()
 // Populate all our levelInfos from disk; return true if we managed to load any, false otherwise
 bool MultiLevelSource::loadLevels(FolderManager *folderManager)
 {
-   bool anyLoaded = false;
+   Vector<string> filenames(mLevelInfos.size());
 
    for(S32 i = 0; i < mLevelInfos.size(); i++)
-   {
-      string filename = folderManager->findLevelFile(mLevelInfos[i].folder, mLevelInfos[i].filename);
+      filenames.push_back(folderManager->findLevelFile(mLevelInfos[i].folder, mLevelInfos[i].filename));
 
-      if(Parent::populateLevelInfoFromSource(filename, i))
-         anyLoaded = true;
-      else
-      {
-         mLevelInfos.erase(i);
-         i--;
-      }
-   }
+   populateLevelInfosFromSource(filenames);
 
-   return anyLoaded;
+   return mLevelInfos.size() > 0;
 }
 
 
@@ -319,7 +674,7 @@ string MultiLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObje
 
    LevelInfo *levelInfo = &mLevelInfos[index];
 
-   string filename = FolderManager::findLevelFile(levelInfo->folder, levelInfo->filename);
+   string filename = getLevelFilePath(index);
 
    if(filename == "")
    {
@@ -327,8 +682,16 @@ string MultiLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObje
       return "";
    }
 
-   if(game->loadLevelFromFile(filename, gameObjectDatabase))
-      return Game::md5.getHashFromFile(filename);    // TODO: Combine this with the reading of the file we're doing anyway in initLevelFromFile()
+   // Use the copy read by the secondary thread while the last game was ending, if we have it
+   string contents, hash;
+   if(takePreloadedLevel(index, filename, contents, hash))
+   {
+      game->loadLevelFromString(contents, gameObjectDatabase, filename);
+      return hash;
+   }
+
+   if(game->loadLevelFromFile(filename, gameObjectDatabase, &hash))
+      return hash;
    else
    {
       logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
@@ -337,6 +700,12 @@ string MultiLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObje
 }
 
 
+string MultiLevelSource::getLevelFilePath(S32 index)
+{
+   return FolderManager::findLevelFile(mLevelInfos[index].folder, mLevelInfos[index].filename);
+}
+
+
 // Returns a textual level descriptor good for logging and error messages and such
 string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 {
@@ -348,17 +717,11 @@ string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 // Reads 4kb of file and uses what it finds there to populate the levelInfo
 bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo)
 {
-   FILE *f = fopen(fullFilename.c_str(), "rb");
-   if(f)
-   {
-      char data[1024 * 4];  // 4 kb should be enough to fit all parameters at the beginning of level; we don't need to read everything
-      S32 size = (S32)fread(data, 1, sizeof(data), f);
-      fclose(f);
-
-       getLevelInfoFromCodeChunk(data, size, levelInfo);     // Fills levelInfo with data from file
-
-      levelInfo.ensureLevelInfoHasValidName();
+   LevelHeader header;
 
+   if(readLevelHeader(fullFilename, header))
+   {
+      applyLevelHeader(header, levelInfo);     // Fills levelInfo with data from file
       return true;
    }
    else
@@ -370,6 +733,32 @@ bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, L
 }
 
 
+// Read all our level files' headers at once, on several threads, then fill in the levelInfos in order
+void MultiLevelSource::populateLevelInfosFromSource(const Vector<string> &fullFilenames)
+{
+   TNLAssert(fullFilenames.size() == mLevelInfos.size(), "Need one filename per level!");
+
+   const string &cacheDir = GameSettings::getFolderManager()->cacheDir;
+   string indexFilename = cacheDir == "" ? "" : joindir(cacheDir, LevelIndexFilename);
+
+   Vector<LevelHeader> headers;
+   readLevelHeaders(fullFilenames, headers, indexFilename);
+
+   // Go backwards so removing levels doesn't upset our indices
+   for(S32 i = mLevelInfos.size() - 1; i >= 0; i--)
+   {
+      if(headers[i].found)
+         applyLevelHeader(headers[i], mLevelInfos[i]);
+      else
+      {
+         logprintf(LogConsumer::LogWarning, "Could not load level %s [%s]... Skipping...",
+                                             mLevelInfos[i].filename.c_str(), fullFilenames[i].c_str());
+         mLevelInfos.erase(i);
+      }
+   }
+}
+
+
 bool MultiLevelSource::isEmptyLevelDirOk() const
 {
    return false;
@@ -413,28 +802,9 @@ FileListLevelSource::~FileListLevelSource()
 }
 
 
-// Load specified level, put results in gameObjectDatabase.  Return md5 hash of level.
-string FileListLevelSource::loadLevel(S32 index, Game *game, GridDatabase *gameObjectDatabase)
+string FileListLevelSource::getLevelFilePath(S32 index)
 {
-   TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
-
-   LevelInfo *levelInfo = &mLevelInfos[index];
-
-   string filename = FolderManager::findLevelFile(GameSettings::getFolderManager()->levelDir, levelInfo->filename);
-
-   if(filename == "")
-   {
-      logprintf("Unable to find level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return "";
-   }
-
-   if(game->loadLevelFromFile(filename, gameObjectDatabase))
-      return Game::md5.getHashFromFile(filename);   
-   else
-   {
-      logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return "";
-   }
+   return FolderManager::findLevelFile(GameSettings::getFolderManager()->levelDir, mLevelInfos[index].filename);
 }
 
 
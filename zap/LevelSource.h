@@ -51,6 +51,27 @@ public:
 };
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Raw values found at the top of a level file.  Unlike LevelInfo, these are plain strings, so headers can be
+// read and parsed on any thread.  Values left blank were not found in the file.
+struct LevelHeader
+{
+   LevelHeader();    // Constructor
+
+   bool found;       // False if file could not be read
+   S64 fileTime;     // File's modification time and size, so we can tell if an indexed header is still good
+   S64 fileSize;
+
+   string gameType;
+   string levelName;
+   string minPlayers;
+   string maxPlayers;
+   string script;
+};
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -64,6 +85,14 @@ class LevelSource
 protected:
    Vector<LevelInfo> mLevelInfos;   // Info about these levels
 
+   // Contents of the next level's file, read ahead of time by a LevelPreloadThread
+   S32 mPreloadedIndex;
+   string mPreloadedFilename;
+   string mPreloadedContents;
+   string mPreloadedHash;
+
+   bool takePreloadedLevel(S32 index, const string &filename, string &contents, string &hash);
+
 public:
    static const string TestFileName;
 
@@ -89,11 +118,23 @@ public:
    virtual bool loadLevels(FolderManager *folderManager);
    virtual string getLevelFileDescriptor(S32 index) const = 0;
    virtual bool isEmptyLevelDirOk() const = 0;
+   virtual string getLevelFilePath(S32 index);     // Full path of level's file, or "" if it doesn't come from a file
+
+   void setPreloadedLevel(S32 index, const string &filename, const string &contents, const string &hash);
+   void clearPreloadedLevel();
 
    bool populateLevelInfoFromSource(const string &sourceName, S32 levelInfoIndex);
 
+   // Populate all our levelInfos, one filename per level; levels that can't be read are removed
+   virtual void populateLevelInfosFromSource(const Vector<string> &fullFilenames);
+
    static Vector<string> findAllLevelFilesInFolder(const string &levelDir);
    static void getLevelInfoFromCodeChunk(char *chunk, S32 size, LevelInfo &levelInfo);     // Populates levelInfo
+
+   static void parseLevelHeader(const char *chunk, S32 size, LevelHeader &header);          // Thread safe
+   static void applyLevelHeader(const LevelHeader &header, LevelInfo &levelInfo);
+   static bool readLevelHeader(const string &fullFilename, LevelHeader &header);            // Thread safe
+   static void readLevelHeaders(const Vector<string> &fullFilenames, Vector<LevelHeader> &headers, const string &indexFilename);
 };
 
 
@@ -113,8 +154,10 @@ public:
    string loadLevel(S32 index, Game *game, GridDatabase *gameObjDatabase);
    string getLevelFileDescriptor(S32 index) const;
    bool isEmptyLevelDirOk() const;
+   string getLevelFilePath(S32 index);
 
    bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo);
+   void populateLevelInfosFromSource(const Vector<string> &fullFilenames);
 };
 
 
@@ -148,7 +191,7 @@ public:
    FileListLevelSource(const Vector<string> &levelList, const string &folder);     // Constructor
    virtual ~FileListLevelSource();                                                                                                                // Destructor
 
-   string loadLevel(S32 index, Game *game, GridDatabase *gameObjDatabase);
+   string getLevelFilePath(S32 index);
 
    static Vector<string> findAllFilesInPlaylist(const string &fileName, const string &levelDir);
 };
@@ -19,6 +19,74 @@ namespace Zap
 
 using namespace LuaArgs;
 
+
+// Constructor
+LuaStateInfo::LuaStateInfo()
+{
+   defaultAlloc = NULL;
+   defaultAllocState = NULL;
+   allocatedBytes = 0;
+   methodCalls = 0;
+   runningScript = NULL;
+   watchdogVictim = NULL;
+   callStartTime = 0;
+   callInstructions = 0;
+   budgetVersion = 0;
+   threaded = false;
+   pool = NULL;
+   worker = 0;
+}
+
+
+static void *countingAlloc(void *ud, void *ptr, size_t oldSize, size_t newSize)
+{
+   LuaStateInfo *info = static_cast<LuaStateInfo *>(ud);
+
+   if(newSize > oldSize)
+      info->allocatedBytes += newSize - oldSize;
+
+   return info->defaultAlloc(info->defaultAllocState, ptr, oldSize, newSize);
+}
+
+
+lua_State *createLuaState(bool threaded)
+{
+   lua_State *L = lua_open();
+
+   if(!L)
+      return NULL;
+
+   // Count what scripts allocate.  We have to keep using Lua's own allocator underneath, as LuaJIT needs its
+   // memory to come from the low 2GB on x64.
+   LuaStateInfo *info = new LuaStateInfo();
+   info->defaultAlloc = lua_getallocf(L, &info->defaultAllocState);
+   info->threaded = threaded;
+
+   lua_setallocf(L, countingAlloc, info);
+
+   return L;
+}
+
+
+void closeLuaState(lua_State *L)
+{
+   LuaStateInfo *info = getLuaStateInfo(L);
+
+   lua_close(L);     // Still needs the info to free its memory
+   delete info;
+}
+
+
+LuaStateInfo *getLuaStateInfo(lua_State *L)
+{
+   void *ud;
+   if(lua_getallocf(L, &ud) != countingAlloc)
+      return NULL;
+
+   return static_cast<LuaStateInfo *>(ud);
+}
+
+
 // Make sure we got the number of args we wanted
 void checkArgCount(lua_State *L, S32 argsWanted, const char *methodName)
 {
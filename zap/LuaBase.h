@@ -36,6 +36,8 @@ class LuaPlayerInfo;
 class MenuItem;
 class BfObject;
 class ServerGame;
+class LuaScriptRunner;
+class BotThreadPool;
 struct LuaFunctionProfile;    // Defined below
 struct LuaFunctionArgList;    // Defined below
 
@@ -194,6 +196,37 @@ bool luaIsPoint(lua_State *L, S32 index);
 ScriptContext getScriptContext(lua_State *L);
 void setScriptContext(lua_State *L, ScriptContext context);
 
+/////
+// Per-state bookkeeping
+
+// What we keep track of for each lua_State we create.  It rides along as the userdata of the state's
+// allocator, so it can be found from the lua_State alone -- and states run on different threads never
+// share one.
+struct LuaStateInfo
+{
+   lua_Alloc defaultAlloc;             // Lua's own allocator, which we wrap to count allocations
+   void *defaultAllocState;
+   U64 allocatedBytes;
+
+   U32 methodCalls;                    // Running count of calls from scripts into our C++ methods, so they can be charged to the script that made them
+
+   LuaScriptRunner *runningScript;     // Script whose code is running right now, if any
+   LuaScriptRunner *watchdogVictim;    // Script being killed by the watchdog, if any
+   S64 callStartTime;
+   U32 callInstructions;
+   U32 budgetVersion;                  // Which budget settings our hook was set up for
+
+   bool threaded;                      // State belongs to a single script, and may be run on a BotThreadPool
+   BotThreadPool *pool;                // Pool whose thread is running the state right now, or NULL on the main thread
+   S32 worker;                         // ...and which of its threads that is
+
+   LuaStateInfo();      // Constructor
+};
+
+lua_State *createLuaState(bool threaded);    // Like lua_open(), but with a LuaStateInfo attached
+void closeLuaState(lua_State *L);
+LuaStateInfo *getLuaStateInfo(lua_State *L); // NULL for states not made with createLuaState()
+
 /////
 // Documenting and help
 S32 checkArgList(lua_State *L, const LuaFunctionProfile *functionInfos,   const char *className, const char *functionName);
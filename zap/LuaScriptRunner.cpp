@@ -11,6 +11,7 @@
 #include "Engineerable.h"
 #include "game.h"
 #include "ServerGame.h"
+#include "VisibilityCache.h"
 #include "GeomUtils.h"
 
 #include "GameTypesEnum.h"
@@ -19,14 +20,20 @@
 #include "config.h"
 #include "GameSettings.h"
 #include "Console.h"           // For gConsole
+#include "BotThreadPool.h"
 
 #include "stringUtils.h"
 
 #include <clipper.hpp>
 
+extern "C" {
+#  include "luajit.h"  // For luaJIT_setmode
+}
+
 #include "tnlLog.h"            // For logprintf
 #include "tnlRandom.h"
 
+#include <algorithm>           // For sort
 #include <iostream>            // For enum code
 #include <sstream>             // For enum code
 #include <string>
@@ -39,16 +46,45 @@ namespace Zap
 ////////////////////////////////////////
 
 // Declare and Initialize statics:
-lua_State *LuaScriptRunner::L = NULL;
+lua_State *LuaScriptRunner::mSharedState = NULL;
 string LuaScriptRunner::mScriptingDir;
 
 deque<string> LuaScriptRunner::mCachedScripts;
 
+U32 LuaScriptRunner::mInstructionBudget = 0;
+U32 LuaScriptRunner::mTimeBudget = 0;
+U32 LuaScriptRunner::mWatchdogTimeout = 0;
+U32 LuaScriptRunner::mCurrentTick = 0;
+U32 LuaScriptRunner::mBudgetVersion = 1;
+
+
+// Constructor
+LuaScriptProfile::LuaScriptProfile()
+{
+   reset();
+}
+
+
+void LuaScriptProfile::reset()
+{
+   calls = 0;
+   tickCalls = 0;
+   totalMs = 0;
+   tickMs = 0;
+   maxCallMs = 0;
+   methodCalls = 0;
+   instructions = 0;
+   allocBytes = 0;
+   overBudgetTicks = 0;
+   throttledTicks = 0;
+}
+
+
 void LuaScriptRunner::clearScriptCache()
 {
 	while(mCachedScripts.size() != 0)
 	{
-		deleteScript(mCachedScripts.front().c_str());
+		deleteScript(mSharedState, mCachedScripts.front().c_str());
 		mCachedScripts.pop_front();
 	}
 }
@@ -61,6 +97,10 @@ LuaScriptRunner::LuaScriptRunner()
    mLuaGame = NULL;
    mLuaGridDatabase = NULL;
 
+   L = mSharedState;
+   mOwnsState = false;
+   mKillPending = false;
+
    static U32 mNextScriptId = 0;
 
    // Initialize all subscriptions to unsubscribed -- bits will automatically subscribe to onTick later
@@ -70,6 +110,11 @@ LuaScriptRunner::LuaScriptRunner()
    mScriptId = "script" + itos(mNextScriptId++);
    mScriptType = ScriptTypeInvalid;
 
+   mBudgetTick = 0;
+   mTickInstructions = 0;
+   mTickMs = 0;
+   mThrottleTicks = 0;
+
    LUAW_CONSTRUCTOR_INITIALIZATIONS;
 }
 
@@ -86,8 +131,23 @@ LuaScriptRunner::~LuaScriptRunner()
    // Clean-up any game objects that were added in Lua with '.new()' but not added
    // with bf:addItem()
 
-   // And delete the script's environment table from the Lua instance
-   deleteScript(getScriptId());
+   // And delete the script's environment table from the Lua instance -- or the whole instance, if it's ours
+   if(mOwnsState)
+   {
+      closeLuaState(L);
+      L = NULL;
+   }
+   else if(mSharedState)
+   {
+      L = mSharedState;             // In case the shared state was replaced since we last ran
+      deleteScript(L, getScriptId());
+
+      LuaStateInfo *info = getLuaStateInfo(L);
+      if(info && info->runningScript == this)
+         info->runningScript = NULL;
+      if(info && info->watchdogVictim == this)
+         info->watchdogVictim = NULL;
+   }
 
    LUAW_DESTRUCTOR_CLEANUP;
 }
@@ -98,27 +158,64 @@ const char *LuaScriptRunner::getErrorMessagePrefix() { return "SCRIPT"; }
 
 lua_State *LuaScriptRunner::getL()
 {
-   TNLAssert(L, "L not yet instantiated!");
-   return L;
+   TNLAssert(mSharedState, "L not yet instantiated!");
+   return mSharedState;
 }
 
 
 void LuaScriptRunner::shutdown()
 {
-   if(L)
+   if(mSharedState)
    {
-      lua_close(L);
-      L = NULL;
+      closeLuaState(mSharedState);
+      mSharedState = NULL;
    }
 }
 
 
+lua_State *LuaScriptRunner::getLuaState() const
+{
+   return L;
+}
+
+
+bool LuaScriptRunner::ownsLuaState() const
+{
+   return mOwnsState;
+}
+
+
+// Give this script a state of its own, so it can be run on a BotThreadPool alongside other scripts.  Costs
+// a few hundred KB per script.
+bool LuaScriptRunner::useOwnLuaState()
+{
+   if(mOwnsState)
+      return true;
+
+   lua_State *state = createState(true);
+
+   if(!state)
+      return false;
+
+   L = state;
+   mOwnsState = true;
+
+   return true;
+}
+
+
 const char *LuaScriptRunner::getScriptId()
 {
    return mScriptId.c_str();
 }
 
 
+Game *LuaScriptRunner::getLuaGame() const
+{
+   return mLuaGame;
+}
+
+
 // Load the script, execute the chunk to get it in memory, then run its main() function
 // Return false if there was an error, true if not
 bool LuaScriptRunner::runScript(bool cacheScript)
@@ -192,7 +289,7 @@ void LuaScriptRunner::pushStackTracer()
 // environment.  This loaded script will be cleared when the parent script terminates
 bool LuaScriptRunner::loadCompileRunEnvironmentScript(const string &scriptName) {
    // The timer is loaded in each script
-   loadCompileScript(joindir(mScriptingDir, scriptName).c_str());
+   loadCompileScript(L, joindir(mScriptingDir, scriptName).c_str());
    setEnvironment();
 
    S32 err = lua_pcall(L, 0, 0, 0);
@@ -229,8 +326,9 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
    {
       pushStackTracer();            // -- _stackTracer
 
-      if(!cacheScript)
-         loadCompileScript(mScriptName.c_str());
+      // Our script cache lives in the shared state
+      if(!cacheScript || mOwnsState)
+         loadCompileScript(L, mScriptName.c_str());
       else  
       {
          bool found = false;
@@ -250,12 +348,12 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
             if(cacheSize > MAX_CACHE_SIZE)
             {
                // Remove oldest script from the cache
-               deleteScript(mCachedScripts.front().c_str());
+               deleteScript(L, mCachedScripts.front().c_str());
                mCachedScripts.pop_front();
             }
 
             // Load new script into cache using full name as registry key
-            loadCompileSaveScript(mScriptName.c_str(), mScriptName.c_str());
+            loadCompileSaveScript(L, mScriptName.c_str(), mScriptName.c_str());
             mCachedScripts.push_back(mScriptName);
          }
 
@@ -353,9 +451,42 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
       lua_insert(L, 1);                                      // -- _stackTracer, function, <<args>>
    }
 
+   LuaStateInfo *info = getLuaStateInfo(L);
+   TNLAssert(info, "Scripts should only run in states made by createState()");
+
+   if(info->budgetVersion != mBudgetVersion)
+      updateHook(L);
+
+   // Calls can nest, e.g. a levelgen firing an event a bot is listening for, so remember whose call we're interrupting
+   LuaScriptRunner *caller = info->runningScript;
+   S64 callerStartTime = info->callStartTime;
+   U32 callerInstructions = info->callInstructions;
+
+   info->runningScript = this;
+   info->callStartTime = Platform::getHighPrecisionTimerValue();
+   info->callInstructions = 0;
+
+   U32 methodCalls = info->methodCalls;
+   U64 allocatedBytes = info->allocatedBytes;
+
    S32 error = lua_pcall(L, args, returnValues, -2 - args);  // -- _stackTracer, <<return values>>
 
-   if(!error)
+   chargeCall(function, Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - info->callStartTime),
+              info->callInstructions, info->methodCalls - methodCalls, info->allocatedBytes - allocatedBytes);
+
+   // Even if the script managed to swallow the watchdog's error, it's going down
+   bool stoppedByWatchdog = (info->watchdogVictim == this);
+   if(stoppedByWatchdog)
+   {
+      info->watchdogVictim = NULL;
+      lua_sethook(L, instructionHook, LUA_MASKCOUNT, InstructionHookInterval);   // Back to the normal interval
+   }
+
+   info->runningScript = caller;
+   info->callStartTime = callerStartTime;
+   info->callInstructions = callerInstructions;
+
+   if(!error && !stoppedByWatchdog)
    {
       lua_remove(L, 1);    // Remove _stackTracer            // -- <<return values>>
 
@@ -365,8 +496,13 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
 
    // There was an error... handle it!
 
-   string msg = lua_tostring(L, -1);
-   lua_pop(L, 1);    // Remove the message from the stack, so it won't appear in our stack dump
+   string msg = "Stopped by watchdog";
+
+   if(error)
+   {
+      msg = lua_tostring(L, -1);
+      lua_pop(L, 1);    // Remove the message from the stack, so it won't appear in our stack dump
+   }
 
    string text = "In method " + string(function) +"():\n" + msg;
 
@@ -375,7 +511,12 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
    dumpStack(L);
    logprintf(LogConsumer::LogError, "Terminating script");
 
-   killScript();
+   // Killing a script changes the game, which has to wait until we're back on the main thread
+   if(info->pool)
+      mKillPending = true;
+   else
+      killScript();
+
    clearStack(L);
 
    return true;
@@ -385,12 +526,20 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
 // Start Lua and get everything configured
 bool LuaScriptRunner::startLua(const string &scriptingDir)
 {
-   TNLAssert(!L, "L should not have been created yet!");
+   TNLAssert(!mSharedState, "L should not have been created yet!");
 
    mScriptingDir = scriptingDir;
 
-   // Prepare the Lua global environment
-   L = lua_open();               // Create a new Lua interpreter; will be shutdown in the destructor
+   // Prepare the Lua global environment; will be shutdown in shutdown()
+   mSharedState = createState(false);
+
+   return mSharedState != NULL;
+}
+
+
+lua_State *LuaScriptRunner::createState(bool threaded)
+{
+   lua_State *L = createLuaState(threaded);    // Create a new Lua interpreter
 
    // Failure here is likely to be something systemic, something bad.  Like smallpox.
    if(!L)
@@ -399,23 +548,222 @@ bool LuaScriptRunner::startLua(const string &scriptingDir)
 
       // Lua just isn't going to work out for this session.
       logprintf(LogConsumer::LogError, "=====FATAL LUA ERROR=====\n%s\n=========================", msg.c_str());
-      lua_close(L);
-      L = NULL;
-      return false;
+      return NULL;
    }
 
    if(!configureNewLuaInstance(L))
    {
       // An error message will have been printed by configureNewLuaInstance()
-      lua_close(L);
-      L = NULL;
-      return false;
+      closeLuaState(L);
+      return NULL;
    }
 
+   updateHook(L);
+
+   return L;
+}
+
+
+// Set per-script, per-tick limits; pass 0 for no limit.  Enforcing any of them means running scripts in
+// LuaJIT's interpreter; with everything at 0, scripts are compiled as usual.
+void LuaScriptRunner::setBudgets(U32 instructionBudget, U32 timeBudget, U32 watchdogTimeout)
+{
+   mInstructionBudget = instructionBudget;
+   mTimeBudget = timeBudget;
+   mWatchdogTimeout = watchdogTimeout;
+
+   // States pick up the new settings the next time they run a script
+   mBudgetVersion++;
+}
+
+
+void LuaScriptRunner::updateHook(lua_State *L)
+{
+   LuaStateInfo *info = getLuaStateInfo(L);
+   if(info)
+      info->budgetVersion = mBudgetVersion;
+
+   if(mInstructionBudget == 0 && mTimeBudget == 0 && mWatchdogTimeout == 0)
+   {
+      lua_sethook(L, NULL, 0, 0);
+      luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_ON);
+      return;
+   }
+
+   // Count hooks are never called from compiled code, so a script looping inside a trace could never
+   // be stopped.  Keep everything in the interpreter while we're watching.
+   luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_FLUSH);
+   luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+
+   lua_sethook(L, instructionHook, LUA_MASKCOUNT, InstructionHookInterval);
+}
+
+
+// Called every InstructionHookInterval instructions while Lua is running.  Charges the instructions to
+// whichever script is running, and stops it if this call has gone on far too long, most likely because
+// it's stuck in a loop.
+void LuaScriptRunner::instructionHook(lua_State *L, lua_Debug *ar)
+{
+   LuaStateInfo *info = getLuaStateInfo(L);
+   LuaScriptRunner *script = info->runningScript;
+
+   if(!script)       // Helper code running outside of any script call
+      return;
+
+   // Once we've decided to stop a script, keep raising errors until it unwinds out of any pcall()s it made
+   if(script == info->watchdogVictim)
+      luaL_error(L, "Script stopped by watchdog");
+
+   info->callInstructions += InstructionHookInterval;
+
+   if(!script->isBudgeted())
+      return;
+
+   const char *reason = NULL;
+
+   if(mInstructionBudget > 0 && U64(info->callInstructions) > U64(mInstructionBudget) * WatchdogBudgetMultiple)
+      reason = "ran too many instructions";
+   else if(mWatchdogTimeout > 0 && 
+           Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - info->callStartTime) > mWatchdogTimeout)
+      reason = "ran too long";
+
+   if(!reason)
+      return;
+
+   logprintf(LogConsumer::LogWarning, "Lua script %s %s in a single call -- stopping it", script->getProfileName().c_str(), reason);
+
+   info->watchdogVictim = script;
+   lua_sethook(L, instructionHook, LUA_MASKCOUNT, 1);    // So the error gets raised again right after any pcall() catches it
+
+   luaL_error(L, "Script stopped by watchdog: %s", reason);
+}
+
+
+bool LuaScriptRunner::isBudgeted() const
+{
+   return mScriptType == ScriptTypeRobot || mScriptType == ScriptTypeLevelgen;
+}
+
+
+// Add a finished call to our profile, and to our usage for this tick -- if that's over budget, skip some ticks to make up for it
+void LuaScriptRunner::chargeCall(const char *function, F64 ms, U32 instructions, U32 methodCalls, U64 allocBytes)
+{
+   mProfile.calls++;
+   mProfile.totalMs += ms;
+   mProfile.maxCallMs = max(mProfile.maxCallMs, ms);
+   mProfile.methodCalls += methodCalls;
+   mProfile.instructions += instructions;
+   mProfile.allocBytes += allocBytes;
+
+   if(strcmp(function, "onTick") == 0)
+   {
+      mProfile.tickCalls++;
+      mProfile.tickMs += ms;
+   }
+
+   // main() runs once, while the level is loading, so it doesn't count against any tick
+   if(!isBudgeted() || strcmp(function, "main") == 0)
+      return;
+
+   if(mBudgetTick != mCurrentTick)
+   {
+      mBudgetTick = mCurrentTick;
+      mTickInstructions = 0;
+      mTickMs = 0;
+   }
+
+   bool wasOverBudget = (mInstructionBudget > 0 && mTickInstructions > mInstructionBudget) || 
+                        (mTimeBudget > 0 && mTickMs > mTimeBudget);
+
+   mTickInstructions += instructions;
+   mTickMs += ms;
+
+   F64 overage = 0;     // How many ticks' worth of budget we've used
+
+   if(mInstructionBudget > 0)
+      overage = F64(mTickInstructions) / mInstructionBudget;
+   if(mTimeBudget > 0)
+      overage = max(overage, mTickMs / mTimeBudget);
+
+   if(wasOverBudget || overage <= 1)
+      return;
+
+   mThrottleTicks = min(U32(overage), U32(MaxThrottleTicks));
+   mProfile.overBudgetTicks++;
+
+   // Don't flood the log with a script that's over budget every tick
+   if(mProfile.overBudgetTicks % 100 == 1)
+      logprintf(LogConsumer::LogWarning, "Lua script %s used %.1fms and ~%d instructions in one tick -- skipping %d of its ticks "
+                "(over budget %d times so far)", getProfileName().c_str(), mTickMs, mTickInstructions, 
+                mThrottleTicks, mProfile.overBudgetTicks);
+}
+
+
+void LuaScriptRunner::startTick()
+{
+   mCurrentTick++;
+}
+
+
+bool LuaScriptRunner::skipTick()
+{
+   if(mThrottleTicks == 0)
+      return false;
+
+   mThrottleTicks--;
+   mProfile.throttledTicks++;
    return true;
 }
 
 
+const LuaScriptProfile &LuaScriptRunner::getProfile() const
+{
+   return mProfile;
+}
+
+
+void LuaScriptRunner::resetProfile()
+{
+   mProfile.reset();
+}
+
+
+// Name to show in profile reports; subclasses can be more helpful
+string LuaScriptRunner::getProfileName()
+{
+   return extractFilename(mScriptName);
+}
+
+
+static bool profileSort(LuaScriptRunner *a, LuaScriptRunner *b)
+{
+   return a->getProfile().totalMs > b->getProfile().totalMs;
+}
+
+
+void LuaScriptRunner::getProfileReport(const Vector<LuaScriptRunner *> &scripts, Vector<string> &lines)
+{
+   Vector<LuaScriptRunner *> sorted(scripts);
+   std::sort(sorted.getStlVector().begin(), sorted.getStlVector().end(), profileSort);
+
+   char line[256];
+   dSprintf(line, sizeof(line), "%-24s %6s %9s %9s %7s %9s %8s %8s %9s", 
+            "Script", "Calls", "Total ms", "onTick ms", "Max ms", "API calls", "K instr", "Alloc KB", "Over/Skip");
+   lines.push_back(line);
+
+   for(S32 i = 0; i < sorted.size(); i++)
+   {
+      const LuaScriptProfile &profile = sorted[i]->getProfile();
+
+      dSprintf(line, sizeof(line), "%-24.24s %6u %9.1f %9.1f %7.2f %9u %8u %8u %4u/%-4u", 
+               sorted[i]->getProfileName().c_str(), profile.calls, profile.totalMs, profile.tickMs, profile.maxCallMs,
+               profile.methodCalls, U32(profile.instructions / 1000), U32(profile.allocBytes / 1024), 
+               profile.overBudgetTicks, profile.throttledTicks);
+      lines.push_back(line);
+   }
+}
+
+
 // Prepare a new Lua environment ("L") for use -- called from startLua(), and testing.
 bool LuaScriptRunner::configureNewLuaInstance(lua_State *L)
 {
@@ -430,31 +778,36 @@ bool LuaScriptRunner::configureNewLuaInstance(lua_State *L)
       luaL_openlibs(L);    // Load the standard libraries
 
       // This allows the safe use of 'require' in our scripts
-      setModulePath();
+      setModulePath(L);
 
       // Register all our classes in the global namespace... they will be copied below when we copy the environment
-      registerClasses();            // Perform class and global function registration once per lua_State
+      registerClasses(L);           // Perform class and global function registration once per lua_State
       registerLooseFunctions(L);    // Register some functions not associated with a particular class
 
+      // Scripts in a state of their own may run on a bot thread; make sure what they call is safe to call from there
+      LuaStateInfo *info = getLuaStateInfo(L);
+      if(info && info->threaded)
+         BotThreadPool::wrapFunctions(L);
+
       // Set scads of global vars in the Lua instance that mimic the use of the enums we use everywhere.
       // These will be copied into the script's environment when we run createEnvironment.
       setEnums(L);
       setGlobalObjectArrays(L);
 
       // Immediately execute the lua helper functions (these are global and need to be loaded before sandboxing)
-      loadCompileRunHelper("lua_helper_functions.lua");
+      loadCompileRunHelper(L, "lua_helper_functions.lua");
 
       // Load our vector library
-      loadCompileRunHelper("luavec.lua");
+      loadCompileRunHelper(L, "luavec.lua");
 
       // Load our helper functions and store copies of the compiled code in the registry where we can use them for starting new scripts
-      loadCompileSaveHelper("robot_helper_functions.lua",    ROBOT_HELPER_FUNCTIONS_KEY);
-      loadCompileSaveHelper("levelgen_helper_functions.lua", LEVELGEN_HELPER_FUNCTIONS_KEY);
-      loadCompileSaveHelper("timer.lua",                     SCRIPT_TIMER_KEY);
+      loadCompileSaveHelper(L, "robot_helper_functions.lua",    ROBOT_HELPER_FUNCTIONS_KEY);
+      loadCompileSaveHelper(L, "levelgen_helper_functions.lua", LEVELGEN_HELPER_FUNCTIONS_KEY);
+      loadCompileSaveHelper(L, "timer.lua",                     SCRIPT_TIMER_KEY);
 
       // Perform sandboxing now
       // Only code executed before this point can access dangerous functions
-      loadCompileRunHelper("sandbox.lua");
+      loadCompileRunHelper(L, "sandbox.lua");
 
       return true;
    }
@@ -466,17 +819,17 @@ bool LuaScriptRunner::configureNewLuaInstance(lua_State *L)
 }
 
 
-void LuaScriptRunner::loadCompileSaveHelper(const string &scriptName, const char *registryKey)
+void LuaScriptRunner::loadCompileSaveHelper(lua_State *L, const string &scriptName, const char *registryKey)
 {
-   loadCompileSaveScript(joindir(mScriptingDir, scriptName).c_str(), registryKey);
+   loadCompileSaveScript(L, joindir(mScriptingDir, scriptName).c_str(), registryKey);
 }
 
 
 // Load a script from the scripting directory by basename (e.g. "my_script.lua").
 // Throws LuaException when there's an error compiling or running the script.
-void LuaScriptRunner::loadCompileRunHelper(const string &scriptName)
+void LuaScriptRunner::loadCompileRunHelper(lua_State *L, const string &scriptName)
 {
-   loadCompileScript(joindir(mScriptingDir, scriptName).c_str());
+   loadCompileScript(L, joindir(mScriptingDir, scriptName).c_str());
    if(lua_pcall(L, 0, 0, 0))
       throw LuaException("Error running " + scriptName + ": " + string(lua_tostring(L, -1)));
 }
@@ -484,16 +837,16 @@ void LuaScriptRunner::loadCompileRunHelper(const string &scriptName)
 
 // Load script from specified file, compile it, and store it in the registry.
 // All callers of this script have catch blocks, so we can throw errors if something goes wrong.
-void LuaScriptRunner::loadCompileSaveScript(const char *filename, const char *registryKey)
+void LuaScriptRunner::loadCompileSaveScript(lua_State *L, const char *filename, const char *registryKey)
 {
-   loadCompileScript(filename);                       // Throws if there is an error
+   loadCompileScript(L, filename);                       // Throws if there is an error
    lua_setfield(L, LUA_REGISTRYINDEX, registryKey);   // Save compiled code in registry
 }
 
 
 // Load script and place on top of the stack.
 // All callers of this script have catch blocks, so we can throw errors if something goes wrong.
-void LuaScriptRunner::loadCompileScript(const char *filename)
+void LuaScriptRunner::loadCompileScript(lua_State *L, const char *filename)
 {
    // luaL_loadfile: Loads a file as a Lua chunk. This function uses lua_load to load the chunk in the file named filename. 
    // If filename is NULL, then it loads from the standard input. The first line in the file is ignored if it starts with a #.
@@ -508,7 +861,7 @@ void LuaScriptRunner::loadCompileScript(const char *filename)
 
 
 // Delete script's environment from the registry -- actually set the registry entry to nil so the table can be collected
-void LuaScriptRunner::deleteScript(const char *name)
+void LuaScriptRunner::deleteScript(lua_State *L, const char *name)
 {
    // If a script is not found, or there is some other problem with the bot (or levelgen), we might get here before our L has been
    // set up.  If L hasn't been defined, there's no point in mucking with the registry, right?
@@ -522,6 +875,10 @@ void LuaScriptRunner::deleteScript(const char *name)
 
 bool LuaScriptRunner::prepareEnvironment()              
 {
+   // Scripts can be created before the shared state is, so pick it up now
+   if(!mOwnsState)
+      L = mSharedState;
+
    if(!L)
    {
       logprintf(LogConsumer::LogError, "%s %s.", getErrorMessagePrefix(), 
@@ -590,7 +947,7 @@ static string getStackTraceLine(lua_State *L, S32 level)
 */
 
 // Register classes needed by all script runners
-void LuaScriptRunner::registerClasses()
+void LuaScriptRunner::registerClasses(lua_State *L)
 {
    LuaW_Registrar::registerClasses(L);    // Register all objects that use our automatic registration scheme
 }
@@ -623,7 +980,7 @@ void LuaScriptRunner::setLuaArgs(const Vector<string> &args)
 
 
 // Set up paths so that we can use require to load code in our scripts 
-void LuaScriptRunner::setModulePath()   
+void LuaScriptRunner::setModulePath(lua_State *L)   
 {
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
@@ -1056,6 +1413,10 @@ S32 LuaScriptRunner::lua_pointCanSeePoint(lua_State *L)
 
    TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
 
+   // In a game, share the answer with anyone else asking the same thing this tick
+   if(mLuaGame && mLuaGame->isServer() && mLuaGridDatabase == mLuaGame->getGameObjDatabase())
+      return returnBool(L, static_cast<ServerGame *>(mLuaGame)->getVisibilityCache()->canSee(p1, p2));
+
    return returnBool(L, mLuaGridDatabase->pointCanSeePoint(p1, p2));
 }
 
@@ -1115,10 +1476,8 @@ S32 LuaScriptRunner::lua_findAllObjects(lua_State *L)
 
    TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
 
-   fillVector.clear();
-   static Vector<U8> types;
-
-   types.clear();
+   Vector<DatabaseObject *> fillVector;
+   Vector<U8> types;
 
    // We expect the stack to look like this: -- objType1, objType2, ...
    // or this, if using the deprecated fill table option -- [fillTable], objType1, objType2, ...
@@ -1202,10 +1561,8 @@ S32 LuaScriptRunner::lua_findAllObjectsInArea(lua_State *L)
 
    TNLAssert(mLuaGridDatabase != NULL, "Grid Database must not be NULL!");
 
-   static Vector<U8> types;
-
-   types.clear();
-   fillVector.clear();
+   Vector<U8> types;
+   Vector<DatabaseObject *> fillVector;
 
    bool hasBotZoneType = false;
 
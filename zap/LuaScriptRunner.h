@@ -43,27 +43,74 @@ class MenuItem;
 #define LEVELGEN_HELPER_FUNCTIONS_KEY "levelgen_helper_functions"
 #define SCRIPT_TIMER_KEY "script_timer"
 
+
+// Where a script's time goes, so we can find out which one is eating our tick
+struct LuaScriptProfile
+{
+   U32 calls;              // Calls from the game into the script: events, timers, main()...
+   U32 tickCalls;          // ...of which were onTick()
+   F64 totalMs;
+   F64 tickMs;             // Time spent in onTick()
+   F64 maxCallMs;
+   U32 methodCalls;        // Calls from the script into our C++ methods, e.g. Robot::lua_findClosestEnemy()
+   U64 instructions;       // Counted in blocks of InstructionHookInterval, so approximate
+   U64 allocBytes;         // Memory allocated by Lua during calls
+   U32 overBudgetTicks;    // Ticks in which the script went over its budget
+   U32 throttledTicks;     // onTick() calls skipped as a result
+
+   LuaScriptProfile();     // Constructor
+   void reset();
+};
+
+
 class LuaScriptRunner
 {
+   friend class BotThreadPool;
 
 private:
    static deque<string> mCachedScripts;
 
    static string mScriptingDir;
 
+   static lua_State *mSharedState;   // State shared by all scripts that don't have their own
+
+   bool mOwnsState;                  // True if L is ours alone, false if it's mSharedState
+   bool mKillPending;                // Script failed on a worker thread; kill it once we're back on the main thread
+
    void setLuaArgs(const Vector<string> &args);
-   static void setModulePath();
+   static void setModulePath(lua_State *L);
 
-   static void loadCompileSaveHelper(const string &scriptName, const char *registryKey);
-   static void loadCompileRunHelper(const string &scriptName);
-   static void loadCompileSaveScript(const char *filename, const char *registryKey);
-   static void loadCompileScript(const char *filename);
+   static void loadCompileSaveHelper(lua_State *L, const string &scriptName, const char *registryKey);
+   static void loadCompileRunHelper(lua_State *L, const string &scriptName);
+   static void loadCompileSaveScript(lua_State *L, const char *filename, const char *registryKey);
+   static void loadCompileScript(lua_State *L, const char *filename);
+
+   static lua_State *createState(bool threaded);   // Create and configure a new state, NULL if that fails
 
    void pushStackTracer();      // Put error handler function onto the stack
 
    static void setEnums(lua_State *L);                       // Set a whole slew of enum values that we want the scripts to have access to
    static void setGlobalObjectArrays(lua_State *L);          // And some objects
-   static void logErrorHandler(const char *msg, const char *prefix);
+   void logErrorHandler(const char *msg, const char *prefix);
+
+   // Budgets and profiling -- budgets are per script, per tick, and only apply to bots and levelgens
+   static U32 mInstructionBudget;            // 0 for no limit
+   static U32 mTimeBudget;                   // In ms; 0 for no limit
+   static U32 mWatchdogTimeout;              // A single call running longer than this many ms gets the script killed; 0 to disable
+   static U32 mCurrentTick;
+   static U32 mBudgetVersion;                // Bumped when the budgets change, so each state can update its hook
+
+   LuaScriptProfile mProfile;
+   U32 mBudgetTick;                          // Tick our usage below belongs to
+   U32 mTickInstructions;
+   F64 mTickMs;
+   U32 mThrottleTicks;                       // Number of upcoming onTick() calls to skip
+
+   static void updateHook(lua_State *L);
+   static void instructionHook(lua_State *L, lua_Debug *ar);
+
+   bool isBudgeted() const;
+   void chargeCall(const char *function, F64 ms, U32 instructions, U32 methodCalls, U64 allocBytes);
 
 protected:
    enum ScriptType {
@@ -79,7 +126,7 @@ protected:
                                     // ClientGame depending on where the script is called from
    GridDatabase *mLuaGridDatabase;  // Pointer to our current grid database with objects to manipulate
 
-   static lua_State *L;          // Main Lua state variable
+   lua_State *L;                 // Lua state this script runs in -- usually shared by all scripts
    string mScriptName;           // Fully qualified script name, with path and everything
    Vector<string> mScriptArgs;   // List of arguments passed to the script
 
@@ -92,12 +139,14 @@ protected:
    virtual bool prepareEnvironment();
 
    static int luaPanicked(lua_State *L);  // Handle a total freakout by Lua
-   static void registerClasses();
+   static void registerClasses(lua_State *L);
    void setEnvironment();                 // Sets the environment for the function on the top of the stack to that associated with name
 
    bool loadCompileRunEnvironmentScript(const string &scriptName);
 
-   static void deleteScript(const char *name);  // Remove saved script from the Lua registry
+   static void deleteScript(lua_State *L, const char *name);  // Remove saved script from the Lua registry
+
+   bool useOwnLuaState();        // Run in a state of our own, rather than the shared one; call before prepareEnvironment()
 
    static void registerLooseFunctions(lua_State *L);   // Register some functions not associated with a particular class
 
@@ -133,9 +182,12 @@ public:
 
    virtual const char *getErrorMessagePrefix();
 
-   static lua_State *getL();
-   static bool startLua(const string &scriptingDir);  // Create L
-   static void shutdown();                            // Delete L
+   static lua_State *getL();                          // The shared state
+   static bool startLua(const string &scriptingDir);  // Create the shared state
+   static void shutdown();                            // Delete the shared state
+
+   lua_State *getLuaState() const;                    // The state this script runs in
+   bool ownsLuaState() const;
 
    static bool configureNewLuaInstance(lua_State *L); // Prepare a new Lua environment for use
 
@@ -148,7 +200,23 @@ public:
 
    bool runCmd(const char *function, S32 returnValues);
 
+   static const U32 InstructionHookInterval = 1000;   // Instructions between checks on the running script
+   static const U32 WatchdogBudgetMultiple = 20;      // A single call using this many ticks' worth of instructions gets killed
+   static const U32 MaxThrottleTicks = 50;
+
+   static void setBudgets(U32 instructionBudget, U32 timeBudget, U32 watchdogTimeout);
+   static void startTick();                           // Call once per game tick, before running any scripts
+
+   bool skipTick();                                   // Returns true if this script's onTick() should be skipped this tick
+   const LuaScriptProfile &getProfile() const;
+   void resetProfile();
+   virtual string getProfileName();
+
+   // One line per script, heaviest first, plus a header
+   static void getProfileReport(const Vector<LuaScriptRunner *> &scripts, Vector<string> &lines);
+
    const char *getScriptId();
+   Game *getLuaGame() const;
    static bool loadFunction(lua_State *L, const char *scriptId, const char *functionName);
    bool loadAndRunGlobalFunction(lua_State *L, const char *key, ScriptContext context);
 
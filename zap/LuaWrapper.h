@@ -53,6 +53,8 @@ extern "C"
 #include "LuaBase.h"   
 #include "LuaException.h"   
 
+#include "tnlThread.h"
+
 #include <string>
 #include <vector>
 #include <map>
@@ -233,23 +235,14 @@ inline bool luaW_isUsingProxy(lua_State* L, void *objptr)
 }
 
 
-// Set whether or not our object uses a proxy
+// Set whether or not our object uses a proxy.  Pass the proxy if it does, the object itself if not.  This
+// is because we use the luaW_Userdata to find out if an object is using a proxy.  luaW_Userdata will
+// contain the proxy for proxied object otherwise it contains the object itself
 template <typename T>
-void luaW_setUsingProxy(lua_State* L, T* obj, bool usingProxy)
+void luaW_setUsingProxy(lua_State* L, void* objOrProxy, bool usingProxy)
 {
    luaW_wrapperfield<T>(L, LUAW_USING_PROXY_KEY);     // -- ... usingproxy_table
-
-   // If we're using a proxy, then use that as the usingproxy table key.  This is because
-   // we use the luaW_Userdata to find out if an object is using a proxy.  luaW_Userdata
-   // will contain the proxy for proxied object otherwise it contains the object itself
-   if(usingProxy)
-   {
-      LuaProxy<T> *proxy = obj->getLuaProxy();
-      lua_pushlightuserdata(L, proxy);                // -- ... usingproxy_table, &proxy
-   }
-   else
-      lua_pushlightuserdata(L, obj);                  // -- ... usingproxy_table, &obj
-
+   lua_pushlightuserdata(L, objOrProxy);              // -- ... usingproxy_table, &obj_or_proxy
    lua_pushboolean(L, usingProxy);                    // -- ... usingproxy_table, &obj_or_proxy, bool
    lua_rawset(L, -3);                                 // -- ... usingproxy_table
    lua_pop(L, 1);                                     // -- ...
@@ -386,61 +379,72 @@ void luaW_push(lua_State* L, T* obj)
    // Should we be using proxies for our objects?
    if(luaW_shouldCreateProxy(L))
    {
-      // Get the object's proxy, or create one if it doesn't yet exist
-      LuaProxy<T> *proxy = obj->getLuaProxy();
+      // Each lua_State gets its own proxy for the object, so look for this state's in our cache table
+      luaW_wrapperfield<T>(L, LUAW_CACHE_KEY);        // -- cache_table
+      LuaWrapper<T>::identifier(L, obj);              // -- cache_table, id
 
-      if(proxy)         // Retrieve the userdata for this proxy from our cache table
-      {
-         luaW_wrapperfield<T>(L, LUAW_CACHE_KEY);        // -- cache_table
-         LuaWrapper<T>::identifier(L, obj);              // -- cache_table, id
+      // lua_gettable pushes onto the stack the value t[k], where t is the value at the given valid
+      // index and k is the value at the top of the stack.  Pops k, triggers metamethods.
+      // Here: retrieves and pushes cache_table[id]
+      lua_gettable(L, -2);                            // -- cache_table, userdata
 
-         // lua_gettable pushes onto the stack the value t[k], where t is the value at the given valid
-         // index and k is the value at the top of the stack.  Pops k, triggers metamethods.
-         // Here: retrieves and pushes cache_table[id]
-         lua_gettable(L, -2);                            // -- cache_table, userdata
+      // The cached userdata may belong to an earlier object that lived at the same address, or
+      // be for a parent class that shares our cache table
+      LuaProxy<T> *proxy = NULL;
 
-         TNLAssert(lua_isuserdata(L, -1) ||
-               dumpStack(L, "Expect table, userdata") || dumpTable(L, -2, "Cached Userdatas"),
-               "Expected userdata!");
-         TNLAssert(proxy == luaW_toProxy<T>(L, -1), "Cached object is not the one we expect!");
+      if(luaW_is<T>(L, -1, true))
+      {
+         void *data = static_cast<luaW_Userdata *>(lua_touserdata(L, -1))->data;
 
-         // Clean up the stack
-         lua_remove(L, -2);                              // -- userdata
+         if(luaW_isUsingProxy<T>(L, data))
+         {
+            proxy = static_cast<LuaProxy<T> *>(data);
+
+            if(proxy->isDefunct() || proxy->getProxiedObject() != obj)
+               proxy = NULL;
+         }
       }
-      else
+
+      if(proxy)
       {
-         // Create a new proxy
-         proxy = new LuaProxy<T>(obj);
-
-         // Add a new entry to our cache table (a weak table; more about those here: http://lua-users.org/wiki/WeakTablesTutorial).
-         // Note that from here on down, we'll fall back on the normal LuaW push code, except for the bit at the end where
-         // we add it to the table.
-         LuaWrapper<T>::identifier(L, obj);                 // -- id
-         luaW_wrapperfield<T>(L, LUAW_CACHE_KEY);           // -- id, cache_table
-
-         lua_pushvalue(L, -2);                              // -- id, cache_table, id
-
-         // Create the new luaW_userdata and place it in the cache
-         lua_pop(L, 1); // ... id cache
-         lua_insert(L, -2); // ... cache id
-         luaW_Userdata* ud = static_cast<luaW_Userdata*>(lua_newuserdata(L, sizeof(luaW_Userdata))); // ... cache id obj
-         ud->data = proxy;
-         ud->cast = LuaWrapper<T>::cast;
-         lua_pushvalue(L, -1); // ... cache id obj obj
-         lua_insert(L, -4); // ... obj cache id obj
-         lua_settable(L, -3); // ... obj cache
-
-         // Set the class metatable on userdata
-         luaL_getmetatable(L, LuaWrapper<T>::classname); // ... obj cache mt
-         lua_setmetatable(L, -3); // ... obj cache
-
-         // Cleanup
-         lua_pop(L, 1); // ... obj
-         TNLAssert(lua_isuserdata(L, -1) || dumpStack(L, "Expect userdata"), "Expected userdata!");
-
-         luaW_setUsingProxy(L, obj, true);
-         luaW_hold<T>(L, obj);     // Tell luaW to collect the proxy when it's done with it
+         // Clean up the stack
+         lua_remove(L, -2);                           // -- userdata
+         return;
       }
+
+      lua_pop(L, 2);                                  // --
+
+      // Create a new proxy
+      proxy = new LuaProxy<T>(obj);
+
+      // Add a new entry to our cache table (a weak table; more about those here: http://lua-users.org/wiki/WeakTablesTutorial).
+      // Note that from here on down, we'll fall back on the normal LuaW push code, except for the bit at the end where
+      // we add it to the table.
+      LuaWrapper<T>::identifier(L, obj);                 // -- id
+      luaW_wrapperfield<T>(L, LUAW_CACHE_KEY);           // -- id, cache_table
+
+      lua_pushvalue(L, -2);                              // -- id, cache_table, id
+
+      // Create the new luaW_userdata and place it in the cache
+      lua_pop(L, 1); // ... id cache
+      lua_insert(L, -2); // ... cache id
+      luaW_Userdata* ud = static_cast<luaW_Userdata*>(lua_newuserdata(L, sizeof(luaW_Userdata))); // ... cache id obj
+      ud->data = proxy;
+      ud->cast = LuaWrapper<T>::cast;
+      lua_pushvalue(L, -1); // ... cache id obj obj
+      lua_insert(L, -4); // ... obj cache id obj
+      lua_settable(L, -3); // ... obj cache
+
+      // Set the class metatable on userdata
+      luaL_getmetatable(L, LuaWrapper<T>::classname); // ... obj cache mt
+      lua_setmetatable(L, -3); // ... obj cache
+
+      // Cleanup
+      lua_pop(L, 1); // ... obj
+      TNLAssert(lua_isuserdata(L, -1) || dumpStack(L, "Expect userdata"), "Expected userdata!");
+
+      luaW_setUsingProxy<T>(L, proxy, true);
+      luaW_hold<T>(L, obj);     // Tell luaW to collect the proxy when it's done with it
    }  // useLuaProxy
 
    // No proxy: Use upstream behavior
@@ -467,7 +471,7 @@ void luaW_push(lua_State* L, T* obj)
 
           lua_pop(L, 1); // ... obj
 
-          luaW_setUsingProxy(L, obj, false);
+          luaW_setUsingProxy<T>(L, obj, false);
           luaW_hold<T>(L, obj);     // Tell luaW to manage this object
       }
       else
@@ -1155,12 +1159,24 @@ public:
 
 
 
+// Proxies for one object are created and destroyed by whichever thread is running the lua_State that
+// holds them, so the list of them is guarded by a lock.  Objects share a handful of locks between them.
+inline TNL::Mutex &luaW_proxyLock(const void *obj)
+{
+   static TNL::Mutex locks[32];
+   return locks[(size_t(obj) >> 4) % 32];
+}
+
+
+// Each lua_State an object is pushed into gets its own proxy; those for one object form a list starting
+// at the object's mLuaProxy
 template <class T>
 class LuaProxy
 {
 private:
     bool mDefunct;
     T *mProxiedObject;
+    LuaProxy<T> *mNext;      // Next proxy for the same object
 
 public:
     // Default constructor
@@ -1170,15 +1186,30 @@ public:
     explicit LuaProxy(T *obj)
     {
       mProxiedObject = obj;
-      obj->setLuaProxy(this);
       mDefunct = false;
+
+      TNL::Mutex &lock = luaW_proxyLock(obj);
+      lock.lock();
+      mNext = obj->mLuaProxy;
+      obj->mLuaProxy = this;
+      lock.unlock();
     }
 
    // Destructor
    ~LuaProxy()
    {
-      if(!mDefunct)
-         mProxiedObject->mLuaProxy = NULL;
+      if(mDefunct)
+         return;
+
+      TNL::Mutex &lock = luaW_proxyLock(mProxiedObject);
+      lock.lock();
+
+      LuaProxy<T> **link = &mProxiedObject->mLuaProxy;
+      while(*link != this)
+         link = &(*link)->mNext;
+      *link = mNext;
+
+      lock.unlock();
    }
 
 
@@ -1186,6 +1217,18 @@ public:
    bool isDefunct()        { return mDefunct;       }
 
    void setDefunct(bool isDefunct) { mDefunct = isDefunct; }
+
+   // Called when the object is destroyed; marks every proxy in the list
+   void setAllDefunct()
+   {
+      TNL::Mutex &lock = luaW_proxyLock(mProxiedObject);
+      lock.lock();
+
+      for(LuaProxy<T> *proxy = this; proxy; proxy = proxy->mNext)
+         proxy->mDefunct = true;
+
+      lock.unlock();
+   }
 };
 
 
@@ -1232,7 +1275,7 @@ public:
 
 // And this goes in the destructor of the "wrapped class"
 #define LUAW_DESTRUCTOR_CLEANUP \
-   if(mLuaProxy) mLuaProxy->setDefunct(true)
+   if(mLuaProxy) mLuaProxy->setAllDefunct()
 
 
 
@@ -1241,6 +1284,10 @@ public:
 template <typename T, int (T::*methodName)(lua_State * )>
 int luaW_doMethod(lua_State *L)
 {
+   LuaStateInfo *info = getLuaStateInfo(L);
+   if(info)
+      info->methodCalls++;
+
    T *w = luaW_check<T>(L, 1);
    if(w) 
    {
@@ -174,7 +174,7 @@ void Rect::unionRect(const Rect &r)
 }
 
 // Does rect interset rect r?
-bool Rect::intersects(const Rect &r)
+bool Rect::intersects(const Rect &r) const
 {
    return min.x < r.max.x && min.y < r.max.y &&
          max.x > r.min.x && max.y > r.min.y;
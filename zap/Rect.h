@@ -72,7 +72,7 @@ public:
    void unionRect(const Rect &r);
 
    // Does rect interset rect r?
-   bool intersects(const Rect &r);
+   bool intersects(const Rect &r) const;
    
    // Does rect interset or border on rect r?
    bool intersectsOrBorders(const Rect &r);
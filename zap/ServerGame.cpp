@@ -16,6 +16,10 @@
 #include "Teleporter.h"
 #include "BanList.h"             // For banList kick duration
 #include "BotNavMeshZone.h"      // For zone clearing code
+#include "BotZoneBuildThread.h"
+#include "BotThreadPool.h"
+#include "VisibilityCache.h"
+#include "LevelPreloadThread.h"
 #include "LevelSource.h"
 #include "LevelDatabase.h"
 
@@ -34,7 +38,7 @@ namespace Zap
 {
 
 
-static bool instantiated;           // Just a little something to keep us from creating multiple ServerGames...
+static S32 instanceCount = 0;      // Just a little something to keep us from creating ServerGames GameManager doesn't know about...
 
 
 // Constructor -- be sure to see Game constructor too!  Lots going on there!
@@ -42,10 +46,10 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
       Game(address, settings),
       mRobotManager(this, settings)
 {
-   TNLAssert(!instantiated, "Only one ServerGame at a time, please!  If this trips while testing, "
-      "it is probably because a test failed before another instance could be deleted.  Try disabling "
-      "this assert, see what test fails, and fix it.  Then re-enable it, please!");
-   instantiated = true;
+   TNLAssert(instanceCount == GameManager::getServerGameCount(), "Only one ServerGame at a time, please (other than "
+      "additional arenas)!  If this trips while testing, it is probably because a test failed before another instance "
+      "could be deleted.  Try disabling this assert, see what test fails, and fix it.  Then re-enable it, please!");
+   instanceCount++;
 
    mLevelSource = levelSource;
 
@@ -54,7 +58,6 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mVoteNo = 0;
    mVoteNumber = 0;
    mVoteType = VoteLevelChange;  // Arbitrary
-   mLevelLoadIndex = 0;
    mShutdownOriginator = NULL;
    mHostOnServer = hostOnServer;
 
@@ -74,6 +77,7 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mCurrentLevelIndex = 0;
 
    mBotZoneDatabase = new GridDatabase();    // Deleted in destructor
+   mLevelLoadCount = 0;
 
    if(testMode)
       mInfoFlags |= TestModeFlag;
@@ -96,6 +100,13 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mTestMode = testMode;
 
    mNetInterface->setAllowsConnections(true);
+   mNetInterface->setPacketPrepareThreadCount(mSettings->getIniSettings()->packetPrepareThreads);
+
+   IniSettings *iniSettings = mSettings->getIniSettings();
+   LuaScriptRunner::setBudgets(iniSettings->luaTickInstructionBudget, iniSettings->luaTickTimeBudget, iniSettings->luaWatchdogTimeout);
+
+   mBotThreadPool = BotThreadPool::create(iniSettings->botThreads);
+   mVisibilityCache = new VisibilityCache(getGameObjDatabase());    // Deleted in destructor
    mMasterUpdateTimer.reset(UpdateServerStatusTime);
 
    mSuspendor = NULL;
@@ -122,6 +133,12 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    GameManager::setHostingModePhase(GameManager::NotHosting);
 
    mGameRecorderServer = NULL;
+
+   mPrevStatusLevelType = NoGameType;
+   mPrevStatusRobotCount = 0;
+   mPrevStatusPlayerCount = -1;
+
+   resetTickStats();
 }
 
 
@@ -135,7 +152,7 @@ ServerGame::~ServerGame()
 
    clearAddTarget();
 
-   instantiated = false;
+   instanceCount--;
 
    delete mGameInfo;
    delete mBotZoneDatabase;
@@ -144,13 +161,16 @@ ServerGame::~ServerGame()
 
    if(mGameRecorderServer)
       delete mGameRecorderServer;
+
+   delete mBotThreadPool;
+   delete mVisibilityCache;
 }
 
 
 // Called before we load a new level, or when we shut the server down
 void ServerGame::cleanUp()
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mDatabaseForBotZones.findObjects(fillVector);
 
    mLevelGens.deleteAndClear();
@@ -307,12 +327,6 @@ AbstractTeam *ServerGame::getNewTeam()
 }
 
 
-void ServerGame::resetLevelLoadIndex()
-{
-   mLevelLoadIndex = 0;
-}
-
-
 // Return true if the only client connected is the one we passed; don't consider bots
 bool ServerGame::onlyClientIs(GameConnection *client)
 {
@@ -361,38 +375,34 @@ bool ServerGame::populateLevelInfoFromSource(const string &fullFilename, LevelIn
 }
 
 
-// Returns name of level loaded, which will be displayed in the client window during level loading phase of hosting.
-// Can return "" if there was a problem with the level.
-string ServerGame::loadNextLevelInfo()
+// Read the info for all our levels, dropping any we can't read.  Returns names of levels loaded, which will be displayed in
+// the client window during level loading phase of hosting.
+Vector<string> ServerGame::loadLevelInfos()
 {
-   // Last level to process?
-   if(mLevelLoadIndex == mLevelSource->getLevelCount())
+   Vector<string> levelNames;
+
+   if(mLevelSource->getLevelCount() == 0)
    {
       TNLAssert(mHostOnServer, "Shouldn't be empty if not using -hostonserver");
       GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
-      return string("No levels loaded");
+      levelNames.push_back("No levels loaded");
+      return levelNames;
    }
 
    FolderManager *folderManager = getSettings()->getFolderManager();
 
-   string filename = folderManager->findLevelFile(mLevelSource->getLevelFileName(mLevelLoadIndex));
-   TNLAssert(filename != "", "Expected a filename here!");
+   Vector<string> filenames(mLevelSource->getLevelCount());
+   for(S32 i = 0; i < mLevelSource->getLevelCount(); i++)
+      filenames.push_back(folderManager->findLevelFile(mLevelSource->getLevelFileName(i)));
 
-   // populateLevelInfoFromSource() will return true if the level was processed successfully
-   string levelName;
-   if(mLevelSource->populateLevelInfoFromSource(filename, mLevelLoadIndex))
-   {
-      levelName = mLevelSource->getLevelName(mLevelLoadIndex);    // This will be the name specified in the level file we just populated
-      mLevelLoadIndex++;
-   }
-   else     // Failed to process level; remove it from the list
-      mLevelSource->remove(mLevelLoadIndex);
+   mLevelSource->populateLevelInfosFromSource(filenames);
 
-   // Last level to process?
-   if(mLevelLoadIndex == mLevelSource->getLevelCount())
-      GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
+   for(S32 i = 0; i < mLevelSource->getLevelCount(); i++)
+      levelNames.push_back(mLevelSource->getLevelName(i));    // This will be the name specified in the level file
+
+   GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
 
-   return levelName;
+   return levelNames;
 }
 
 
@@ -575,6 +585,9 @@ void ServerGame::cycleLevel(S32 nextLevel)
       }
    }
 
+   S64 switchStartTime = Platform::getHighPrecisionTimerValue();
+   mLevelLoadCount++;
+
    delete mGameRecorderServer;
    mGameRecorderServer = NULL;
 
@@ -641,52 +654,17 @@ void ServerGame::cycleLevel(S32 nextLevel)
       }
    }
 
-   computeWorldObjectExtents();                       // Compute world Extents nice and early
+   getGameObjDatabase()->fitGridToExtents(*getWorldExtents());    // Size our spatial index to suit this level
+   getGameObjDatabase()->freezeStaticObjects((TestFunc)isStaticGeometryType);     // Walls and such won't move from here on
 
    if(!mGameRecorderServer && !mShuttingDown && getSettings()->getIniSettings()->enableGameRecording)
       mGameRecorderServer = new GameRecorderServer(this);
 
 
-   ////// This block could easily be moved off somewhere else   
-   fillVector.clear();
-   getGameObjDatabase()->findObjects(TeleporterTypeNumber, fillVector);
-
-   Vector<pair<Point, const Vector<Point> *> > teleporterData(fillVector.size());
-   pair<Point, const Vector<Point> *> teldat;
-
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      Teleporter *teleporter = static_cast<Teleporter *>(fillVector[i]);
-
-      teldat.first  = teleporter->getPos();
-      teldat.second = teleporter->getDestList();
-
-      teleporterData.push_back(teldat);
-   }
-
-   // Get our parameters together
-   Vector<DatabaseObject *> barrierList;
-   getGameObjDatabase()->findObjects((TestFunc)isWallType, barrierList, *getWorldExtents());
-
-   Vector<DatabaseObject *> turretList;
-   getGameObjDatabase()->findObjects(TurretTypeNumber, turretList, *getWorldExtents());
-
-   Vector<DatabaseObject *> forceFieldProjectorList;
-   getGameObjDatabase()->findObjects(ForceFieldProjectorTypeNumber, forceFieldProjectorList, *getWorldExtents());
-
-   bool triangulate;
-
-   // Try and load Bot Zones for this level, set flag if failed
-   // We need to run buildBotMeshZones in order to set mAllZones properly, which is why I (sort of) disabled the use of hand-built zones in level files
-#ifdef ZAP_DEDICATED
-   triangulate = false;
-#else
-   triangulate = !isDedicated();
-#endif
+   // Zones can take a while to build on bigger levels.  If players are waiting on us, build them in the background and
+   // get the game going; robots just won't be able to find their way around for the first few ticks.
+   buildBotZones(getPlayerCount() > 0);
 
-   mGameType->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mBotZoneDatabase, &mAllZones,
-                                                                          getWorldExtents(), barrierList, turretList,
-                                                                          forceFieldProjectorList, teleporterData, triangulate);
    // Clear team info for all clients
    resetAllClientTeams();
 
@@ -727,6 +705,111 @@ void ServerGame::cycleLevel(S32 nextLevel)
    sendLevelStatsToMaster();     // Give the master some information about this level for its database
 
    suspendIfNoActivePlayers();   // Does nothing if we're already suspended
+
+   logprintf(LogConsumer::ServerFilter, "Level switch took %.1f ms", 
+             Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - switchStartTime));
+}
+
+
+// Build bot zones for the level we just loaded, either right now or on the secondary thread
+void ServerGame::buildBotZones(bool inBackground)
+{
+   Vector<DatabaseObject *> barrierList;
+   getGameObjDatabase()->findObjects((TestFunc)isWallType, barrierList, *getWorldExtents());
+
+   Vector<DatabaseObject *> turretList;
+   getGameObjDatabase()->findObjects(TurretTypeNumber, turretList, *getWorldExtents());
+
+   Vector<DatabaseObject *> forceFieldProjectorList;
+   getGameObjDatabase()->findObjects(ForceFieldProjectorTypeNumber, forceFieldProjectorList, *getWorldExtents());
+
+   mAllZones.deleteAndClear();      // Old level's zones are no use to anyone
+   mZoneRouteCache.clear();         // ...nor are any routes through them
+
+   BotZoneGeometry geometry;
+
+   if(!BotNavMeshZone::prepareBotMeshZones(geometry, getWorldExtents(), barrierList, turretList, forceFieldProjectorList))
+   {
+      mGameType->mBotZoneCreationFailed = true;
+      return;
+   }
+
+   string cacheFilename = getBotZoneCacheFilename();
+
+   if(cacheFilename != "" && geometry.loadFromCache(cacheFilename))
+      onBotZonesBuilt(mLevelLoadCount, geometry, true);
+
+   else if(inBackground)
+      getSecondaryThread()->addEntry(new BotZoneBuildThread(this, mLevelLoadCount, geometry, cacheFilename));
+
+   else
+   {
+      bool succeeded = BotNavMeshZone::computeBotMeshZones(geometry);
+
+      if(succeeded && cacheFilename != "")
+         geometry.saveToCache(cacheFilename);
+
+      onBotZonesBuilt(mLevelLoadCount, geometry, succeeded);
+   }
+}
+
+
+// Zones for levels loaded from files are cached under the level's hash; others, like levels being tested from the editor,
+// change too often to be worth it.  Returns "" if current level's zones shouldn't be cached.
+string ServerGame::getBotZoneCacheFilename()
+{
+   const string &cacheDir = getSettings()->getFolderManager()->cacheDir;
+
+   if(cacheDir == "" || mLevelFileHash == "" || mLevelSource->getLevelFilePath(mCurrentLevelIndex) == "")
+      return "";
+
+   return joindir(cacheDir, mLevelFileHash + ".botzones");
+}
+
+
+// Turn computed zone geometry into zones -- runs on the game thread
+void ServerGame::onBotZonesBuilt(U32 levelLoadCount, const BotZoneGeometry &geometry, bool succeeded)
+{
+   if(levelLoadCount != mLevelLoadCount)     // Built for a level we're no longer playing
+      return;
+
+   // Try and load Bot Zones for this level, set flag if failed
+   // We need to run buildBotMeshZones in order to set mAllZones properly, which is why I (sort of) disabled the use of hand-built zones in level files
+   if(mGameType.isValid())
+      mGameType->mBotZoneCreationFailed = !succeeded;
+
+   if(!succeeded)
+      return;
+
+   Vector<DatabaseObject *> fillVector;
+   getGameObjDatabase()->findObjects(TeleporterTypeNumber, fillVector);
+
+   Vector<pair<Point, const Vector<Point> *> > teleporterData(fillVector.size());
+   pair<Point, const Vector<Point> *> teldat;
+
+   for(S32 i = 0; i < fillVector.size(); i++)
+   {
+      Teleporter *teleporter = static_cast<Teleporter *>(fillVector[i]);
+
+      teldat.first  = teleporter->getPos();
+      teldat.second = teleporter->getDestList();
+
+      teleporterData.push_back(teldat);
+   }
+
+   bool triangulate;
+
+#ifdef ZAP_DEDICATED
+   triangulate = false;
+#else
+   triangulate = !isDedicated();
+#endif
+
+   BotNavMeshZone::createBotMeshZones(geometry, mBotZoneDatabase, &mAllZones, teleporterData, triangulate);
+   mZoneRouteCache.clear();
+
+   mBotZoneDatabase->fitGridToExtents(*getWorldExtents());
+   mBotZoneDatabase->freezeStaticObjects((TestFunc)isAnyObjectType);
 }
 
 
@@ -1324,6 +1407,24 @@ void ServerGame::fewerBots()
 }
 
 
+void ServerGame::getScriptProfile(Vector<string> &lines, bool reset)
+{
+   Vector<LuaScriptRunner *> scripts;
+
+   for(S32 i = 0; i < mLevelGens.size(); i++)
+      scripts.push_back(mLevelGens[i]);
+
+   for(S32 i = 0; i < getBotCount(); i++)
+      scripts.push_back(getBot(i));
+
+   LuaScriptRunner::getProfileReport(scripts, lines);
+
+   if(reset)
+      for(S32 i = 0; i < scripts.size(); i++)
+         scripts[i]->resetProfile();
+}
+
+
 // Comes from c2sKickBot
 void ServerGame::kickSingleBotFromLargestTeamWithBots()
 {
@@ -1465,6 +1566,9 @@ void ServerGame::idle(U32 timeDelta)
       }
    }
 
+   LuaScriptRunner::startTick();    // Scripts' per-tick budgets start over
+   mVisibilityCache->clear();       // Walls may have changed since last tick
+
    // Tick levelgen timers
    for(S32 i = 0; i < mLevelGens.size(); i++)
       mLevelGens[i]->tickTimer<LuaLevelGenerator>(timeDelta);
@@ -1477,11 +1581,6 @@ void ServerGame::idle(U32 timeDelta)
          mLevelGens.deleteAndErase_fast(index);
    }
 
-   // Compute new world extents -- these might change if a ship flies far away, for example...
-   // In practice, we could probably just set it and forget it when we load a level.
-   // Compute it here to save recomputing it for every robot and other method that relies on it.
-   computeWorldObjectExtents();
-
    U32 botControlTickElapsed = botControlTickTimer.getElapsed();
 
    if(botControlTickTimer.update(timeDelta))
@@ -1788,28 +1887,23 @@ void ServerGame::updateStatusOnMaster()
 {
    MasterServerConnection *masterConn = getConnectionToMaster();
 
-   static string prevCurrentLevelName;      // Using static, so it holds the value when it comes back here
-   static GameTypeId prevCurrentLevelType;
-   static S32 prevRobotCount;
-   static S32 prevPlayerCount;
-
    if(masterConn && masterConn->isEstablished())
    {
       // Only update if something is different
-      if(prevCurrentLevelName != getGameType()->getLevelName() ||
-         prevCurrentLevelType != getGameType()->getGameTypeId() ||
-         prevRobotCount       != getRobotCount() ||
-         prevPlayerCount      != getPlayerCount())
+      if(mPrevStatusLevelName != getGameType()->getLevelName() ||
+         mPrevStatusLevelType != getGameType()->getGameTypeId() ||
+         mPrevStatusRobotCount       != getRobotCount() ||
+         mPrevStatusPlayerCount      != getPlayerCount())
       {
-         prevCurrentLevelName = getGameType()->getLevelName();
-         prevCurrentLevelType = getGameType()->getGameTypeId();
-         prevRobotCount       = getRobotCount();
-         prevPlayerCount      = getPlayerCount();
-
-         masterConn->updateServerStatus(StringTableEntry(prevCurrentLevelName.c_str()), 
-                                        GameType::getGameTypeName(prevCurrentLevelType), 
-                                        prevRobotCount, 
-                                        prevPlayerCount, 
+         mPrevStatusLevelName = getGameType()->getLevelName();
+         mPrevStatusLevelType = getGameType()->getGameTypeId();
+         mPrevStatusRobotCount       = getRobotCount();
+         mPrevStatusPlayerCount      = getPlayerCount();
+
+         masterConn->updateServerStatus(StringTableEntry(mPrevStatusLevelName.c_str()), 
+                                        GameType::getGameTypeName(mPrevStatusLevelType), 
+                                        mPrevStatusRobotCount, 
+                                        mPrevStatusPlayerCount, 
                                         mSettings->getMaxPlayers(), 
                                         mInfoFlags);
 
@@ -1820,12 +1914,48 @@ void ServerGame::updateStatusOnMaster()
    }
    else
    {
-      prevPlayerCount = -1;   // Not sure if needed, but if we're disconnected, we need to update to master when we reconnect
+      mPrevStatusPlayerCount = -1;   // Not sure if needed, but if we're disconnected, we need to update to master when we reconnect
       mMasterUpdateTimer.reset(CheckServerStatusTime);
    }
 }
 
 
+void ServerGame::recordTick(F64 tickTime)
+{
+   mTickCount++;
+   mTickTimeTotal += tickTime;
+
+   if(tickTime > mTickTimeMax)
+      mTickTimeMax = tickTime;
+}
+
+
+U32 ServerGame::getTickCount() const
+{
+   return mTickCount;
+}
+
+
+F64 ServerGame::getAverageTickTime() const
+{
+   return mTickCount == 0 ? 0 : mTickTimeTotal / mTickCount;
+}
+
+
+F64 ServerGame::getMaxTickTime() const
+{
+   return mTickTimeMax;
+}
+
+
+void ServerGame::resetTickStats()
+{
+   mTickCount = 0;
+   mTickTimeTotal = 0;
+   mTickTimeMax = 0;
+}
+
+
 // Returns true if things went well, false if we couldn't find any levels to host
 bool ServerGame::startHosting()
 {
@@ -1858,6 +1988,27 @@ bool ServerGame::startHosting()
 void ServerGame::gameEnded()
 {
    mLevelSwitchTimer.reset();
+
+   preloadNextLevel();
+}
+
+
+// Have the secondary thread read the next level's file while players look at the scoreboard, so the switch doesn't
+// have to wait on the disk
+void ServerGame::preloadNextLevel()
+{
+   if(mHostOnServer || mLevelSource->getLevelCount() == 0)
+      return;
+
+   // Decide on a random level now, so we preload the one we'll actually play
+   S32 nextLevel = getAbsoluteLevelIndex(mNextLevel);
+   if(mNextLevel == RANDOM_LEVEL)
+      mNextLevel = nextLevel;
+
+   string filename = mLevelSource->getLevelFilePath(nextLevel);
+
+   if(filename != "")
+      getSecondaryThread()->addEntry(new LevelPreloadThread(mLevelSource, nextLevel, filename));
 }
 
 
@@ -1971,10 +2122,16 @@ const Vector<BotNavMeshZone *> *ServerGame::getBotZones() const
 }
 
 
+ZoneRouteCache *ServerGame::getZoneRouteCache()
+{
+   return &mZoneRouteCache;
+}
+
+
 // Returns ID of zone containing specified point
 U16 ServerGame::findZoneContaining(const Point &p) const
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mBotZoneDatabase->findObjects(BotNavMeshZoneTypeNumber, fillVector,
                                 Rect(p - Point(0.1f, 0.1f), p + Point(0.1f, 0.1f)));  // Slightly extend Rect, it can be on the edge of zone
 
@@ -2021,5 +2178,17 @@ GameRecorderServer *ServerGame::getGameRecorder()
 }
 
 
+BotThreadPool *ServerGame::getBotThreadPool() const
+{
+   return mBotThreadPool;
+}
+
+
+VisibilityCache *ServerGame::getVisibilityCache() const
+{
+   return mVisibilityCache;
+}
+
+
 };
 
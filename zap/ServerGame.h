@@ -30,6 +30,8 @@ class ItemSpawn;
 struct LevelInfo;
 
 class GameRecorderServer;
+class BotThreadPool;
+class VisibilityCache;
 
 static const string UploadPrefix = "upload_";
 static const string DownloadPrefix = "download_";
@@ -63,13 +65,15 @@ private:
    SafePtr<GameConnection> mShutdownOriginator;   // Who started the shutdown?
 
    bool mDedicated;
-   S32 mLevelLoadIndex;                   // For keeping track of where we are in the level loading process.  NOT CURRENT LEVEL IN PLAY!
 
    SafePtr<GameConnection> mSuspendor;    // Player requesting suspension if game suspended by request
    Timer mTimeToSuspend;
 
    GameRecorderServer *mGameRecorderServer;
 
+   BotThreadPool *mBotThreadPool;         // Runs bots with Lua states of their own in parallel; NULL to run all bots serially
+   VisibilityCache *mVisibilityCache;     // Line-of-sight answers for the current tick
+
    string mOriginalName;
    string mOriginalDescr;
    string mOriginalServerPassword;
@@ -93,6 +97,17 @@ private:
 
    Vector<string> mSentHashes;            // Hashes of levels already sent to master
 
+   // What we last told the master, so we only send updates when something changes
+   string mPrevStatusLevelName;
+   GameTypeId mPrevStatusLevelType;
+   S32 mPrevStatusRobotCount;
+   S32 mPrevStatusPlayerCount;
+
+   // Tick accounting, kept separately for each arena when hosting several
+   U32 mTickCount;
+   F64 mTickTimeTotal;                    // In ms
+   F64 mTickTimeMax;                      // In ms
+
    void updateStatusOnMaster();           // Give master a status report for this server
    void processVoting(U32 timeDelta);     // Manage any ongoing votes
    void processSimulatedStutter(U32 timeDelta);
@@ -119,6 +134,12 @@ private:
 
    GridDatabase *mBotZoneDatabase;
    Vector<BotNavMeshZone *> mAllZones;
+   ZoneRouteCache mZoneRouteCache;           // Flight plans through mAllZones, shared by all bots
+   U32 mLevelLoadCount;                   // Bumped every level load, so we can tell if background work is for an old level
+
+   void buildBotZones(bool inBackground);
+   string getBotZoneCacheFilename();
+   void preloadNextLevel();
    
 public:
    ServerGame(const Address &address, GameSettingsPtr settings, LevelSourcePtr levelSource, bool testMode, bool dedicated, bool hostOnServer = false);    // Constructor
@@ -152,6 +173,12 @@ public:
 
    bool startHosting();
 
+   void recordTick(F64 tickTime);         // Time, in ms, taken by one call to idle()
+   U32 getTickCount() const;
+   F64 getAverageTickTime() const;
+   F64 getMaxTickTime() const;
+   void resetTickStats();
+
    U32 getMaxPlayers() const;
 
    bool isTestServer() const;
@@ -165,8 +192,7 @@ public:
 
    void setShuttingDown(bool shuttingDown, U16 time, GameConnection *who, StringPtr reason);  
 
-   void resetLevelLoadIndex();
-   string loadNextLevelInfo();
+   Vector<string> loadLevelInfos();
    bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo);
 
    void deleteLevelGen(LuaLevelGenerator *levelgen);     // Add misbehaved levelgen to the kill list
@@ -180,6 +206,7 @@ public:
    void receivedLevelFromHoster(S32 levelIndex, const string &filename);
    void makeEmptyLevelIfNoGameType();
    void cycleLevel(S32 newLevelIndex = NEXT_LEVEL);
+   void onBotZonesBuilt(U32 levelLoadCount, const BotZoneGeometry &geometry, bool succeeded);
    void sendLevelStatsToMaster();
 
    void onConnectedToMaster();
@@ -202,6 +229,8 @@ public:
    void deleteAllBots();
    Robot *findBot(const char *id);
    void moreBots();
+
+   void getScriptProfile(Vector<string> &lines, bool reset);   // Profile of our bots and levelgens, for finding slow scripts
    void fewerBots();
    void kickSingleBotFromLargestTeamWithBots();
 
@@ -264,12 +293,15 @@ public:
    // BotNavMeshZone management
    GridDatabase *getBotZoneDatabase() const;
    const Vector<BotNavMeshZone *> *getBotZones() const;
+   ZoneRouteCache *getZoneRouteCache();
    U16 findZoneContaining(const Point &p) const;
 
    void setGameType(GameType *gameType);
    void onObjectAdded(BfObject *obj);
    void onObjectRemoved(BfObject *obj);
    GameRecorderServer *getGameRecorder();
+   BotThreadPool *getBotThreadPool() const;
+   VisibilityCache *getVisibilityCache() const;
 
    friend class ObjectTest;
 };
@@ -48,6 +48,24 @@ void initHosting(GameSettingsPtr settings, LevelSourcePtr levelSource, bool test
    GameManager::setServerGame(new ServerGame(address, settings, levelSource, testMode, dedicatedServer, hostOnServer));
 
    GameManager::getServerGame()->setReadyToConnectToMaster(true);
+
+   // Any further arenas listen on the ports following ours, and share our level list, so levels are only
+   // scanned once.  Each keeps its own connection to the master.
+   S32 arenaCount = testMode ? 1 : settings->getArenaCount();
+
+   for(S32 i = 1; i < arenaCount; i++)
+   {
+      Address arenaAddress = address;
+      arenaAddress.port += i;
+
+      ServerGame *arena = new ServerGame(arenaAddress, settings, levelSource, testMode, dedicatedServer, hostOnServer);
+      arena->setReadyToConnectToMaster(true);
+      GameManager::addServerGame(arena);
+   }
+
+   if(arenaCount > 1)
+      GameManager::getServerGame()->setAddTarget();    // Each arena claimed it as it was built; level loading needs it back
+
    Game::seedRandomNumberGenerator(settings->getHostName());
 
    // Don't need to build our level list when in test mode because we're only running that one level stored in editor.tmp
@@ -68,8 +86,6 @@ void initHosting(GameSettingsPtr settings, LevelSourcePtr levelSource, bool test
       return;
    }
 
-   GameManager::getServerGame()->resetLevelLoadIndex();
-
    if(hostOnServer)
       GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
 
@@ -139,8 +139,6 @@ const Vector<Point> *Teleporter::getDestList() const
 
 TNL_IMPLEMENT_NETOBJECT(Teleporter);
 
-static Vector<DatabaseObject *> foundObjects;      // Reusable container
-
 const F32 Teleporter::DamageReductionFactor = 0.5f;
 
 
@@ -259,7 +257,7 @@ bool Teleporter::processArguments(S32 argc2, const char **argv2, Game *game)
    // Note that editor handles multi-dest teleporters as separate single dest items, so this only runs on server!
    if(game->isServer())    
    {
-      foundObjects.clear();
+      Vector<DatabaseObject *> foundObjects;
       game->getGameObjDatabase()->findObjects(TeleporterTypeNumber, foundObjects, Rect(pos, 1));
 
       for(S32 i = 0; i < foundObjects.size(); i++)
@@ -328,7 +326,7 @@ bool Teleporter::checkDeploymentPosition(const Point &position, const GridDataba
    Rect queryRect(position, TELEPORTER_RADIUS);
    Point outPoint;  // only used as a return value in polygonCircleIntersect
 
-   foundObjects.clear();
+   Vector<DatabaseObject *> foundObjects;
    gb->findObjects((TestFunc) isCollideableType, foundObjects, queryRect);
 
    Point foundObjectCenter;
@@ -549,7 +547,7 @@ void Teleporter::doTeleport()
 
    Rect queryRect(getOrigin(), TRIGGER_RADIUS);     
 
-   foundObjects.clear();
+   Vector<DatabaseObject *> foundObjects;
    findObjects((TestFunc)isShipType, foundObjects, queryRect);
 
    S32 dest = getRandomDest();
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickScheduler.h"
+
+
+namespace Zap
+{
+
+
+TickScheduler::TickScheduler(U32 period)
+{
+   mPeriod = period;
+   mNextTickTime = 0;
+   mLastTickTime = 0;
+   mStarted = false;
+
+   resetStats();
+}
+
+
+TickScheduler::~TickScheduler()
+{
+   // Do nothing
+}
+
+
+void TickScheduler::setPeriod(U32 period)
+{
+   if(period == mPeriod)
+      return;
+
+   mPeriod = period;
+
+   if(mStarted)
+      mNextTickTime = mLastTickTime + period;
+}
+
+
+U32 TickScheduler::getPeriod() const
+{
+   return mPeriod;
+}
+
+
+U32 TickScheduler::getTimeToNextTick(U32 currentTime) const
+{
+   if(!mStarted)
+      return 0;
+
+   // Signed compare so this keeps working when the ms counter wraps
+   S32 timeLeft = S32(mNextTickTime - currentTime);
+   return timeLeft > 0 ? U32(timeLeft) : 0;
+}
+
+
+U32 TickScheduler::tick(U32 currentTime)
+{
+   if(!mStarted)
+   {
+      mStarted = true;
+      mLastTickTime = currentTime;
+      mNextTickTime = currentTime + mPeriod;
+      return mPeriod;
+   }
+
+   S32 late = S32(currentTime - mNextTickTime);
+   U32 jitter = late > 0 ? U32(late) : 0;
+
+   mTickCount++;
+   mJitterTotal += jitter;
+   if(jitter > mJitterMax)
+      mJitterMax = jitter;
+
+   U32 timeDelta = currentTime - mLastTickTime;
+   mLastTickTime = currentTime;
+
+   // Stay on schedule, running the next ticks back-to-back if we're behind... unless we're so far
+   // behind (server was frozen, or the clock jumped) that it's better to just start over from now
+   mNextTickTime += mPeriod;
+   if(S32(currentTime - mNextTickTime) >= S32(mPeriod * MaxCatchUpTicks))
+      mNextTickTime = currentTime + mPeriod;
+
+   return timeDelta;
+}
+
+
+U32 TickScheduler::getTickCount() const
+{
+   return mTickCount;
+}
+
+
+// Returns average lateness in ms
+F32 TickScheduler::getAverageJitter() const
+{
+   return mTickCount == 0 ? 0 : F32(mJitterTotal) / mTickCount;
+}
+
+
+U32 TickScheduler::getMaxJitter() const
+{
+   return mJitterMax;
+}
+
+
+void TickScheduler::resetStats()
+{
+   mTickCount = 0;
+   mJitterTotal = 0;
+   mJitterMax = 0;
+}
+
+
+} /* namespace Zap */
@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TICK_SCHEDULER_H_
+#define _TICK_SCHEDULER_H_
+
+#include "tnlTypes.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Keeps game ticks on a fixed schedule, and tracks how late each tick ran.  Ticks are due
+// every period ms measured from when the schedule started, not from when the previous tick
+// actually ran, so a late tick doesn't push back all the ones after it.
+class TickScheduler
+{
+private:
+   U32 mPeriod;
+   U32 mNextTickTime;
+   U32 mLastTickTime;
+   bool mStarted;
+
+   // Jitter stats -- how long after its scheduled time each tick ran
+   U32 mTickCount;
+   U32 mJitterTotal;
+   U32 mJitterMax;
+
+public:
+   static const U32 MaxCatchUpTicks = 5;     // When further behind than this, give up on the missed ticks
+
+   explicit TickScheduler(U32 period = 10);  // Constructor
+   virtual ~TickScheduler();                 // Destructor
+
+   void setPeriod(U32 period);   // Takes effect from the last tick
+   U32 getPeriod() const;
+
+   // Return how long until the next tick is due, 0 if it is due now
+   U32 getTimeToNextTick(U32 currentTime) const;
+
+   // Call when running a tick; returns time since the previous tick, suitable for passing to idle()
+   U32 tick(U32 currentTime);
+
+   U32 getTickCount() const;
+   F32 getAverageJitter() const;
+   U32 getMaxJitter() const;
+   void resetStats();
+};
+
+} /* namespace Zap */
+#endif
@@ -484,7 +484,7 @@ void EditorUserInterface::rebuildEverything(GridDatabase *database)
 // Resnaps all engineered items in database
 void EditorUserInterface::resnapAllEngineeredItems(GridDatabase *database, bool onlyUnsnapped)
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects((TestFunc)isEngineeredType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -752,7 +752,7 @@ void EditorUserInterface::runScript(GridDatabase *database, const FolderManager
 
    // Process new items that need it (walls need processing so that they can render properly).
    // Items that need no extra processing will be kept as-is.
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects((TestFunc)isWallType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -1003,7 +1003,7 @@ static bool hasTeamFlags(GridDatabase *database)
 
 static bool hasTeamSpawns(GridDatabase *database)
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects(FlagSpawnTypeNumber, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -1034,7 +1034,7 @@ void EditorUserInterface::validateLevel()
 
    GridDatabase *gridDatabase = getDatabase();
       
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    gridDatabase->findObjects(ShipSpawnTypeNumber, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -1092,7 +1092,7 @@ void EditorUserInterface::validateLevel()
       for(S32 i = 0; i < teamCount; i++)      // Initialize vector
          foundSpawn[i] = false;
 
-      fillVector.clear();
+      Vector<DatabaseObject *> fillVector;
       gridDatabase->findObjects(CoreTypeNumber, fillVector);
       for(S32 i = 0; i < fillVector.size(); i++)
       {
@@ -1202,7 +1202,7 @@ void EditorUserInterface::onSelectionChanged()
    wallSegmentManager->clearSelected();
    
    // Update wall segment manager with what's currently selected
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects((TestFunc)isWallType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -1667,8 +1667,8 @@ static S32 QSORT_CALLBACK sortByTeam(DatabaseObject **a, DatabaseObject **b)
 
 void EditorUserInterface::renderTurretAndSpyBugRanges(GridDatabase *editorDb)
 {
-   fillVector = *editorDb->findObjects_fast(SpyBugTypeNumber);  // This will actually copy vector of pointers to fillVector
-                                                                // so we can sort by team, this is still faster then findObjects.
+   Vector<DatabaseObject *> fillVector = *editorDb->findObjects_fast(SpyBugTypeNumber);  // Copy the vector of pointers so we can
+                                                                                         // sort by team, this is still faster than findObjects.
    if(fillVector.size() != 0)
    {
       // Use Z Buffer to make use of not drawing overlap visible area of same team SpyBug, but does overlap different team
@@ -2040,7 +2040,7 @@ void EditorUserInterface::render()
       // get the width for display at bottom of dock
       else  
       {
-         fillVector.clear();
+         Vector<DatabaseObject *> fillVector;
          editorDb->findObjects((TestFunc)isLineItemType, fillVector);
 
          for(S32 i = 0; i < fillVector.size(); i++)
@@ -2753,7 +2753,7 @@ void EditorUserInterface::findHitItemAndEdge()
    // Note that this is only used for requesting a candidate list from the database, actual hit detection is more precise.
    const Rect cursorRect((mMousePos - mCurrentOffset) / mCurrentScale, 50); 
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    GridDatabase *editorDb = getDatabase();
    editorDb->findObjects((TestFunc)isAnyObjectType, fillVector, cursorRect);
 
@@ -2777,12 +2777,12 @@ void EditorUserInterface::findHitItemAndEdge()
 
    // We've already checked for wall vertices; now we'll check for hits in the interior of walls
    GridDatabase *wallDb = editorDb->getWallSegmentManager()->getWallSegmentDatabase();
-   fillVector2.clear();
+   Vector<DatabaseObject *> fillVector2;
 
    wallDb->findObjects((TestFunc)isAnyObjectType, fillVector2, cursorRect);
 
    for(S32 i = 0; i < fillVector2.size(); i++)
-      if(checkForWallHit(mouse, fillVector2[i]))
+      if(checkForWallHit(mouse, fillVector2[i], fillVector))
          return;
 
    // If we're still here, it means we didn't find anything yet.  Make one more pass, and see if we're in any polys.
@@ -2854,7 +2854,8 @@ bool EditorUserInterface::checkForEdgeHit(const Point &point, BfObject *object)
 }
 
 
-bool EditorUserInterface::checkForWallHit(const Point &point, DatabaseObject *object)
+// candidates is the list of objects near point; the wall our segment belongs to should be one of them
+bool EditorUserInterface::checkForWallHit(const Point &point, DatabaseObject *object, const Vector<DatabaseObject *> &candidates)
 {
    TNLAssert(dynamic_cast<WallSegment *>(object), "Expected a WallSegment!");
    WallSegment *wallSegment = static_cast<WallSegment *>(object);
@@ -2862,12 +2863,12 @@ bool EditorUserInterface::checkForWallHit(const Point &point, DatabaseObject *ob
    if(triangulatedFillContains(wallSegment->getTriangulatedFillPoints(), point))
    {
       // Now that we've found a segment that our mouse is over, we need to find the wall object that it belongs to.  Chances are good
-      // that it will be one of the objects sitting in fillVector.
-      for(S32 i = 0; i < fillVector.size(); i++)
+      // that it will be one of the objects sitting in candidates.
+      for(S32 i = 0; i < candidates.size(); i++)
       {
-         if(isWallType(fillVector[i]->getObjectTypeNumber()))
+         if(isWallType(candidates[i]->getObjectTypeNumber()))
          {
-            BfObject *eobj = dynamic_cast<BfObject *>(fillVector[i]);
+            BfObject *eobj = dynamic_cast<BfObject *>(candidates[i]);
 
             if(eobj->getSerialNumber() == wallSegment->getOwner())
             {
@@ -3412,7 +3413,7 @@ void EditorUserInterface::changeBarrierWidth(S32 amt)
    if(!mLastUndoStateWasBarrierWidthChange)
       saveUndoState(); 
 
-   fillVector2.clear();    // fillVector gets modified in some child function, so use our secondary reusable container
+   Vector<DatabaseObject *> fillVector2;
    getDatabase()->findObjects((TestFunc)isWallItemType, fillVector2);
 
    for(S32 i = 0; i < fillVector2.size(); i++)
@@ -4677,7 +4678,7 @@ void EditorUserInterface::onKeyUp(InputCode inputCode)
          {
             Rect r(convertCanvasToLevelCoord(mMousePos), mMouseDownPos);
 
-            fillVector.clear();
+            Vector<DatabaseObject *> fillVector;
 
             getDatabase()->findObjects(fillVector);
 
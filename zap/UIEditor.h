@@ -232,7 +232,7 @@ private:
    void findHitItemAndEdge();                         
    bool checkForVertexHit(BfObject *object);
    bool checkForEdgeHit(const Point &point, BfObject *object);        
-   bool checkForWallHit(const Point &point, DatabaseObject *wallSegment);
+   bool checkForWallHit(const Point &point, DatabaseObject *wallSegment, const Vector<DatabaseObject *> &candidates);
    bool checkForPolygonHit(const Point &point, BfObject *object);    
 
    void findHitItemOnDock();     // Sets mDockItemHit
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "VisibilityCache.h"
+
+#include "BfObject.h"      // For isWallType
+#include "moveObject.h"    // For ActualState
+#include "gridDB.h"
+#include "GeomUtils.h"
+
+
+namespace Zap
+{
+
+// Point's operator< compares distances from the origin, so different points can look the same to it; we need a real order
+static bool pointLess(const Point &a, const Point &b)
+{
+   return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+
+// Constructor -- walls don't care which way you look through them, so from and to are put in a standard order
+VisibilityCache::Query::Query(const Point &from, const Point &to, F32 radius)
+{
+   if(pointLess(to, from))
+   {
+      this->from = to;
+      this->to = from;
+   }
+   else
+   {
+      this->from = from;
+      this->to = to;
+   }
+
+   this->radius = radius;
+}
+
+
+bool VisibilityCache::Query::operator<(const Query &other) const
+{
+   if(from != other.from)
+      return pointLess(from, other.from);
+
+   if(to != other.to)
+      return pointLess(to, other.to);
+
+   return radius < other.radius;
+}
+
+
+// Only used for picking a stripe, so it just needs to spread nearby queries around
+U32 VisibilityCache::Query::hash() const
+{
+   return U32(S32(from.x) * 73856093 ^ S32(from.y) * 19349663 ^ S32(to.x) * 83492791 ^ S32(to.y));
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+VisibilityCache::VisibilityCache(const GridDatabase *database)
+{
+   mDatabase = database;
+
+   for(S32 i = 0; i < StripeCount; i++)
+   {
+      mStripes[i].queries = 0;
+      mStripes[i].hits = 0;
+   }
+}
+
+
+// Destructor
+VisibilityCache::~VisibilityCache()
+{
+   // Do nothing
+}
+
+
+void VisibilityCache::clear()
+{
+   for(S32 i = 0; i < StripeCount; i++)
+   {
+      Stripe &stripe = mStripes[i];
+
+      stripe.lock.lock();
+      stripe.results.clear();
+      stripe.queries = 0;
+      stripe.hits = 0;
+      stripe.lock.unlock();
+   }
+}
+
+
+bool VisibilityCache::canSee(const Point &from, const Point &to)
+{
+   return lookup(Query(from, to, 0));
+}
+
+
+bool VisibilityCache::canSee(const Point &from, const Point &to, F32 radius)
+{
+   return lookup(Query(from, to, radius));
+}
+
+
+bool VisibilityCache::lookup(const Query &query)
+{
+   Stripe &stripe = mStripes[query.hash() % StripeCount];
+
+   stripe.lock.lock();
+   stripe.queries++;
+
+   map<Query, bool>::iterator it = stripe.results.find(query);
+   if(it != stripe.results.end())
+   {
+      bool visible = it->second;
+      stripe.hits++;
+      stripe.lock.unlock();
+
+      return visible;
+   }
+
+   stripe.lock.unlock();
+
+   // Work it out without holding the lock; if someone else asks the same thing meanwhile, we'll both get the same answer
+   bool visible = computeVisible(query);
+
+   stripe.lock.lock();
+   stripe.results[query] = visible;
+   stripe.lock.unlock();
+
+   return visible;
+}
+
+
+bool VisibilityCache::computeVisible(const Query &query) const
+{
+   if(query.radius == 0)
+   {
+      F32 time;
+      Point normal;
+
+      return mDatabase->findObjectLOS((TestFunc)isWallType, ActualState, true, query.from, query.to, time, normal) == NULL;
+   }
+
+   // Sweep a box as wide as the object along the line, and see if it hits any walls
+   Point difference = query.to - query.from;
+
+   Point crossVector(difference.y, -difference.x);  // Create a point whose vector from 0,0 is perpenticular to the original vector
+   crossVector.normalize(query.radius);             // reduce point so the vector has length of radius
+
+   Vector<Point> corridor;
+   corridor.push_back(query.from + crossVector);
+   corridor.push_back(query.from - crossVector);
+   corridor.push_back(query.to - crossVector);
+   corridor.push_back(query.to + crossVector);
+
+   Vector<DatabaseObject *> fillVector;
+   mDatabase->findObjects((TestFunc)isWallType, fillVector, Rect(corridor));
+
+   for(S32 i = 0; i < fillVector.size(); i++)
+   {
+      const Vector<Point> *otherPoints = fillVector[i]->getCollisionPoly();
+      if(otherPoints && polygonsIntersect(corridor, *otherPoints))
+         return false;
+   }
+
+   return true;
+}
+
+
+U32 VisibilityCache::getQueryCount() const
+{
+   U32 queries = 0;
+   for(S32 i = 0; i < StripeCount; i++)
+      queries += mStripes[i].queries;
+
+   return queries;
+}
+
+
+U32 VisibilityCache::getHitCount() const
+{
+   U32 hits = 0;
+   for(S32 i = 0; i < StripeCount; i++)
+      hits += mStripes[i].hits;
+
+   return hits;
+}
+
+
+} /* namespace Zap */
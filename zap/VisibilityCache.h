@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _VISIBILITY_CACHE_H_
+#define _VISIBILITY_CACHE_H_
+
+#include "Point.h"
+
+#include "tnlThread.h"
+
+#include <map>
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class GridDatabase;
+
+// Line-of-sight through walls, remembered for the rest of the tick.  The same questions get asked over and over each
+// tick -- a bot checks canSeePoint on its target, then getWaypoint checks it again; every bot chasing the flag asks which
+// zones can see it -- so each one only gets worked out once.  Only walls are considered, as they don't move during a
+// tick.  Safe to use from the bot threads.
+class VisibilityCache
+{
+private:
+   static const S32 StripeCount = 16;     // Results are spread over this many maps, each with its own lock
+
+   struct Query
+   {
+      Point from, to;
+      F32 radius;
+
+      Query(const Point &from, const Point &to, F32 radius);     // Constructor
+      bool operator<(const Query &other) const;
+      U32 hash() const;
+   };
+
+   struct Stripe
+   {
+      Mutex lock;
+      map<Query, bool> results;
+      U32 queries;
+      U32 hits;
+   };
+
+   const GridDatabase *mDatabase;
+   Stripe mStripes[StripeCount];
+
+   bool lookup(const Query &query);
+   bool computeVisible(const Query &query) const;
+
+public:
+   explicit VisibilityCache(const GridDatabase *database);     // Constructor
+   virtual ~VisibilityCache();                                 // Destructor
+
+   void clear();     // Call at the start of each tick
+
+   // Are there no walls between from and to?  Same answer as GridDatabase::pointCanSeePoint.
+   bool canSee(const Point &from, const Point &to);
+
+   // Could something of radius get from from to to without touching a wall?
+   bool canSee(const Point &from, const Point &to, F32 radius);
+
+   // Stats since the last clear(), for tuning
+   U32 getQueryCount() const;
+   U32 getHitCount() const;
+};
+
+
+} /* namespace Zap */
+#endif /* _VISIBILITY_CACHE_H_ */
@@ -85,7 +85,7 @@ void WallSegmentManager::finishedChangingWalls(GridDatabase *editorObjectDatabas
    // This block is a modified version of updateAllMountedItems that homes in on a particular segment
    // First, find any items directly mounted on our wall, and update their location.  Because we don't know where the wall _was_, we 
    // will need to search through all the engineered items, and query each to find which ones where attached to the wall that moved.
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    editorObjectDatabase->findObjects((TestFunc)isEngineeredType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -155,7 +155,7 @@ void WallSegmentManager::buildAllWallSegmentEdgesAndPoints(GridDatabase *databas
 {
    mWallSegmentDatabase->removeEverythingFromDatabase();
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects((TestFunc)isWallType, fillVector);
 
    Vector<DatabaseObject *> engrObjects;
@@ -261,7 +261,7 @@ void WallSegmentManager::updateAllMountedItems(GridDatabase *database)
 {
    // First, find any items directly mounted on our wall, and update their location.  Because we don't know where the wall _was_, we 
    // will need to search through all the engineered items, and query each to find which ones where attached to the wall that moved.
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    database->findObjects((TestFunc)isEngineeredType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -93,6 +93,11 @@ IniSettings::IniSettings()
 
    maxDedicatedFPS = 100;             // Max FPS on dedicated server
    maxFPS = 100;                      // Max FPS on client/non-dedicated server
+   packetPrepareThreads = 0;          // Prepare client packets on the main thread
+   botThreads = 0;                    // Run bots on the main thread
+   luaTickInstructionBudget = 1000000;
+   luaTickTimeBudget = 10;
+   luaWatchdogTimeout = 2000;
 
    masterAddress = MASTER_SERVER_LIST_ADDRESS;   // Default address of our master server
    name = "";                         // Player name (none by default)
@@ -661,6 +666,16 @@ static void loadHostConfiguration(CIniFile *ini, IniSettings *iniSettings)
       iniSettings->maxDedicatedFPS = fps; 
    // TODO: else warn?
 
+   S32 threads = ini->GetValueI(section, "PacketPrepareThreads", iniSettings->packetPrepareThreads);
+   if(threads >= 0)
+      iniSettings->packetPrepareThreads = threads;
+
+   iniSettings->botThreads = max(ini->GetValueI(section, "BotThreads", iniSettings->botThreads), 0);
+
+   iniSettings->luaTickInstructionBudget = max(ini->GetValueI(section, "LuaTickInstructionBudget", iniSettings->luaTickInstructionBudget), 0);
+   iniSettings->luaTickTimeBudget        = max(ini->GetValueI(section, "LuaTickTimeBudget",        iniSettings->luaTickTimeBudget),        0);
+   iniSettings->luaWatchdogTimeout       = max(ini->GetValueI(section, "LuaWatchdogTimeout",       iniSettings->luaWatchdogTimeout),       0);
+
    iniSettings->logStats = ini->GetValueYN(section, "LogStats", iniSettings->logStats);
 
    //iniSettings->SendStatsToMaster = (lcase(ini->GetValue(section, "SendStatsToMaster", "yes")) != "no");
@@ -1791,6 +1806,15 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
       addComment(" KickIdlePlayers - If true, the server will kick players that are considered idle.");
       addComment(" AlertsVolume - Volume of audio alerts when players join or leave game from 0 (mute) to 10 (full bore).");
       addComment(" MaxFPS - Maximum FPS the dedicaetd server will run at.  Higher values use more CPU, lower may increase lag (default = 100).");
+      addComment(" PacketPrepareThreads - Number of worker threads used to work out which objects each player sees each tick.  Helps busy servers");
+      addComment("                        on multi-core machines; 0 does all the work on the main thread (default = 0).");
+      addComment(" BotThreads - Number of worker threads used to run robots' onTick() in parallel.  Each bot then gets a Lua instance");
+      addComment("              of its own, costing some memory; 0 runs all bots on the main thread (default = 0).");
+      addComment(" LuaTickInstructionBudget - Lua instructions each bot or levelgen may run in one tick.  Scripts going over budget skip some");
+      addComment("                            of their onTick() calls to make up for it; 0 = no limit (default = 1000000).");
+      addComment(" LuaTickTimeBudget - Same, in ms of run time per tick (default = 10).");
+      addComment(" LuaWatchdogTimeout - Scripts stuck in a single call for this many ms, or for 20 ticks' worth of instructions, are killed;");
+      addComment("                      0 = never (default = 2000).  With all three Lua settings at 0, scripts can be compiled by LuaJIT.");
       addComment(" RandomLevels - When current level ends, this can enable randomly switching to any available levels.");
       addComment(" SkipUploads - When current level ends, enables skipping all uploaded levels.");
       addComment(" AllowGetMap - When getmap is allowed, anyone can download the current level using the /getmap command.");
@@ -1827,6 +1851,11 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
    ini->setValueYN(section, "AllowGetMap", iniSettings->allowGetMap);
    ini->setValueYN(section, "AllowDataConnections", iniSettings->allowDataConnections);
    ini->SetValueI (section, "MaxFPS", iniSettings->maxDedicatedFPS);
+   ini->SetValueI (section, "PacketPrepareThreads", iniSettings->packetPrepareThreads);
+   ini->SetValueI (section, "BotThreads", iniSettings->botThreads);
+   ini->SetValueI (section, "LuaTickInstructionBudget", iniSettings->luaTickInstructionBudget);
+   ini->SetValueI (section, "LuaTickTimeBudget", iniSettings->luaTickTimeBudget);
+   ini->SetValueI (section, "LuaWatchdogTimeout", iniSettings->luaWatchdogTimeout);
    ini->setValueYN(section, "LogStats", iniSettings->logStats);
 
    ini->setValueYN(section, "RandomLevels", S32(iniSettings->randomLevels) );
@@ -2056,7 +2085,8 @@ FolderManager::FolderManager(const string &levelDir,    const string &robotDir,
                rootDataDir   (rootDataDir),
                pluginDir     (pluginDir),
                fontsDir      (fontsDir),
-               recordDir     (recordDir)
+               recordDir     (recordDir),
+               cacheDir      ("")
 {
    // Do nothing (more)
 }
@@ -2104,6 +2134,7 @@ void FolderManager::resolveDirs(GameSettings *settings)
    folderManager->screenshotDir = resolutionHelper(cmdLineDirs.screenshotDir, rootDataDir, "screenshots");
    folderManager->musicDir      = resolutionHelper(cmdLineDirs.musicDir,      rootDataDir, "music");
    folderManager->recordDir     = resolutionHelper(cmdLineDirs.recordDir,     rootDataDir, "record");
+   folderManager->cacheDir      = resolutionHelper("",                        rootDataDir, "cache");
 
    // rootDataDir not used for these folders
    folderManager->sfxDir        = resolutionHelper(cmdLineDirs.sfxDir,        "", "sfx");
@@ -2126,6 +2157,7 @@ void FolderManager::resolveDirs(const string &root)
    screenshotDir = joindir(root, "screenshots");
    musicDir      = joindir(root, "music");
    recordDir     = joindir(root, "record");
+   cacheDir      = joindir(root, "cache");
 
    // root not used for these folders
    sfxDir        = joindir("", "sfx");
@@ -61,6 +61,7 @@ struct FolderManager
    string pluginDir;
    string fontsDir;
    string recordDir;
+   string cacheDir;        // For things we can rebuild, but would rather not; not settable from the cmd line
 
    void resolveDirs(GameSettings *settings);                                  
    void resolveDirs(const string &root);
@@ -200,6 +201,11 @@ public:
 
    U32 maxDedicatedFPS;
    U32 maxFPS;
+   U32 packetPrepareThreads;        // Worker threads used to prepare ghost updates for clients; 0 = prepare on the main thread
+   U32 botThreads;                  // Worker threads used to run bots' onTick() in parallel; 0 = run bots on the main thread
+   U32 luaTickInstructionBudget;    // Lua instructions each bot or levelgen may run per tick before being throttled; 0 = no limit
+   U32 luaTickTimeBudget;           // Ms each bot or levelgen may run per tick before being throttled; 0 = no limit
+   U32 luaWatchdogTimeout;          // Ms a single call into a script may run before the script is killed; 0 = no limit
 
 
    string masterAddress;            // Default address of our master server
@@ -362,6 +362,9 @@ bool ControlObjectConnection::getObjectMovedThisGame()
 
 void ControlObjectConnection::writeCompressedPoint(const Point &p, BitStream *stream)
 {
+   // Points are relative to this connection's view, and not every connection compresses them
+   markPackUpdateConnectionSpecific();
+
    if(!mCompressPointsRelative)
    {
       stream->write(p.x);
@@ -57,7 +57,6 @@ U32 NameToAddressThread::run()
 ////////////////////////////////////////
 ////////////////////////////////////////
 
-static Vector<DatabaseObject *> fillVector2;
 md5wrapper Game::md5;
 
 ////////////////////////////////////
@@ -99,6 +98,8 @@ Game::Game(const Address &theBindAddress, GameSettingsPtr settings) : mGameObjDa
    mObjectsLoaded = 0;
 
    mSecondaryThread = new Master::DatabaseAccessThread();
+
+   mMoveScratch = new MoveScratch();
 }
 
 
@@ -108,6 +109,7 @@ Game::~Game()
    if(mNameToAddressThread)
       delete mNameToAddressThread;
    delete mSecondaryThread;
+   delete mMoveScratch;
 }
 
 
@@ -364,6 +366,12 @@ GridDatabase *Game::getGameObjDatabase()
 }
 
 
+MoveScratch *Game::getMoveScratch()
+{
+   return mMoveScratch;
+}
+
+
 MasterServerConnection *Game::getConnectionToMaster()
 {
    return mConnectionToMaster;
@@ -599,57 +607,66 @@ void Game::resetLevelInfo()
 
 // Each line of the file is handled separately by processLevelLoadLine in game.cpp or UIEditor.cpp
 
-void Game::parseLevelLine(const char *line, GridDatabase *database, const string &levelFileName)
+void Game::parseLevelLine(const char *line, S32 length, LevelLineTokenizer &tokenizer, GridDatabase *database, 
+                          const string &levelFileName)
 {
-   Vector<string> args = parseString(string(line));
-   U32 argc = args.size();
-   S32 id = 0;
-   const char** argv = new const char* [argc];
-
-   if(argc >= 1)
-   {
-      std::size_t pos = args[0].find("!");
-      if(pos != string::npos)
-      {
-         id = atoi(args[0].substr(pos + 1, args[0].size() - pos - 1).c_str());
-         args[0] = args[0].substr(0, pos);
-      }
-   }
-
-   for(U32 i = 0; i < argc; i++)
-   {
-      argv[i] = args[i].c_str();
-   }
+   U32 argc = tokenizer.tokenize(line, length);
 
    try
    {
-      processLevelLoadLine(argc, id, (const char **) argv, database, levelFileName);
+      processLevelLoadLine(argc, tokenizer.getId(), tokenizer.getArgv(), database, levelFileName);
    }
    catch(LevelLoadException &e)
    {
-      logprintf("Level Error: Can't parse %s: %s", line, e.what());  // TODO: fix "line" variable having hundreds of level lines
+      logprintf("Level Error: Can't parse %s: %s", string(line, length).c_str(), e.what());
    }
-
-   delete[] argv;
 }
 
 
 void Game::loadLevelFromString(const string &contents, GridDatabase* database, const string &filename)
 {
-   istringstream iss(contents);
-   string line;
-   while(std::getline(iss, line))
-      parseLevelLine(line.c_str(), database, filename);
+   loadLevelFromBuffer(contents.c_str(), (S32)contents.size(), database, filename);
+}
+
+
+// Walks the level one line at a time, straight out of the buffer we were given
+void Game::loadLevelFromBuffer(const char *contents, S32 size, GridDatabase *database, const string &filename)
+{
+   LevelLineTokenizer tokenizer;
+
+   const char *pos = contents;
+   const char *end = contents + size;
+
+   while(pos < end)
+   {
+      const char *eol = (const char *)memchr(pos, '\n', end - pos);
+      if(!eol)
+         eol = end;
+
+      parseLevelLine(pos, S32(eol - pos), tokenizer, database, filename);
+      pos = eol + 1;
+   }
 }
 
 
-bool Game::loadLevelFromFile(const string &filename, GridDatabase *database)
+// If md5Hash is provided, it will be filled with the hash of the file, computed as the file is read
+bool Game::loadLevelFromFile(const string &filename, GridDatabase *database, string *md5Hash)
 {
-   string contents = readFile(filename);
+   string contents;
+   string hash = md5.getHashFromFile(filename, contents);
+
    if(contents == "")
       return false;
 
-   loadLevelFromString(contents, database, filename);
+   if(md5Hash)
+      *md5Hash = hash;
+
+   // Skip the UTF-8 BOM, the same way readFile() would
+   string::size_type start = contents.find_first_not_of("\357\273\277");
+   if(start == string::npos)
+      return false;
+
+   loadLevelFromBuffer(contents.c_str() + start, S32(contents.size() - start), database, filename);
 
 #ifdef SAM_ONLY
    // In case the level crash the game trying to load, want to know which file is the problem. 
@@ -822,8 +839,6 @@ void Game::processLevelLoadLine(U32 argc, S32 id, const char **argv, GridDatabas
          object->setUserAssignedId(id, false);
          object->addToGame(this, database);
 
-         computeWorldObjectExtents();    // Make sure this is current if we process a robot that needs this for intro code
-
          // Mark the item as being a ghost (client copy of a server object) so that the object will not trigger server-side tests
          // The only time this code is run on the client is when loading into the editor.
          if(!isServer())
@@ -1144,7 +1159,7 @@ void Game::processDeleteList(U32 timeDelta)
 // Delete all objects of specified type  --> currently only used to remove all walls from the game
 void Game::deleteObjects(U8 typeNumber)
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mGameObjDatabase->findObjects(typeNumber, fillVector);
    for(S32 i = 0; i < fillVector.size(); i++)
    {
@@ -1157,7 +1172,7 @@ void Game::deleteObjects(U8 typeNumber)
 // Not currently used
 void Game::deleteObjects(TestFunc testFunc)
 {
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mGameObjDatabase->findObjects(testFunc, fillVector);
    for(S32 i = 0; i < fillVector.size(); i++)
    {
@@ -1167,17 +1182,11 @@ void Game::deleteObjects(TestFunc testFunc)
 }
 
 
-void Game::computeWorldObjectExtents()
-{
-   mWorldExtents = mGameObjDatabase->getExtents();
-}
-
-
 Rect Game::computeBarrierExtents()
 {
    Rect extents;
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mGameObjDatabase->findObjects((TestFunc)isWallType, fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -1265,7 +1274,7 @@ void Game::cleanUp()
 
 const Rect *Game::getWorldExtents() const
 {
-   return &mWorldExtents;
+   return &mGameObjDatabase->getExtents();
 }
 
 
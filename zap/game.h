@@ -164,9 +164,11 @@ class WallItem;
 class LuaLevelGenerator;
 class Teleporter;
 class MoveItem;
+struct MoveScratch;
 class AbstractSpawn;
 
 struct WallRec;
+class LevelLineTokenizer;
 
 
 class Game
@@ -198,12 +200,13 @@ private:
    NameToAddressThread *mNameToAddressThread;
    Master::DatabaseAccessThread *mSecondaryThread;
 
+   MoveScratch *mMoveScratch;             // Reused by every MoveObject::move() so moving doesn't allocate
+
 protected:
    U32 mNextMasterTryTime;
 
    bool mReadyToConnectToMaster;
 
-   Rect mWorldExtents;                    // Extents of everything
    string mLevelFileHash;                 // MD5 hash of level file
 
    virtual void idle(U32 timeDelta);      // Only called from ServerGame::idle() and ClientGame::idle()
@@ -304,14 +307,13 @@ public:
    ClientInfo *findClientInfo(const StringTableEntry &name);      // Find client by name
    Ship *findShip(const StringTableEntry &clientName);            // Find ship by name
    
-   const Rect *getWorldExtents() const;
+   const Rect *getWorldExtents() const;      // Maintained by our object database as things come and go
 
    virtual const Color *getTeamColor(S32 teamId) const;
    const Color *getTeamHealthBarColor(S32 teamId) const;
 
    virtual void setPreviousLevelName(const string &name);
 
-   void computeWorldObjectExtents();
    Rect computeBarrierExtents();
 
    Point computePlayerVisArea(Ship *ship) const;
@@ -344,8 +346,10 @@ public:
 
 
    void loadLevelFromString(const string &contents, GridDatabase *database, const string& filename = "");
-   bool loadLevelFromFile(const string &filename, GridDatabase *database);
-   void parseLevelLine(const char *line, GridDatabase *database, const string &levelFileName);
+   void loadLevelFromBuffer(const char *contents, S32 size, GridDatabase *database, const string& filename = "");
+   bool loadLevelFromFile(const string &filename, GridDatabase *database, string *md5Hash = NULL);
+   void parseLevelLine(const char *line, S32 length, LevelLineTokenizer &tokenizer, GridDatabase *database, 
+                       const string &levelFileName);
 
    void processLevelLoadLine(U32 argc, S32 id, const char **argv, GridDatabase *database, const string &levelFileName);  
    bool processLevelParam(S32 argc, const char **argv);
@@ -386,6 +390,7 @@ public:
 
    GameNetInterface *getNetInterface();
    virtual GridDatabase *getGameObjDatabase();
+   MoveScratch *getMoveScratch();
 
    const Vector<SafePtr<BfObject> > &getScopeAlwaysList();
 
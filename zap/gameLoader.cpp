@@ -17,6 +17,7 @@
 #include <sstream>
 
 #include <stdio.h>
+#include <string.h>
 
 #  ifdef TNL_OS_WIN32
 #     include "../other/dirent.h"        // Need local copy for Windows builds
@@ -35,6 +36,115 @@ namespace Zap
 using namespace std;
 
 
+// Constructor
+LevelLineTokenizer::LevelLineTokenizer()
+{
+   mId = 0;
+}
+
+
+// Destructor
+LevelLineTokenizer::~LevelLineTokenizer()
+{
+   // Do nothing
+}
+
+
+// Same set of chars istream >> uses to separate words, plus the terminators we've written over them
+static bool isWordSeparator(char c)
+{
+   return c == '\0' || c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+
+// Follows the rules of parseString(): words are separated by whitespace, and a word starting with a quote runs
+// until the next quote, even across whitespace.  Quotes are then trimmed off both ends of the word.
+S32 LevelLineTokenizer::tokenize(const char *line, S32 length)
+{
+   mArgv.clear();
+   mId = 0;
+
+   // parseString() only ever saw the line up to the first NUL
+   const char *nul = (const char *)memchr(line, '\0', length);
+   if(nul)
+      length = S32(nul - line);
+
+   // One extra char so the last word always has somewhere to put its terminator
+   mLine.resize(length + 1);
+   char *buf = mLine.address();
+   memcpy(buf, line, length);
+   buf[length] = '\0';
+
+   S32 pos = 0;
+
+   while(true)
+   {
+      while(pos < length && isWordSeparator(buf[pos]))
+         pos++;
+
+      if(pos == length)
+         break;
+
+      S32 start = pos;
+      while(pos < length && !isWordSeparator(buf[pos]))
+         pos++;
+
+      S32 end = pos;
+
+      if(buf[start] == '"')
+      {
+         // Opening quote without a closing one -- keep going up to the next quote, which gets eaten
+         if(buf[end - 1] != '"')
+         {
+            while(pos < length && buf[pos] != '"')
+               pos++;
+
+            end = pos;
+
+            if(pos < length)
+               pos++;
+         }
+
+         while(start < end && buf[start] == '"')
+            start++;
+
+         while(end > start && buf[end - 1] == '"')
+            end--;
+      }
+
+      // Everything past end has already been consumed, so we're free to stomp on it
+      buf[end] = '\0';
+      mArgv.push_back(buf + start);
+   }
+
+   if(mArgv.size() > 0)
+   {
+      char *bang = strchr((char *)mArgv[0], '!');
+      if(bang)
+      {
+         mId = atoi(bang + 1);
+         *bang = '\0';
+      }
+   }
+
+   return mArgv.size();
+}
+
+
+const char **LevelLineTokenizer::getArgv()
+{
+   return mArgv.size() > 0 ? mArgv.address() : NULL;
+}
+
+
+S32 LevelLineTokenizer::getId() const
+{
+   return mId;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
 
 // Constructor
 LevelLoadException::LevelLoadException(string str) : msg(str)
@@ -17,6 +17,25 @@ using namespace std;
 namespace Zap
 {
 
+// Splits lines of a level file into words, the same way parseString() does, but without allocating anything
+// once it has warmed up.  Each line is copied into a scratch buffer that is reused from line to line, and the
+// words are NUL-terminated in place there, so the argv we hand out is only good until the next call to tokenize().
+class LevelLineTokenizer
+{
+private:
+   Vector<char> mLine;
+   Vector<const char *> mArgv;
+   S32 mId;
+
+public:
+   LevelLineTokenizer();            // Constructor
+   virtual ~LevelLineTokenizer();   // Destructor
+
+   S32 tokenize(const char *line, S32 length);   // Returns argc
+
+   const char **getArgv();
+   S32 getId() const;               // Value of the !id suffix on the first word, 0 if there wasn't one
+};
 
 
 ////////////////////////////////////////
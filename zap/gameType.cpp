@@ -36,6 +36,7 @@
 
 #include "tnlThread.h"
 #include <math.h>
+#include <algorithm>
 
 namespace Zap
 {
@@ -1363,8 +1364,6 @@ void GameType::performScopeQuery(GhostConnection *connection)
    }
 
    // What does the spy bug see?
-   bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
-
    const Vector<DatabaseObject *> *spyBugs = mGame->getGameObjDatabase()->findObjects_fast(SpyBugTypeNumber);
    const Point scopeRange(SpyBug::SPY_BUG_RADIUS, SpyBug::SPY_BUG_RADIUS * FloatSqrt3Half);  // Bounding box of hexagon
 
@@ -1380,9 +1379,8 @@ void GameType::performScopeQuery(GhostConnection *connection)
 
          queryRect.expand(scopeRange);
 
-         fillVector.clear();
-         mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect, sameQuery);
-         sameQuery = true;
+         Vector<DatabaseObject *> fillVector;
+         mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
 
          for(S32 j = 0; j < fillVector.size(); j++)
          {
@@ -1430,11 +1428,11 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
    GameConnection *connection = clientInfo->getConnection();
    TNLAssert(connection, "NULL gameConnection!");
 
+   Vector<DatabaseObject *> fillVector;
+
    if(isTeamGame() && connection->isInCommanderMap())
    {
       S32 teamId = clientInfo->getTeamIndex();
-      fillVector.clear();
-      bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
 
       for(S32 i = 0; i < mGame->getClientCount(); i++)
       {
@@ -1459,9 +1457,13 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
             else     // No sensor
                testFunc = &isVisibleOnCmdrsMapType;
 
-         mGame->getGameObjDatabase()->findObjects(testFunc, fillVector, queryRect, sameQuery);
-         sameQuery = true;
+         mGame->getGameObjDatabase()->findObjects(testFunc, fillVector, queryRect);
       }
+
+      // Teammates' views usually overlap, so weed out objects found more than once
+      std::vector<DatabaseObject *> &found = fillVector.getStlVector();
+      std::sort(found.begin(), found.end());
+      fillVector.resize(U32(std::unique(found.begin(), found.end()) - found.begin()));
    }
    else     // Not a team game OR not in commander's map -- Do a simple query of the objects within scope range of the ship
    {
@@ -1473,7 +1475,6 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
       Rect queryRect(pos, pos);
       queryRect.expand( mGame->getScopeRange(co->hasModule(ModuleSensor)) );
 
-      fillVector.clear();
       mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
    }
 
@@ -1529,7 +1530,7 @@ void GameType::queryItemsOfInterest()
       Rect queryRect(pos, pos);
 
       queryRect.expand(scopeRange);
-      fillVector.clear();
+      Vector<DatabaseObject *> fillVector;
       mGame->getGameObjDatabase()->findObjects((TestFunc)isShipType, fillVector, queryRect);
 
       for(S32 j = 0; j < fillVector.size(); j++)
@@ -2236,7 +2237,7 @@ void GameType::changeClientTeam(ClientInfo *client, S32 team)
    if(ship)
    {
       // Find all spybugs and mines that this player owned, and reset ownership
-      fillVector.clear();
+      Vector<DatabaseObject *> fillVector;
       mGame->getGameObjDatabase()->findObjects((TestFunc)isGrenadeType, fillVector);
 
       for(S32 i = 0; i < fillVector.size(); i++)
@@ -2507,7 +2508,7 @@ GAMETYPE_RPC_S2C(GameType, s2cClientJoinedTeam,
    // save the overhead of sending a separate message which, while theoretically cleaner, will never be needed practically.
    if(localClientInfo->getName() == name)
    {
-      fillVector.clear();
+      Vector<DatabaseObject *> fillVector;
       mGame->getGameObjDatabase()->findObjects((TestFunc)isGrenadeType, fillVector);
 
       for(S32 i = 0; i < fillVector.size(); i++)
@@ -2698,11 +2699,41 @@ void GameType::processServerCommand(ClientInfo *clientInfo, const char *cmd, Vec
                   GameConnection *gc = mGame->getClientInfo(i)->getConnection();
                   gc->s2rVoiceChatEnable(serverGame->getSettings()->getIniSettings()->enableServerVoiceChat && !gc->mChatMute);
                }
+         IniSettings *iniSettings = serverGame->getSettings()->getIniSettings();
+         LuaScriptRunner::setBudgets(iniSettings->luaTickInstructionBudget, iniSettings->luaTickTimeBudget, iniSettings->luaWatchdogTimeout);
+
          clientInfo->getConnection()->s2cDisplayMessage(0, 0, "Configuration settings loaded");
       }
       else
          clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
    }
+   else if(stricmp(cmd, "luaprofile") == 0)
+   {
+      if(clientInfo->isAdmin())
+      {
+         bool reset = args.size() > 0 && stricmp(args[0].getString(), "reset") == 0;
+
+         Vector<string> lines;
+         serverGame->getScriptProfile(lines, reset);
+
+         // Goes to the log too, where it's easier to read than in a message box
+         logprintf(LogConsumer::ServerFilter, "Lua script profile, requested by %s:", clientInfo->getName().getString());
+
+         Vector<StringTableEntry> message;
+         for(S32 i = 0; i < lines.size(); i++)
+         {
+            logprintf(LogConsumer::ServerFilter, "%s", lines[i].c_str());
+            message.push_back(lines[i].c_str());
+         }
+
+         if(reset)
+            message.push_back("Profile has been reset");
+
+         clientInfo->getConnection()->s2cDisplayMessageBox("Lua Script Profile", "Press [[Esc]] to continue", message);
+      }
+      else
+         clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
+   }
    else
       clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Invalid Command");
 }
@@ -3310,7 +3341,7 @@ GAMETYPE_RPC_C2S(GameType, c2sSendChatPM, (StringTableEntry toName, StringPtr me
    if(!source->checkMessage(message.getString(), 2))     // Check message for flooding, etc.
       return;
 
-   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayChatPM, (sourceClientInfo->getName(), toName, message));
+   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_BROADCAST(this, s2cDisplayChatPM, (sourceClientInfo->getName(), toName, message));
    clientInfo->getConnection()->postNetEvent(theEvent);
    source->postNetEvent(theEvent);
 }
@@ -3354,16 +3385,16 @@ void GameType::displayAnnouncement(const string &message) const
 {
    TNLAssert(dynamic_cast<ServerGame *>(mGame), "Server only!");
 
-   for(S32 i = 0; i < mGame->getClientCount(); i++)
-   {
-      if(mGame->getClientInfo(i)->isRobot())
-         continue;
+   Vector<GameConnection *> connections;
+   getBroadcastConnections(connections, false);    // Announcements aren't recorded
 
-      GameConnection *conn = mGame->getClientInfo(i)->getConnection();
+   if(connections.size() == 0)
+      return;
 
-      if(conn)
-         conn->s2cDisplayAnnouncement(message);
-   }
+   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_BROADCAST(connections[0], s2cDisplayAnnouncement, (message));
+
+   for(S32 i = 0; i < connections.size(); i++)
+      connections[i]->postNetEvent(theEvent);
 }
 
 
@@ -3385,7 +3416,7 @@ GAMETYPE_RPC_C2S(GameType, c2sSendChatSTE, (bool global, StringTableEntry messag
 // Note that sender may be NULL, if the message has been sent by a LevelController script
 void GameType::sendChat(const StringTableEntry &senderName, ClientInfo *senderClientInfo, const StringPtr &message, bool global, S32 teamIndex)
 {
-   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cDisplayChatMessage, (global, senderName, message));
+   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_BROADCAST(this, s2cDisplayChatMessage, (global, senderName, message));
 
    for(S32 i = 0; i < mGame->getClientCount(); i++)
    {
@@ -3501,7 +3532,7 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sResendItemStatus, (U16 itemId), (itemId
       }
    }
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    mGame->getGameObjDatabase()->findObjects(fillVector);
 
    for(S32 i = 0; i < fillVector.size(); i++)
@@ -3685,7 +3716,7 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sVoiceChat, (bool echo, ByteBufferPtr vo
 
    if(source)
    {
-      RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cVoiceChat, (sourceClientInfo->getName(), voiceBuffer));
+      RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_BROADCAST(this, s2cVoiceChat, (sourceClientInfo->getName(), voiceBuffer));
 
       for(S32 i = 0; i < mGame->getClientCount(); i++)
       {
@@ -3986,20 +4017,47 @@ const Vector<WallRec> *GameType::getBarrierList()
 }
 
 
-// Send a message to all clients
-void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &message)
+// Fills connections with the connection of every human client that can receive events, followed by
+// the game recorder's if includeRecorder is set and we're recording.  Server only.
+void GameType::getBroadcastConnections(Vector<GameConnection *> &connections, bool includeRecorder) const
 {
-   if(!isGameOver())  // Avoid flooding messages on game over.
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
    {
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-         if(!mGame->getClientInfo(i)->isRobot())
-            mGame->getClientInfo(i)->getConnection()->s2cDisplayMessage(color, sfx, message);
+      ClientInfo *clientInfo = mGame->getClientInfo(i);
+      if(clientInfo->isRobot())
+         continue;
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         gc->s2cDisplayMessage(color, sfx, message);
+      GameConnection *conn = clientInfo->getConnection();
+      if(conn && conn->canPostNetEvent())
+         connections.push_back(conn);
    }
 
+   if(!includeRecorder)
+      return;
+
+   GameConnection *gc = static_cast<ServerGame *>(mGame)->getGameRecorder();
+   if(gc && gc->canPostNetEvent())
+      connections.push_back(gc);
+}
+
+
+// Send a message to all clients
+void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &message)
+{
+   if(isGameOver())  // Avoid flooding messages on game over.
+      return;
+
+   Vector<GameConnection *> connections;
+   getBroadcastConnections(connections, true);
+
+   if(connections.size() == 0)
+      return;
+
+   // One event, posted to everyone
+   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_BROADCAST(connections[0], s2cDisplayMessage, (color, sfx, message));
+
+   for(S32 i = 0; i < connections.size(); i++)
+      connections[i]->postNetEvent(theEvent);
 }
 
 
@@ -4007,16 +4065,19 @@ void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles
 void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, 
                                 const StringTableEntry &formatString, const Vector<StringTableEntry> &e)
 {
-   if(!isGameOver())  // Avoid flooding messages on game over
-   {
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-         if(!mGame->getClientInfo(i)->isRobot())
-            mGame->getClientInfo(i)->getConnection()->s2cDisplayMessageE(color, sfx, formatString, e);
+   if(isGameOver())  // Avoid flooding messages on game over
+      return;
 
-      GameConnection *gc = ((ServerGame*)mGame)->getGameRecorder();
-      if(gc)
-         gc->s2cDisplayMessageE(color, sfx, formatString, e);
-   }
+   Vector<GameConnection *> connections;
+   getBroadcastConnections(connections, true);
+
+   if(connections.size() == 0)
+      return;
+
+   RefPtr<NetEvent> theEvent = TNL_RPC_CONSTRUCT_BROADCAST(connections[0], s2cDisplayMessageE, (color, sfx, formatString, e));
+
+   for(S32 i = 0; i < connections.size(); i++)
+      connections[i]->postNetEvent(theEvent);
 }
 
 
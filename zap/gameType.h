@@ -100,6 +100,8 @@ private:
    void fewerBots(ClientInfo *clientInfo);
    void moreBots(ClientInfo *clientInfo);
 
+   void getBroadcastConnections(Vector<GameConnection *> &connections, bool includeRecorder) const;   // Every human client
+
 protected:
    Timer mScoreboardUpdateTimer;
 
@@ -511,8 +513,6 @@ public:
    bool addBotFromClient(Vector<StringTableEntry> args);
 
    void displayAnnouncement(const string &message) const;
-
-   map <pair<U16,U16>, Vector<Point> > cachedBotFlightPlans;  // cache of zone-to-zone flight plans, shared for all bots
 };
 
 #define GAMETYPE_RPC_S2C(className, methodName, args, argNames) \
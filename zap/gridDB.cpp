@@ -10,10 +10,12 @@
 
 #include "tnlLog.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Zap
 {
 
-U32 GridDatabase::mQueryId = 0;
 ClassChunker<DatabaseBucketEntry> *GridDatabase::mChunker = NULL;
 U32 GridDatabase::mCountGridDatabase = 0;
 
@@ -23,6 +25,35 @@ static U32 getNextId()
    return nextId++;
 }
 
+// Adapters that let our search code work with either of the ways callers specify the types they are looking for
+struct TestFuncTypeTest
+{
+   TestFunc mTestFunc;
+
+   explicit TestFuncTypeTest(TestFunc testFunc) { mTestFunc = testFunc; }
+   bool operator()(U8 typeNumber) const { return mTestFunc(typeNumber); }
+};
+
+
+struct TypeNumberTypeTest
+{
+   U8 mTypeNumber;
+
+   explicit TypeNumberTypeTest(U8 typeNumber) { mTypeNumber = typeNumber; }
+   bool operator()(U8 typeNumber) const { return typeNumber == mTypeNumber; }
+};
+
+
+struct TypeListTypeTest
+{
+   const Vector<U8> &mTypes;
+   const GridDatabase *mDatabase;
+
+   TypeListTypeTest(const Vector<U8> &types, const GridDatabase *database) : mTypes(types) { mDatabase = database; }
+   bool operator()(U8 typeNumber) const { return mDatabase->testTypes(mTypes, typeNumber); }
+};
+
+
 // Constructor
 GridDatabase::GridDatabase(bool createWallSegmentManager)
 {
@@ -31,9 +62,19 @@ GridDatabase::GridDatabase(bool createWallSegmentManager)
 
    mCountGridDatabase++;
 
-   for(U32 i = 0; i < BucketRowCount; i++)
-      for(U32 j = 0; j < BucketRowCount; j++)
-         mBuckets[i][j].nextInBucket = NULL;
+   mBucketWidthBitShift = DefaultBucketWidthBitShift;
+   mBucketMinX = -DefaultBucketRowCount / 2;
+   mBucketMinY = -DefaultBucketRowCount / 2;
+   mBucketCols = DefaultBucketRowCount;
+   mBucketRows = DefaultBucketRowCount;
+
+   mBuckets.resize(mBucketCols * mBucketRows);
+   for(S32 i = 0; i < mBuckets.size(); i++)
+      mBuckets[i].nextInBucket = NULL;
+
+   mOversizeBucket.nextInBucket = NULL;
+
+   mExtentsValid = true;
 
    if(createWallSegmentManager)
       mWallSegmentManager = new WallSegmentManager();    // Gets deleted in destructor
@@ -127,27 +168,21 @@ void GridDatabase::addToDatabase(DatabaseObject *theObject)
 
    theObject->mDatabase = this;
 
-   static IntRect bins;
+   IntRect bins;
    fillBins(theObject->getExtent(), bins);
-
-   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
-      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
-      {
-         DatabaseBucketEntry *be = mChunker->alloc();
-         DatabaseBucketEntryBase *base = &mBuckets[x & BucketMask][y & BucketMask];
-         be->theObject = theObject;
-         if(base->nextInBucket)
-            base->nextInBucket->prevInBucket = be;
-         be->nextInBucket = base->nextInBucket;
-         be->prevInBucket = base;
-         base->nextInBucket = be;
-         be->nextInBucketForThisObject = theObject->mBucketList;
-         theObject->mBucketList = be;
-      }
+   linkToBuckets(theObject, bins);
 
    // Add the object to our non-spatial "database" as well
    mAllObjects.push_back(theObject);
 
+   if(mAllObjects.size() == 1)
+   {
+      mExtents = theObject->getExtent();
+      mExtentsValid = true;
+   }
+   else if(mExtentsValid)
+      mExtents.unionRect(theObject->getExtent());
+
    U8 type = theObject->getObjectTypeNumber();
    if(type == GoalZoneTypeNumber)
       mGoalZones.push_back(theObject);
@@ -168,22 +203,60 @@ void GridDatabase::addToDatabase(const Vector<DatabaseObject *> &objects)
 }
 
 
-void GridDatabase::removeEverythingFromDatabase()
+// Register theObject in every bucket covered by bins, or in our oversize bucket if there are too many of those
+void GridDatabase::linkToBuckets(DatabaseObject *theObject, const IntRect &bins)
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
-   {
-      for(S32 y = 0; y < BucketRowCount; y++)
+   TNLAssert(!theObject->mBucketList, "Object is already in some buckets!");
+
+   theObject->mBins = bins;
+   bool oversize = isOversize(bins);
+
+   // Don't use x <= maxx, it will endless loop if maxx = S32_MAX and x overflows
+   // Instead, use maxx - x >= 0, it will better handle overflows and avoid endless loop (MIN_S32 - MAX_S32 = +1)
+   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
       {
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; )
-         {
-            DatabaseBucketEntry *rem = walk;
-            walk->theObject->mDatabase = NULL;  // make sure object don't point to this database anymore
-            walk->theObject->mBucketList = NULL;
-            walk = rem->nextInBucket;
-            mChunker->free(rem);
-         }
-         mBuckets[x & BucketMask][y & BucketMask].nextInBucket = NULL;
+         DatabaseBucketEntry *be = mChunker->alloc();
+         DatabaseBucketEntryBase *base = oversize ? &mOversizeBucket : &mBuckets[y * mBucketCols + x];
+         be->theObject = theObject;
+         if(base->nextInBucket)
+            base->nextInBucket->prevInBucket = be;
+         be->nextInBucket = base->nextInBucket;
+         be->prevInBucket = base;
+         base->nextInBucket = be;
+         be->nextInBucketForThisObject = theObject->mBucketList;
+         theObject->mBucketList = be;
+
+         if(oversize)      // Only need one entry in the oversize bucket
+            return;
       }
+}
+
+
+void GridDatabase::unlinkFromBuckets(DatabaseObject *theObject)
+{
+   while(theObject->mBucketList)
+   {
+      DatabaseBucketEntry *b = theObject->mBucketList;
+      TNLAssert(b->theObject == theObject, "Object mismatch");
+      TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
+      if(b->nextInBucket)
+         b->nextInBucket->prevInBucket = b->prevInBucket;
+      b->prevInBucket->nextInBucket = b->nextInBucket;
+      theObject->mBucketList = b->nextInBucketForThisObject;
+      mChunker->free(b);
+   }
+}
+
+
+void GridDatabase::removeEverythingFromDatabase()
+{
+   clearStaticLayer();
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+   {
+      unlinkFromBuckets(mAllObjects[i]);
+      mAllObjects[i]->mDatabase = NULL;      // Make sure object doesn't point to this database anymore
    }
 
    // Clear out our specialty lists -- since objects are also in mAllObjects, they'll be deleted below
@@ -192,6 +265,9 @@ void GridDatabase::removeEverythingFromDatabase()
    mSpyBugs.clear();
 
    mAllObjects.deleteAndClear();
+
+   mExtents = Rect();
+   mExtentsValid = true;
    
    if(mWallSegmentManager)
       mWallSegmentManager->clear();
@@ -216,23 +292,16 @@ void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
    if(object->mDatabase != this)
       return;
 
-   const Rect &extents = object->mExtent;
    object->mDatabase = NULL;
 
-   static IntRect bins;
-   fillBins(extents, bins);
+   // If this object was holding up one of the edges of our extents, they may be about to shrink
+   if(mExtentsValid && isOnExtentsEdge(object->getExtent()))
+      mExtentsValid = false;
 
-   while(object->mBucketList)
-   {
-      DatabaseBucketEntry *b = object->mBucketList;
-      TNLAssert(b->theObject == object, "Object mismatch");
-      TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-      if(b->nextInBucket)
-         b->nextInBucket->prevInBucket = b->prevInBucket;
-      b->prevInBucket->nextInBucket = b->nextInBucket;
-      object->mBucketList = b->nextInBucketForThisObject;
-      mChunker->free(b);
-   }
+   if(object->mStaticIndex >= 0)
+      thawStaticObject(object);
+   else
+      unlinkFromBuckets(object);
 
    // Find and delete object from our non-spatial databases
    for(S32 i = 0; i < mAllObjects.size(); i++)
@@ -290,35 +359,86 @@ const Vector<DatabaseObject *> *GridDatabase::findObjects_fast(U8 typeNumber) co
 }
 
 
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
+// All our spatial searches come through here.  Searches don't modify the database or the objects in it, so any number of
+// them can run at once, provided nothing is being added, moved, or removed at the time.  Each caller supplies its own
+// fillVector.
+template <class TypeTest>
+void GridDatabase::findObjects(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
 {
-   static Vector<U8> types;
-   types.resize(1);
+   // Search our static layer first, then the buckets covered by our bins, then the oversize bucket, which has no location
+   findStaticObjects(typeTest, fillVector, extents, bins);
+
+   for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
+      for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
+         findObjectsInBucket(typeTest, fillVector, extents, bins, x, y);
+
+   for(DatabaseBucketEntry *walk = mOversizeBucket.nextInBucket; walk; walk = walk->nextInBucket)
+   {
+      DatabaseObject *theObject = walk->theObject;
+
+      if(typeTest(theObject->getObjectTypeNumber()) && (!extents || theObject->mExtent.intersects(*extents)))
+         fillVector.push_back(theObject);
+   }
+}
+
 
-   types[0] = typeNumber;
+// Objects are listed in every bucket they overlap.  Rather than marking objects as we find them, we only report an object
+// from the first bucket (lowest x and y) that it shares with the search area, so each object is found once no matter how
+// many of our buckets it's in.
+template <class TypeTest>
+void GridDatabase::findObjectsInBucket(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, const Rect *extents,
+                                       const IntRect *bins, S32 x, S32 y) const
+{
+   for(DatabaseBucketEntry *walk = mBuckets[y * mBucketCols + x].nextInBucket; walk; walk = walk->nextInBucket)
+   {
+      DatabaseObject *theObject = walk->theObject;
 
-   findObjects(types, fillVector, extents, bins);
+      if(typeTest(theObject->getObjectTypeNumber()) &&                  // Object is of the right type; and
+         (!extents || theObject->mExtent.intersects(*extents)) &&       // overlaps our extents (if passed); and
+         x == max(theObject->mBins.minx, bins->minx) &&                 // this is the first bucket we'll see it in
+         y == max(theObject->mBins.miny, bins->miny))
+      {
+         fillVector.push_back(theObject);
+      }
+   }
 }
 
 
-void GridDatabase::findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
+// Search our static layer, using the same first-bucket rule as above.  We only touch the objects themselves once they
+// are found.
+template <class TypeTest>
+void GridDatabase::findStaticObjects(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, 
+                                     const Rect *extents, const IntRect *bins) const
 {
-   mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   if(mStaticObjects.size() == 0)
+      return;
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
+   for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
+      for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
+      {
+         S32 bucket = y * mBucketCols + x;
+
+         for(S32 i = mStaticBucketStart[bucket]; i < mStaticBucketStart[bucket + 1]; i++)
          {
-            DatabaseObject *theObject = walk->theObject;
+            S32 index = mStaticBucketItems[i];
 
-            if(theObject->mLastQueryId != mQueryId &&                         // Object hasn't been queried; and
-               testTypes(typeNumbers, theObject->getObjectTypeNumber()) &&    // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )        // overlaps our extents (if passed)
+            if(typeTest(mStaticTypes[index]) && (!extents || mStaticExtents[index].intersects(*extents)))
             {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
+               const IntRect &objBins = mStaticBins[index];
+
+               if(x == max(objBins.minx, bins->minx) && y == max(objBins.miny, bins->miny) && mStaticObjects[index])
+                  fillVector.push_back(mStaticObjects[index]);
             }
          }
+      }
+
+   for(S32 i = 0; i < mStaticOversizeItems.size(); i++)
+   {
+      S32 index = mStaticOversizeItems[i];
+
+      if(typeTest(mStaticTypes[index]) && (!extents || mStaticExtents[index].intersects(*extents)) && mStaticObjects[index])
+         fillVector.push_back(mStaticObjects[index]);
+   }
 }
 
 
@@ -356,52 +476,371 @@ void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVect
 }
 
 
-// Translates extents into bins to search
+// Convert a world coordinate into a bucket coordinate, taking care not to overflow on crazy coordinates
+static S32 toBucketCoord(F32 coord, S32 bucketWidthBitShift)
+{
+   const F32 MaxCoord = F32(1 << 30);
+
+   if(coord > MaxCoord)
+      coord = MaxCoord;
+   else if(coord < -MaxCoord)
+      coord = -MaxCoord;
+
+   return S32(coord) >> bucketWidthBitShift;
+}
+
+
+static S32 clampBucketIndex(S32 index, S32 count)
+{
+   if(index < 0)
+      return 0;
+
+   if(index >= count)
+      return count - 1;
+
+   return index;
+}
+
+
+// Translates extents into bins to search; bins are indices into our grid, with anything outside the grid clamped to the border
 void GridDatabase::fillBins(const Rect &extents, IntRect &bins) const
 {
-   bins.minx = S32(extents.min.x) >> BucketWidthBitShift;
-   bins.miny = S32(extents.min.y) >> BucketWidthBitShift;
-   bins.maxx = S32(extents.max.x) >> BucketWidthBitShift;
-   bins.maxy = S32(extents.max.y) >> BucketWidthBitShift;
+   bins.minx = clampBucketIndex(toBucketCoord(extents.min.x, mBucketWidthBitShift) - mBucketMinX, mBucketCols);
+   bins.miny = clampBucketIndex(toBucketCoord(extents.min.y, mBucketWidthBitShift) - mBucketMinY, mBucketRows);
+   bins.maxx = clampBucketIndex(toBucketCoord(extents.max.x, mBucketWidthBitShift) - mBucketMinX, mBucketCols);
+   bins.maxy = clampBucketIndex(toBucketCoord(extents.max.y, mBucketWidthBitShift) - mBucketMinY, mBucketRows);
+}
 
-   if(U32(bins.maxx - bins.minx) >= BucketRowCount)
-      bins.maxx = bins.minx + BucketRowCount - 1;
 
-   if(U32(bins.maxy - bins.miny) >= BucketRowCount)
-      bins.maxy = bins.miny + BucketRowCount - 1;
+// Objects covering too many buckets would be expensive to add and move, and would clog up the grid
+bool GridDatabase::isOversize(const IntRect &bins) const
+{
+   return (bins.maxx - bins.minx + 1) * (bins.maxy - bins.miny + 1) > MaxBucketsPerObject;
 }
 
 
-// Find all objects in &extents that are of type typeNumber
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+// Pick a bucket size for a grid covering extents.  We aim for a handful of objects per bucket, but won't make buckets smaller
+// than a typical object, as objects would then have to be registered in many buckets.  We also keep the total number of
+// buckets within MaxBucketCount.
+S32 GridDatabase::computeBucketWidthBitShift(const Rect &extents, S32 objectCount, F32 typicalObjectSize)
 {
-   static IntRect bins;
-   fillBins(extents, bins);
+   F32 width  = max(extents.getWidth(),  1.0f);
+   F32 height = max(extents.getHeight(), 1.0f);
+
+   const F32 ObjectsPerBucket = 4;
+   F32 bucketSize = sqrt(width * height * ObjectsPerBucket / F32(max(objectCount, 1)));
+   bucketSize = max(bucketSize, typicalObjectSize);
+
+   S32 shift = MinBucketWidthBitShift;
+   while(shift < MaxBucketWidthBitShift && F32(1 << shift) < bucketSize)
+      shift++;
 
-   findObjects(typeNumber, fillVector, &extents, &bins);
+   while(shift < MaxBucketWidthBitShift && 
+         ((S32(width) >> shift) + 2) * ((S32(height) >> shift) + 2) > MaxBucketCount)
+      shift++;
+
+   return shift;
 }
 
 
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery) const
+// Rebuild our grid to cover extents, using the specified bucket size.  All objects are re-registered.
+void GridDatabase::setGridLayout(S32 bucketWidthBitShift, const Rect &extents)
 {
-   TNLAssert(this, "findObjects 'this' is NULL");
-   if(!sameQuery)
-      mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      unlinkFromBuckets(mAllObjects[i]);
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
-         {
-            DatabaseObject *theObject = walk->theObject;
+   TNLAssert(!mOversizeBucket.nextInBucket, "Oversize bucket should be empty!");
 
-            if(theObject->mLastQueryId != mQueryId &&                      // Object hasn't been queried; and
-               (testFunc(theObject->getObjectTypeNumber())) &&             // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )     // overlaps our extents (if passed)
-            {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
-            }
-         }
+   mBucketWidthBitShift = bucketWidthBitShift;
+   mBucketMinX = toBucketCoord(extents.min.x, bucketWidthBitShift);
+   mBucketMinY = toBucketCoord(extents.min.y, bucketWidthBitShift);
+   mBucketCols = toBucketCoord(extents.max.x, bucketWidthBitShift) - mBucketMinX + 1;
+   mBucketRows = toBucketCoord(extents.max.y, bucketWidthBitShift) - mBucketMinY + 1;
+
+   // Guard against absurdly large extents; objects beyond the edge will land in the border buckets
+   while(mBucketCols * mBucketRows > MaxBucketCount)
+   {
+      if(mBucketCols > mBucketRows)
+         mBucketCols = (mBucketCols + 1) / 2;
+      else
+         mBucketRows = (mBucketRows + 1) / 2;
+   }
+
+   mBuckets.resize(mBucketCols * mBucketRows);
+   for(S32 i = 0; i < mBuckets.size(); i++)
+      mBuckets[i].nextInBucket = NULL;
+
+   IntRect bins;
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      if(mAllObjects[i]->mStaticIndex < 0)
+      {
+         fillBins(mAllObjects[i]->getExtent(), bins);
+         linkToBuckets(mAllObjects[i], bins);
+      }
+
+   buildStaticBuckets();
+}
+
+
+// Move every object that passes isStaticFunc out of the dynamic buckets and into our packed static layer.  Call this once
+// a level has been loaded and the grid sized.  Static objects can still be moved or removed, but doing so will evict them
+// from the static layer, so it's best to only freeze things that will stay put.
+void GridDatabase::freezeStaticObjects(TestFunc isStaticFunc)
+{
+   clearStaticLayer();
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+   {
+      DatabaseObject *object = mAllObjects[i];
+
+      if(!isStaticFunc(object->getObjectTypeNumber()))
+         continue;
+
+      unlinkFromBuckets(object);
+
+      object->mStaticIndex = mStaticObjects.size();
+
+      mStaticObjects.push_back(object);
+      mStaticTypes  .push_back(object->getObjectTypeNumber());
+      mStaticExtents.push_back(object->mExtent);
+
+      // Keep a copy of wall geometry, which is what most line-of-sight and collision checks are interested in
+      const Vector<Point> *poly = isWallType(object->getObjectTypeNumber()) ? object->getCollisionPoly() : NULL;
+
+      if(poly)
+      {
+         mStaticPolyStart.push_back(mStaticPolyPoints.size());
+         mStaticPolySize .push_back(poly->size());
+
+         for(S32 j = 0; j < poly->size(); j++)
+            mStaticPolyPoints.push_back(poly->get(j));
+      }
+      else
+      {
+         mStaticPolyStart.push_back(-1);
+         mStaticPolySize .push_back(0);
+      }
+   }
+
+   buildStaticBuckets();
+}
+
+
+// (Re)build the per-bucket lists of static objects for our current grid layout
+void GridDatabase::buildStaticBuckets()
+{
+   mStaticBins.resize(mStaticObjects.size());
+   mStaticBucketItems.clear();
+   mStaticOversizeItems.clear();
+
+   if(mStaticObjects.size() == 0)
+   {
+      mStaticBucketStart.clear();
+      return;
+   }
+
+   // Count how many objects land in each bucket, then lay the buckets out end to end
+   Vector<S32> counts(mBuckets.size());
+   counts.resize(mBuckets.size());
+   for(S32 i = 0; i < counts.size(); i++)
+      counts[i] = 0;
+
+   for(S32 i = 0; i < mStaticObjects.size(); i++)
+   {
+      IntRect &bins = mStaticBins[i];
+      fillBins(mStaticExtents[i], bins);
+
+      if(!mStaticObjects[i])
+         continue;
+
+      if(isOversize(bins))
+      {
+         mStaticOversizeItems.push_back(i);
+         continue;
+      }
+
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+         for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+            counts[y * mBucketCols + x]++;
+   }
+
+   mStaticBucketStart.resize(mBuckets.size() + 1);
+   mStaticBucketStart[0] = 0;
+   for(S32 i = 0; i < counts.size(); i++)
+      mStaticBucketStart[i + 1] = mStaticBucketStart[i] + counts[i];
+
+   mStaticBucketItems.resize(mStaticBucketStart[mBuckets.size()]);
+
+   for(S32 i = 0; i < counts.size(); i++)
+      counts[i] = mStaticBucketStart[i];      // Reuse counts as the insertion point for each bucket
+
+   for(S32 i = 0; i < mStaticObjects.size(); i++)
+   {
+      const IntRect &bins = mStaticBins[i];
+
+      if(!mStaticObjects[i] || isOversize(bins))
+         continue;
+
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+         for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+            mStaticBucketItems[counts[y * mBucketCols + x]++] = i;
+   }
+}
+
+
+// Remove an object from the static layer.  Its slot stays behind, empty, until the layer is rebuilt.
+void GridDatabase::thawStaticObject(DatabaseObject *theObject)
+{
+   S32 index = theObject->mStaticIndex;
+   TNLAssert(index >= 0 && mStaticObjects[index] == theObject, "Object is not in our static layer!");
+
+   mStaticObjects[index] = NULL;
+   mStaticExtents[index].min.set( F32_MAX,  F32_MAX);    // Inside-out rect will never intersect anything
+   mStaticExtents[index].max.set(-F32_MAX, -F32_MAX);
+   mStaticPolyStart[index] = -1;
+
+   theObject->mStaticIndex = -1;
+}
+
+
+void GridDatabase::clearStaticLayer()
+{
+   for(S32 i = 0; i < mStaticObjects.size(); i++)
+      if(mStaticObjects[i])
+         mStaticObjects[i]->mStaticIndex = -1;
+
+   mStaticTypes.clear();
+   mStaticExtents.clear();
+   mStaticObjects.clear();
+   mStaticBins.clear();
+   mStaticBucketStart.clear();
+   mStaticBucketItems.clear();
+   mStaticOversizeItems.clear();
+   mStaticPolyStart.clear();
+   mStaticPolySize.clear();
+   mStaticPolyPoints.clear();
+}
+
+
+S32 GridDatabase::getStaticObjectCount() const
+{
+   S32 count = 0;
+
+   for(S32 i = 0; i < mStaticObjects.size(); i++)
+      if(mStaticObjects[i])
+         count++;
+
+   return count;
+}
+
+
+bool GridDatabase::isStatic(const DatabaseObject *object) const
+{
+   return object->mDatabase == this && object->mStaticIndex >= 0;
+}
+
+
+// Gets object's collision poly, using our packed copy if we have one.  Returns false if object doesn't have a collision poly.
+bool GridDatabase::getCollisionPoly(const DatabaseObject *object, const Point *&points, S32 &pointCount) const
+{
+   points = getStaticCollisionPoly(object, pointCount);
+   if(points)
+      return true;
+
+   const Vector<Point> *poly = object->getCollisionPoly();
+   if(!poly)
+      return false;
+
+   pointCount = poly->size();
+   points = pointCount > 0 ? &poly->get(0) : NULL;
+
+   return true;
+}
+
+
+// Returns our packed copy of object's collision poly, or NULL if we don't have one.  Only static walls are packed.
+const Point *GridDatabase::getStaticCollisionPoly(const DatabaseObject *object, S32 &pointCount) const
+{
+   if(!isStatic(object) || mStaticPolyStart[object->mStaticIndex] < 0)
+      return NULL;
+
+   pointCount = mStaticPolySize[object->mStaticIndex];
+
+   return pointCount > 0 ? &mStaticPolyPoints[mStaticPolyStart[object->mStaticIndex]] : NULL;
+}
+
+
+// Rebuild our grid to cover extents, choosing a bucket size based on what's currently in the database.  Call this once
+// a level has been loaded.
+void GridDatabase::fitGridToExtents(const Rect &extents)
+{
+   // Use the median object size as our typical size -- walls and zones can be huge, and would distort an average
+   Vector<F32> sizes(mAllObjects.size());
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+   {
+      const Rect &extent = mAllObjects[i]->mExtent;
+      sizes.push_back(max(extent.getWidth(), extent.getHeight()));
+   }
+
+   F32 typicalObjectSize = 0;
+   if(sizes.size() > 0)
+   {
+      std::nth_element(sizes.getStlVector().begin(), sizes.getStlVector().begin() + sizes.size() / 2, sizes.getStlVector().end());
+      typicalObjectSize = sizes[sizes.size() / 2];
+   }
+
+   setGridLayout(computeBucketWidthBitShift(extents, mAllObjects.size(), typicalObjectSize), extents);
+}
+
+
+S32 GridDatabase::getBucketWidthBitShift() const
+{
+   return mBucketWidthBitShift;
+}
+
+
+S32 GridDatabase::getBucketCount() const
+{
+   return mBuckets.size();
+}
+
+
+// Returns the number of bucket entries a search over extents will examine, including duplicates and false positives
+S32 GridDatabase::countBucketEntries(const Rect &extents) const
+{
+   IntRect bins;
+   fillBins(extents, bins);
+
+   S32 count = 0;
+
+   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+         for(DatabaseBucketEntry *walk = mBuckets[y * mBucketCols + x].nextInBucket; walk; walk = walk->nextInBucket)
+            count++;
+
+   for(DatabaseBucketEntry *walk = mOversizeBucket.nextInBucket; walk; walk = walk->nextInBucket)
+      count++;
+
+   if(mStaticObjects.size() > 0)
+   {
+      for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
+         for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
+            count += mStaticBucketStart[y * mBucketCols + x + 1] - mStaticBucketStart[y * mBucketCols + x];
+
+      count += mStaticOversizeItems.size();
+   }
+
+   return count;
+}
+
+
+// Find all objects in &extents that are of type typeNumber
+void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
+{
+   IntRect bins;
+   fillBins(extents, bins);
+
+   findObjects(TypeNumberTypeTest(typeNumber), fillVector, &extents, &bins);
 }
 
 
@@ -417,10 +856,10 @@ void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fill
 // Find all objects in database using derived type test function
 void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
 {
-   static IntRect bins;
+   IntRect bins;
    fillBins(extents, bins);
 
-   findObjects(types, fillVector, &extents, &bins);
+   findObjects(TypeListTypeTest(types, this), fillVector, &extents, &bins);
 }
 
 
@@ -444,20 +883,20 @@ bool GridDatabase::testTypes(const Vector<U8> &types, U8 objectType) const
 
 
 // Find all objects in &extents derived type test function
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents, bool sameQuery) const
+void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
 {
-   static IntRect bins;
+   IntRect bins;
    fillBins(extents, bins);
 
-   findObjects(testFunc, fillVector, &extents, &bins, sameQuery);
+   findObjects(TestFuncTypeTest(testFunc), fillVector, &extents, &bins);
 }
 
 
 void GridDatabase::dumpObjects()
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
-      for(S32 y = 0; y < BucketRowCount; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
+   for(S32 x = 0; x < mBucketCols; x++)
+      for(S32 y = 0; y < mBucketRows; y++)
+         for(DatabaseBucketEntry *walk = mBuckets[y * mBucketCols + x].nextInBucket; walk; walk = walk->nextInBucket)
          {
             DatabaseObject *theObject = walk->theObject;
             logprintf("Found object in (%d,%d) with extents %s", x, y, theObject->getExtent().toString().c_str());
@@ -466,49 +905,65 @@ void GridDatabase::dumpObjects()
 }
 
 
-// Get the extents of every object in the database
-Rect GridDatabase::getExtents()
+// Get the extents of every object in the database -- O(1) unless something on the edge has moved in since we last looked
+const Rect &GridDatabase::getExtents()
 {
-   if(mAllObjects.size() == 0)     // No objects ==> no extents!
-      return Rect();
+   if(!mExtentsValid)
+      rebuildExtents();
 
-   Rect rect;
+   return mExtents;
+}
 
-   // Think we can delete from HERE...   inserted this comment 27-Jan-2012  #########################################
 
-   // All this rigamarole is to make world extent correct for levels that do not overlap (0,0)
-   // The problem is that the GameType is treated as an object, and has the extent (0,0), and
-   // a mask of UnknownType.  Fortunately, the GameType tends to be first, so what we do is skip
-   // all objects until we find an UnknownType object, then start creating our extent from there.
-   // We have to assign theRect to an extent object initially to avoid getting the default coords
-   // of (0,0) that are assigned by the constructor.
+bool GridDatabase::isOnExtentsEdge(const Rect &extent) const
+{
+   return extent.min.x <= mExtents.min.x || extent.min.y <= mExtents.min.y ||
+          extent.max.x >= mExtents.max.x || extent.max.y >= mExtents.max.y;
+}
 
 
-   S32 first = -1;
+// Called when an object in the database changes its extent.  As long as the old extent wasn't on the edge, or the new one
+// still covers it, our extents stay exact by just growing them.  Otherwise, they might shrink, so rebuild them when needed.
+void GridDatabase::updateExtents(const Rect &oldExtent, const Rect &newExtent)
+{
+   if(!mExtentsValid)
+      return;
 
-   // Look for first non-UnknownType object
-   for(S32 i = 0; i < mAllObjects.size() && first == -1; i++)
-      if(mAllObjects[i]->getObjectTypeNumber() != UnknownTypeNumber)
-      {
-         rect = mAllObjects[i]->getExtent();
-         first = i;
-      }
+   bool coversOld = newExtent.min.x <= oldExtent.min.x && newExtent.min.y <= oldExtent.min.y &&
+                    newExtent.max.x >= oldExtent.max.x && newExtent.max.y >= oldExtent.max.y;
 
-   TNLAssert(first == 0, "I think this should never happen -- how would an object with UnknownTypeNumber get in the database?? \
-                          if it does, please document it and remove this assert, along withthe rect = line below -Wat");
+   if(!coversOld && isOnExtentsEdge(oldExtent))
+      mExtentsValid = false;
+   else
+      mExtents.unionRect(newExtent);
+}
 
-   if(first == -1)      // No suitable objects found, return empty extents
-      return Rect();
 
-   // ...to HERE
+void GridDatabase::rebuildExtents()
+{
+   mExtentsValid = true;
 
-   rect = mAllObjects[0]->getExtent();
+   if(mAllObjects.size() == 0)     // No objects ==> no extents!
+   {
+      mExtents = Rect();
+      return;
+   }
 
-   // Now start unioning the extents of remaining objects.  Should be all of them.
-   for(S32 i = /*first + */1; i < mAllObjects.size(); i++)
-      rect.unionRect(mAllObjects[i]->getExtent());
+   // Start inside-out, so the first union sets the rect
+   Rect rect;
+   rect.min.set( F32_MAX,  F32_MAX);
+   rect.max.set(-F32_MAX, -F32_MAX);
+
+   // Static geometry is usually most of the level, and is packed into one array.  Objects that have been thawed
+   // have inside-out extents there, which won't affect the union.
+   for(S32 i = 0; i < mStaticExtents.size(); i++)
+      rect.unionRect(mStaticExtents[i]);
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      if(mAllObjects[i]->mStaticIndex < 0)
+         rect.unionRect(mAllObjects[i]->mExtent);
 
-   return rect;
+   mExtents = rect;
 }
 
 
@@ -549,11 +1004,12 @@ DatabaseObject::~DatabaseObject()
 // Code that needs to run for both constructor and copy constructor
 void DatabaseObject::initialize() 
 {
-   mLastQueryId = 0; 
    mExtent = Rect(); 
    mExtentSet = false;
    mDatabase = NULL;
    mBucketList = NULL;
+   mBins.minx = mBins.miny = mBins.maxx = mBins.maxy = 0;
+   mStaticIndex = -1;
 }
 
 
@@ -575,8 +1031,7 @@ DatabaseObject *GridDatabase::findObjectLOS(U8 typeNumber, U32 stateIndex, bool
 {
    Rect queryRect(rayStart, rayEnd);
 
-   static Vector<DatabaseObject *> fillVector;  // Use local here, Most of code expects a global FillVector left unchanged
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
 
    findObjects(typeNumber, fillVector, queryRect);
 
@@ -593,17 +1048,18 @@ DatabaseObject *GridDatabase::findObjectLOS(U8 typeNumber, U32 stateIndex, bool
       if(!fillVector[i]->isCollisionEnabled())     // Skip collision-disabled objects
          continue;
 
-      const Vector<Point> *poly = fillVector[i]->getCollisionPoly();
+      const Point *polyPoints;
+      S32 polySize;
 
       F32 radius, ct;
 
-      if(poly)
+      if(getCollisionPoly(fillVector[i], polyPoints, polySize))
       {
-         if(poly->size() == 0)    // This can happen in the editor when a wall segment is completely hidden by another
+         if(polySize == 0)    // This can happen in the editor when a wall segment is completely hidden by another
             continue;
 
          Point normal;
-         if(polygonIntersectsSegmentDetailed(&poly->first(), poly->size(), format, rayStart, rayEnd, ct, normal))
+         if(polygonIntersectsSegmentDetailed(polyPoints, polySize, format, rayStart, rayEnd, ct, normal))
          {
             if(ct < collisionTime)
             {
@@ -637,8 +1093,7 @@ DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, b
 {
    Rect queryRect(rayStart, rayEnd);
 
-   static Vector<DatabaseObject *> fillVector;  // Use local here, most callers expect our global fillVector to be left unchanged
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
 
    findObjects(testFunc, fillVector, queryRect);
 
@@ -655,18 +1110,19 @@ DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, b
       if(!fillVector[i]->isCollisionEnabled())     // Skip collision-disabled objects
          continue;
 
-      const Vector<Point> *poly = fillVector[i]->getCollisionPoly();
+      const Point *polyPoints;
+      S32 polySize;
 
       F32 radius;
       float ct;
 
-      if(poly)
+      if(getCollisionPoly(fillVector[i], polyPoints, polySize))
       {
-         if(poly->size() == 0)    // This can happen in the editor when a wall segment is completely hidden by another
+         if(polySize == 0)    // This can happen in the editor when a wall segment is completely hidden by another
             continue;
 
          Point normal;
-         if(polygonIntersectsSegmentDetailed(&poly->get(0), poly->size(), format, rayStart, rayEnd, ct, normal))
+         if(polygonIntersectsSegmentDetailed(polyPoints, polySize, format, rayStart, rayEnd, ct, normal))
          {
             if(ct < collisionTime)
             {
@@ -886,6 +1342,20 @@ void DatabaseObject::setExtent(const Rect &extents)
    GridDatabase *gridDB = getDatabase();
 
    if(gridDB)
+      gridDB->updateExtents(mExtent, extents);
+
+   if(gridDB && mStaticIndex >= 0)
+   {
+      // Static objects aren't supposed to move; if one does, it goes back into the dynamic buckets
+      if(!(extents == mExtent))
+      {
+         IntRect newBins;
+         gridDB->fillBins(extents, newBins);
+         gridDB->thawStaticObject(this);
+         gridDB->linkToBuckets(this, newBins);
+      }
+   }
+   else if(gridDB)
    {
       // Remove from the extents database for current extents...
       //gridDB->removeFromDatabase(this, mExtent);    // old extent
@@ -893,60 +1363,15 @@ void DatabaseObject::setExtent(const Rect &extents)
       //gridDB->addToDatabase(this, extents);
 
 
-      S32 minxold, minyold, maxxold, maxyold;
-      S32 minx, miny, maxx, maxy;
-
-      minxold = S32(mExtent.min.x) >> GridDatabase::BucketWidthBitShift;
-      minyold = S32(mExtent.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxxold = S32(mExtent.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxyold = S32(mExtent.max.y) >> GridDatabase::BucketWidthBitShift;
-
-      minx    = S32(extents.min.x) >> GridDatabase::BucketWidthBitShift;
-      miny    = S32(extents.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxx    = S32(extents.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxy    = S32(extents.max.y) >> GridDatabase::BucketWidthBitShift;
+      IntRect newBins;
+      gridDB->fillBins(extents, newBins);
 
       // Don't do anything if the buckets haven't changed...
-      if((minxold - minx) | (minyold - miny) | (maxxold - maxx) | (maxyold - maxy))
+      if((mBins.minx - newBins.minx) | (mBins.miny - newBins.miny) | (mBins.maxx - newBins.maxx) | (mBins.maxy - newBins.maxy))
       {
          // They are different... remove and readd to database, but don't touch gridDB->mAllObjects
-         if(U32(maxx - minx) >= gridDB->BucketRowCount)        maxx    = minx    + gridDB->BucketRowCount - 1;
-         if(U32(maxy - miny) >= gridDB->BucketRowCount)        maxy    = miny    + gridDB->BucketRowCount - 1;
-         if(U32(maxxold >= minxold) + gridDB->BucketRowCount)  maxxold = minxold + gridDB->BucketRowCount - 1;
-         if(U32(maxyold >= minyold) + gridDB->BucketRowCount)  maxyold = minyold + gridDB->BucketRowCount - 1;
-
-
-         // Don't use x <= maxx, it will endless loop if maxx = S32_MAX and x overflows
-         // Instead, use maxx - x >= 0, it will better handle overflows and avoid endless loop (MIN_S32 - MAX_S32 = +1)
-
-         // Remove from the extents database for current extents...
-         while(mBucketList)
-         {
-            DatabaseBucketEntry *b = mBucketList;
-            TNLAssert(b->theObject == this, "Object mismatch");
-            TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-            if(b->nextInBucket)
-               b->nextInBucket->prevInBucket = b->prevInBucket;
-            b->prevInBucket->nextInBucket = b->nextInBucket;
-            mBucketList = b->nextInBucketForThisObject;
-            gridDB->mChunker->free(b);
-         }
-
-         // ...and re-add for the new extent
-         for(S32 x = minx; maxx - x >= 0; x++)
-            for(S32 y = miny; maxy - y >= 0; y++)
-            {
-               DatabaseBucketEntry *be = gridDB->mChunker->alloc();
-               DatabaseBucketEntryBase *base = &gridDB->mBuckets[x & gridDB->BucketMask][y & gridDB->BucketMask];
-               be->theObject = this;
-               if(base->nextInBucket)
-                  base->nextInBucket->prevInBucket = be;
-               be->nextInBucket = base->nextInBucket;
-               be->prevInBucket = base;
-               base->nextInBucket = be;
-               be->nextInBucketForThisObject = mBucketList;
-               mBucketList = be;
-            }
+         gridDB->unlinkFromBuckets(this);
+         gridDB->linkToBuckets(this, newBins);
       }
    }
 
@@ -964,9 +1389,3 @@ DatabaseObject *DatabaseObject::clone() const
 
 };
 
-// Reusable container for searching gridDatabases
-// Has to be outside of Zap namespace seems to help with debugging showing what's inside fillVector  (debugger forgets to add Zap::)
-Vector<Zap::DatabaseObject *> fillVector;
-Vector<Zap::DatabaseObject *> fillVector2;
-
-
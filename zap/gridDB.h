@@ -50,11 +50,12 @@ class DatabaseObject : public GeomObject
 
 
 private:
-   U32 mLastQueryId;
    Rect mExtent;
    bool mExtentSet;     // A flag to mark whether extent has been set on this object
    GridDatabase *mDatabase;
    DatabaseBucketEntry *mBucketList;
+   IntRect mBins;       // Buckets we're registered in, as of the last time we were linked into them
+   S32 mStaticIndex;    // Index into our database's static layer, or -1 if we're in the dynamic buckets
 
 protected:
    U8 mObjectTypeNumber;
@@ -102,9 +103,10 @@ class GoalZone;
 
 class GridDatabase
 {
+   friend class DatabaseObject;
+
 private:
    U32 mDatabaseId;
-   static U32 mQueryId;
    static U32 mCountGridDatabase;      // Reference counter for destruction of mChunker
 
    WallSegmentManager *mWallSegmentManager;
@@ -114,28 +116,90 @@ private:
    Vector<DatabaseObject *> mFlags;
    Vector<DatabaseObject *> mSpyBugs;
 
-   void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery = false) const;
+   // Our spatial index is a grid of buckets covering the world.  Anything outside the grid is clamped into the nearest
+   // border bucket, so objects that are far apart never end up sharing a bucket.  Objects that would need to be registered
+   // in more than MaxBucketsPerObject buckets live in mOversizeBucket instead, which is searched by every query.
+   S32 mBucketWidthBitShift;           // Width/height of each bucket in pixels, in a form of 2 ^ n, 8 is 256 pixels
+   S32 mBucketMinX, mBucketMinY;       // Location of our first bucket, in bucket units
+   S32 mBucketCols, mBucketRows;       // Size of grid, in buckets
+
+   Vector<DatabaseBucketEntryBase> mBuckets;
+   DatabaseBucketEntryBase mOversizeBucket;
+
+   // Objects that won't move for the rest of the level can be frozen into our static layer, which is packed into
+   // contiguous arrays rather than linked lists.  The hot data (types and extents) are kept in their own arrays so
+   // searches touch as little memory as possible.  Static objects in bucket i are listed in mStaticBucketItems, from
+   // mStaticBucketStart[i] up to mStaticBucketStart[i + 1].  Removed objects leave a NULL in mStaticObjects.
+   Vector<U8>   mStaticTypes;
+   Vector<Rect> mStaticExtents;
+   Vector<DatabaseObject *> mStaticObjects;
+   Vector<IntRect> mStaticBins;
+   Vector<S32> mStaticBucketStart;
+   Vector<S32> mStaticBucketItems;
+   Vector<S32> mStaticOversizeItems;
+
+   // Packed copies of static wall collision polys, for line-of-sight and collision checks
+   Vector<S32>   mStaticPolyStart;     // -1 if we don't have a packed poly for this object
+   Vector<S32>   mStaticPolySize;
+   Vector<Point> mStaticPolyPoints;
+
+   // Combined extents of everything in the database, kept up to date as objects are added, moved, and removed.  Growing
+   // them is cheap; when something sitting on the edge moves inward or goes away, we mark them stale and rebuild on the
+   // next query from the packed static extents plus whatever dynamic objects we have.
+   Rect mExtents;
+   bool mExtentsValid;
+
+   template <class TypeTest>
+   void findObjects(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
+   template <class TypeTest>
+   void findObjectsInBucket(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, const Rect *extents,
+                            const IntRect *bins, S32 x, S32 y) const;
+   template <class TypeTest>
+   void findStaticObjects(const TypeTest &typeTest, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
 
    void fillBins(const Rect &extents, IntRect &bins) const;    // Helper function -- translates extents into bins to search
+   bool isOversize(const IntRect &bins) const;
+
+   void linkToBuckets(DatabaseObject *theObject, const IntRect &bins);
+   void unlinkFromBuckets(DatabaseObject *theObject);
+
+   void buildStaticBuckets();
+   void thawStaticObject(DatabaseObject *theObject);
+   void clearStaticLayer();
+
+   bool isOnExtentsEdge(const Rect &extent) const;
+   void updateExtents(const Rect &oldExtent, const Rect &newExtent);
+   void rebuildExtents();
 
 public:
    enum {
-      BucketRowCount = 16,    // Number of buckets per grid row, and number of rows; should be power of 2
-      BucketMask = BucketRowCount - 1,
+      DefaultBucketWidthBitShift = 8,     // 256 pixels
+      DefaultBucketRowCount = 16,         // Default grid covers -2048 to 2048 in both directions
+      MinBucketWidthBitShift = 5,         // 32 pixels
+      MaxBucketWidthBitShift = 12,        // 4096 pixels
+      MaxBucketCount = 256 * 256,         // Upper limit of number of buckets in the grid
+      MaxBucketsPerObject = 256,          // Objects bigger than this go into mOversizeBucket
    };
 
    static ClassChunker<DatabaseBucketEntry> *mChunker;
 
-   DatabaseBucketEntryBase mBuckets[BucketRowCount][BucketRowCount];
-
    explicit GridDatabase(bool createWallSegmentManager = true);   // Constructor
    // GridDatabase::GridDatabase(const GridDatabase &source);
    virtual ~GridDatabase();                                       // Destructor
 
+   void setGridLayout(S32 bucketWidthBitShift, const Rect &extents);   // Rebuild our grid to cover extents, using the specified bucket size
+   void fitGridToExtents(const Rect &extents);                          // Rebuild our grid to cover extents, picking a bucket size to suit our objects
+   static S32 computeBucketWidthBitShift(const Rect &extents, S32 objectCount, F32 typicalObjectSize);
+
+   S32 getBucketWidthBitShift() const;
+   S32 getBucketCount() const;
+   S32 countBucketEntries(const Rect &extents) const;    // Number of bucket entries a search of extents will walk -- for tuning
 
-   static const S32 BucketWidthBitShift = 8;    // Width/height of each bucket in pixels, in a form of 2 ^ n, 8 is 256 pixels
+   void freezeStaticObjects(TestFunc isStaticFunc);      // Move objects that won't move again into our packed static layer
+   S32 getStaticObjectCount() const;
+   bool isStatic(const DatabaseObject *object) const;
+   const Point *getStaticCollisionPoly(const DatabaseObject *object, S32 &pointCount) const;
+   bool getCollisionPoly(const DatabaseObject *object, const Point *&points, S32 &pointCount) const;
 
    DatabaseObject *findObjectLOS(U8 typeNumber, U32 stateIndex, bool format, const Point &rayStart, const Point &rayEnd,
                                  float &collisionTime, Point &surfaceNormal) const;
@@ -157,7 +221,7 @@ public:
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
 
    void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector) const;
-   void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents, bool sameQuery = false) const;
+   void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
 
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const;
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
@@ -171,7 +235,7 @@ public:
    void dumpObjects();     // For debugging purposes
 
    
-   Rect getExtents();      // Get the combined extents of every object in the database
+   const Rect &getExtents();     // Get the combined extents of every object in the database
 
    WallSegmentManager *getWallSegmentManager() const;      
 
@@ -192,9 +256,4 @@ public:
 };
 
 
-// Reusable container for searching gridDatabases
-// putting it outside of Zap namespace seems to help with visual C++ debugging showing whats inside fillVector  (debugger forgets to add Zap::)
-extern Vector<Zap::DatabaseObject *> fillVector;
-extern Vector<Zap::DatabaseObject *> fillVector2;
-
 #endif
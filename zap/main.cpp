@@ -124,6 +124,7 @@ using namespace TNL;
 #include "BotNavMeshZone.h"
 #include "ship.h"
 #include "LevelSource.h"
+#include "TickScheduler.h"
 
 #include <math.h>
 #include <stdarg.h>
@@ -277,9 +278,32 @@ void checkIfServerGameIsShuttingDown(U32 timeDelta)
 #ifndef ZAP_DEDICATED
    const Vector<ClientGame *> *clientGames = GameManager::getClientGames();
 #endif
+   string shutdownReason;
+
+   // When hosting several arenas, each can be shut down on its own; the process only exits with the last one.
+   // Only dedicated servers host more than one, so there are no local clients to worry about.
+   const Vector<ServerGame *> *arenas = GameManager::getServerGames();
+   if(arenas->size() > 1)
+   {
+      for(S32 i = arenas->size() - 1; i >= 0; i--)
+      {
+         GameManager::setCurrentServerGame(arenas->get(i));
+
+         if(arenas->get(i)->isReadyToShutdown(timeDelta, shutdownReason))
+         {
+            logprintf(LogConsumer::ServerFilter, "Arena %d shut down: %s", i + 1, shutdownReason.c_str());
+            GameManager::deleteServerGame(arenas->get(i));
+         }
+      }
+
+      if(arenas->size() == 0)
+         shutdownBitfighter();
+
+      return;
+   }
+
    ServerGame *serverGame = GameManager::getServerGame();
 
-   string shutdownReason;
    if(serverGame && serverGame->isReadyToShutdown(timeDelta, shutdownReason))
    {
 #ifndef ZAP_DEDICATED
@@ -306,18 +330,74 @@ void loadAnotherLevelOrStartHosting()
 
    if(GameManager::getHostingModePhase() == GameManager::LoadingLevels)
    {
-      string levelName = GameManager::getServerGame()->loadNextLevelInfo();
+      Vector<string> levelNames = GameManager::getServerGame()->loadLevelInfos();
 
 #ifndef ZAP_DEDICATED
       const Vector<ClientGame *> *clientGames = GameManager::getClientGames();
-      // Notify any client UIs on the hosting machine that the server has loaded a level
+      // Notify any client UIs on the hosting machine that the server has loaded its levels
       for(S32 i = 0; i < clientGames->size(); i++)
-         clientGames->get(i)->getUIManager()->serverLoadedLevel(levelName);
+         for(S32 j = 0; j < levelNames.size(); j++)
+            clientGames->get(i)->getUIManager()->serverLoadedLevel(levelNames[j]);
 #endif
    }
 
    else if(GameManager::getHostingModePhase() == GameManager::DoneLoadingLevels)
-      hostGame(GameManager::getServerGame());
+   {
+      // All arenas share the level list the first one just loaded, so they can all start together
+      const Vector<ServerGame *> *arenas = GameManager::getServerGames();
+
+      for(S32 i = arenas->size() - 1; i >= 0; i--)
+      {
+         GameManager::setCurrentServerGame(arenas->get(i));
+         hostGame(arenas->get(i));
+      }
+   }
+}
+
+
+// Dedicated servers sleep on their sockets between ticks rather than polling, so incoming packets
+// are handled as soon as they arrive, and ticks run on a fixed schedule no matter how busy the
+// network is.
+static void idleDedicated(U32 maxFPS)
+{
+   // If there are no players, tick less often to further reduce impact on the server.  Since we
+   // wake up for incoming packets anyway, this no longer costs any ping accuracy on the lobby.
+   static const U32 SuspendedTickPeriod = 40;
+
+   bool suspended = true;
+   for(S32 i = 0; i < GameManager::getServerGameCount() && suspended; i++)
+      suspended = GameManager::getServerGames()->get(i)->isSuspended();
+
+   TickScheduler *scheduler = GameManager::getTickScheduler();
+   scheduler->setPeriod(suspended ? SuspendedTickPeriod : 1000 / maxFPS);
+
+   U32 timeToTick = scheduler->getTimeToNextTick(Platform::getRealMilliseconds());
+
+   if(timeToTick > 0)
+   {
+      // Level infos get loaded from idle(), so don't hold that up
+      U32 maxWait = GameManager::getHostingModePhase() == GameManager::LoadingLevels ? 0 : timeToTick;
+
+      if(GameManager::waitForIncomingPackets(maxWait))
+         GameManager::checkIncomingPackets();
+
+      GameManager::processDueConnections();
+      return;
+   }
+
+   U32 timeDelta = scheduler->tick(Platform::getRealMilliseconds());
+
+   // Sanity check, as in idle()
+   if(timeDelta > 5000)
+      timeDelta = 10;
+
+   checkIfServerGameIsShuttingDown(timeDelta);
+   GameManager::idle(timeDelta);
+
+#ifndef ZAP_DEDICATED
+   // Run 3rd-party app things
+   AppIntegrationController::idle(timeDelta);
+#endif
 }
 
 
@@ -337,6 +417,14 @@ void idle()
       settings = GameManager::getClientGames()->get(0)->getSettings();
 #endif
 
+   bool dedicated = GameManager::getServerGame() && GameManager::getServerGame()->isDedicated();
+
+   if(dedicated)
+   {
+      idleDedicated(settings->getIniSettings()->maxDedicatedFPS);
+      return;
+   }
+
    static S32 deltaT = 0;     // static, as we need to keep holding the value that was set... probably some reason this is S32?
    static U32 prevTimer = 0;
 
@@ -350,9 +438,7 @@ void idle()
 
    U32 sleepTime = 1;
 
-   bool dedicated = GameManager::getServerGame() && GameManager::getServerGame()->isDedicated();
-
-   U32 maxFPS = dedicated ? settings->getIniSettings()->maxDedicatedFPS : settings->getIniSettings()->maxFPS;
+   U32 maxFPS = settings->getIniSettings()->maxFPS;
 
    if(deltaT >= S32(1000 / maxFPS))
    {
@@ -360,16 +446,14 @@ void idle()
       GameManager::idle(U32(deltaT));
 
 #ifndef ZAP_DEDICATED
-      if(!dedicated)
-         display();          // Draw the screen if not dedicated
+      display();          // Draw the screen
 
       // Run 3rd-party app things
       AppIntegrationController::idle(U32(deltaT));
 #endif
       deltaT = 0;
 
-      if(!dedicated)
-         sleepTime = 0;      
+      sleepTime = 0;      
    }
 
 
@@ -396,12 +480,6 @@ void idle()
 
    // Sleep a bit so we don't saturate the system. For a non-dedicated server,
    // sleep(0) helps reduce the impact of OpenGL on windows.
-
-   // If there are no players, set sleepTime to 40 to further reduce impact on the server.
-   // We'll only go into this longer sleep on dedicated servers when there are no players.
-   if(dedicated && GameManager::getServerGame()->isSuspended())
-      sleepTime = 40;     // The higher this number, the less accurate the ping is on server lobby when empty, but the less power consumed.
-
    Platform::sleep(sleepTime);
 
 }  // end idle()
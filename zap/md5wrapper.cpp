@@ -180,6 +180,60 @@ std::string md5wrapper::getHashFromFile(std::string filename)
 	return convToString(digest);
 }
 
+
+// Reads the whole file into contents, hashing it chunk by chunk as it comes in
+std::string md5wrapper::getHashFromFile(const std::string &filename, std::string &contents)
+{
+   static const std::string::size_type ChunkSize = 16384;
+
+   contents.clear();
+
+   FILE *file = fopen(filename.c_str(), "rb");
+   if(file == NULL)
+      return "";
+
+   // Size the buffer up front so the file gets read straight into it
+   std::string::size_type capacity = ChunkSize;
+   if(fseek(file, 0, SEEK_END) == 0)
+   {
+      long size = ftell(file);
+      if(size > 0)
+         capacity = (std::string::size_type)size + 1;    // +1 so we can see EOF without growing
+      fseek(file, 0, SEEK_SET);
+   }
+
+   hash_state md;
+   unsigned char digest[16];
+   std::string::size_type used = 0;
+
+   md5_init(&md);
+   contents.resize(capacity);
+
+   while(true)
+   {
+      if(used == contents.size())
+         contents.resize(contents.size() * 2);
+
+      std::string::size_type toRead = contents.size() - used;
+      if(toRead > ChunkSize)
+         toRead = ChunkSize;
+
+      unsigned int len = (unsigned int)fread(&contents[used], 1, toRead, file);
+      if(len == 0)
+         break;
+
+      md5_process(&md, (unsigned char *)&contents[used], len);
+      used += len;
+   }
+
+   md5_done(&md, digest);
+   fclose(file);
+
+   contents.resize(used);
+
+   return convToString(digest);
+}
+
 /*
  * EOF
  */
@@ -64,6 +64,10 @@ class md5wrapper
 		 * returns it as string
 		 */	
 		std::string getHashFromFile(std::string filename);
+
+      // Same, but also hands back the contents of the file, so callers that need both only have to read it once.
+      // Returns "" if the file could not be read.
+		std::string getHashFromFile(const std::string &filename, std::string &contents);
 };
 
 
@@ -58,6 +58,18 @@ F32   MoveStates::getAngle(S32 state) const      { return mMoveState[state].angl
 void  MoveStates::setAngle(S32 state, F32 angle) { mMoveState[state].angle = angle; }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor -- start out with room for a crowded tick, so we don't spend the first few growing
+MoveScratch::MoveScratch()
+{
+   displacers.reserve(64);
+   disabled.reserve(32);
+   fillVector.reserve(256);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -108,7 +120,7 @@ void MoveObject::idle(BfObject::IdleCallPath path)
    mHitLimit = 16;      // Reset hit limit
 
    if(path == ServerIdleMainLoop)
-      checkForZones();        // See if ship entered or left any zones
+      checkForZones(*getGame()->getMoveScratch());        // See if ship entered or left any zones
 }
 
 
@@ -329,15 +341,17 @@ const F32 velocityEpsilon = 0.00001f;
 // Apply mMoveState info to an object to compute it's new position.  Used for ships et. al.
 // isBeingDisplaced is true when the object is being pushed by something else, which will only happen in a collision
 // Remember: stateIndex will be one of 0-ActualState, 1-RenderState, or 2-LastProcessState
-F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector<SafePtr<MoveObject> > displacerList)
+// scratch is shared by everything pushed around during this move; we only touch the entries we add, and take them off
+// again before returning
+F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, MoveScratch &scratch)
 {
    U32 tryCount = 0;
    const U32 TRY_COUNT_MAX = 8;
-   Vector<SafePtr<BfObject> > disabledList;
+   const S32 firstDisabled = scratch.disabled.size();
+   const S32 firstDisplacer = scratch.displacers.size();    // Everything before this is pushing us
    F32 moveTimeStart = moveTime;
 
-   static Point origPos;   // Reusable container
-   origPos = getPos(stateIndex);
+   Point origPos = getPos(stateIndex);    // Not static -- a displaced object's move() would clobber ours
 
    while(moveTime > moveTimeEpsilon && tryCount < TRY_COUNT_MAX)     // moveTimeEpsilon is a very short, but non-zero, bit of time
    {
@@ -350,7 +364,7 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
       F32 collisionTime = moveTime;
       static Point collisionPoint, newPos;     // Reusable containers
 
-      BfObject *objectHit = findFirstCollision(stateIndex, collisionTime, collisionPoint);
+      BfObject *objectHit = findFirstCollision(stateIndex, collisionTime, collisionPoint, scratch);
       if(!objectHit)    // No collision (or if isBeingDisplaced is true, we haven't been pushed into another object)
       {
          newPos = getPos(stateIndex) + getVel(stateIndex) * moveTime;   // Move to desired destination
@@ -365,7 +379,7 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
       // Collided is a sort of collision pre-handler; it will return true if the collision was dealt with, false if not
       if(collided(objectHit, stateIndex) || objectHit->collided(this, stateIndex))
       {
-         disabledList.push_back(objectHit);
+         scratch.disabled.push_back(objectHit);
          objectHit->disableCollision();
          tryCount--;   // Don't count as tryCount
       }
@@ -382,8 +396,8 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
          if(isBeingDisplaced)
          {
             bool hit = false;
-            for(S32 i = 0; i < displacerList.size(); i++)
-               if(moveObjectThatWasHit == displacerList[i])
+            for(S32 i = 0; i < firstDisplacer; i++)
+               if(moveObjectThatWasHit == scratch.displacers[i])
                  hit = true;
             if(hit) break;
          }
@@ -406,13 +420,14 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
             // Note that we could end up with an infinite feedback loop here, if, for some reason, two objects keep trying to displace
             // one another, as this will just recurse deeper and deeper.
 
-            displacerList.push_back(this);
+            if(scratch.displacers.size() == firstDisplacer)
+               scratch.displacers.push_back(this);
 
             // Only try a limited number of times to avoid dragging the game under the dark waves of infinity
             if(mHitLimit > 0) 
             {
                // Move the displaced object a tiny bit, true -> isBeingDisplaced
-               moveObjectThatWasHit->move(t + displaceEpsilon, stateIndex, true, displacerList); 
+               moveObjectThatWasHit->move(t + displaceEpsilon, stateIndex, true, scratch); 
                mHitLimit--;
             }
          }
@@ -423,9 +438,12 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
       moveTime -= collisionTime;
    }
 
-   for(S32 i = 0; i < disabledList.size(); i++)   // enable any disabled collision
-      if(disabledList[i].isValid())
-         disabledList[i]->enableCollision();
+   for(S32 i = firstDisabled; i < scratch.disabled.size(); i++)   // enable any disabled collision
+      if(scratch.disabled[i].isValid())
+         scratch.disabled[i]->enableCollision();
+
+   scratch.disabled.resize(firstDisabled);
+   scratch.displacers.resize(firstDisplacer);
 
    if(tryCount == TRY_COUNT_MAX && moveTime > moveTimeStart * 0.98f)
       setVel(stateIndex, Point(0,0));  // prevents some overload by not trying to move anymore
@@ -446,13 +464,23 @@ TestFunc MoveObject::collideTypes()
 }
 
 
-static S32 QSORT_CALLBACK sortBarriersFirst(DatabaseObject **a, DatabaseObject **b)
+// Move Barriers to the front of objects[first...], in one pass and without a sort
+static void putBarriersFirst(Vector<DatabaseObject *> &objects, S32 first)
 {
-   return ((*b)->getObjectTypeNumber() == BarrierTypeNumber ? 1 : 0) - ((*a)->getObjectTypeNumber() == BarrierTypeNumber ? 1 : 0);
+   S32 barrierEnd = first;
+
+   for(S32 i = first; i < objects.size(); i++)
+      if(objects[i]->getObjectTypeNumber() == BarrierTypeNumber)
+      {
+         if(i != barrierEnd)
+            swap(objects[i], objects[barrierEnd]);
+
+         barrierEnd++;
+      }
 }
 
 
-BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Point &collisionPoint)
+BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Point &collisionPoint, MoveScratch &scratch)
 {
    // Check for collisions against other objects
    Point delta = getVel(stateIndex) * collisionTime;
@@ -460,31 +488,37 @@ BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Poi
    Rect queryRect(getPos(stateIndex), getPos(stateIndex) + delta);
    queryRect.expand(Point(mRadius, mRadius));
 
-   fillVector.clear();
+   // Our candidates go on the end of fillVector, and come off again before we return.  collide() handlers can do almost
+   // anything, including getting back in here for some other object, so never assume we're the only ones using it.
+   Vector<DatabaseObject *> &fillVector = scratch.fillVector;
+   const S32 firstFound = fillVector.size();
 
    findObjects(collideTypes(), fillVector, queryRect);   // Free CPU for finding only the ones we care about
 
-   fillVector.sort(sortBarriersFirst);  // Sort to do Barriers::Collide first, to prevent picking up flag (FlagItem::Collide) through Barriers, especially when client does /maxfps 10
+   const S32 lastFound = fillVector.size();
+
+   putBarriersFirst(fillVector, firstFound);  // Do Barriers::Collide first, to prevent picking up flag (FlagItem::Collide) through Barriers, especially when client does /maxfps 10
 
    F32 collisionFraction;
 
    BfObject *collisionObject = NULL;
 
-   for(S32 i = 0; i < fillVector.size(); i++)
+   for(S32 i = firstFound; i < lastFound; i++)
    {
       BfObject *foundObject = static_cast<BfObject *>(fillVector[i]);
 
       if(!foundObject->isCollisionEnabled())
          continue;
 
-      const Vector<Point> *poly = foundObject->getCollisionPoly();
+      const Point *polyPoints;
+      S32 polySize;
 
-      if(poly)
+      if(getDatabase()->getCollisionPoly(foundObject, polyPoints, polySize))    // Uses packed copy for static walls
       {
          Point cp;
 
-         if(PolygonSweptCircleIntersect(&poly->first(), poly->size(), getPos(stateIndex),
-                                        delta, mRadius, cp, collisionFraction))
+         if(polySize > 0 && PolygonSweptCircleIntersect(polyPoints, polySize, getPos(stateIndex),
+                                                        delta, mRadius, cp, collisionFraction))
          {
             if(cp != getPos(stateIndex) || !isCollideableType(foundObject->getObjectTypeNumber()))   // Avoid getting stuck inside polygon wall
             {
@@ -561,18 +595,24 @@ BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Poi
          }
       }
    }
+
+   fillVector.resize(firstFound);
+
    return collisionObject;
 }
 
 
 // See if ship entered or left any zones
 // Server only
-void MoveObject::checkForZones()
+void MoveObject::checkForZones(MoveScratch &scratch)
 {
+   // Use this boolean as a cheap way of making the current zone list be the previous out without copying
+   mZones1IsCurrent = !mZones1IsCurrent;
+
    Vector<SafePtr<Zone> > &currZoneList = getCurrZoneList();
    Vector<SafePtr<Zone> > &prevZoneList = getPrevZoneList();
 
-   getZonesObjectIsIn(currZoneList);     // Fill currZoneList with a list of all zones ship is currently in
+   getZonesObjectIsIn(currZoneList, scratch);     // Fill currZoneList with a list of all zones ship is currently in
 
    // Now compare currZoneList with prevZoneList to figure out if ship entered or exited any zones
    for(S32 i = 0; i < currZoneList.size(); i++)
@@ -599,29 +639,40 @@ void MoveObject::onLeftZone(Zone *zone)
 
 
 
-// Fill zoneList with a list of all zones that the ship is currently in
+// Fill zoneList with a list of all zones that the ship is currently in.  Entries that already point at the right zone
+// are left alone, so an object sitting in the same zones tick after tick doesn't relink any SafePtrs.
 // Server only
-void MoveObject::getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList)
+void MoveObject::getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList, MoveScratch &scratch)
 {
-   // Use this boolean as a cheap way of making the current zone list be the previous out without copying
-   mZones1IsCurrent = !mZones1IsCurrent;
-
-   zoneList.clear();
-
    Rect rect(getActualPos(), getActualPos());            // Center of object
 
-   fillVector.clear();
+   Vector<DatabaseObject *> &fillVector = scratch.fillVector;    // Someone further up the stack may be using the start
+   const S32 firstFound = fillVector.size();
    findObjects((TestFunc)isZoneType, fillVector, rect);  // Find all zones the object might be in
 
+   S32 count = 0;
+
    // Extents overlap...  now check for actual overlap
-   for(S32 i = 0; i < fillVector.size(); i++)
+   for(S32 i = firstFound; i < fillVector.size(); i++)
    {
       // Get points that define the zone boundaries
       const Vector<Point> *polyPoints = fillVector[i]->getCollisionPoly();
 
-      if(polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()))
-         zoneList.push_back(SafePtr<Zone>(static_cast<Zone *>(fillVector[i])));
+      if(!polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()))
+         continue;
+
+      Zone *zone = static_cast<Zone *>(fillVector[i]);
+
+      if(count == zoneList.size())
+         zoneList.push_back(zone);
+      else if(zoneList[count] != zone)
+         zoneList[count] = zone;
+
+      count++;
    }
+
+   fillVector.resize(firstFound);
+   zoneList.resize(count);
 }
 
 
@@ -1014,7 +1065,7 @@ void MoveItem::idle(BfObject::IdleCallPath path)
 
 
    float time = mCurrentMove.time * 0.001f;
-   move(time, ActualState, false);
+   move(time, ActualState, false, *getGame()->getMoveScratch());
 
    if(path == ClientIdlingNotLocalShip)
    {
@@ -1129,7 +1180,7 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
       else
       {
          mInterpolating = true;
-         move(connection->getOneWayTime() * 0.001f, ActualState, false);
+         move(connection->getOneWayTime() * 0.001f, ActualState, false, *getGame()->getMoveScratch());
       }
 
       copyMoveState(ActualState, LastUnpackUpdateState);
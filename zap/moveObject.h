@@ -50,6 +50,22 @@ public:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+class MoveObject;
+
+// Working storage for moving objects around.  Each list is used as a stack: callers push what they need onto the end
+// and pop it off again before returning, so nested moves (and collision handlers that start moves of their own) can
+// share it.  The lists keep their capacity, so once they've grown to fit, resolving collisions doesn't touch the heap.
+// Each Game owns one; not thread safe.
+struct MoveScratch
+{
+   Vector<MoveObject *> displacers;          // Objects pushing something out of their way, outermost first
+   Vector<SafePtr<BfObject> > disabled;      // Objects with collision turned off while a move is resolved
+   Vector<DatabaseObject *> fillVector;      // Results of database queries
+
+   MoveScratch();    // Constructor
+};
+
+
 class MoveObject : public Item
 {
    typedef Item Parent;
@@ -84,7 +100,7 @@ protected:
 
    virtual void onEnteredZone(Zone *zone);
    virtual void onLeftZone(Zone *zone);
-   void getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList);
+   void getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList, MoveScratch &scratch);
 
 public:
    MoveObject(const Point &p = Point(0,0), float radius = 1, float mass = 1);     // Constructor
@@ -146,18 +162,18 @@ public:
 
    virtual void playCollisionSound(U32 stateIndex, MoveObject *moveObjectThatWasHit, F32 velocity);
 
-   F32 move(F32 time, U32 stateIndex, bool displacing = false, Vector<SafePtr<MoveObject> > = Vector<SafePtr<MoveObject> >());
+   F32 move(F32 time, U32 stateIndex, bool displacing, MoveScratch &scratch);
    virtual bool collide(BfObject *otherObject);
 
    // CollideTypes is used to improve speed on findFirstCollision
    virtual TestFunc collideTypes();
 
-   BfObject *findFirstCollision(U32 stateIndex, F32 &collisionTime, Point &collisionPoint);
+   BfObject *findFirstCollision(U32 stateIndex, F32 &collisionTime, Point &collisionPoint, MoveScratch &scratch);
    void computeCollisionResponseMoveObject(U32 stateIndex, MoveObject *objHit);
    void computeCollisionResponseBarrier(U32 stateIndex, Point &collisionPoint);
    F32 computeMinSeperationTime(U32 stateIndex, MoveObject *contactObject, Point intendedPos);
 
-   void checkForZones();                                       // See if object entered or left any zones
+   void checkForZones(MoveScratch &scratch);                   // See if object entered or left any zones
         
    void computeImpulseDirection(DamageInfo *damageInfo);
 
@@ -903,7 +903,7 @@ void Mine::idle(IdleCallPath path)
    Rect queryRect(pos, pos);
    queryRect.expand(Point(SensorRadius, SensorRadius));
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    findObjects((TestFunc)isMotionTriggerType, fillVector, queryRect);
 
    // Found something!
@@ -993,6 +993,7 @@ U32 Mine::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
       writeThisTeam(stream);
 
       GameConnection *gc = static_cast<GameConnection *>(connection);
+      gc->markPackUpdateConnectionSpecific();      // Ownership is per-client
 
       bool isOwner = getOwner() == gc->getClientInfo();
 
@@ -1234,6 +1235,7 @@ U32 SpyBug::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *s
       writeThisTeam(stream);
 
       GameConnection *gc = static_cast<GameConnection *>(connection);
+      gc->markPackUpdateConnectionSpecific();      // Ownership is per-client
 
       bool isOwner = getOwner() == gc->getClientInfo();
 
@@ -1592,10 +1594,10 @@ void Seeker::acquireTarget()
    F32 ourAngle = getActualAngle();
 
    // Used for wall detection
-   static Vector<DatabaseObject *> localFillVector;
+   Vector<DatabaseObject *> localFillVector;
 
    Rect queryRect(getPos(), TargetAcquisitionRadius);
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
    findObjects(isSeekerTarget, fillVector, queryRect);
 
    F32 closest = F32_MAX;
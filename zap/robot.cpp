@@ -14,6 +14,7 @@
 #include "GeomUtils.h"
 
 #include "ServerGame.h"
+#include "VisibilityCache.h"
 #include "GameManager.h"
 
 
@@ -165,7 +166,14 @@ const char *Robot::getErrorMessagePrefix() { return "***ROBOT ERROR***"; }
 // Server only
 bool Robot::start()
 {
-   if(!getGame() || !runScript(!getGame()->isTestServer()))   // Load the script, execute the chunk to get it in memory, then run its main() function
+   if(!getGame())
+      return false;
+
+   // When bots are run on the bot threads, each needs a Lua instance of its own
+   if(getGame()->isServer() && static_cast<ServerGame *>(getGame())->getBotThreadPool())
+      useOwnLuaState();
+
+   if(!runScript(!getGame()->isTestServer()))   // Load the script, execute the chunk to get it in memory, then run its main() function
       return false;
 
    // Pass true so that if this bot doesn't have a TickEvent handler, we don't print a message
@@ -437,8 +445,30 @@ F32 Robot::getAnglePt(Point point)
 }
 
 
+// Things other than walls that block a bot's view; these can change during a tick, so they aren't cached
+static bool isNonWallCollideableType(U8 x)
+{
+   return isCollideableType(x) && !isWallType(x);
+}
+
+
 bool Robot::canSeePoint(Point point, bool wallOnly)
 {
+   TestFunc testFunc = wallOnly ? (TestFunc)isWallType : (TestFunc)isCollideableType;
+
+   // Walls are the same for everyone for the rest of the tick, so that part of the answer is shared with anyone
+   // else asking the same thing
+   if(mGame->isServer())
+   {
+      if(!static_cast<ServerGame *>(mGame)->getVisibilityCache()->canSee(getActualPos(), point, mRadius))
+         return false;
+
+      if(wallOnly)
+         return true;
+
+      testFunc = (TestFunc)isNonWallCollideableType;
+   }
+
    Point difference = point - getActualPos();
 
    Point crossVector(difference.y, -difference.x);  // Create a point whose vector from 0,0 is perpenticular to the original vector
@@ -460,8 +490,8 @@ bool Robot::canSeePoint(Point point, bool wallOnly)
 
    Rect queryRect(thisPoints);
 
-   fillVector.clear();
-   mGame->getGameObjDatabase()->findObjects(wallOnly ? (TestFunc)isWallType : (TestFunc)isCollideableType, fillVector, queryRect);
+   Vector<DatabaseObject *> fillVector;
+   mGame->getGameObjDatabase()->findObjects(testFunc, fillVector, queryRect);
 
    for(S32 i = 0; i < fillVector.size(); i++)
    {
@@ -495,7 +525,7 @@ void Robot::idle(BfObject::IdleCallPath path)
 
    // See if robot entered or left any zones, why isn't this called via Parent?
    if(path == ServerIdleMainLoop)
-      checkForZones();
+      checkForZones(*getGame()->getMoveScratch());
 
    if(path != BfObject::ServerIdleMainLoop)   
       Parent::idle(path);                       
@@ -547,6 +577,16 @@ const char *Robot::getScriptName()
 }
 
 
+// Several bots often run the same script, so tell them apart by name
+string Robot::getProfileName()
+{
+   if(!mClientInfo)
+      return LuaScriptRunner::getProfileName();
+
+   return string(mClientInfo->getName().getString()) + " (" + LuaScriptRunner::getProfileName() + ")";
+}
+
+
 Robot *Robot::clone() const
 {
    return new Robot(*this);
@@ -573,7 +613,7 @@ U16 Robot::findClosestZone(const Point &point)
       BotNavMeshZone *zone = static_cast<BotNavMeshZone *>(objects[i]);
       Point center = zone->getCenter();
 
-      if(getGame()->getGameObjDatabase()->pointCanSeePoint(center, point))  // This is an expensive test
+      if(static_cast<ServerGame *>(getGame())->getVisibilityCache()->canSee(center, point))  // Expensive, but bots chasing the same thing share it
       {
          closestZone = zone->getZoneId();
          break;
@@ -842,21 +882,9 @@ S32 Robot::lua_getWaypoint(lua_State *L)
    // or the path we had no longer applied to our current location
    flightPlanTo = targetZone;
 
-   // check cache for path first
-   pair<S32,S32> pathIndex = pair<S32,S32>(currentZone, targetZone);
-
+   // Routes are shared by all bots, so most of the time someone else has already done the work
    const Vector<BotNavMeshZone *> *zones = static_cast<ServerGame *>(getGame())->getBotZones();  // Our pre-cached list of nav zones
-
-   if(getGame()->getGameType()->cachedBotFlightPlans.find(pathIndex) == getGame()->getGameType()->cachedBotFlightPlans.end())
-   {
-      // Not found so calculate flight plan
-      flightPlan = AStar::findPath(zones, currentZone, targetZone, target);
-
-      // Add to cache
-      getGame()->getGameType()->cachedBotFlightPlans[pathIndex] = flightPlan;
-   }
-   else
-      flightPlan = getGame()->getGameType()->cachedBotFlightPlans[pathIndex];
+   static_cast<ServerGame *>(getGame())->getZoneRouteCache()->getRoute(zones, currentZone, targetZone, target, flightPlan);
 
    if(flightPlan.size() > 0)
       return returnPoint(L, flightPlan.last());
@@ -904,7 +932,7 @@ S32 Robot::lua_findClosestEnemy(lua_State *L)
    F32 minDist = F32_MAX;
    Ship *closest = NULL;
 
-   fillVector.clear();
+   Vector<DatabaseObject *> fillVector;
 
    if(useRange)
       getGame()->getGameObjDatabase()->findObjects((TestFunc)isShipType, fillVector, queryRect);   
@@ -1301,10 +1329,8 @@ S32 Robot::lua_findVisibleObjects(lua_State *L)
    Rect queryRect(pos, pos);
    queryRect.expand(getGame()->computePlayerVisArea(this));
 
-   fillVector.clear();
-   static Vector<U8> types;
-
-   types.clear();
+   Vector<DatabaseObject *> fillVector;
+   Vector<U8> types;
 
    // We expect the stack to look like this: -- objType1, objType2, ...
    // or this, if using the deprecated fill table option -- [fillTable], objType1, objType2, ...
@@ -83,6 +83,7 @@ public:
 
 
    const char *getScriptName();
+   string getProfileName();
 
    Robot *clone() const;
 
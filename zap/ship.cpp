@@ -339,7 +339,7 @@ F32 Ship::processMove(U32 stateIndex)
       setVel(stateIndex, getVel(stateIndex) + accel);
    }
 
-   return move(time, stateIndex, false);
+   return move(time, stateIndex, false, *getGame()->getMoveScratch());
 }
 
 
@@ -347,7 +347,8 @@ F32 Ship::processMove(U32 stateIndex)
 // If ship is in multiple zones, an aribtrary one will be returned, and the level designer will be flogged.
 BfObject *Ship::isInAnyZone() const
 {
-   findObjectsUnderShip((TestFunc)isZoneType);  // Fills fillVector
+   Vector<DatabaseObject *> fillVector;
+   findObjectsUnderShip((TestFunc)isZoneType, fillVector);
    return doIsInZone(fillVector);
 }
 
@@ -356,12 +357,13 @@ BfObject *Ship::isInAnyZone() const
 // If ship is in multiple zones of type zoneTypeNumber, an aribtrary one will be returned, and the level designer will be flogged.
 BfObject *Ship::isInZone(U8 zoneTypeNumber) const
 {
-   findObjectsUnderShip(zoneTypeNumber);        // Fills fillVector
+   Vector<DatabaseObject *> fillVector;
+   findObjectsUnderShip(zoneTypeNumber, fillVector);
    return doIsInZone(fillVector);
 }
 
 
-// Private helper for isInZone() and isInAnyZone() -- these fill fillVector, and we operate on it below
+// Private helper for isInZone() and isInAnyZone() -- objects are the candidates found by findObjectsUnderShip()
 BfObject *Ship::doIsInZone(const Vector<DatabaseObject *> &objects) const
 {
    if(objects.size() == 0)  // Ship isn't in extent of any objectType objects, can bail here
@@ -386,7 +388,8 @@ BfObject *Ship::doIsInZone(const Vector<DatabaseObject *> &objects) const
 // Returns the object in question if this ship is on an object of type objectType
 DatabaseObject *Ship::isOnObject(U8 objectType, U32 stateIndex)
 {
-   findObjectsUnderShip(objectType);
+   Vector<DatabaseObject *> fillVector;
+   findObjectsUnderShip(objectType, fillVector);
 
    if(fillVector.size() == 0)  // Ship isn't in extent of any objectType objects, can bail here
       return NULL;
@@ -691,8 +694,6 @@ bool Ship::checkForSpeedzones(U32 stateIndex)
 }
 
 
-static Vector<DatabaseObject *> foundObjects;      // Reusable container
-
 void Ship::findRepairTargets()
 {
    // We use the render position in findRepairTargets so that
@@ -703,7 +704,7 @@ void Ship::findRepairTargets()
    Point pos = getRenderPos();
    Rect r(pos, (RepairRadius + CollisionRadius));
    
-   foundObjects.clear();
+   Vector<DatabaseObject *> foundObjects;
    findObjects((TestFunc)isWithHealthType, foundObjects, r);   // All isWithHealthType objects are items
 
    for(S32 i = 0; i < foundObjects.size(); i++)
@@ -1320,6 +1321,9 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
 {
    GameConnection *gameConnection = (GameConnection *) connection;
 
+   // What gets written depends on whether the client controls this ship
+   gameConnection->markPackUpdateConnectionSpecific();
+
    if(isInitialUpdate())      // This stuff gets sent only once per ship
    {
       // We'll need the name (or some other identifier) to match the ship to its clientInfo on the client side
@@ -1914,7 +1918,7 @@ void Ship::kill()
       // Fire the ShipLeftZoneEvent for every zone the ship is in
       Vector<SafePtr<Zone> > zoneList;   // Reuse our reusable container
 
-      getZonesObjectIsIn(zoneList);
+      getZonesObjectIsIn(zoneList, *getGame()->getMoveScratch());
    
       for(S32 i = 0; i < zoneList.size(); i++)
          EventManager::get()->fireEvent(EventManager::ShipLeftZoneEvent, this, static_cast<Zone *>(zoneList[i].getPointer()));
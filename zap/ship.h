@@ -51,12 +51,11 @@ private:
    // Find objects of specified type that may be under the ship, and put them in fillVector.  This is a private helper
    // for isInZone() and isInAnyZone().
    template <typename T>
-   void findObjectsUnderShip(T typeNumberOrFunction) const
+   void findObjectsUnderShip(T typeNumberOrFunction, Vector<DatabaseObject *> &fillVector) const
    {
       Rect rect(getActualPos(), getActualPos());
       rect.expand(Point(CollisionRadius, CollisionRadius));
 
-      fillVector.clear();           // This vector will hold any matching zones
       findObjects(typeNumberOrFunction, fillVector, rect);
    }
 
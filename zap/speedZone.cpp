@@ -455,7 +455,7 @@ bool SpeedZone::collided(BfObject *hitObject, U32 stateIndex)
       s->setVel(stateIndex, newPos - oldPos);
 
       F32 collisionTime = 1;
-      s->findFirstCollision(stateIndex, collisionTime, collisionPoint);
+      s->findFirstCollision(stateIndex, collisionTime, collisionPoint, *getGame()->getMoveScratch());
 
       p = s->getPos(stateIndex) + s->getVel(stateIndex) * collisionTime;    // x = x + vt
       s->setPos(stateIndex, p);